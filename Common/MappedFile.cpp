@@ -0,0 +1,135 @@
+// Author : Jihong Shin (snowapril)
+
+#include <Common/pch.h>
+#include <Common/MappedFile.h>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace vfs
+{
+	MappedFile::MappedFile(const char* filePath)
+	{
+		open(filePath);
+	}
+
+	MappedFile::~MappedFile()
+	{
+		close();
+	}
+
+#if defined(_WIN32)
+	bool MappedFile::open(const char* filePath)
+	{
+		close();
+
+		HANDLE file = CreateFileA(filePath, GENERIC_READ, FILE_SHARE_READ, nullptr,
+								  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+
+		LARGE_INTEGER fileSize = {};
+		if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping == nullptr)
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (view == nullptr)
+		{
+			CloseHandle(mapping);
+			CloseHandle(file);
+			return false;
+		}
+
+		_fileHandle		= file;
+		_mappingHandle	= mapping;
+		_data			= static_cast<const uint8_t*>(view);
+		_size			= static_cast<size_t>(fileSize.QuadPart);
+		return true;
+	}
+
+	void MappedFile::close(void)
+	{
+		if (_data != nullptr)
+		{
+			UnmapViewOfFile(_data);
+			_data = nullptr;
+		}
+		if (_mappingHandle != nullptr)
+		{
+			CloseHandle(static_cast<HANDLE>(_mappingHandle));
+			_mappingHandle = nullptr;
+		}
+		if (_fileHandle != nullptr)
+		{
+			CloseHandle(static_cast<HANDLE>(_fileHandle));
+			_fileHandle = nullptr;
+		}
+		_size = 0;
+	}
+#else
+	bool MappedFile::open(const char* filePath)
+	{
+		close();
+
+		int fd = ::open(filePath, O_RDONLY);
+		if (fd < 0)
+		{
+			return false;
+		}
+
+		struct stat fileStat = {};
+		if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0)
+		{
+			::close(fd);
+			return false;
+		}
+
+		void* view = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+		if (view == MAP_FAILED)
+		{
+			::close(fd);
+			return false;
+		}
+
+		_fileDescriptor = fd;
+		_data			= static_cast<const uint8_t*>(view);
+		_size			= static_cast<size_t>(fileStat.st_size);
+		return true;
+	}
+
+	void MappedFile::close(void)
+	{
+		if (_data != nullptr)
+		{
+			munmap(const_cast<uint8_t*>(_data), _size);
+			_data = nullptr;
+		}
+		if (_fileDescriptor >= 0)
+		{
+			::close(_fileDescriptor);
+			_fileDescriptor = -1;
+		}
+		_size = 0;
+	}
+#endif
+}
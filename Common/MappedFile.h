@@ -0,0 +1,52 @@
+// Author : Jihong Shin (snowapril)
+
+#if !defined(COMMON_MAPPED_FILE_H)
+#define COMMON_MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace vfs
+{
+	//! Read-only memory mapped view of a whole file.
+	//! Pages are faulted in lazily by the OS, so opening a large file is cheap
+	//! and only the touched ranges are actually read from disk.
+	class MappedFile
+	{
+	public:
+		explicit MappedFile() = default;
+		explicit MappedFile(const char* filePath);
+				~MappedFile();
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+	public:
+		bool open	(const char* filePath);
+		void close	(void);
+
+		inline bool isOpen(void) const
+		{
+			return _data != nullptr;
+		}
+		inline const uint8_t* getData(void) const
+		{
+			return _data;
+		}
+		inline size_t getSize(void) const
+		{
+			return _size;
+		}
+
+	private:
+		const uint8_t*	_data			{ nullptr };
+		size_t			_size			{ 0 };
+#if defined(_WIN32)
+		void*			_fileHandle		{ nullptr };
+		void*			_mappingHandle	{ nullptr };
+#else
+		int				_fileDescriptor	{ -1 };
+#endif
+	};
+}
+
+#endif
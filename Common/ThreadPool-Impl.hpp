@@ -0,0 +1,63 @@
+// Author : Jihong Shin (snowapril)
+
+#if !defined(COMMON_THREAD_POOL_IMPL_H)
+#define COMMON_THREAD_POOL_IMPL_H
+
+#include <algorithm>
+#include <memory>
+
+namespace vfs
+{
+	template <typename Func>
+	std::future<std::invoke_result_t<Func>> ThreadPool::enqueue(Func&& job)
+	{
+		using ReturnType = std::invoke_result_t<Func>;
+
+		// std::function requires copyable callable, so packaged_task is shared
+		auto task = std::make_shared<std::packaged_task<ReturnType()>>(std::forward<Func>(job));
+		std::future<ReturnType> result = task->get_future();
+
+		if (_workers.empty())
+		{
+			// snowapril : pool without workers runs the job in place
+			(*task)();
+			return result;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_jobs.emplace([task]() { (*task)(); });
+		}
+		_condition.notify_one();
+		return result;
+	}
+
+	template <typename Func>
+	void ThreadPool::parallelFor(uint32_t count, Func&& func)
+	{
+		std::atomic<uint32_t> nextIndex{ 0 };
+		auto worker = [&nextIndex, &func, count]()
+		{
+			for (uint32_t index = nextIndex++; index < count; index = nextIndex++)
+			{
+				func(index);
+			}
+		};
+
+		const uint32_t numJobs = count > 1 ? std::min(getNumThreads(), count - 1) : 0;
+		std::vector<std::future<void>> jobs;
+		jobs.reserve(numJobs);
+		for (uint32_t i = 0; i < numJobs; ++i)
+		{
+			jobs.emplace_back(enqueue(worker));
+		}
+
+		worker();
+		for (std::future<void>& job : jobs)
+		{
+			job.wait();
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,76 @@
+// Author : Jihong Shin (snowapril)
+
+#include <Common/pch.h>
+#include <Common/ThreadPool.h>
+#include <cassert>
+
+namespace vfs
+{
+	ThreadPool::ThreadPool(uint32_t numThreads)
+	{
+		// snowapril : initialize must run in release builds as well, assert only checks its result
+		const bool bInitialized = initialize(numThreads);
+		assert(bInitialized);
+		(void)bInitialized;
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		destroyThreadPool();
+	}
+
+	bool ThreadPool::initialize(uint32_t numThreads)
+	{
+		_bStopping = false;
+		_workers.reserve(numThreads);
+		for (uint32_t i = 0; i < numThreads; ++i)
+		{
+			_workers.emplace_back(&ThreadPool::workerLoop, this);
+		}
+		return true;
+	}
+
+	void ThreadPool::destroyThreadPool(void)
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_bStopping = true;
+		}
+		_condition.notify_all();
+
+		// Remaining jobs are drained by workers before they exit
+		for (std::thread& worker : _workers)
+		{
+			if (worker.joinable())
+			{
+				worker.join();
+			}
+		}
+		_workers.clear();
+	}
+
+	uint32_t ThreadPool::GetDefaultNumThreads(void)
+	{
+		const uint32_t numThreads = std::thread::hardware_concurrency();
+		return numThreads > 0 ? numThreads : 1;
+	}
+
+	void ThreadPool::workerLoop(void)
+	{
+		for (;;)
+		{
+			std::function<void()> job;
+			{
+				std::unique_lock<std::mutex> lock(_mutex);
+				_condition.wait(lock, [this]() { return _bStopping || !_jobs.empty(); });
+				if (_jobs.empty())
+				{
+					return;
+				}
+				job = std::move(_jobs.front());
+				_jobs.pop();
+			}
+			job();
+		}
+	}
+}
@@ -0,0 +1,64 @@
+// Author : Jihong Shin (snowapril)
+
+#if !defined(COMMON_THREAD_POOL_H)
+#define COMMON_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace vfs
+{
+	//! Fixed size worker pool for CPU side jobs such as scene importing.
+	//! Jobs are executed in FIFO order, results are delivered through std::future.
+	class ThreadPool
+	{
+	public:
+		explicit ThreadPool() = default;
+		explicit ThreadPool(uint32_t numThreads);
+				~ThreadPool();
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+	public:
+		bool initialize			(uint32_t numThreads);
+		void destroyThreadPool	(void);
+
+		template <typename Func>
+		std::future<std::invoke_result_t<Func>> enqueue(Func&& job);
+
+		//! Call func(index) for every index in [0, count) and wait for all of them.
+		//! Indices are handed out dynamically, so uneven workloads are balanced.
+		//! The calling thread participates in the work as well.
+		template <typename Func>
+		void parallelFor(uint32_t count, Func&& func);
+
+		inline uint32_t getNumThreads(void) const
+		{
+			return static_cast<uint32_t>(_workers.size());
+		}
+
+		//! Returns hardware concurrency, at least one
+		static uint32_t GetDefaultNumThreads(void);
+
+	private:
+		void workerLoop(void);
+
+	private:
+		std::vector<std::thread>			_workers;
+		std::queue<std::function<void()>>	_jobs;
+		std::mutex							_mutex;
+		std::condition_variable				_condition;
+		bool								_bStopping	{ false };
+	};
+}
+
+#include <Common/ThreadPool-Impl.hpp>
+
+#endif
@@ -7,7 +7,39 @@ namespace vfs
 {
     unsigned int VertexHelper::GetNumBytes(VertexFormat vertexFormat)
     {
-        return GetNumFloats(vertexFormat) * sizeof(float);
+        if (!static_cast<bool>(vertexFormat & VertexFormat::Quantized))
+        {
+            return GetNumFloats(vertexFormat) * sizeof(float);
+        }
+
+        // Position (RGBA16 unorm), Normal (octahedral RG16 snorm), TexCoord (half floats),
+        // Color (RGBA8 unorm), Tangent (octahedral RG8 snorm with handedness in A)
+        unsigned int numBytes{ 0 };
+        if (static_cast<bool>(vertexFormat & VertexFormat::Position3))
+        {
+            numBytes += 8;
+        }
+        if (static_cast<bool>(vertexFormat & VertexFormat::Normal3))
+        {
+            numBytes += 4;
+        }
+        if (static_cast<bool>(vertexFormat & VertexFormat::TexCoord2))
+        {
+            numBytes += 4;
+        }
+        if (static_cast<bool>(vertexFormat & VertexFormat::TexCoord3))
+        {
+            numBytes += 8;
+        }
+        if (static_cast<bool>(vertexFormat & VertexFormat::Color4))
+        {
+            numBytes += 4;
+        }
+        if (static_cast<bool>(vertexFormat & VertexFormat::Tangent4))
+        {
+            numBytes += 4;
+        }
+        return numBytes;
     }
 
     unsigned int VertexHelper::GetNumFloats(VertexFormat vertexFormat)
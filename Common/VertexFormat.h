@@ -14,7 +14,8 @@ namespace vfs
         TexCoord3   = 1 << 3,
         Color4      = 1 << 4,
         Tangent4    = 1 << 5,
-        Last        = 1 << 6,
+        Quantized   = 1 << 6, // Attributes are packed into compact formats on upload
+        Last        = 1 << 7,
         Position3Normal3    = Position3 | Normal3,
         Position3TexCoord2  = Position3 | TexCoord2,
         Position3TexCoord3  = Position3 | TexCoord3,
@@ -40,12 +41,18 @@ namespace vfs
                                          static_cast<unsigned int>(b));
     }
 
+    inline VertexFormat operator~(VertexFormat a)
+    {
+        return static_cast<VertexFormat>(~static_cast<unsigned int>(a));
+    }
+
     class VertexHelper
     {
     public:
         VertexHelper() = delete;
 
     public:
+        //! Returns packed size of the attributes if Quantized flag is given
         static unsigned int GetNumBytes (VertexFormat vertexFormat);
         static unsigned int GetNumFloats(VertexFormat vertexFormat);
     };
@@ -5,9 +5,12 @@
 #include <Common/CPUTimer.h>
 #include <Common/Logger.h>
 #include <VulkanFramework/Commands/CommandPool.h>
+#include <VulkanFramework/Buffers/UploadManager.h>
+#include <VulkanFramework/Buffers/FrameUniformAllocator.h>
 #include <VulkanFramework/Device.h>
 #include <VulkanFramework/Window.h>
 #include <VulkanFramework/Queue.h>
+#include <VulkanFramework/Sync/SubmissionScheduler.h>
 #include <VulkanFramework/RenderPass/RenderPass.h>
 #include <VulkanFramework/FrameLayout.h>
 #include <RenderPass/GBufferPass.h>
@@ -48,6 +51,7 @@ namespace vfs
     void Application::destroyApplication(void)
     {
         vkDeviceWaitIdle(_device->getDeviceHandle());
+        _drawCuller.reset();
         _clipmapDownSampler.reset();
         _clipmapBorderWrapper.reset();
         _clipmapCleaner.reset();
@@ -57,6 +61,9 @@ namespace vfs
         _mainCamera.reset();
         _renderer.reset();
         _uiRenderer.reset();
+        _frameUniformAllocator.reset();
+        _uploadManager.reset();
+        _graphicsScheduler.reset();
         _mainCommandPool.reset();
         _loaderQueue.reset();
         _presentQueue.reset();
@@ -75,14 +82,16 @@ namespace vfs
             return false;
         }
 
-        _mainCamera     = std::make_shared<Camera>(_window, _device, _renderer->getFrameCount());
-        _sceneManager   = std::make_unique<SceneManager>(_graphicsQueue, VertexFormat::Position3Normal3TexCoord2Tangent4);
+        _mainCamera     = std::make_shared<Camera>(_window, _device, MAX_NUM_FRAMES);
+        _sceneManager   = std::make_unique<SceneManager>(_uploadManager, _loaderQueue, VertexFormat::Position3Normal3TexCoord2Tangent4 |
+                                                            (DEFAULT_PACKED_VERTEX_FORMAT ? VertexFormat::Quantized : VertexFormat::None));
         _uiRenderer     = std::make_unique<UIRenderer>(_window, _device, _graphicsQueue, _renderer->getSwapChainRenderPass()->getHandle());
         _uiRenderer->createFontTexture(_mainCommandPool);
 
         _renderPassManager = std::make_shared<RenderPassManager>(_device);
         _renderPassManager->put("MainCamera",   _mainCamera.get());
         _renderPassManager->put("SceneManager", _sceneManager.get());
+        _renderPassManager->put("GraphicsScheduler", _graphicsScheduler.get());
 
         if (!buildCommonPasses())
         {
@@ -130,14 +139,21 @@ namespace vfs
     
     void Application::run(void)
     {
-        QueryPool preQueryPool(_device, 8);
+        // Pre-pass resources are duplicated per frame in flight, so recording a frame never
+        // waits for the pre-pass of the previous one. Frames in flight can be raised up to MAX_NUM_FRAMES
+        std::vector<VkCommandBuffer> preCmdBuffers = _mainCommandPool->allocateMultipleCommandBuffer(MAX_NUM_FRAMES);
+        std::vector<std::unique_ptr<QueryPool>> preQueryPools, mainQueryPools;
+        std::vector<bool> queriesWritten(MAX_NUM_FRAMES, false);
+        int numFramesInFlight = static_cast<int>(DEFAULT_NUM_FRAMES);
+        for (uint32_t i = 0; i < MAX_NUM_FRAMES; ++i)
+        {
+            preQueryPools.emplace_back(std::make_unique<QueryPool>(_device, 8));
+            mainQueryPools.emplace_back(std::make_unique<QueryPool>(_device, 4));
+        }
         std::vector<VkDeviceSize> preQueryResults(8);
-        QueryPool mainQueryPool(_device, 4);
         std::vector<VkDeviceSize> mainQueryResults(4);
-        Fence fence(_device, 1, 0);
         DebugUtils debugUtils(_device);
 
-        CommandBuffer preCmdBuffer(_mainCommandPool->allocateCommandBuffer());
         std::chrono::steady_clock::time_point currentTime = std::chrono::high_resolution_clock::now();
         while (!_window->getWindowShouldClose())
         {
@@ -153,80 +169,116 @@ namespace vfs
             _window->processKeyInput();
             updateClipRegionBoundingBox();
 
+            // Frame count changed on GUI last frame is applied between frames
+            _renderer->setNumFrames(static_cast<uint32_t>(numFramesInFlight));
+
+            // Waits timeline value of the last frame submitted with this index. Main pass waits the pre-pass
+            // of the same frame on GPU, so both command buffers of this index are retired after this call
+            CommandBuffer cmdBuffer(_renderer->beginFrame());
+            if (cmdBuffer.getHandle() == VK_NULL_HANDLE)
+            {
+                // snowapril : nothing reaches the queue anymore once a frame submission failed
+                if (_renderer->isSubmissionLost())
+                {
+                    VFS_ERROR << "Frame submission failed, leaving the main loop";
+                    break;
+                }
+                continue;
+            }
+            const uint32_t frameIndex = _renderer->getCurrentFrameIndex();
+            CommandBuffer preCmdBuffer(preCmdBuffers[frameIndex]);
+            QueryPool* preQueryPool  = preQueryPools[frameIndex].get();
+            QueryPool* mainQueryPool = mainQueryPools[frameIndex].get();
+
+            // Slices written into this frame region last time are never read by GPU anymore
+            _frameUniformAllocator->beginFrame(frameIndex);
+            _drawCuller->beginFrame(frameIndex);
+
+            // Timings are as old as frames in flight, queries are waited with result only once written
+            if (queriesWritten[frameIndex])
+            {
+                preQueryPool->readQueryResults(&preQueryResults);
+                mainQueryPool->readQueryResults(&mainQueryResults);
+            }
+            queriesWritten[frameIndex] = true;
+
+            // Scenes finished on the loader thread join from this frame on
+            _sceneManager->publishLoadedScenes();
+
             {
                 vfs::FrameLayout frame = {
-                    _mainCamera->getDescriptorSet(_renderer->getCurrentFrameIndex()),
+                    _mainCamera->getDescriptorSet(frameIndex),
                     preCmdBuffer.getHandle(),
-                    _renderer->getCurrentFrameIndex(),
+                    frameIndex,
                     elapsedTime,
                 };
                 _mainCamera->updateCamera(frame.frameIndex);
             
                 preCmdBuffer.beginRecord(0);
-                preQueryPool.resetQueryPool(preCmdBuffer.getHandle());
+                preQueryPool->resetQueryPool(preCmdBuffer.getHandle());
             
                 // 0. GBuffer Pass
                 {
-                    preQueryPool.writeTimeStamp(preCmdBuffer.getHandle(), VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0);
+                    preQueryPool->writeTimeStamp(preCmdBuffer.getHandle(), VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0);
                     _renderPassManager->drawSingleRenderPass("GBuffer", &frame);
-                    preQueryPool.writeTimeStamp(preCmdBuffer.getHandle(), VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 1);
+                    preQueryPool->writeTimeStamp(preCmdBuffer.getHandle(), VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 1);
                 }
             
                 // 1. Voxelization Pass(Opacity Encoding)
                 {
-                    preQueryPool.writeTimeStamp(preCmdBuffer.getHandle(), VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 2);
+                    preQueryPool->writeTimeStamp(preCmdBuffer.getHandle(), VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 2);
                     _renderPassManager->drawSingleRenderPass("VoxelizationPass", &frame);
-                    preQueryPool.writeTimeStamp(preCmdBuffer.getHandle(), VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 3);
+                    preQueryPool->writeTimeStamp(preCmdBuffer.getHandle(), VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 3);
                 }
             
                 // 2. Shadow Map Pass
                 {
-                    preQueryPool.writeTimeStamp(preCmdBuffer.getHandle(), VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 4);
+                    preQueryPool->writeTimeStamp(preCmdBuffer.getHandle(), VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 4);
                     _renderPassManager->drawSingleRenderPass("RSMPass", &frame);
-                    preQueryPool.writeTimeStamp(preCmdBuffer.getHandle(), VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 5);
+                    preQueryPool->writeTimeStamp(preCmdBuffer.getHandle(), VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 5);
                 }
             
                 // 3. Radiance Injection Pass (Radiance Encoding)
                 {
-                    preQueryPool.writeTimeStamp(preCmdBuffer.getHandle(), VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 6);
+                    preQueryPool->writeTimeStamp(preCmdBuffer.getHandle(), VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 6);
                     _renderPassManager->drawSingleRenderPass("RadianceInjectionPass", &frame);
-                    preQueryPool.writeTimeStamp(preCmdBuffer.getHandle(), VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 7);
+                    preQueryPool->writeTimeStamp(preCmdBuffer.getHandle(), VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 7);
                 }
             
                 preCmdBuffer.endRecord();
-                
-                // TODO(snowapril) : sync using semaphore
-                fence.resetFence();
-                _graphicsQueue->submitCmdBuffer({ preCmdBuffer }, &fence);
-                fence.waitForAllFences(UINT64_MAX);
-            
-                preQueryPool.readQueryResults(&preQueryResults);
+
+                // Uploads enqueued since last frame must precede this frame's submissions.
+                // Both reach the queue with the main pass in one submission at the end of the frame
+                _uploadManager->enqueue();
+                const uint64_t prePassValue = _graphicsScheduler->enqueue({ preCmdBuffer.getHandle() });
+
+                // Main pass reads every pre-pass output, so its whole submission waits the pre-pass
+                _renderer->addWaitSemaphore(_graphicsScheduler->getTimelineHandle(), prePassValue, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
             }
 
             // Main renderer pass for voxel cone tracing and UI Rendering
             {
-                CommandBuffer cmdBuffer(_renderer->beginFrame());
-                mainQueryPool.resetQueryPool(cmdBuffer.getHandle());
+                mainQueryPool->resetQueryPool(cmdBuffer.getHandle());
 
                 vfs::FrameLayout frame = {
-                    _mainCamera->getDescriptorSet(_renderer->getCurrentFrameIndex()),
+                    _mainCamera->getDescriptorSet(frameIndex),
                     cmdBuffer.getHandle(),
-                    _renderer->getCurrentFrameIndex(),
+                    frameIndex,
                     elapsedTime,
                 };
 
                 // 4. Voxel Cone Tracing Pass
                 {
-                    mainQueryPool.writeTimeStamp(cmdBuffer.getHandle(), VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0);
+                    mainQueryPool->writeTimeStamp(cmdBuffer.getHandle(), VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0);
                     _renderPassManager->drawSingleRenderPass("VoxelConeTracingPass", &frame);
-                    mainQueryPool.writeTimeStamp(cmdBuffer.getHandle(), VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 1);
+                    mainQueryPool->writeTimeStamp(cmdBuffer.getHandle(), VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 1);
                 }
 
                 // 5. Specular filtering pass
                 {
-                    mainQueryPool.writeTimeStamp(cmdBuffer.getHandle(), VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 2);
+                    mainQueryPool->writeTimeStamp(cmdBuffer.getHandle(), VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 2);
                     _renderPassManager->drawSingleRenderPass("SpecularFilterPass", &frame);
-                    mainQueryPool.writeTimeStamp(cmdBuffer.getHandle(), VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 3);
+                    mainQueryPool->writeTimeStamp(cmdBuffer.getHandle(), VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 3);
                 }
 
                 _renderer->beginRenderPass(frame.commandBuffer);
@@ -238,6 +290,7 @@ namespace vfs
                     _uiRenderer->beginUIRender();
                     _renderPassManager->drawGUIRenderPasses();
                     _sceneManager->drawGUI();
+                    _drawCuller->drawGUI();
 
                     if (ImGui::TreeNode("Performance Metrices"))
                     {
@@ -250,7 +303,9 @@ namespace vfs
                         const float totalMs = gbufferPassMs + voxelizationPassMs + shadowPassMs +
                                               radianceInjectionPassMs + voxelConeTracingPassMs + specularFilterPassMs;
 
-                        ImGui::PlotVar("GBuffer Pass",              gbufferPassMs);
+                        // Each GBuffer path keeps its own history, so they can be compared after toggling
+                        const GBufferPass* gbufferPass = static_cast<GBufferPass*>(_renderPassManager->getRenderPass("GBuffer"));
+                        ImGui::PlotVar(gbufferPass->getShadingPathName(), gbufferPassMs);
                         ImGui::PlotVar("Voxelization Pass",         voxelizationPassMs);
                         ImGui::PlotVar("Shadow Pass",               shadowPassMs);
                         ImGui::PlotVar("Radiance Injection Pass",   radianceInjectionPassMs);
@@ -260,6 +315,19 @@ namespace vfs
                         ImGui::TreePop();
                     }
 
+                    if (ImGui::TreeNode("Frames In Flight"))
+                    {
+                        // More frames in flight hide CPU and GPU stalls at the cost of input latency
+                        ImGui::SliderInt("Frames in flight", &numFramesInFlight, 1, static_cast<int>(MAX_NUM_FRAMES));
+                        bool bValidate = _renderer->isFrameHazardValidationEnabled();
+                        if (ImGui::Checkbox("Validate frame hazards", &bValidate))
+                        {
+                            _renderer->setFrameHazardValidation(bValidate);
+                        }
+                        ImGui::Text("Frame hazards : %u", _renderer->getNumFrameHazards());
+                        ImGui::TreePop();
+                    }
+
                     if (ImGui::Begin("DebugInfo"))
                     {
                         _renderPassManager->drawDebugInfoRenderPasses();
@@ -269,11 +337,19 @@ namespace vfs
                     _uiRenderer->endUIRender(&frame);
                 }
                 _renderer->endRenderPass(cmdBuffer.getHandle());
+
+                // Versions of per-frame resources written or read by this frame, checked in test mode only
+                const DirectionalLight* dirLight = _renderPassManager->get<DirectionalLight>("DirectionalLight");
+                _renderer->validateFrameVersion("FrameUniformAllocator",    _frameUniformAllocator->getFrameIndex());
+                _renderer->validateFrameVersion("DrawCuller",               _drawCuller->getFrameIndex());
+                _renderer->validateFrameVersion("CameraUniform",            frame.frameIndex);
+                _renderer->validateFrameVersion("DirectionalLight",         dirLight->getFrameIndex());
+                _renderer->validateFrameVersion("PrePassCommandBuffer",     frameIndex);
                 _renderer->endFrame();
-                mainQueryPool.readQueryResults(&mainQueryResults);
             }
         }
         vkDeviceWaitIdle(_device->getDeviceHandle());
+        _mainCommandPool->freeCommandBuffers(preCmdBuffers);
     }
 
     bool Application::initializeVulkanDevice(void)
@@ -346,22 +422,36 @@ namespace vfs
             return false;
         }
 
-        _device->initializeLogicalDevice({ graphicsFamily, presentFamily, loaderFamily });
+        // Loader thread submits concurrently with the render thread, so it needs its own VkQueue.
+        // snowapril : second queue of the family is used when loader shares the family with others
+        const bool bSharedLoaderFamily = loaderFamily == graphicsFamily || loaderFamily == presentFamily;
+        const uint32_t loaderQueueIndex = bSharedLoaderFamily && queueFamilyProperties[loaderFamily].queueCount > 1 ? 1 : 0;
+        _device->initializeLogicalDevice({ graphicsFamily, presentFamily, loaderFamily }, loaderQueueIndex + 1);
         _device->initializeMemoryAllocator();
 
         _graphicsQueue  = std::make_shared<vfs::Queue>(_device, graphicsFamily);
         _presentQueue   = std::make_shared<vfs::Queue>(_device, presentFamily);
-        _loaderQueue    = std::make_shared<vfs::Queue>(_device, loaderFamily);
+        if (!bSharedLoaderFamily || loaderQueueIndex > 0)
+        {
+            _loaderQueue = std::make_shared<vfs::Queue>(_device, loaderFamily, loaderQueueIndex);
+        }
+        else
+        {
+            VFS_WARN << "No queue left for the loader, scenes are uploaded on the render thread";
+        }
 
         _mainCommandPool = std::make_shared<vfs::CommandPool>(_device, _graphicsQueue,
             VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+        _graphicsScheduler = std::make_shared<vfs::SubmissionScheduler>(_graphicsQueue);
+        _uploadManager = std::make_shared<vfs::UploadManager>(_device, _graphicsScheduler, DEFAULT_UPLOAD_RING_SIZE);
+        _frameUniformAllocator = std::make_shared<vfs::FrameUniformAllocator>(_device, MAX_NUM_FRAMES, DEFAULT_FRAME_UNIFORM_SIZE);
 
         using namespace std::placeholders;
         Window::KeyCallback inputCallback = std::bind(&Application::processKeyInput, this, _1, _2);
         _window->operator+=(inputCallback);
 
         _renderer = std::make_unique<Renderer>(
-            _device, _mainCommandPool, std::make_unique<SwapChain>(_graphicsQueue, _presentQueue, _window, surface)
+            _device, _mainCommandPool, _graphicsScheduler, std::make_unique<SwapChain>(_graphicsQueue, _presentQueue, _window, surface)
         );
 
         return true;
@@ -369,6 +459,16 @@ namespace vfs
 
     bool Application::buildCommonPasses(void)
     {
+        // Scene passes cull their views through this before drawing
+        _drawCuller = std::make_unique<DrawCuller>(_device);
+        {
+            CPUTimer timer;
+            _drawCuller->createDescriptors(_sceneManager.get(), _frameUniformAllocator)
+                        .createPipeline();
+            VFS_INFO << "DrawCuller loaded ( " << timer.elapsedSeconds() << " second )";
+        }
+        _renderPassManager->put("DrawCuller", _drawCuller.get());
+
         {
             std::unique_ptr<GBufferPass> gbufferPass = std::make_unique<GBufferPass>(_mainCommandPool, _window->getWindowExtent());
             CPUTimer timer;
@@ -376,7 +476,8 @@ namespace vfs
             gbufferPass->createAttachments()
                        .createRenderPass()
                        .createFramebuffer()
-                       .createPipeline(_mainCamera->getDescriptorSetLayout());
+                       .createPipeline(_mainCamera->getDescriptorSetLayout())
+                       .createHiZPyramid();
             gbufferPass->initializeDebugPass();
             VFS_INFO << "GBuffer pass loaded ( " << timer.elapsedSeconds() << " second )";
             _renderPassManager->addRenderPass("GBuffer", std::move(gbufferPass));
@@ -417,7 +518,7 @@ namespace vfs
                        .createRenderPass()
                        .createFramebuffer(_window->getWindowExtent())
                        .createVoxelClipmap()
-                       .createDescriptors();
+                       .createDescriptors(_frameUniformAllocator);
             VFS_INFO << "Voxelizer loaded ( " << timer.elapsedSeconds() << " second )";
             _renderPassManager->put("Voxelizer", _voxelizer.get());
         }
@@ -486,7 +587,7 @@ namespace vfs
         _clipmapDownSampler = std::make_unique<DownSampler>(_device);
         {
             CPUTimer timer;
-            _clipmapDownSampler->createDescriptors(voxelOpacityView, voxelRadianceView, voxelSampler)
+            _clipmapDownSampler->createDescriptors(voxelOpacityView, voxelRadianceView, voxelSampler, _frameUniformAllocator)
                                 .createPipeline();
             VFS_INFO << "Downsampler loaded ( " << timer.elapsedSeconds() << " second )";
         }
@@ -495,7 +596,7 @@ namespace vfs
         _clipmapBorderWrapper = std::make_unique<BorderWrapper>(_device);
         {
             CPUTimer timer;
-            _clipmapBorderWrapper->createDescriptors(voxelOpacityView, voxelRadianceView, voxelSampler, _mainCommandPool)
+            _clipmapBorderWrapper->createDescriptors(voxelOpacityView, voxelRadianceView, voxelSampler, _uploadManager)
                                   .createPipeline();
             VFS_INFO << "BorderWrapper loaded ( " << timer.elapsedSeconds() << " second )";
         }
@@ -14,6 +14,7 @@
 #include <RenderPass/Clipmap/CopyAlpha.h>
 #include <RenderPass/Clipmap/DownSampler.h>
 #include <RenderPass/Clipmap/ClipmapCleaner.h>
+#include <RenderPass/DrawCuller.h>
 
 namespace vfs
 {
@@ -55,6 +56,9 @@ namespace vfs
 		QueuePtr		_presentQueue;
 		QueuePtr		_loaderQueue;
 		CommandPoolPtr	_mainCommandPool;
+		SubmissionSchedulerPtr	_graphicsScheduler;
+		UploadManagerPtr	_uploadManager;
+		FrameUniformAllocatorPtr	_frameUniformAllocator;
 		CameraPtr		_mainCamera;
 		std::unique_ptr<UIRenderer>				_uiRenderer;
 		std::unique_ptr<Renderer>				_renderer;
@@ -62,6 +66,7 @@ namespace vfs
 		std::shared_ptr<RenderPassManager>		_renderPassManager;
 		std::shared_ptr<Voxelizer>				_voxelizer;
 
+		std::unique_ptr<DrawCuller>		_drawCuller;
 		std::unique_ptr<DownSampler>	_clipmapDownSampler;
 		std::unique_ptr<BorderWrapper>	_clipmapBorderWrapper;
 		std::unique_ptr<ClipmapCleaner> _clipmapCleaner;
@@ -0,0 +1,252 @@
+// Author : Jihong Shin (snowapril)
+
+#include <pch.h>
+#include <BindlessTable.h>
+#include <Common/Logger.h>
+#include <Common/Utils.h>
+#include <VulkanFramework/Device.h>
+#include <VulkanFramework/DebugUtils.h>
+#include <VulkanFramework/Buffers/Buffer.h>
+#include <VulkanFramework/Descriptors/DescriptorPool.h>
+#include <VulkanFramework/Descriptors/DescriptorSet.h>
+#include <VulkanFramework/Descriptors/DescriptorSetLayout.h>
+#include <Shaders/gltf.glsl>
+#include <imgui/imgui.h>
+
+namespace vfs
+{
+	namespace
+	{
+		// Model matrix and its inverse transpose of a scene node
+		constexpr uint64_t kMatrixStride = sizeof(glm::mat4) * 2;
+
+		inline bool AllocateRange(RangeAllocator* table, uint32_t count, const char* tableName, uint32_t* first)
+		{
+			// snowapril : empty ranges are not tracked by the tables
+			uint64_t offset{ 0 };
+			if (count > 0 && !table->allocate(count, 1, &offset))
+			{
+				VFS_ERROR << "Bindless table has no free range of " << count << " " << tableName;
+				return false;
+			}
+			*first = static_cast<uint32_t>(offset);
+			return true;
+		}
+
+		inline void FreeRange(RangeAllocator* table, uint32_t first, uint32_t count)
+		{
+			if (count > 0)
+			{
+				table->free(first, count);
+			}
+		}
+	}
+
+	BindlessTable::BindlessTable(DevicePtr device, uint32_t maxNumMatrices, uint32_t maxNumMaterials,
+								 uint32_t maxNumTextures, uint32_t maxNumDraws)
+	{
+		assert(initialize(device, maxNumMatrices, maxNumMaterials, maxNumTextures, maxNumDraws));
+	}
+
+	BindlessTable::~BindlessTable()
+	{
+		destroyBindlessTable();
+	}
+
+	void BindlessTable::destroyBindlessTable(void)
+	{
+		_descriptorSet.reset();
+		_descLayout.reset();
+		_descPool.reset();
+		_matrixBuffer.reset();
+		_materialBuffer.reset();
+		_drawBuffer.reset();
+		_indirectBuffer.reset();
+		_matrixTable.reset(0);
+		_materialTable.reset(0);
+		_textureTable.reset(0);
+		_drawTable.reset(0);
+		_device.reset();
+	}
+
+	bool BindlessTable::initialize(DevicePtr device, uint32_t maxNumMatrices, uint32_t maxNumMaterials,
+								   uint32_t maxNumTextures, uint32_t maxNumDraws)
+	{
+		_device = device;
+		DebugUtils debugUtil(_device);
+
+		// Update-after-bind limits are usually lower than the plain ones
+		const VkPhysicalDeviceDescriptorIndexingProperties& limits = _device->getDescriptorIndexingProperty();
+		const uint32_t maxTextureLimit = vfs::min(limits.maxPerStageDescriptorUpdateAfterBindSamplers,
+												  limits.maxDescriptorSetUpdateAfterBindSampledImages);
+		if (maxNumTextures > maxTextureLimit)
+		{
+			VFS_WARN << "Bindless texture table is clamped to " << maxTextureLimit << " textures by device limit";
+			maxNumTextures = maxTextureLimit;
+		}
+
+		_matrixBuffer = std::make_shared<Buffer>(_device->getMemoryAllocator(), maxNumMatrices * kMatrixStride,
+												 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+												 VMA_MEMORY_USAGE_GPU_ONLY);
+		debugUtil.setObjectName(_matrixBuffer->getBufferHandle(), "Bindless Table(Matrix Buffer)");
+
+		_materialBuffer = std::make_shared<Buffer>(_device->getMemoryAllocator(), maxNumMaterials * sizeof(GltfShadeMaterial),
+												   VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+												   VMA_MEMORY_USAGE_GPU_ONLY);
+		debugUtil.setObjectName(_materialBuffer->getBufferHandle(), "Bindless Table(Material Buffer)");
+
+		_drawBuffer = std::make_shared<Buffer>(_device->getMemoryAllocator(), maxNumDraws * sizeof(GltfDrawData),
+											   VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+											   VMA_MEMORY_USAGE_GPU_ONLY);
+		debugUtil.setObjectName(_drawBuffer->getBufferHandle(), "Bindless Table(Draw Buffer)");
+
+		_indirectBuffer = std::make_shared<Buffer>(_device->getMemoryAllocator(), maxNumDraws * sizeof(VkDrawIndexedIndirectCommand),
+												   VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+												   VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+		debugUtil.setObjectName(_indirectBuffer->getBufferHandle(), "Bindless Table(Indirect Buffer)");
+
+		const std::vector<VkDescriptorPoolSize> poolSizes = {
+			{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER , 3},
+			{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, maxNumTextures },
+		};
+		_descPool = std::make_shared<DescriptorPool>(_device, poolSizes, 1, VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT);
+
+		_descLayout = std::make_shared<DescriptorSetLayout>(_device);
+		// snowapril : compute stage is included for visibility buffer resolve, which shades from the same table
+		_descLayout->addBinding(VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_COMPUTE_BIT, kMatrixBinding, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 0);
+		_descLayout->addBinding(VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT, kMaterialBinding, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 0);
+		_descLayout->addBinding(VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT, kTextureBinding, maxNumTextures, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+								VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+								VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT);
+		_descLayout->addBinding(VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_COMPUTE_BIT, kDrawBinding, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 0);
+		if (!_descLayout->createDescriptorSetLayout(VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT))
+		{
+			return false;
+		}
+
+		_descriptorSet = std::make_shared<DescriptorSet>(_device, _descPool, _descLayout, 1);
+		_descriptorSet->updateStorageBuffer({ _matrixBuffer }, kMatrixBinding, 1);
+		_descriptorSet->updateStorageBuffer({ _materialBuffer }, kMaterialBinding, 1);
+		_descriptorSet->updateStorageBuffer({ _drawBuffer }, kDrawBinding, 1);
+
+		_matrixTable.reset(maxNumMatrices);
+		_materialTable.reset(maxNumMaterials);
+		_textureTable.reset(maxNumTextures);
+		_drawTable.reset(maxNumDraws);
+		return true;
+	}
+
+	bool BindlessTable::allocate(uint32_t numMatrices, uint32_t numMaterials, uint32_t numTextures,
+								 uint32_t numDraws, Allocation* allocation)
+	{
+		std::lock_guard<std::mutex> lock(_tableMutex);
+
+		Allocation result;
+		result.numMatrices	= numMatrices;
+		result.numMaterials = numMaterials;
+		result.numTextures	= numTextures;
+		result.numDraws		= numDraws;
+		if (!AllocateRange(&_matrixTable, numMatrices, "matrices", &result.firstMatrix))
+		{
+			return false;
+		}
+		if (!AllocateRange(&_materialTable, numMaterials, "materials", &result.firstMaterial))
+		{
+			FreeRange(&_matrixTable, result.firstMatrix, numMatrices);
+			return false;
+		}
+		if (!AllocateRange(&_textureTable, numTextures, "textures", &result.firstTexture))
+		{
+			FreeRange(&_matrixTable, result.firstMatrix, numMatrices);
+			FreeRange(&_materialTable, result.firstMaterial, numMaterials);
+			return false;
+		}
+		if (!AllocateRange(&_drawTable, numDraws, "draws", &result.firstDraw))
+		{
+			FreeRange(&_matrixTable, result.firstMatrix, numMatrices);
+			FreeRange(&_materialTable, result.firstMaterial, numMaterials);
+			FreeRange(&_textureTable, result.firstTexture, numTextures);
+			return false;
+		}
+
+		*allocation = result;
+		return true;
+	}
+
+	void BindlessTable::free(const Allocation& allocation)
+	{
+		std::lock_guard<std::mutex> lock(_tableMutex);
+		FreeRange(&_matrixTable,	allocation.firstMatrix,		allocation.numMatrices);
+		FreeRange(&_materialTable,	allocation.firstMaterial,	allocation.numMaterials);
+		FreeRange(&_textureTable,	allocation.firstTexture,	allocation.numTextures);
+		FreeRange(&_drawTable,		allocation.firstDraw,		allocation.numDraws);
+	}
+
+	void BindlessTable::updateTextures(const Allocation& allocation, const std::vector<VkDescriptorImageInfo>& imageInfos)
+	{
+		assert(imageInfos.size() == allocation.numTextures);
+		// Entries without image view are skipped, texture binding is partially bound
+		size_t runBegin = 0;
+		while (runBegin < imageInfos.size())
+		{
+			if (imageInfos[runBegin].imageView == VK_NULL_HANDLE)
+			{
+				++runBegin;
+				continue;
+			}
+			size_t runEnd = runBegin + 1;
+			while (runEnd < imageInfos.size() && imageInfos[runEnd].imageView != VK_NULL_HANDLE)
+			{
+				++runEnd;
+			}
+			const std::vector<VkDescriptorImageInfo> run(imageInfos.begin() + runBegin, imageInfos.begin() + runEnd);
+			_descriptorSet->updateImage(run, kTextureBinding, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+										allocation.firstTexture + static_cast<uint32_t>(runBegin));
+			runBegin = runEnd;
+		}
+	}
+
+	void BindlessTable::drawGUI(void)
+	{
+		std::lock_guard<std::mutex> lock(_tableMutex);
+		ImGui::Text("Matrices : %llu / %llu",  _matrixTable.getUsedSize(),	 _matrixTable.getCapacity());
+		ImGui::Text("Materials : %llu / %llu", _materialTable.getUsedSize(), _materialTable.getCapacity());
+		ImGui::Text("Textures : %llu / %llu",  _textureTable.getUsedSize(),	 _textureTable.getCapacity());
+		ImGui::Text("Draws : %llu / %llu",	   _drawTable.getUsedSize(),	 _drawTable.getCapacity());
+	}
+
+	void BindlessTable::getQueueTransferBarriers(const Allocation& allocation, uint32_t srcFamily, uint32_t dstFamily,
+												 std::vector<VkBufferMemoryBarrier>* bufferBarriers) const
+	{
+		if (allocation.numMatrices > 0)
+		{
+			VkBufferMemoryBarrier barrier = _matrixBuffer->generateMemoryBarrier(VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+																				 srcFamily, dstFamily);
+			barrier.offset	= allocation.firstMatrix * kMatrixStride;
+			barrier.size	= allocation.numMatrices * kMatrixStride;
+			bufferBarriers->push_back(barrier);
+		}
+		if (allocation.numMaterials > 0)
+		{
+			VkBufferMemoryBarrier barrier = _materialBuffer->generateMemoryBarrier(VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+																				   srcFamily, dstFamily);
+			barrier.offset	= allocation.firstMaterial * sizeof(GltfShadeMaterial);
+			barrier.size	= allocation.numMaterials  * sizeof(GltfShadeMaterial);
+			bufferBarriers->push_back(barrier);
+		}
+		if (allocation.numDraws > 0)
+		{
+			VkBufferMemoryBarrier barrier = _drawBuffer->generateMemoryBarrier(VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+																			   srcFamily, dstFamily);
+			barrier.offset	= allocation.firstDraw * sizeof(GltfDrawData);
+			barrier.size	= allocation.numDraws  * sizeof(GltfDrawData);
+			bufferBarriers->push_back(barrier);
+
+			barrier = _indirectBuffer->generateMemoryBarrier(VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+															 srcFamily, dstFamily);
+			barrier.offset	= allocation.firstDraw * sizeof(VkDrawIndexedIndirectCommand);
+			barrier.size	= allocation.numDraws  * sizeof(VkDrawIndexedIndirectCommand);
+			bufferBarriers->push_back(barrier);
+		}
+	}
+}
@@ -0,0 +1,105 @@
+// Author : Jihong Shin (snowapril)
+
+#if !defined(VFS_BINDLESS_TABLE_H)
+#define VFS_BINDLESS_TABLE_H
+
+#include <pch.h>
+#include <Util/RangeAllocator.h>
+#include <mutex>
+
+namespace vfs
+{
+	//! One descriptor set shared by every scene, holding node matrices, materials and draw
+	//! entries of all scenes in storage buffers and all scene textures in one sampler array.
+	//! Scenes suballocate ranges of each table, and draws address them through indices
+	//! offset by the first element of those ranges, so the set is bound once per pass.
+	//! Each draw slot also owns one indexed indirect command whose firstInstance is the
+	//! slot index, so that shaders find their draw entry by gl_InstanceIndex.
+	//! Sampler array is update-after-bind, textures of newly loaded scenes are written
+	//! while previously recorded frames using the set are still in flight.
+	class BindlessTable : NonCopyable
+	{
+	public:
+		explicit BindlessTable() = default;
+		explicit BindlessTable(DevicePtr device, uint32_t maxNumMatrices, uint32_t maxNumMaterials,
+							   uint32_t maxNumTextures, uint32_t maxNumDraws);
+				~BindlessTable();
+
+		//! Binding points of the set (gBufferPass.vert, gBufferPass.frag)
+		static constexpr uint32_t kMatrixBinding	= 0;
+		static constexpr uint32_t kMaterialBinding	= 1;
+		static constexpr uint32_t kTextureBinding	= 2;
+		static constexpr uint32_t kDrawBinding		= 3;
+
+		struct Allocation
+		{
+			uint32_t firstMatrix	{ 0 };
+			uint32_t numMatrices	{ 0 };
+			uint32_t firstMaterial	{ 0 };
+			uint32_t numMaterials	{ 0 };
+			uint32_t firstTexture	{ 0 };
+			uint32_t numTextures	{ 0 };
+			uint32_t firstDraw		{ 0 };
+			uint32_t numDraws		{ 0 };
+		};
+
+	public:
+		void destroyBindlessTable	(void);
+		bool initialize				(DevicePtr device, uint32_t maxNumMatrices, uint32_t maxNumMaterials,
+									 uint32_t maxNumTextures, uint32_t maxNumDraws);
+		//! Thread safe, scenes allocate their ranges while being imported on the loader thread
+		bool allocate				(uint32_t numMatrices, uint32_t numMaterials, uint32_t numTextures,
+									 uint32_t numDraws, Allocation* allocation);
+		//! Ranges must not be used by GPU anymore when freed
+		void free					(const Allocation& allocation);
+		//! Write textures of the allocation, must be called from the thread recording draws.
+		//! Entries with null image view are left unbound
+		void updateTextures			(const Allocation& allocation, const std::vector<VkDescriptorImageInfo>& imageInfos);
+		void drawGUI				(void);
+		//! Ranged barriers covering matrices, materials, draw entries and indirect commands of the given allocation
+		void getQueueTransferBarriers(const Allocation& allocation, uint32_t srcFamily, uint32_t dstFamily,
+									  std::vector<VkBufferMemoryBarrier>* bufferBarriers) const;
+
+		inline BufferPtr getMatrixBuffer(void) const
+		{
+			return _matrixBuffer;
+		}
+		inline BufferPtr getMaterialBuffer(void) const
+		{
+			return _materialBuffer;
+		}
+		inline BufferPtr getDrawBuffer(void) const
+		{
+			return _drawBuffer;
+		}
+		inline BufferPtr getIndirectBuffer(void) const
+		{
+			return _indirectBuffer;
+		}
+		inline DescriptorSetPtr getDescriptorSet(void) const
+		{
+			return _descriptorSet;
+		}
+		inline DescriptorSetLayoutPtr getDescriptorLayout(void) const
+		{
+			return _descLayout;
+		}
+
+	private:
+		DevicePtr				_device			{ nullptr };
+		BufferPtr				_matrixBuffer	{ nullptr };
+		BufferPtr				_materialBuffer	{ nullptr };
+		BufferPtr				_drawBuffer		{ nullptr };
+		BufferPtr				_indirectBuffer	{ nullptr }; // VkDrawIndexedIndirectCommand per draw slot
+		DescriptorPoolPtr		_descPool		{ nullptr };
+		DescriptorSetLayoutPtr	_descLayout		{ nullptr };
+		DescriptorSetPtr		_descriptorSet	{ nullptr };
+		RangeAllocator			_matrixTable;
+		RangeAllocator			_materialTable;
+		RangeAllocator			_textureTable;
+		RangeAllocator			_drawTable;
+		mutable std::mutex		_tableMutex;
+	};
+}
+
+#endif
@@ -0,0 +1,399 @@
+// Author : Jihong Shin (snowapril)
+
+#include <pch.h>
+#include <BoundingVolumeHierarchy.h>
+#include <algorithm>
+#include <limits>
+
+namespace vfs
+{
+	namespace
+	{
+		constexpr uint32_t	kNumBins			= 12;	// SAH split candidates per axis
+		constexpr uint32_t	kMaxLeafPrimitives	= 4;
+		constexpr float		kTraversalCost		= 1.0f;	// Relative to one primitive box test
+		constexpr uint32_t	kMaxStackDepth		= 64;	// Also limits depth of the tree, deeper nodes stay leaves
+
+		enum class Overlap : uint32_t
+		{
+			Outside		= 0,
+			Intersect	= 1,
+			Inside		= 2,
+		};
+
+		inline float HalfSurfaceArea(const glm::vec3& boxMin, const glm::vec3& boxMax)
+		{
+			const glm::vec3 extent = boxMax - boxMin;
+			return extent.x * extent.y + extent.y * extent.z + extent.z * extent.x;
+		}
+
+		Overlap ClassifyBox(const Frustum& frustum, const glm::vec3& boxMin, const glm::vec3& boxMax)
+		{
+			const glm::vec3 center = (boxMin + boxMax) * 0.5f;
+			const glm::vec3 extent = (boxMax - boxMin) * 0.5f;
+			Overlap overlap = Overlap::Inside;
+			for (const glm::vec4& plane : frustum.planes)
+			{
+				const float distance = glm::dot(glm::vec3(plane), center) + plane.w;
+				const float radius	 = glm::dot(glm::abs(glm::vec3(plane)), extent);
+				if (distance < -radius)
+				{
+					return Overlap::Outside;
+				}
+				if (distance < radius)
+				{
+					overlap = Overlap::Intersect;
+				}
+			}
+			return overlap;
+		}
+
+		inline bool OverlapBox(const glm::vec3& aMin, const glm::vec3& aMax, const glm::vec3& bMin, const glm::vec3& bMax)
+		{
+			return glm::all(glm::lessThanEqual(aMin, bMax)) && glm::all(glm::lessThanEqual(bMin, aMax));
+		}
+
+		inline bool OverlapRay(const glm::vec3& origin, const glm::vec3& invDirection, float maxDistance,
+							   const glm::vec3& boxMin, const glm::vec3& boxMax)
+		{
+			// snowapril : slab test, infinite inverse components of axis parallel rays resolve by themselves
+			const glm::vec3 t0 = (boxMin - origin) * invDirection;
+			const glm::vec3 t1 = (boxMax - origin) * invDirection;
+			const glm::vec3 tNear = glm::min(t0, t1);
+			const glm::vec3 tFar  = glm::max(t0, t1);
+			const float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+			const float exit  = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxDistance));
+			return enter <= exit;
+		}
+	}
+
+	void BoundingVolumeHierarchy::clear(void)
+	{
+		_nodes.clear();
+		_primitiveIndices.clear();
+		_primitiveBoxes.clear();
+	}
+
+	void BoundingVolumeHierarchy::build(const std::vector<BoundingBox<glm::vec3>>& primitiveBoxes)
+	{
+		clear();
+		if (primitiveBoxes.empty())
+		{
+			return;
+		}
+
+		const uint32_t numPrimitives = static_cast<uint32_t>(primitiveBoxes.size());
+		_primitiveBoxes = primitiveBoxes;
+		_primitiveIndices.resize(numPrimitives);
+		std::vector<glm::vec3> centers(numPrimitives);
+		for (uint32_t i = 0; i < numPrimitives; ++i)
+		{
+			_primitiveIndices[i] = i;
+			centers[i] = primitiveBoxes[i].getCenter();
+		}
+
+		// snowapril : full binary tree with at most one primitive per leaf has 2N - 1 nodes
+		_nodes.reserve(2 * numPrimitives - 1);
+		Node root;
+		root.first			= 0;
+		root.numPrimitives	= numPrimitives;
+		_nodes.push_back(root);
+		subdivide(0, 0, primitiveBoxes, centers);
+		_nodes.shrink_to_fit();
+	}
+
+	void BoundingVolumeHierarchy::subdivide(uint32_t nodeIndex, uint32_t depth, const std::vector<BoundingBox<glm::vec3>>& primitiveBoxes,
+											const std::vector<glm::vec3>& centers)
+	{
+		const uint32_t first		 = _nodes[nodeIndex].first;
+		const uint32_t numPrimitives = _nodes[nodeIndex].numPrimitives;
+
+		glm::vec3 boxMin(std::numeric_limits<float>::max()), boxMax(std::numeric_limits<float>::lowest());
+		glm::vec3 centerMin = boxMin, centerMax = boxMax;
+		for (uint32_t i = first; i < first + numPrimitives; ++i)
+		{
+			const uint32_t primitive = _primitiveIndices[i];
+			boxMin		= glm::min(boxMin, primitiveBoxes[primitive].getMinCorner());
+			boxMax		= glm::max(boxMax, primitiveBoxes[primitive].getMaxCorner());
+			centerMin	= glm::min(centerMin, centers[primitive]);
+			centerMax	= glm::max(centerMax, centers[primitive]);
+		}
+		_nodes[nodeIndex].boxMin = boxMin;
+		_nodes[nodeIndex].boxMax = boxMax;
+		if (numPrimitives <= 1)
+		{
+			return;
+		}
+
+		// Binned SAH over primitive centers, the cheapest split of all axes is taken
+		struct Bin
+		{
+			glm::vec3 boxMin { std::numeric_limits<float>::max()	};
+			glm::vec3 boxMax { std::numeric_limits<float>::lowest() };
+			uint32_t  count	 { 0 };
+		};
+		float	 bestCost  = std::numeric_limits<float>::max();
+		int		 bestAxis  = -1;
+		uint32_t bestSplit = 0;
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			const float extent = centerMax[axis] - centerMin[axis];
+			if (extent <= 0.0f)
+			{
+				continue;
+			}
+			const float binScale = kNumBins / extent;
+
+			Bin bins[kNumBins];
+			for (uint32_t i = first; i < first + numPrimitives; ++i)
+			{
+				const uint32_t primitive = _primitiveIndices[i];
+				const uint32_t binIndex	 = std::min(kNumBins - 1, static_cast<uint32_t>((centers[primitive][axis] - centerMin[axis]) * binScale));
+				bins[binIndex].boxMin = glm::min(bins[binIndex].boxMin, primitiveBoxes[primitive].getMinCorner());
+				bins[binIndex].boxMax = glm::max(bins[binIndex].boxMax, primitiveBoxes[primitive].getMaxCorner());
+				++bins[binIndex].count;
+			}
+
+			// Sweep from the right first, then evaluate each split while sweeping from the left
+			float	 rightArea [kNumBins - 1];
+			uint32_t rightCount[kNumBins - 1];
+			Bin		 accumulated;
+			for (uint32_t i = kNumBins - 1; i > 0; --i)
+			{
+				accumulated.boxMin = glm::min(accumulated.boxMin, bins[i].boxMin);
+				accumulated.boxMax = glm::max(accumulated.boxMax, bins[i].boxMax);
+				accumulated.count += bins[i].count;
+				rightArea [i - 1]  = accumulated.count > 0 ? HalfSurfaceArea(accumulated.boxMin, accumulated.boxMax) : 0.0f;
+				rightCount[i - 1]  = accumulated.count;
+			}
+			accumulated = Bin();
+			for (uint32_t i = 0; i < kNumBins - 1; ++i)
+			{
+				accumulated.boxMin = glm::min(accumulated.boxMin, bins[i].boxMin);
+				accumulated.boxMax = glm::max(accumulated.boxMax, bins[i].boxMax);
+				accumulated.count += bins[i].count;
+				if (accumulated.count == 0 || rightCount[i] == 0)
+				{
+					continue;
+				}
+				const float cost = HalfSurfaceArea(accumulated.boxMin, accumulated.boxMax) * accumulated.count +
+								   rightArea[i] * rightCount[i];
+				if (cost < bestCost)
+				{
+					bestCost  = cost;
+					bestAxis  = axis;
+					bestSplit = i;
+				}
+			}
+		}
+
+		// Keep small nodes as leaves unless splitting them is expected to save box tests,
+		// snowapril : coincident centers cannot be binned, large ones are split at the median instead
+		const float leafCost  = static_cast<float>(numPrimitives);
+		const float nodeArea  = HalfSurfaceArea(boxMin, boxMax);
+		const float splitCost = nodeArea > 0.0f ? kTraversalCost + bestCost / nodeArea : leafCost;
+		const bool	bSmall	  = numPrimitives <= kMaxLeafPrimitives;
+		if ((bSmall && (bestAxis < 0 || splitCost >= leafCost)) || depth + 1 >= kMaxStackDepth)
+		{
+			return;
+		}
+
+		uint32_t* begin = _primitiveIndices.data() + first;
+		uint32_t* end	= begin + numPrimitives;
+		uint32_t* middle;
+		if (bestAxis >= 0)
+		{
+			const float binScale = kNumBins / (centerMax[bestAxis] - centerMin[bestAxis]);
+			middle = std::partition(begin, end, [&](uint32_t primitive) {
+				const uint32_t binIndex = std::min(kNumBins - 1, static_cast<uint32_t>((centers[primitive][bestAxis] - centerMin[bestAxis]) * binScale));
+				return binIndex <= bestSplit;
+			});
+		}
+		else
+		{
+			middle = begin + numPrimitives / 2;
+		}
+
+		const uint32_t numLeft	  = static_cast<uint32_t>(middle - begin);
+		const uint32_t leftIndex  = static_cast<uint32_t>(_nodes.size());
+		Node leftChild, rightChild;
+		leftChild.first				= first;
+		leftChild.numPrimitives		= numLeft;
+		rightChild.first			= first + numLeft;
+		rightChild.numPrimitives	= numPrimitives - numLeft;
+		_nodes.push_back(leftChild);
+		_nodes.push_back(rightChild);
+
+		_nodes[nodeIndex].first			= leftIndex;
+		_nodes[nodeIndex].numPrimitives = 0;
+		subdivide(leftIndex,	 depth + 1, primitiveBoxes, centers);
+		subdivide(leftIndex + 1, depth + 1, primitiveBoxes, centers);
+	}
+
+	void BoundingVolumeHierarchy::refit(const std::vector<BoundingBox<glm::vec3>>& primitiveBoxes)
+	{
+		assert(primitiveBoxes.size() == _primitiveBoxes.size());
+		_primitiveBoxes = primitiveBoxes;
+
+		// snowapril : children are placed after their parent, reverse order visits children first
+		for (size_t i = _nodes.size(); i > 0; --i)
+		{
+			Node& node = _nodes[i - 1];
+			if (node.numPrimitives > 0)
+			{
+				node.boxMin = glm::vec3(std::numeric_limits<float>::max());
+				node.boxMax = glm::vec3(std::numeric_limits<float>::lowest());
+				for (uint32_t p = node.first; p < node.first + node.numPrimitives; ++p)
+				{
+					node.boxMin = glm::min(node.boxMin, _primitiveBoxes[_primitiveIndices[p]].getMinCorner());
+					node.boxMax = glm::max(node.boxMax, _primitiveBoxes[_primitiveIndices[p]].getMaxCorner());
+				}
+			}
+			else
+			{
+				node.boxMin = glm::min(_nodes[node.first].boxMin, _nodes[node.first + 1].boxMin);
+				node.boxMax = glm::max(_nodes[node.first].boxMax, _nodes[node.first + 1].boxMax);
+			}
+		}
+	}
+
+	void BoundingVolumeHierarchy::appendSubtree(uint32_t nodeIndex, std::vector<uint32_t>* primitives) const
+	{
+		// Primitives of a subtree are one contiguous range, find it from the leftmost and rightmost leaves
+		uint32_t leftmost = nodeIndex, rightmost = nodeIndex;
+		while (_nodes[leftmost].numPrimitives == 0)
+		{
+			leftmost = _nodes[leftmost].first;
+		}
+		while (_nodes[rightmost].numPrimitives == 0)
+		{
+			rightmost = _nodes[rightmost].first + 1;
+		}
+		primitives->insert(primitives->end(), _primitiveIndices.begin() + _nodes[leftmost].first,
+						   _primitiveIndices.begin() + _nodes[rightmost].first + _nodes[rightmost].numPrimitives);
+	}
+
+	void BoundingVolumeHierarchy::queryFrustums(const Frustum* frustums, uint32_t numFrustums, std::vector<uint32_t>* primitives) const
+	{
+		if (_nodes.empty() || numFrustums == 0)
+		{
+			return;
+		}
+
+		uint32_t stack[kMaxStackDepth];
+		uint32_t stackSize = 0;
+		stack[stackSize++] = 0;
+		while (stackSize > 0)
+		{
+			const uint32_t nodeIndex = stack[--stackSize];
+			const Node& node = _nodes[nodeIndex];
+
+			Overlap overlap = Overlap::Outside;
+			for (uint32_t i = 0; i < numFrustums && overlap != Overlap::Inside; ++i)
+			{
+				overlap = std::max(overlap, ClassifyBox(frustums[i], node.boxMin, node.boxMax));
+			}
+			if (overlap == Overlap::Outside)
+			{
+				continue;
+			}
+			if (overlap == Overlap::Inside)
+			{
+				appendSubtree(nodeIndex, primitives);
+				continue;
+			}
+			if (node.numPrimitives > 0)
+			{
+				// Leaf boxes are loose around several primitives, test each of them once more
+				for (uint32_t p = node.first; p < node.first + node.numPrimitives; ++p)
+				{
+					const BoundingBox<glm::vec3>& box = _primitiveBoxes[_primitiveIndices[p]];
+					for (uint32_t i = 0; i < numFrustums; ++i)
+					{
+						if (ClassifyBox(frustums[i], box.getMinCorner(), box.getMaxCorner()) != Overlap::Outside)
+						{
+							primitives->push_back(_primitiveIndices[p]);
+							break;
+						}
+					}
+				}
+				continue;
+			}
+			assert(stackSize + 2 <= kMaxStackDepth);
+			stack[stackSize++] = node.first + 1;
+			stack[stackSize++] = node.first;
+		}
+	}
+
+	void BoundingVolumeHierarchy::queryBox(const glm::vec3& boxMin, const glm::vec3& boxMax, std::vector<uint32_t>* primitives) const
+	{
+		if (_nodes.empty())
+		{
+			return;
+		}
+
+		uint32_t stack[kMaxStackDepth];
+		uint32_t stackSize = 0;
+		stack[stackSize++] = 0;
+		while (stackSize > 0)
+		{
+			const Node& node = _nodes[stack[--stackSize]];
+			if (!OverlapBox(node.boxMin, node.boxMax, boxMin, boxMax))
+			{
+				continue;
+			}
+			if (node.numPrimitives > 0)
+			{
+				for (uint32_t p = node.first; p < node.first + node.numPrimitives; ++p)
+				{
+					const BoundingBox<glm::vec3>& box = _primitiveBoxes[_primitiveIndices[p]];
+					if (OverlapBox(box.getMinCorner(), box.getMaxCorner(), boxMin, boxMax))
+					{
+						primitives->push_back(_primitiveIndices[p]);
+					}
+				}
+				continue;
+			}
+			assert(stackSize + 2 <= kMaxStackDepth);
+			stack[stackSize++] = node.first + 1;
+			stack[stackSize++] = node.first;
+		}
+	}
+
+	void BoundingVolumeHierarchy::queryRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+										   std::vector<uint32_t>* primitives) const
+	{
+		if (_nodes.empty())
+		{
+			return;
+		}
+
+		const glm::vec3 invDirection = 1.0f / direction;
+		uint32_t stack[kMaxStackDepth];
+		uint32_t stackSize = 0;
+		stack[stackSize++] = 0;
+		while (stackSize > 0)
+		{
+			const Node& node = _nodes[stack[--stackSize]];
+			if (!OverlapRay(origin, invDirection, maxDistance, node.boxMin, node.boxMax))
+			{
+				continue;
+			}
+			if (node.numPrimitives > 0)
+			{
+				for (uint32_t p = node.first; p < node.first + node.numPrimitives; ++p)
+				{
+					const BoundingBox<glm::vec3>& box = _primitiveBoxes[_primitiveIndices[p]];
+					if (OverlapRay(origin, invDirection, maxDistance, box.getMinCorner(), box.getMaxCorner()))
+					{
+						primitives->push_back(_primitiveIndices[p]);
+					}
+				}
+				continue;
+			}
+			assert(stackSize + 2 <= kMaxStackDepth);
+			stack[stackSize++] = node.first + 1;
+			stack[stackSize++] = node.first;
+		}
+	}
+};
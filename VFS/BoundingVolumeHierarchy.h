@@ -0,0 +1,70 @@
+// Author : Jihong Shin (snowapril)
+
+#if !defined(VFS_BOUNDING_VOLUME_HIERARCHY_H)
+#define VFS_BOUNDING_VOLUME_HIERARCHY_H
+
+#include <BoundingBox.h>
+#include <vector>
+
+namespace vfs
+{
+	//! Six inward facing planes, a box is outside if it lies fully behind any of them
+	struct Frustum
+	{
+		glm::vec4 planes[6];
+	};
+
+	//! Binary tree of axis aligned boxes over primitive boxes, split by the surface area heuristic.
+	//! Queries append indices of primitives, in the order given to build, whose boxes pass the test.
+	//! Refitting keeps the topology and only grows or shrinks node boxes, so the tree degrades
+	//! when primitives move far, rebuild it if queries become slow.
+	class BoundingVolumeHierarchy
+	{
+	public:
+		explicit BoundingVolumeHierarchy() = default;
+				~BoundingVolumeHierarchy() = default;
+
+	public:
+		void build			(const std::vector<BoundingBox<glm::vec3>>& primitiveBoxes);
+		//! Box count and order must match the ones given to build
+		void refit			(const std::vector<BoundingBox<glm::vec3>>& primitiveBoxes);
+		void clear			(void);
+		//! Primitives not outside of at least one of the frustums, each primitive is appended once
+		void queryFrustums	(const Frustum* frustums, uint32_t numFrustums, std::vector<uint32_t>* primitives) const;
+		//! Primitives overlapping the box
+		void queryBox		(const glm::vec3& boxMin, const glm::vec3& boxMax, std::vector<uint32_t>* primitives) const;
+		//! Primitives whose boxes are hit by the ray within the distance, direction needs not be normalized
+		void queryRay		(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+							 std::vector<uint32_t>* primitives) const;
+
+		inline bool isEmpty(void) const
+		{
+			return _nodes.empty();
+		}
+		inline uint32_t getNumNodes(void) const
+		{
+			return static_cast<uint32_t>(_nodes.size());
+		}
+
+	private:
+		//! Leaf if numPrimitives is not zero, otherwise children are stored at first and first + 1
+		struct Node
+		{
+			glm::vec3	boxMin;
+			uint32_t	first			{ 0 };
+			glm::vec3	boxMax;
+			uint32_t	numPrimitives	{ 0 };
+		};
+
+		void subdivide			(uint32_t nodeIndex, uint32_t depth, const std::vector<BoundingBox<glm::vec3>>& primitiveBoxes,
+								 const std::vector<glm::vec3>& centers);
+		void appendSubtree		(uint32_t nodeIndex, std::vector<uint32_t>* primitives) const;
+
+	private:
+		std::vector<Node>		_nodes;				// Root first, children are always placed after their parent
+		std::vector<uint32_t>	_primitiveIndices;	// Primitives reordered so that each leaf owns a contiguous range
+		std::vector<BoundingBox<glm::vec3>> _primitiveBoxes; // In build order, tested again inside leaves
+	};
+};
+
+#endif
@@ -51,6 +51,7 @@ namespace vfs
 		for (uint32_t i = 0; i < frameCount; ++i)
 		{
 			_descriptorSets.emplace_back(std::make_shared<DescriptorSet>(device, _descriptorPool, _descriptorLayout, 1));
+			_descriptorSets[i]->updateUniformBuffer({ _uniformBuffers[i] }, 0, 1);
 		}
 
 		return true;
@@ -117,6 +118,5 @@ namespace vfs
 		};
 
 		_uniformBuffers[currentFrameIndex]->uploadData(&ubo, sizeof(ubo));
-		_descriptorSets[currentFrameIndex]->updateUniformBuffer({ _uniformBuffers[currentFrameIndex] }, 0, 1);
 	}
 };
\ No newline at end of file
@@ -24,6 +24,10 @@ namespace vfs
 		{
 			return _position;
 		}
+		inline glm::mat4 getViewProjection(void) const
+		{
+			return _projMatrix * _viewMatrix;
+		}
 		inline DescriptorSetPtr getDescriptorSet(const uint32_t frameIndex) const
 		{
 			return _descriptorSets[frameIndex];
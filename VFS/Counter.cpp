@@ -4,6 +4,7 @@
 #include <Counter.h>
 #include <Common/Logger.h>
 #include <VulkanFramework/Buffers/Buffer.h>
+#include <VulkanFramework/Buffers/UploadManager.h>
 #include <VulkanFramework/Commands/CommandPool.h>
 #include <VulkanFramework/Queue.h>
 #include <VulkanFramework/Device.h>
@@ -77,26 +78,12 @@ namespace vfs
 		return readCounterValue;
 	}
 
-	void Counter::resetCounter(const CommandPoolPtr& cmdPool)
+	void Counter::resetCounter(const UploadManagerPtr& uploadManager)
 	{
+		// snowapril : reset value is a constant, fill command needs no staging memory at all
 		constexpr uint32_t RESET_VALUE = 0;
-		_stagingBuffer->uploadData(&RESET_VALUE, sizeof(uint32_t));
-
-		CommandBuffer cmdBuffer(cmdPool->allocateCommandBuffer());
-		{
-			cmdBuffer.beginRecord(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
-
-			VkBufferCopy bufferCopyInfo = {};
-			bufferCopyInfo.size = sizeof(uint32_t);
-			bufferCopyInfo.srcOffset = 0;
-			bufferCopyInfo.dstOffset = 0;
-			cmdBuffer.copyBuffer(_stagingBuffer.get(), _buffer, { bufferCopyInfo });
-
-			cmdBuffer.endRecord();
-		}
-
-		Fence fence(_device, 1, 0);
-		cmdPool->getQueue()->submitCmdBuffer({ cmdBuffer }, &fence);
-		fence.waitForAllFences(UINT64_MAX);
+		uploadManager->enqueueCommand([this](CommandBuffer cmdBuffer) {
+			vkCmdFillBuffer(cmdBuffer.getHandle(), _buffer->getBufferHandle(), 0, sizeof(uint32_t), RESET_VALUE);
+		});
 	}
 }
\ No newline at end of file
@@ -23,7 +23,7 @@ namespace vfs
 		void	 destroyCounter(void);
 		bool	 initialize					(DevicePtr device);
 		uint32_t readCounterValue			(const CommandPoolPtr& cmdPool);
-		void	 resetCounter				(const CommandPoolPtr& cmdPool);
+		void	 resetCounter				(const UploadManagerPtr& uploadManager);
 
 		inline BufferPtr getBuffer(void) const
 		{
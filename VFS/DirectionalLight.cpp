@@ -9,6 +9,7 @@
 #include <VulkanFramework/Buffers/Buffer.h>
 #include <Shaders/light.glsl>
 #include <imgui/imgui.h>
+#include <cstring>
 
 namespace vfs
 {
@@ -22,7 +23,8 @@ namespace vfs
 	{
 		if (_viewProjBuffer == nullptr)
 		{
-			_viewProjBuffer = std::make_shared<Buffer>(_device->getMemoryAllocator(), sizeof(DirectionalLightShadowDesc),
+			_viewProjStride = getVersionStride(sizeof(DirectionalLightShadowDesc));
+			_viewProjBuffer = std::make_shared<Buffer>(_device->getMemoryAllocator(), _viewProjStride * MAX_NUM_FRAMES,
 													   VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, 
 													   VMA_MEMORY_USAGE_CPU_TO_GPU);
 		}
@@ -32,17 +34,16 @@ namespace vfs
 
 		constexpr glm::vec3 kOrthoHalfResolution{ 16.0f, 16.0f, 16.0f };
 		
-		DirectionalLightShadowDesc lightShadowDesc;
-		lightShadowDesc.view	= glm::lookAt(_origin, _origin + _direction, glm::vec3(0.0f, 1.0f, 0.0f));
-		lightShadowDesc.proj	= glm::ortho(
+		_view		= glm::lookAt(_origin, _origin + _direction, glm::vec3(0.0f, 1.0f, 0.0f));
+		_proj		= glm::ortho(
 			-kOrthoHalfResolution.x, kOrthoHalfResolution.x,
 			-kOrthoHalfResolution.y, kOrthoHalfResolution.y,
 					_zNear,					_zFar	
-		);;
-		lightShadowDesc.zNear	= _zNear;
-		lightShadowDesc.zFar	= _zFar;
+		);
+		_viewProj	= _proj * _view;
 
-		_viewProjBuffer->uploadData(&lightShadowDesc, sizeof(DirectionalLightShadowDesc));
+		// Versions are rewritten on beginFrame of their frame index, frames in flight keep reading old ones
+		_dirtyViewProj = (1u << MAX_NUM_FRAMES) - 1;
 		return *this;
 	}
 
@@ -76,16 +77,16 @@ namespace vfs
 	{
 		if (_lightDescBuffer == nullptr)
 		{
-			_lightDescBuffer = std::make_shared<Buffer>(_device->getMemoryAllocator(), sizeof(DirectionalLightDesc),
+			_lightDescStride = getVersionStride(sizeof(DirectionalLightDesc));
+			_lightDescBuffer = std::make_shared<Buffer>(_device->getMemoryAllocator(), _lightDescStride * MAX_NUM_FRAMES,
 														VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, 
 														VMA_MEMORY_USAGE_CPU_TO_GPU);
 		}
-		DirectionalLightDesc lightDesc;	
-		lightDesc.direction = _direction;
-		lightDesc.color		= color;
-		lightDesc.intensity = intensity;
+		_lightDirection = _direction;
+		_color			= color;
+		_intensity		= intensity;
 
-		_lightDescBuffer->uploadData(&lightDesc, sizeof(lightDesc));
+		_dirtyLightDesc = (1u << MAX_NUM_FRAMES) - 1;
 		return *this;
 	}
 
@@ -94,4 +95,57 @@ namespace vfs
 		const VkExtent3D shadowMapDimension = _shadowMap->getDimension();
 		return { shadowMapDimension.width, shadowMapDimension.height };
 	}
+
+	void DirectionalLight::beginFrame(uint32_t frameIndex)
+	{
+		assert(frameIndex < MAX_NUM_FRAMES);
+		_frameIndex = frameIndex;
+
+		const uint32_t versionBit = 1u << frameIndex;
+		if (_dirtyViewProj & versionBit)
+		{
+			DirectionalLightShadowDesc lightShadowDesc;
+			lightShadowDesc.view	= _view;
+			lightShadowDesc.proj	= _proj;
+			lightShadowDesc.zNear	= _zNear;
+			lightShadowDesc.zFar	= _zFar;
+			writeVersion(_viewProjBuffer, _viewProjStride, &lightShadowDesc, sizeof(DirectionalLightShadowDesc));
+			_dirtyViewProj &= ~versionBit;
+		}
+		if (_dirtyLightDesc & versionBit)
+		{
+			DirectionalLightDesc lightDesc;	
+			lightDesc.direction = _lightDirection;
+			lightDesc.color		= _color;
+			lightDesc.intensity = _intensity;
+			writeVersion(_lightDescBuffer, _lightDescStride, &lightDesc, sizeof(DirectionalLightDesc));
+			_dirtyLightDesc &= ~versionBit;
+		}
+	}
+
+	uint64_t DirectionalLight::getViewProjectionRange(void) const
+	{
+		return sizeof(DirectionalLightShadowDesc);
+	}
+
+	uint64_t DirectionalLight::getLightDescRange(void) const
+	{
+		return sizeof(DirectionalLightDesc);
+	}
+
+	uint64_t DirectionalLight::getVersionStride(uint64_t size) const
+	{
+		const uint64_t alignment = _device->getDeviceProperty().limits.minUniformBufferOffsetAlignment;
+		return (size + alignment - 1) / alignment * alignment;
+	}
+
+	void DirectionalLight::writeVersion(const BufferPtr& buffer, uint64_t stride, const void* srcData, uint64_t size)
+	{
+		uint8_t* mappedData = static_cast<uint8_t*>(buffer->getMappedData());
+		assert(mappedData != nullptr);
+
+		const uint64_t offset = _frameIndex * stride;
+		std::memcpy(mappedData + offset, srcData, static_cast<size_t>(size));
+		buffer->flushMemory(offset, size);
+	}
 };
\ No newline at end of file
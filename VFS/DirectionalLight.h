@@ -5,9 +5,12 @@
 
 #include <pch.h>
 #include <Common/Utils.h>
+#include <Util/EngineConfig.h>
 
 namespace vfs
 {
+	//! Shadow and light descriptions keep one version per frame in flight in each buffer,
+	//! bound as dynamic uniform buffers at the offsets of the frame being recorded
 	class DirectionalLight : NonCopyable
 	{
 	public:
@@ -19,6 +22,11 @@ namespace vfs
 		DirectionalLight&	setColorAndIntensity	(glm::vec3 color, float intensity);
 		DirectionalLight&	createShadowMap			(VkExtent2D resolution);
 		VkExtent2D			getShadowMapResolution	(void) const;
+		//! Writes descriptions changed since the version of this frame index was written last time
+		void				beginFrame				(uint32_t frameIndex);
+		//! Range of one version, buffers are bound as dynamic uniform buffers with this range
+		uint64_t			getViewProjectionRange	(void) const;
+		uint64_t			getLightDescRange		(void) const;
 
 		void				drawGUI					(void);
 
@@ -38,6 +46,26 @@ namespace vfs
 		{
 			return _lightDescBuffer;
 		}
+		inline glm::mat4 getViewProjection(void) const
+		{
+			return _viewProj;
+		}
+		inline uint32_t getViewProjectionOffset(void) const
+		{
+			return static_cast<uint32_t>(_frameIndex * _viewProjStride);
+		}
+		inline uint32_t getLightDescOffset(void) const
+		{
+			return static_cast<uint32_t>(_frameIndex * _lightDescStride);
+		}
+		inline uint32_t getFrameIndex(void) const
+		{
+			return _frameIndex;
+		}
+	private:
+		uint64_t			getVersionStride		(uint64_t size) const;
+		void				writeVersion			(const BufferPtr& buffer, uint64_t stride, const void* srcData, uint64_t size);
+
 	private:
 		DevicePtr		_device;
 		glm::vec3		_origin		{ 0.0f, 15.0f, 0.0f };
@@ -47,6 +75,17 @@ namespace vfs
 		SamplerPtr		_shadowMapSampler;
 		BufferPtr		_viewProjBuffer;
 		BufferPtr		_lightDescBuffer;
+		glm::mat4		_viewProj	{ 1.0f };
+		glm::mat4		_view		{ 1.0f };
+		glm::mat4		_proj		{ 1.0f };
+		glm::vec3		_lightDirection	{ 0.0f, -1.0f, 0.0f };	// Direction when color and intensity were set
+		glm::vec3		_color		{ 1.0f };
+		float			_intensity	{ 1.0f };
+		uint64_t		_viewProjStride		{ 0 };
+		uint64_t		_lightDescStride	{ 0 };
+		uint32_t		_dirtyViewProj		{ 0 };	// Bit per version still holding the old description
+		uint32_t		_dirtyLightDesc		{ 0 };
+		uint32_t		_frameIndex			{ 0 };
 		float			_zNear				{  0.1f };
 		float			_zFar				{ 30.0f };
 	};
@@ -6,486 +6,931 @@
 #include <Common/Logger.h>
 #include <VulkanFramework/Device.h>
 #include <VulkanFramework/Buffers/Buffer.h>
-#include <VulkanFramework/Commands/CommandPool.h>
 #include <VulkanFramework/Commands/CommandBuffer.h>
 #include <VulkanFramework/Images/Image.h>
 #include <VulkanFramework/Images/ImageView.h>
 #include <VulkanFramework/Images/Sampler.h>
+#include <VulkanFramework/Images/SamplerCache.h>
 #include <VulkanFramework/Descriptors/DescriptorPool.h>
 #include <VulkanFramework/Descriptors/DescriptorSet.h>
 #include <VulkanFramework/Descriptors/DescriptorSetLayout.h>
 #include <VulkanFramework/Pipelines/PipelineLayout.h>
 #include <VulkanFramework/Queue.h>
-#include <VulkanFramework/Sync/Fence.h>
 #include <Shaders/gltf.glsl>
 #include <GLTFScene.h>
+#include <Util/MipmapGenerator.h>
+#include <Util/VertexQuantizer.h>
 #include <imgui/imgui.h>
+#include <cstring>
 
 namespace vfs
 {
-	GLTFScene::GLTFScene(DevicePtr device, const char* scenePath, 
-						 const QueuePtr& queue, VertexFormat format)
+	namespace
 	{
-		assert(initialize(device, scenePath, queue, format));
+		//! Primitives whose vertices are all addressable by 16 bits are drawn with UINT16 indices
+		inline bool IsShortIndexed(uint32_t vertexCount)
+		{
+			return vertexCount <= (1u << 16);
+		}
+
+		//! Images without pre-generated mip chain get their levels blitted on GPU, block formats cannot be blitted
+		inline bool IsMipmapBlitRequired(const GLTFImage& image)
+		{
+			return image.mipLevels == 1 && !TextureCompressor::IsBlockCompressed(image.format);
+		}
+
+		inline VkFormat GetImageFormat(TextureFormat format)
+		{
+			switch (format)
+			{
+			case TextureFormat::BC1: return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+			case TextureFormat::BC3: return VK_FORMAT_BC3_UNORM_BLOCK;
+			case TextureFormat::BC5: return VK_FORMAT_BC5_UNORM_BLOCK;
+			case TextureFormat::BC7: return VK_FORMAT_BC7_UNORM_BLOCK;
+			default:				 return VK_FORMAT_R8G8B8A8_UNORM;
+			}
+		}
+	}
+
+	GLTFScene::GLTFScene(DevicePtr device, const char* scenePath, const GeometryPoolPtr& geometryPool,
+						 const BindlessTablePtr& bindlessTable, const UploadManagerPtr& uploadManager, VertexFormat format)
+	{
+		assert(initialize(device, scenePath, geometryPool, bindlessTable, uploadManager, format));
 	}
 
 	GLTFScene::~GLTFScene()
 	{
-		// Do nothing
+		// Return the ranges to the pool and the table, scene must not be in use by GPU anymore
+		if (_bGeometryAllocated)
+		{
+			_geometryPool->free(_geometry);
+		}
+		if (_bTableAllocated)
+		{
+			_bindlessTable->free(_tableRange);
+		}
 	}
 
-	bool GLTFScene::initialize(DevicePtr device, const char* scenePath, const QueuePtr& loaderQueue, VertexFormat format)
+	bool GLTFScene::initialize(DevicePtr device, const char* scenePath, const GeometryPoolPtr& geometryPool,
+							   const BindlessTablePtr& bindlessTable, const UploadManagerPtr& uploadManager, VertexFormat format)
 	{
-		_device		= device;
-		_queue		= loaderQueue;
-		_format		= format;
-		_debugUtil	= DebugUtils(_device);
+		return importScene(device, scenePath, geometryPool, bindlessTable, format) && uploadScene(uploadManager);
+	}
+
+	bool GLTFScene::importScene(DevicePtr device, const char* scenePath, const GeometryPoolPtr& geometryPool,
+								const BindlessTablePtr& bindlessTable, VertexFormat format)
+	{
+		_device			= device;
+		_scenePath		= scenePath;
+		_geometryPool	= geometryPool;
+		_bindlessTable	= bindlessTable;
+		_format			= format;
+		_debugUtil		= DebugUtils(_device);
 		
 		CPUTimer timer;
 
+		setTextureCompression(DEFAULT_COMPRESS_TEXTURES && _device->getDeviceFeature().textureCompressionBC == VK_TRUE);
 		if (!loadScene(scenePath, format))
 		{
 			VFS_ERROR << "Cannot find scene file or not a valid gltf format";
 			return false;
 		}
 		
-		char markerBuffer[128];
-		// Create buffers for vertices
-		// 0. Position Buffer
-		_vertexBuffers.push_back(std::make_shared<Buffer>(_device->getMemoryAllocator(),
-								 _positions.size() * VertexHelper::GetNumBytes(VertexFormat::Position3),
-								 VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-								 VMA_MEMORY_USAGE_GPU_ONLY));
-		snprintf(markerBuffer, sizeof(markerBuffer), "%s(%s)", scenePath, "Position Buffer");
-		_debugUtil.setObjectName(_vertexBuffers[0]->getBufferHandle(), markerBuffer);
-
-		// 1. Normal Buffer
-		_vertexBuffers.push_back(std::make_shared<Buffer>(_device->getMemoryAllocator(),
-								 _normals.size() * VertexHelper::GetNumBytes(VertexFormat::Normal3),
-								 VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-								 VMA_MEMORY_USAGE_GPU_ONLY));
-		snprintf(markerBuffer, sizeof(markerBuffer), "%s(%s)", scenePath, "Normal Buffer");
-		_debugUtil.setObjectName(_vertexBuffers[1]->getBufferHandle(), markerBuffer);
-
-		// 2. TexCoord Buffer
-		_vertexBuffers.push_back(std::make_shared<Buffer>(_device->getMemoryAllocator(),
-								 _texCoords.size() * VertexHelper::GetNumBytes(VertexFormat::TexCoord2),
-								 VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-								 VMA_MEMORY_USAGE_GPU_ONLY));
-		snprintf(markerBuffer, sizeof(markerBuffer), "%s(%s)", scenePath, "TexCoord Buffer");
-		_debugUtil.setObjectName(_vertexBuffers[2]->getBufferHandle(), markerBuffer);
-
-		// 3. Tangent Buffer
-		// Tangent vector (x, y, z) and handedness (w)
-		_vertexBuffers.push_back(std::make_shared<Buffer>(_device->getMemoryAllocator(),
-								 _tangents.size() * VertexHelper::GetNumBytes(VertexFormat::Tangent4),
-								 VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-								 VMA_MEMORY_USAGE_GPU_ONLY));
-		snprintf(markerBuffer, sizeof(markerBuffer), "%s(%s)", scenePath, "Tangent Buffer");
-		_debugUtil.setObjectName(_vertexBuffers[3]->getBufferHandle(), markerBuffer);
-
-		// Create buffers for indices
-		_indexBuffer = std::make_shared<Buffer>(_device->getMemoryAllocator(),
-												_indices.size() * sizeof(uint32_t), 
-												VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-												VMA_MEMORY_USAGE_GPU_ONLY);
-		snprintf(markerBuffer, sizeof(markerBuffer), "%s(%s)", scenePath, "Index Buffer");
-		_debugUtil.setObjectName(_indexBuffer->getBufferHandle(), markerBuffer);
-
-		// Create shader storage buffer object for matrices of scene nodes
-		size_t numMatrices{ 0 };
+		// Streams may point into the mapped scene cache instead of the loader-owned vectors
+		const StreamView<glm::vec3>		positions	= getStream(_positions,	SceneCache::Section::Positions);
+		const StreamView<glm::vec3>		normals		= getStream(_normals,	SceneCache::Section::Normals);
+		const StreamView<glm::vec2>		texCoords	= getStream(_texCoords,	SceneCache::Section::TexCoords);
+		const StreamView<glm::vec4>		tangents	= getStream(_tangents,	SceneCache::Section::Tangents);
+
+		// Packed streams need per primitive decode transforms before sizing and uploading
+		const VertexFormat packing = _format & VertexFormat::Quantized;
+		if (static_cast<bool>(packing))
+		{
+			computeDecodeTransforms(positions);
+		}
+
+		// Vertices and indices are placed in the ranges of the shared geometry pool
+		// snowapril : 16-bit indices of small primitives are placed in front of 32-bit ones
+		buildDrawCommands();
+		std::vector<BoundingBox<glm::vec3>> drawBoxes;
+		gatherDrawBoxes(&drawBoxes);
+		_drawBVH.build(drawBoxes);
+		VFS_INFO << "Draw BVH of " << drawBoxes.size() << " primitives built with " << _drawBVH.getNumNodes() << " nodes";
+
+		uint64_t numIndices32{ 0 };
+		for (const GLTFPrimMesh& primMesh : _scenePrimMeshes)
+		{
+			numIndices32 += IsShortIndexed(primMesh.vertexCount) ? 0 : primMesh.indexCount;
+		}
+		assert(normals.count <= positions.count && texCoords.count <= positions.count && tangents.count <= positions.count);
+		if (!_geometryPool->allocate(static_cast<uint32_t>(positions.count), _index32Offset + numIndices32 * sizeof(uint32_t), &_geometry))
+		{
+			VFS_ERROR << "Not enough geometry pool space for " << scenePath;
+			return false;
+		}
+		_bGeometryAllocated = true;
+
+		// Matrices, materials, textures and draws are placed in the ranges of the shared bindless table
+		uint32_t numMatrices{ 0 };
 		for (const GLTFNode& node : _sceneNodes)
 		{
 			numMatrices += static_cast<uint32_t>(node.primMeshes.empty() == false);
 		}
-		
-		_matrixBuffer = std::make_shared<Buffer>(_device->getMemoryAllocator(), 
-												 numMatrices * sizeof(glm::mat4) * 2,
-												 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-												 VMA_MEMORY_USAGE_GPU_ONLY);
-		snprintf(markerBuffer, sizeof(markerBuffer), "%s(%s)", scenePath, "Matrix Buffer");
-		_debugUtil.setObjectName(_matrixBuffer->getBufferHandle(), markerBuffer);
-
-		_materialBuffer = std::make_shared<Buffer>(_device->getMemoryAllocator(), 
-												   _sceneMaterials.size() * sizeof(GltfShadeMaterial),
-												   VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-												   VMA_MEMORY_USAGE_GPU_ONLY);
-		snprintf(markerBuffer, sizeof(markerBuffer), "%s(%s)", scenePath, "Material Buffer");
-		_debugUtil.setObjectName(_materialBuffer->getBufferHandle(), markerBuffer);
-
-		uploadBuffer();
-		uploadImage();
-		uploadMaterialBuffer();
-		uploadMatrixBuffer();
+		if (!_bindlessTable->allocate(numMatrices, static_cast<uint32_t>(_sceneMaterials.size()),
+									  static_cast<uint32_t>(_sceneTextures.size()),
+									  static_cast<uint32_t>(_drawCommands.size()), &_tableRange))
+		{
+			VFS_ERROR << "Not enough bindless table space for " << scenePath;
+			return false;
+		}
+		_bTableAllocated = true;
 
-		// After uploading all required vertex data and images We can release them to free
-		releaseSourceData();
+		// snowapril : source images are released after upload, so textures without image are marked here
+		for (GLTFTexture& texture : _sceneTextures)
+		{
+			if (texture.imageIndex >= static_cast<int>(_images.size()))
+			{
+				texture.imageIndex = -1;
+			}
+		}
+
+		// Textures sharing the same sampler state share one sampler object
+		_samplerCache = std::make_shared<SamplerCache>(_device);
+		_textureSamplers.reserve(_sceneTextures.size());
+		for (const GLTFTexture& texture : _sceneTextures)
+		{
+			_textureSamplers.emplace_back(_samplerCache->getSampler(GetSamplerCreateInfo(texture)));
+		}
+		VFS_INFO << _sceneTextures.size() << " textures use " << _images.size() << " images and " 
+				 << _samplerCache->getNumSamplers() << " samplers";
 
-		VFS_INFO << scenePath << " scene loaded ( " << timer.elapsedSeconds() << " second )";
+		VFS_INFO << scenePath << " scene imported ( " << timer.elapsedSeconds() << " second )";
 		return true;
 	}
 
-	bool GLTFScene::uploadBuffer(void)
+	bool GLTFScene::uploadScene(const UploadManagerPtr& uploadManager)
 	{
-		VmaAllocator allocator = _device->getMemoryAllocator();
-
-		const uint32_t positionBufSize = static_cast<uint32_t>(_positions.size()) * 
-										 VertexHelper::GetNumBytes(VertexFormat::Position3);
-		Buffer stagingPosition(allocator, positionBufSize,
-							   VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-							   VMA_MEMORY_USAGE_CPU_ONLY);
-		stagingPosition.uploadData(_positions.data(), positionBufSize);
-		
-		const uint32_t normalBufSize = static_cast<uint32_t>(_normals.size()) *
-										 VertexHelper::GetNumBytes(VertexFormat::Normal3);
-		Buffer stagingNormal(allocator, normalBufSize,
-							 VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-							 VMA_MEMORY_USAGE_CPU_ONLY);
-		stagingNormal.uploadData(_normals.data(), normalBufSize);
-
-		const uint32_t texCoordBufSize = static_cast<uint32_t>(_texCoords.size()) *
-										 VertexHelper::GetNumBytes(VertexFormat::TexCoord2);
-		Buffer stagingTexCoord(allocator, texCoordBufSize,
-							   VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-							   VMA_MEMORY_USAGE_CPU_ONLY);
-		stagingTexCoord.uploadData(_texCoords.data(), texCoordBufSize);
-
-		const uint32_t tangentBufSize = static_cast<uint32_t>(_tangents.size()) *
-										VertexHelper::GetNumBytes(VertexFormat::Tangent4);
-		Buffer stagingTangent(allocator, tangentBufSize,
-							  VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-							  VMA_MEMORY_USAGE_CPU_ONLY);
-		stagingTangent.uploadData(_tangents.data(), tangentBufSize);
-
-		const uint32_t indicesBufSize = static_cast<uint32_t>(_indices.size()) * sizeof(uint32_t);
-		Buffer stagingIndices(allocator, indicesBufSize,
-							  VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-							  VMA_MEMORY_USAGE_CPU_ONLY);
-		stagingIndices.uploadData(_indices.data(), indicesBufSize);
-
-		CommandPool loaderCmdPool(_device, _queue, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT |
-													    VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
-
-		CommandBuffer cmdBuffer(loaderCmdPool.allocateCommandBuffer());
-		{
-			cmdBuffer.beginRecord(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
-
-			cmdBuffer.copyBuffer(&stagingPosition,	_vertexBuffers[0], { { 0, 0, positionBufSize} });
-			cmdBuffer.copyBuffer(&stagingNormal,	_vertexBuffers[1], { { 0, 0, normalBufSize  } });
-			cmdBuffer.copyBuffer(&stagingTexCoord,	_vertexBuffers[2], { { 0, 0, texCoordBufSize} });
-			cmdBuffer.copyBuffer(&stagingTangent,	_vertexBuffers[3], { { 0, 0, tangentBufSize } });
-			cmdBuffer.copyBuffer(&stagingIndices,		 _indexBuffer, { { 0, 0, indicesBufSize } });
-
-			cmdBuffer.endRecord();
-
-			Fence fence(_device, 1, 0);
-			_queue->submitCmdBuffer({ cmdBuffer }, &fence);
-			if (!fence.waitForAllFences(UINT64_MAX))
-			{
-				return false;
-			}
+		_uploadManager = uploadManager;
+
+		if (!uploadSceneData())
+		{
+			VFS_ERROR << "Failed to upload scene data of " << _scenePath;
+			return false;
 		}
 
+		// After uploading all required vertex data and images We can release them to free
+		releaseSourceData();
+		reportProgress(1.0f);
 		return true;
 	}
 
-	bool GLTFScene::uploadImage(void)
+	void GLTFScene::getQueueTransferBarriers(uint32_t srcFamily, uint32_t dstFamily,
+											 std::vector<VkBufferMemoryBarrier>* bufferBarriers,
+											 std::vector<VkImageMemoryBarrier>* imageBarriers) const
 	{
-		CommandPool loaderCmdPool(_device, _queue, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT |
-														VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
-		std::vector<Buffer> stagingBuffers(_images.size());
-		for (size_t i = 0; i < _images.size(); ++i)
+		// snowapril : access masks are ignored by the release or the acquire half, so both are filled
+		_geometryPool->getQueueTransferBarriers(_geometry, srcFamily, dstFamily, bufferBarriers);
+		_bindlessTable->getQueueTransferBarriers(_tableRange, srcFamily, dstFamily, bufferBarriers);
+
+		// Images are already in their final layout after the upload
+		for (const ImagePtr& image : _textureImages)
 		{
-			CommandBuffer coypCmdBuffer(loaderCmdPool.allocateCommandBuffer());
-			coypCmdBuffer.beginRecord(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+			VkImageMemoryBarrier barrier = image->generateMemoryBarrier(VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+																		VK_IMAGE_ASPECT_COLOR_BIT, 
+																		VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+																		VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+																		srcFamily, dstFamily);
+			barrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+			imageBarriers->push_back(barrier);
+		}
+	}
 
-			GLTFImage& image = _images[i];
+	namespace
+	{
+		// snowapril : 16 bytes covers texel block alignment required by buffer to image copies
+		constexpr uint64_t kStagingAlignment = 16;
 
-			const uint32_t mipLevels = static_cast<uint32_t>(std::floor(
-				std::log2(vfs::max(image.width, image.height))
-			)) + 1;
+		inline uint64_t AlignStaging(uint64_t size)
+		{
+			return (size + kStagingAlignment - 1) & ~(kStagingAlignment - 1);
+		}
 
-			VkImageCreateInfo imageInfo = Image::GetDefaultImageCreateInfo();
-			imageInfo.extent		= { static_cast<uint32_t>(image.width), static_cast<uint32_t>(image.height), 1 };
-			imageInfo.format		= VK_FORMAT_R8G8B8A8_UNORM;
-			imageInfo.usage			= VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
-			imageInfo.imageType		= VK_IMAGE_TYPE_2D;
-			imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-			imageInfo.mipLevels		= mipLevels;
-			ImagePtr imageBuffer = std::make_shared<Image>(_device->getMemoryAllocator(), VMA_MEMORY_USAGE_GPU_ONLY, imageInfo);
+		//! Reserve the given size in the staging allocation and returns its offset in the staging buffer
+		inline uint64_t ReserveStaging(const UploadManager::Allocation& staging, uint64_t* stagingOffset, uint64_t size, uint8_t** dstData)
+		{
+			const uint64_t offset = *stagingOffset;
+			*dstData	   = staging.data + offset;
+			*stagingOffset = offset + AlignStaging(size);
+			return staging.offset + offset;
+		}
 
-			stagingBuffers[i].initialize(_device->getMemoryAllocator(), image.width * image.height * 4,
-										 VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY);
-			stagingBuffers[i].uploadData(image.data.data(), image.width * image.height * 4);
+		//! Copy the given data into the staging allocation and returns its offset in the staging buffer
+		inline uint64_t WriteStaging(const UploadManager::Allocation& staging, uint64_t* stagingOffset, const void* srcData, uint64_t size)
+		{
+			uint8_t* dstData{ nullptr };
+			const uint64_t offset = ReserveStaging(staging, stagingOffset, size, &dstData);
+			if (size > 0)
+			{
+				std::memcpy(dstData, srcData, static_cast<size_t>(size));
+			}
+			return offset;
+		}
+	}
 
-			coypCmdBuffer.pipelineBarrier(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
-				0, {}, {}, 
-				{ imageBuffer->generateMemoryBarrier(0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_ASPECT_COLOR_BIT,
-				VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) }
-			);
+	bool GLTFScene::uploadSceneData(void)
+	{
+		// Gather materials and matrices first, staging size must be known before allocation
+		std::vector<GltfShadeMaterial> materials;
+		gatherMaterials(&materials);
 
-			VkBufferImageCopy bufferImageCopy = {};
-			bufferImageCopy.bufferOffset					= 0;
-			bufferImageCopy.bufferRowLength					= 0;
-			bufferImageCopy.bufferImageHeight				= 0;
-			bufferImageCopy.imageSubresource.aspectMask		= VK_IMAGE_ASPECT_COLOR_BIT;
-			bufferImageCopy.imageSubresource.baseArrayLayer = 0;
-			bufferImageCopy.imageSubresource.layerCount		= 1;
-			bufferImageCopy.imageSubresource.mipLevel		= 0;
-			bufferImageCopy.imageOffset						= { 0, 0, 0 };
-			bufferImageCopy.imageExtent						= imageBuffer->getDimension();
-
-			coypCmdBuffer.copyBufferToImage(&stagingBuffers[i], imageBuffer, { bufferImageCopy });
-
-			coypCmdBuffer.pipelineBarrier(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
-				0, {}, {},
-				{ imageBuffer->generateMemoryBarrier(VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_ASPECT_COLOR_BIT,
-				VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL) }
-			);
+		std::vector<std::pair<glm::mat4, glm::mat4>> matrixBuf;
+		gatherMatrices(&matrixBuf);
+
+		std::vector<VkDrawIndexedIndirectCommand> indirectCommands;
+		std::vector<GltfDrawData> drawData;
+		gatherIndirectCommands(&indirectCommands, &drawData);
+
+		uint64_t stagingSize = AlignStaging(_geometry.indexSize) +
+							   AlignStaging(materials.size() * sizeof(GltfShadeMaterial)) +
+							   AlignStaging(matrixBuf.size() * sizeof(glm::mat4) * 2) +
+							   AlignStaging(indirectCommands.size() * sizeof(VkDrawIndexedIndirectCommand)) +
+							   AlignStaging(drawData.size() * sizeof(GltfDrawData));
+		for (uint32_t stream = 0; stream < GeometryPool::kNumVertexStreams; ++stream)
+		{
+			stagingSize += AlignStaging(static_cast<uint64_t>(_geometry.vertexCount) * _geometryPool->getVertexStride(stream));
+		}
+		for (const GLTFImage& image : _images)
+		{
+			stagingSize += AlignStaging(image.getNumBytes());
+		}
 
-			coypCmdBuffer.endRecord();
-
-			Fence copyCmdFence(_device, 1, 0);
-			_queue->submitCmdBuffer({ coypCmdBuffer }, &copyCmdFence);
-			copyCmdFence.waitForAllFences(UINT64_MAX);
-
-			CommandBuffer blitCmdBuffer(loaderCmdPool.allocateCommandBuffer());
-			blitCmdBuffer.beginRecord(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
-
-			// Mipmap generation
-			VkImageMemoryBarrier mipmapBarrier = {};
-			mipmapBarrier.sType								= VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-			mipmapBarrier.pNext								= nullptr;
-			mipmapBarrier.image								= imageBuffer->getImageHandle();
-			mipmapBarrier.srcQueueFamilyIndex				= VK_QUEUE_FAMILY_IGNORED;
-			mipmapBarrier.dstQueueFamilyIndex				= VK_QUEUE_FAMILY_IGNORED;
-			mipmapBarrier.subresourceRange.aspectMask		= VK_IMAGE_ASPECT_COLOR_BIT;
-			mipmapBarrier.subresourceRange.baseArrayLayer	= 0;
-			mipmapBarrier.subresourceRange.layerCount		= 1;
-			mipmapBarrier.subresourceRange.levelCount		= 1;
-
-			int32_t mipWidth  = static_cast<int32_t>(image.width);
-			int32_t mipHeight = static_cast<int32_t>(image.height);
-			
-			for (uint32_t mip = 1; mip < mipLevels; ++mip)
+		// All scene data goes through one staging allocation of the upload manager
+		UploadManager::Allocation staging;
+		if (!_uploadManager->allocateStaging(vfs::max(stagingSize, kStagingAlignment), kStagingAlignment, &staging))
+		{
+			VFS_ERROR << "Failed to allocate scene staging memory";
+			return false;
+		}
+
+		_uploadManager->enqueueCommand([&](CommandBuffer cmdBuffer) {
+			uint64_t stagingOffset{ 0 };
+			cmdUploadBuffer(&cmdBuffer, staging, &stagingOffset);
+			cmdUploadImage(&cmdBuffer, staging, &stagingOffset);
+
+			const uint64_t materialBufSize = materials.size() * sizeof(GltfShadeMaterial);
+			if (materialBufSize > 0)
 			{
-				mipmapBarrier.subresourceRange.baseMipLevel = mip;
-				mipmapBarrier.oldLayout						= VK_IMAGE_LAYOUT_UNDEFINED;
-				mipmapBarrier.newLayout						= VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-				mipmapBarrier.srcAccessMask					= 0;
-				mipmapBarrier.dstAccessMask					= VK_ACCESS_TRANSFER_WRITE_BIT;
-
-				blitCmdBuffer.pipelineBarrier(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
-					0, {}, {}, { mipmapBarrier });
-
-				VkImageBlit blit{};
-				// Blit source
-				blit.srcOffsets[0] = { 0, 0, 0 };
-				blit.srcOffsets[1] = { mipWidth, mipHeight, 1 };
-				blit.srcSubresource.aspectMask		= VK_IMAGE_ASPECT_COLOR_BIT;
-				blit.srcSubresource.mipLevel		= mip - 1;
-				blit.srcSubresource.baseArrayLayer	= 0;
-				blit.srcSubresource.layerCount		= 1;
-				// Blit destination
-				blit.dstOffsets[0] = { 0, 0, 0 };
-				blit.dstOffsets[1] = { mipWidth > 1 ? mipWidth >> 1 : 1, mipHeight > 1 ? mipHeight >> 1 : 1, 1 };
-				blit.dstSubresource.aspectMask		= VK_IMAGE_ASPECT_COLOR_BIT;
-				blit.dstSubresource.mipLevel		= mip;
-				blit.dstSubresource.baseArrayLayer	= 0;
-				blit.dstSubresource.layerCount		= 1;
-
-				blitCmdBuffer.blitImage(imageBuffer, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-					imageBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, { blit }, VK_FILTER_LINEAR);
-
-				mipmapBarrier.oldLayout		= VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-				mipmapBarrier.newLayout		= VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-				mipmapBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-				mipmapBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-
-				blitCmdBuffer.pipelineBarrier(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
-					0, {}, {}, { mipmapBarrier });
-
-				if (mipWidth > 1)	mipWidth >>= 1;
-				if (mipHeight > 1)	mipHeight >>= 1;
+				const uint64_t materialOffset = WriteStaging(staging, &stagingOffset, materials.data(), materialBufSize);
+				cmdBuffer.copyBuffer(staging.buffer, _bindlessTable->getMaterialBuffer(),
+									 { { materialOffset, _tableRange.firstMaterial * sizeof(GltfShadeMaterial), materialBufSize } });
 			}
 
-			blitCmdBuffer.endRecord();
-
-			Fence blitCmdFence(_device, 1, 0);
-			_queue->submitCmdBuffer({ blitCmdBuffer }, &blitCmdFence);
-			blitCmdFence.waitForAllFences(UINT64_MAX);
+			const uint64_t matrixBufSize = matrixBuf.size() * sizeof(glm::mat4) * 2;
+			if (matrixBufSize > 0)
+			{
+				const uint64_t matrixOffset = WriteStaging(staging, &stagingOffset, matrixBuf.data(), matrixBufSize);
+				cmdBuffer.copyBuffer(staging.buffer, _bindlessTable->getMatrixBuffer(),
+									 { { matrixOffset, _tableRange.firstMatrix * sizeof(glm::mat4) * 2, matrixBufSize } });
+			}
 
-			CommandBuffer finalTransitionCmdBuffer(loaderCmdPool.allocateCommandBuffer());
-			finalTransitionCmdBuffer.beginRecord(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+			// Indirect commands never change after upload, only their matrices and materials do
+			if (!indirectCommands.empty())
+			{
+				const uint64_t commandBufSize = indirectCommands.size() * sizeof(VkDrawIndexedIndirectCommand);
+				const uint64_t commandOffset  = WriteStaging(staging, &stagingOffset, indirectCommands.data(), commandBufSize);
+				cmdBuffer.copyBuffer(staging.buffer, _bindlessTable->getIndirectBuffer(),
+									 { { commandOffset, _tableRange.firstDraw * sizeof(VkDrawIndexedIndirectCommand), commandBufSize } });
+
+				const uint64_t drawBufSize = drawData.size() * sizeof(GltfDrawData);
+				const uint64_t drawOffset  = WriteStaging(staging, &stagingOffset, drawData.data(), drawBufSize);
+				cmdBuffer.copyBuffer(staging.buffer, _bindlessTable->getDrawBuffer(),
+									 { { drawOffset, _tableRange.firstDraw * sizeof(GltfDrawData), drawBufSize } });
+			}
+		});
 
-			mipmapBarrier.subresourceRange.baseMipLevel = 0;
-			mipmapBarrier.subresourceRange.levelCount	= mipLevels;
-			mipmapBarrier.oldLayout		= VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-			mipmapBarrier.newLayout		= VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			mipmapBarrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-			mipmapBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		// Single submission for the whole scene, later submissions on the same queue are ordered after it
+		return _uploadManager->submit();
+	}
 
-			finalTransitionCmdBuffer.pipelineBarrier(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-				0, {}, {}, { mipmapBarrier });
+	bool GLTFScene::uploadMaterialBuffer(void)
+	{
+		std::vector<GltfShadeMaterial> materials;
+		gatherMaterials(&materials);
 
-			finalTransitionCmdBuffer.endRecord();
+		// Recorded into the pending upload batch, submitted ahead of the next frame
+		const uint64_t materialBufSize = materials.size() * sizeof(GltfShadeMaterial);
+		if (materialBufSize == 0)
+		{
+			return true;
+		}
+		enqueueTableWriteBarrier();
+		return _uploadManager->uploadBuffer(_bindlessTable->getMaterialBuffer(), materials.data(), materialBufSize,
+											_tableRange.firstMaterial * sizeof(GltfShadeMaterial));
+	}
 
-			Fence finalTransitionFence(_device, 1, 0);
-			_queue->submitCmdBuffer({ finalTransitionCmdBuffer }, &finalTransitionFence);
-			finalTransitionFence.waitForAllFences(UINT64_MAX);
+	bool GLTFScene::uploadMatrixBuffer(void)
+	{
+		std::vector<std::pair<glm::mat4, glm::mat4>> matrixBuf;
+		gatherMatrices(&matrixBuf);
 
-			_textureImages.emplace_back(imageBuffer);
-			_textureImageViews.emplace_back(std::make_shared<ImageView>(_device, imageBuffer, VK_IMAGE_ASPECT_COLOR_BIT, mipLevels));
-			_textureSamplers.emplace_back(std::make_shared<Sampler>(_device, VK_SAMPLER_ADDRESS_MODE_REPEAT, VK_FILTER_LINEAR, 0.0f));
+		const uint64_t matrixBufSize = matrixBuf.size() * sizeof(glm::mat4) * 2;
+		if (matrixBufSize == 0)
+		{
+			return true;
 		}
-		
-		return true;
+		enqueueTableWriteBarrier();
+		return _uploadManager->uploadBuffer(_bindlessTable->getMatrixBuffer(), matrixBuf.data(), matrixBufSize,
+											_tableRange.firstMatrix * sizeof(glm::mat4) * 2);
 	}
 
-	bool GLTFScene::uploadMaterialBuffer(void)
+	void GLTFScene::enqueueTableWriteBarrier(void)
 	{
-		const VmaAllocator allocator = _device->getMemoryAllocator();
-		
-		// Create shader storage buffer object for materials and fill it
-		std::vector<GltfShadeMaterial> materials;
-		materials.reserve(_sceneMaterials.size());
+		// snowapril : frames in flight may still read the old materials and matrices, the upload
+		//			   batch waits for shaders of earlier submissions before overwriting the ranges
+		_uploadManager->enqueueCommand([](CommandBuffer cmdBuffer) {
+			cmdBuffer.pipelineBarrier(VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+									  VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, {}, {}, {});
+		});
+	}
+
+	void GLTFScene::gatherMaterials(std::vector<GltfShadeMaterial>* materials) const
+	{
+		// Texture indices point into the bindless texture table, -1 marks missing texture
+		const int firstTexture = static_cast<int>(_tableRange.firstTexture);
+		auto toTableIndex = [this, firstTexture](int textureIndex) {
+			return hasTextureImage(textureIndex) ? firstTexture + textureIndex : -1;
+		};
+
+		materials->reserve(_sceneMaterials.size());
 		for (const GLTFMaterial& material : _sceneMaterials)
 		{
-			materials.push_back({   material.baseColorFactor,
-									material.baseColorTexture,
+			materials->push_back({  material.baseColorFactor,
+									toTableIndex(material.baseColorTexture),
 									material.metallicFactor,
 									material.roughnessFactor,
-									material.metallicRoughnessTexture,
-									material.emissiveTexture,
+									toTableIndex(material.metallicRoughnessTexture),
+									toTableIndex(material.emissiveTexture),
 									material.alphaMode,
 									material.alphaCutoff,
 									material.doubleSided,
 									material.emissiveFactor,
-									material.normalTexture,
+									toTableIndex(material.normalTexture),
 									material.normalTextureScale,
-									material.occlusionTexture,
+									toTableIndex(material.occlusionTexture),
 									material.occlusionTextureStrength } );
 		}
+	}
+
+	bool GLTFScene::hasTextureImage(int textureIndex) const
+	{
+		if (textureIndex < 0 || textureIndex >= static_cast<int>(_sceneTextures.size()))
+		{
+			return false;
+		}
+		// Image indices were validated on import, _images is empty once the scene is uploaded
+		return _sceneTextures[textureIndex].imageIndex > -1;
+	}
 
-		const uint32_t materialBufSize = static_cast<uint32_t>(materials.size()) * sizeof(GltfShadeMaterial);
-		Buffer stagingMaterial(allocator, materialBufSize,
-							   VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-							   VMA_MEMORY_USAGE_CPU_ONLY);
-		stagingMaterial.uploadData(materials.data(), materialBufSize);
+	void GLTFScene::gatherMatrices(std::vector<std::pair<glm::mat4, glm::mat4>>* matrices) const
+	{
+		matrices->reserve(_sceneNodes.size());
+		for (const GLTFNode& node : _sceneNodes)
+		{
+			if (!node.primMeshes.empty())
+			{
+				// Dequantization of packed positions is folded into the model matrix only,
+				// normal matrix keeps using the original world transform
+				const glm::mat4 model = _decodeTransforms.empty() ? node.world :
+										node.world * _decodeTransforms[node.primMeshes.front()].getMatrix();
+				matrices->emplace_back(model, glm::transpose(glm::inverse(node.world)));
+			}
+		}
+	}
 
-		CommandPool loaderCmdPool(_device, _queue, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT |
-													    VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+	void GLTFScene::computeDecodeTransforms(const StreamView<glm::vec3>& positions)
+	{
+		std::vector<glm::vec3> boxMin(_scenePrimMeshes.size(), glm::vec3(std::numeric_limits<float>::max()));
+		std::vector<glm::vec3> boxMax(_scenePrimMeshes.size(), glm::vec3(std::numeric_limits<float>::lowest()));
+		for (size_t i = 0; i < _scenePrimMeshes.size(); ++i)
+		{
+			const GLTFPrimMesh& primMesh = _scenePrimMeshes[i];
+			for (uint32_t v = 0; v < primMesh.vertexCount; ++v)
+			{
+				const glm::vec3& position = positions.data[primMesh.vertexOffset + v];
+				boxMin[i] = glm::min(boxMin[i], position);
+				boxMax[i] = glm::max(boxMax[i], position);
+			}
+		}
 
-		CommandBuffer cmdBuffer(loaderCmdPool.allocateCommandBuffer());
+		// snowapril : primitives of a node are drawn with one model matrix, so they
+		//			   share the box of their mesh instead of having their own one
+		for (const GLTFNode& node : _sceneNodes)
 		{
-			cmdBuffer.beginRecord(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+			glm::vec3 meshMin(std::numeric_limits<float>::max()), meshMax(std::numeric_limits<float>::lowest());
+			for (uint32_t meshIdx : node.primMeshes)
+			{
+				meshMin = glm::min(meshMin, boxMin[meshIdx]);
+				meshMax = glm::max(meshMax, boxMax[meshIdx]);
+			}
+			for (uint32_t meshIdx : node.primMeshes)
+			{
+				boxMin[meshIdx] = meshMin;
+				boxMax[meshIdx] = meshMax;
+			}
+		}
 
-			cmdBuffer.copyBuffer(&stagingMaterial, _materialBuffer, { { 0, 0, materialBufSize } });
+		_decodeTransforms.resize(_scenePrimMeshes.size());
+		for (size_t i = 0; i < _scenePrimMeshes.size(); ++i)
+		{
+			// Primitives without vertices keep identity transform
+			if (_scenePrimMeshes[i].vertexCount > 0)
+			{
+				_decodeTransforms[i] = VertexQuantizer::GetDecodeTransform(boxMin[i], boxMax[i]);
+			}
+		}
+	}
 
-			cmdBuffer.endRecord();
+	void GLTFScene::buildDrawCommands(void)
+	{
+		// Assign each primitive its place in the 16-bit or 32-bit index region
+		uint32_t numIndices16{ 0 }, numIndices32{ 0 };
+		_regionFirstIndices.resize(_scenePrimMeshes.size());
+		for (size_t i = 0; i < _scenePrimMeshes.size(); ++i)
+		{
+			uint32_t& numIndices = IsShortIndexed(_scenePrimMeshes[i].vertexCount) ? numIndices16 : numIndices32;
+			_regionFirstIndices[i] = numIndices;
+			numIndices += _scenePrimMeshes[i].indexCount;
+		}
+		// snowapril : offset of index buffer binding must be multiple of index type size
+		_index32Offset = (static_cast<VkDeviceSize>(numIndices16) * sizeof(uint16_t) + sizeof(uint32_t) - 1) & ~(sizeof(uint32_t) - 1);
 
-			Fence fence(_device, 1, 0);
-			_queue->submitCmdBuffer({ cmdBuffer }, &fence);
-			if (!fence.waitForAllFences(UINT64_MAX))
+		_drawCommands.clear();
+		_numDraws16 = 0;
+		_maxDrawTriangles = 0;
+		for (const VkIndexType indexType : { VK_INDEX_TYPE_UINT16, VK_INDEX_TYPE_UINT32 })
+		{
+			// snowapril : only nodes with meshes have matrices, see gatherMatrices
+			uint32_t instanceIndex = 0;
+			for (uint32_t nodeIndex = 0; nodeIndex < static_cast<uint32_t>(_sceneNodes.size()); ++nodeIndex)
+			{
+				const GLTFNode& sceneNode = _sceneNodes[nodeIndex];
+				if (sceneNode.primMeshes.empty())
+				{
+					continue;
+				}
+				for (uint32_t meshIdx : sceneNode.primMeshes)
+				{
+					const bool bShortIndexed = IsShortIndexed(_scenePrimMeshes[meshIdx].vertexCount);
+					if (bShortIndexed == (indexType == VK_INDEX_TYPE_UINT16))
+					{
+						DrawCommand drawCommand;
+						drawCommand.instanceIndex = instanceIndex;
+						drawCommand.nodeIndex	  = nodeIndex;
+						drawCommand.primMeshIndex = meshIdx;
+						drawCommand.firstIndex	  = _regionFirstIndices[meshIdx];
+						drawCommand.indexType	  = indexType;
+						_drawCommands.push_back(drawCommand);
+						_maxDrawTriangles = vfs::max(_maxDrawTriangles, _scenePrimMeshes[meshIdx].indexCount / 3);
+					}
+				}
+				++instanceIndex;
+			}
+			if (indexType == VK_INDEX_TYPE_UINT16)
 			{
-				return false;
+				_numDraws16 = static_cast<uint32_t>(_drawCommands.size());
 			}
 		}
+	}
 
-		return true;
+	void GLTFScene::gatherDrawBoxes(std::vector<BoundingBox<glm::vec3>>* drawBoxes) const
+	{
+		drawBoxes->reserve(_drawCommands.size());
+		for (const DrawCommand& drawCommand : _drawCommands)
+		{
+			// World box enclosing the transformed primitive box, extent is spread by absolute matrix
+			const GLTFPrimMesh& primMesh = _scenePrimMeshes[drawCommand.primMeshIndex];
+			const glm::mat4&	world	 = _sceneNodes[drawCommand.nodeIndex].world;
+			const glm::vec3 localCenter	 = (primMesh.min + primMesh.max) * 0.5f;
+			const glm::vec3 localExtent	 = (primMesh.max - primMesh.min) * 0.5f;
+			const glm::vec3 center		 = glm::vec3(world * glm::vec4(localCenter, 1.0f));
+			const glm::vec3 extent		 = glm::abs(glm::vec3(world[0])) * localExtent.x +
+										   glm::abs(glm::vec3(world[1])) * localExtent.y +
+										   glm::abs(glm::vec3(world[2])) * localExtent.z;
+			drawBoxes->emplace_back(center - extent, center + extent);
+		}
 	}
 
-	bool GLTFScene::uploadMatrixBuffer(void)
+	void GLTFScene::gatherIndirectCommands(std::vector<VkDrawIndexedIndirectCommand>* indirectCommands,
+										   std::vector<GltfDrawData>* drawData) const
 	{
-		const VmaAllocator allocator = _device->getMemoryAllocator();
+		indirectCommands->reserve(_drawCommands.size());
+		drawData->reserve(_drawCommands.size());
 
-		std::vector<std::pair<glm::mat4, glm::mat4>> matrixBuf;
-		matrixBuf.reserve(_sceneNodes.size());
+		// First index and vertex offset point into the ranges of this scene in the geometry pool
+		const uint32_t regionFirstIndex16 = static_cast<uint32_t>(_geometry.indexOffset / sizeof(uint16_t));
+		const uint32_t regionFirstIndex32 = static_cast<uint32_t>((_geometry.indexOffset + _index32Offset) / sizeof(uint32_t));
+		for (const DrawCommand& drawCommand : _drawCommands)
+		{
+			const GLTFPrimMesh& primMesh = _scenePrimMeshes[drawCommand.primMeshIndex];
+			const uint32_t drawIndex = _tableRange.firstDraw + static_cast<uint32_t>(indirectCommands->size());
+
+			// snowapril : firstInstance carries the draw table index, read back as gl_InstanceIndex
+			VkDrawIndexedIndirectCommand indirectCommand;
+			indirectCommand.indexCount		= primMesh.indexCount;
+			indirectCommand.instanceCount	= 1;
+			indirectCommand.firstIndex		= (drawCommand.indexType == VK_INDEX_TYPE_UINT16 ? regionFirstIndex16 : regionFirstIndex32) +
+											  drawCommand.firstIndex;
+			indirectCommand.vertexOffset	= static_cast<int32_t>(_geometry.baseVertex + primMesh.vertexOffset);
+			indirectCommand.firstInstance	= drawIndex;
+			indirectCommands->push_back(indirectCommand);
+
+			// Model matrix of packed scenes decodes positions first, so bounds are encoded the same way
+			GltfDrawData data;
+			data.boundsMin		= primMesh.min;
+			data.boundsMax		= primMesh.max;
+			if (!_decodeTransforms.empty())
+			{
+				const VertexQuantizer::DecodeTransform& decode = _decodeTransforms[drawCommand.primMeshIndex];
+				data.boundsMin	= (primMesh.min - decode.offset) / decode.scale;
+				data.boundsMax	= (primMesh.max - decode.offset) / decode.scale;
+			}
+			data.matrixIndex	= _tableRange.firstMatrix + drawCommand.instanceIndex;
+			data.materialIndex	= _tableRange.firstMaterial + static_cast<uint32_t>(primMesh.materialIndex);
+			data.indexSize		= drawCommand.indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+			data.padding0		= 0;
+			data.padding1		= 0;
+			data.padding2		= 0;
+			drawData->push_back(data);
+		}
+	}
 
-		for (const GLTFNode& node : _sceneNodes)
+	void GLTFScene::cmdUploadBuffer(CommandBuffer* cmdBuffer, const UploadManager::Allocation& staging,
+									uint64_t* stagingOffset)
+	{
+		const StreamView<glm::vec3>		positions	= getStream(_positions,	SceneCache::Section::Positions);
+		const StreamView<glm::vec3>		normals		= getStream(_normals,	SceneCache::Section::Normals);
+		const StreamView<glm::vec2>		texCoords	= getStream(_texCoords,	SceneCache::Section::TexCoords);
+		const StreamView<glm::vec4>		tangents	= getStream(_tangents,	SceneCache::Section::Tangents);
+		const StreamView<unsigned int>	indices		= getStream(_indices,	SceneCache::Section::Indices);
+
+		const uint64_t positionBytes	= positions.count * _geometryPool->getVertexStride(0);
+		const uint64_t normalBytes		= normals.count	  * _geometryPool->getVertexStride(1);
+		const uint64_t texCoordBytes	= texCoords.count * _geometryPool->getVertexStride(2);
+		const uint64_t tangentBytes		= tangents.count  * _geometryPool->getVertexStride(3);
+
+		uint64_t positionOffset{ 0 }, normalOffset{ 0 }, texCoordOffset{ 0 }, tangentOffset{ 0 };
+		if (static_cast<bool>(_format & VertexFormat::Quantized))
 		{
-			if (!node.primMeshes.empty())
+			// Packed streams are encoded straight into the staging memory
+			uint8_t* positionData{ nullptr }, *normalData{ nullptr }, *texCoordData{ nullptr }, *tangentData{ nullptr };
+			positionOffset	= ReserveStaging(staging, stagingOffset, positionBytes,	&positionData);
+			normalOffset	= ReserveStaging(staging, stagingOffset, normalBytes,	&normalData);
+			texCoordOffset	= ReserveStaging(staging, stagingOffset, texCoordBytes,	&texCoordData);
+			tangentOffset	= ReserveStaging(staging, stagingOffset, tangentBytes,	&tangentData);
+
+			for (size_t i = 0; i < _scenePrimMeshes.size(); ++i)
+			{
+				const GLTFPrimMesh& primMesh = _scenePrimMeshes[i];
+				VertexQuantizer::EncodePositions(positions.data + primMesh.vertexOffset, primMesh.vertexCount, _decodeTransforms[i],
+												 reinterpret_cast<uint64_t*>(positionData) + primMesh.vertexOffset);
+			}
+			VertexQuantizer::EncodeNormals	(normals.data,	 normals.count,	  reinterpret_cast<uint32_t*>(normalData));
+			VertexQuantizer::EncodeTexCoords(texCoords.data, texCoords.count, reinterpret_cast<uint32_t*>(texCoordData));
+			VertexQuantizer::EncodeTangents	(tangents.data,	 tangents.count,  reinterpret_cast<uint32_t*>(tangentData));
+		}
+		else
+		{
+			positionOffset	= WriteStaging(staging, stagingOffset, positions.data, positionBytes);
+			normalOffset	= WriteStaging(staging, stagingOffset, normals.data,   normalBytes);
+			texCoordOffset	= WriteStaging(staging, stagingOffset, texCoords.data, texCoordBytes);
+			tangentOffset	= WriteStaging(staging, stagingOffset, tangents.data,  tangentBytes);
+		}
+
+		// Narrow indices of small primitives while writing them into their regions
+		uint8_t* indexData{ nullptr };
+		const uint64_t indexBytes	 = _geometry.indexSize;
+		const uint64_t indicesOffset = ReserveStaging(staging, stagingOffset, indexBytes, &indexData);
+		for (size_t i = 0; i < _scenePrimMeshes.size(); ++i)
+		{
+			const GLTFPrimMesh& primMesh = _scenePrimMeshes[i];
+			const unsigned int* srcIndices = indices.data + primMesh.firstIndex;
+			if (IsShortIndexed(primMesh.vertexCount))
+			{
+				uint16_t* dstIndices = reinterpret_cast<uint16_t*>(indexData) + _regionFirstIndices[i];
+				for (uint32_t idx = 0; idx < primMesh.indexCount; ++idx)
+				{
+					dstIndices[idx] = static_cast<uint16_t>(srcIndices[idx]);
+				}
+			}
+			else
 			{
-				matrixBuf.emplace_back(node.world, glm::transpose(glm::inverse(node.world)));
+				uint32_t* dstIndices = reinterpret_cast<uint32_t*>(indexData + _index32Offset) + _regionFirstIndices[i];
+				std::memcpy(dstIndices, srcIndices, primMesh.indexCount * sizeof(uint32_t));
 			}
 		}
 
-		const uint32_t matrixBufSize = static_cast<uint32_t>(matrixBuf.size() * sizeof(glm::mat4) * 2);
-		Buffer stagingMatrix(allocator, matrixBufSize,
-							 VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-							 VMA_MEMORY_USAGE_CPU_ONLY);
-		stagingMatrix.uploadData(matrixBuf.data(), matrixBufSize);
+		// snowapril : zero sized copy regions are invalid
+		const uint64_t baseVertex = _geometry.baseVertex;
+		if (positions.count > 0)
+			cmdBuffer->copyBuffer(staging.buffer, _geometryPool->getVertexBuffer(0), { { positionOffset, baseVertex * _geometryPool->getVertexStride(0), positionBytes } });
+		if (normals.count > 0)
+			cmdBuffer->copyBuffer(staging.buffer, _geometryPool->getVertexBuffer(1), { { normalOffset,	 baseVertex * _geometryPool->getVertexStride(1), normalBytes	} });
+		if (texCoords.count > 0)
+			cmdBuffer->copyBuffer(staging.buffer, _geometryPool->getVertexBuffer(2), { { texCoordOffset, baseVertex * _geometryPool->getVertexStride(2), texCoordBytes } });
+		if (tangents.count > 0)
+			cmdBuffer->copyBuffer(staging.buffer, _geometryPool->getVertexBuffer(3), { { tangentOffset,	 baseVertex * _geometryPool->getVertexStride(3), tangentBytes	} });
+		if (indexBytes > 0)
+			cmdBuffer->copyBuffer(staging.buffer, _geometryPool->getIndexBuffer(),	 { { indicesOffset,	 _geometry.indexOffset,							 indexBytes		} });
+	}
+
+	void GLTFScene::cmdUploadImage(CommandBuffer* cmdBuffer, const UploadManager::Allocation& staging,
+								   uint64_t* stagingOffset)
+	{
+		std::vector<VkImageMemoryBarrier> uploadBarriers;
+		std::vector<VkImageMemoryBarrier> postCopyBarriers;
+		std::vector<VkImageMemoryBarrier> finalBarriers;
+		uploadBarriers.reserve(_images.size());
+
+		// Create all images first so that their layout transitions are batched
+		for (const GLTFImage& image : _images)
+		{
+			// Mip chain pre-generated on CPU is copied as it is, otherwise blit it on GPU
+			const bool bBlitMips = IsMipmapBlitRequired(image);
+			const uint32_t mipLevels = bBlitMips ? MipmapGenerator::GetNumMipLevels(image.width, image.height) : image.mipLevels;
+
+			VkImageCreateInfo imageInfo = Image::GetDefaultImageCreateInfo();
+			imageInfo.extent		= { static_cast<uint32_t>(image.width), static_cast<uint32_t>(image.height), 1 };
+			imageInfo.format		= GetImageFormat(image.format);
+			imageInfo.usage			= (bBlitMips ? VK_IMAGE_USAGE_TRANSFER_SRC_BIT : 0) | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+			imageInfo.imageType		= VK_IMAGE_TYPE_2D;
+			imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			imageInfo.mipLevels		= mipLevels;
+			ImagePtr imageBuffer = std::make_shared<Image>(_device->getMemoryAllocator(), VMA_MEMORY_USAGE_GPU_ONLY, imageInfo);
+
+			// Whole mip chain is transitioned at once, levels filled by blit are overwritten anyway
+			VkImageMemoryBarrier uploadBarrier = imageBuffer->generateMemoryBarrier(0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_ASPECT_COLOR_BIT,
+																					VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+			uploadBarrier.subresourceRange.levelCount = mipLevels;
+			uploadBarriers.push_back(uploadBarrier);
+
+			_textureImages.emplace_back(imageBuffer);
+			_textureImageViews.emplace_back(std::make_shared<ImageView>(_device, imageBuffer, VK_IMAGE_ASPECT_COLOR_BIT, mipLevels));
+		}
+
+		if (uploadBarriers.empty())
+		{
+			return;
+		}
 
-		CommandPool loaderCmdPool(_device, _queue, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT |
-													    VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+		cmdBuffer->pipelineBarrier(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+			0, {}, {}, uploadBarriers
+		);
 
-		CommandBuffer cmdBuffer(loaderCmdPool.allocateCommandBuffer());
+		for (size_t i = 0; i < _images.size(); ++i)
 		{
-			cmdBuffer.beginRecord(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+			const GLTFImage& image = _images[i];
+			const ImagePtr& imageBuffer = _textureImages[i];
 
-			cmdBuffer.copyBuffer(&stagingMatrix, _matrixBuffer, { { 0, 0, matrixBufSize } });
+			const uint64_t imageOffset = WriteStaging(staging, stagingOffset, image.getPixels(), image.getNumBytes());
 
-			cmdBuffer.endRecord();
+			std::vector<VkBufferImageCopy> bufferImageCopies(image.mipLevels);
+			for (uint32_t mip = 0; mip < image.mipLevels; ++mip)
+			{
+				VkBufferImageCopy& bufferImageCopy = bufferImageCopies[mip];
+				bufferImageCopy.bufferOffset					= imageOffset + TextureCompressor::GetMipOffset(image.format, image.width, image.height, mip);
+				bufferImageCopy.bufferRowLength					= 0;
+				bufferImageCopy.bufferImageHeight				= 0;
+				bufferImageCopy.imageSubresource.aspectMask		= VK_IMAGE_ASPECT_COLOR_BIT;
+				bufferImageCopy.imageSubresource.baseArrayLayer = 0;
+				bufferImageCopy.imageSubresource.layerCount		= 1;
+				bufferImageCopy.imageSubresource.mipLevel		= mip;
+				bufferImageCopy.imageOffset						= { 0, 0, 0 };
+				bufferImageCopy.imageExtent						= { vfs::max(image.width >> mip, 1u), vfs::max(image.height >> mip, 1u), 1 };
+			}
+			cmdBuffer->copyBufferToImage(staging.buffer, imageBuffer, bufferImageCopies);
 
-			Fence fence(_device, 1, 0);
-			_queue->submitCmdBuffer({ cmdBuffer }, &fence);
-			if (!fence.waitForAllFences(UINT64_MAX))
+			const uint32_t mipLevels = uploadBarriers[i].subresourceRange.levelCount;
+			if (!IsMipmapBlitRequired(image))
+			{
+				VkImageMemoryBarrier finalBarrier = imageBuffer->generateMemoryBarrier(VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_ASPECT_COLOR_BIT,
+																					   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+				finalBarrier.subresourceRange.levelCount = mipLevels;
+				finalBarriers.push_back(finalBarrier);
+			}
+			else
 			{
-				return false;
+				postCopyBarriers.push_back(imageBuffer->generateMemoryBarrier(VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_ASPECT_COLOR_BIT,
+																			  VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL));
 			}
 		}
 
-		return true;
+		// Blit remaining mip levels on GPU for images without pre-generated mip chain
+		if (!postCopyBarriers.empty())
+		{
+			cmdBuffer->pipelineBarrier(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+				0, {}, {}, postCopyBarriers
+			);
+
+			for (size_t i = 0; i < _images.size(); ++i)
+			{
+				const GLTFImage& image = _images[i];
+				if (!IsMipmapBlitRequired(image))
+				{
+					continue;
+				}
+
+				const uint32_t mipLevels = uploadBarriers[i].subresourceRange.levelCount;
+				cmdGenerateMipmaps(cmdBuffer, _textureImages[i], image.width, image.height, mipLevels);
+
+				VkImageMemoryBarrier finalBarrier = _textureImages[i]->generateMemoryBarrier(VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_ASPECT_COLOR_BIT,
+																							 VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+				finalBarrier.subresourceRange.levelCount = mipLevels;
+				finalBarriers.push_back(finalBarrier);
+			}
+		}
+
+		// Transition every texture to shader read layout at once
+		cmdBuffer->pipelineBarrier(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+			0, {}, {}, finalBarriers
+		);
+	}
+
+	void GLTFScene::cmdGenerateMipmaps(CommandBuffer* cmdBuffer, const ImagePtr& imageBuffer,
+									   uint32_t width, uint32_t height, uint32_t mipLevels)
+	{
+		// Level 0 is in TRANSFER_SRC layout and the other levels in TRANSFER_DST layout.
+		// After this, whole mip chain is in TRANSFER_SRC layout.
+		VkImageMemoryBarrier mipmapBarrier = {};
+		mipmapBarrier.sType								= VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		mipmapBarrier.pNext								= nullptr;
+		mipmapBarrier.image								= imageBuffer->getImageHandle();
+		mipmapBarrier.srcQueueFamilyIndex				= VK_QUEUE_FAMILY_IGNORED;
+		mipmapBarrier.dstQueueFamilyIndex				= VK_QUEUE_FAMILY_IGNORED;
+		mipmapBarrier.subresourceRange.aspectMask		= VK_IMAGE_ASPECT_COLOR_BIT;
+		mipmapBarrier.subresourceRange.baseArrayLayer	= 0;
+		mipmapBarrier.subresourceRange.layerCount		= 1;
+		mipmapBarrier.subresourceRange.levelCount		= 1;
+
+		int32_t mipWidth  = static_cast<int32_t>(width);
+		int32_t mipHeight = static_cast<int32_t>(height);
+		
+		for (uint32_t mip = 1; mip < mipLevels; ++mip)
+		{
+			VkImageBlit blit{};
+			// Blit source
+			blit.srcOffsets[0] = { 0, 0, 0 };
+			blit.srcOffsets[1] = { mipWidth, mipHeight, 1 };
+			blit.srcSubresource.aspectMask		= VK_IMAGE_ASPECT_COLOR_BIT;
+			blit.srcSubresource.mipLevel		= mip - 1;
+			blit.srcSubresource.baseArrayLayer	= 0;
+			blit.srcSubresource.layerCount		= 1;
+			// Blit destination
+			blit.dstOffsets[0] = { 0, 0, 0 };
+			blit.dstOffsets[1] = { mipWidth > 1 ? mipWidth >> 1 : 1, mipHeight > 1 ? mipHeight >> 1 : 1, 1 };
+			blit.dstSubresource.aspectMask		= VK_IMAGE_ASPECT_COLOR_BIT;
+			blit.dstSubresource.mipLevel		= mip;
+			blit.dstSubresource.baseArrayLayer	= 0;
+			blit.dstSubresource.layerCount		= 1;
+
+			cmdBuffer->blitImage(imageBuffer, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+				imageBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, { blit }, VK_FILTER_LINEAR);
+
+			mipmapBarrier.subresourceRange.baseMipLevel = mip;
+			mipmapBarrier.oldLayout		= VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			mipmapBarrier.newLayout		= VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+			mipmapBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			mipmapBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+			cmdBuffer->pipelineBarrier(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+				0, {}, {}, { mipmapBarrier });
+
+			if (mipWidth > 1)	mipWidth >>= 1;
+			if (mipHeight > 1)	mipHeight >>= 1;
+		}
 	}
 
-	void GLTFScene::allocateDescriptor(const DescriptorPoolPtr& pool, const DescriptorSetLayoutPtr& layout)
+	void GLTFScene::updateTextureDescriptors(void)
 	{
-		_descriptorSet = std::make_shared<DescriptorSet>(_device, pool, layout, 1);
-		std::vector<VkDescriptorImageInfo> imageInfos(_textureImages.size());
-		for (size_t i = 0; i < _textureImages.size(); ++i)
+		// snowapril : texture without supported image is left unbound, materials see it as missing texture
+		std::vector<VkDescriptorImageInfo> imageInfos(_sceneTextures.size());
+		uint32_t numUnbound{ 0 };
+		for (size_t i = 0; i < _sceneTextures.size(); ++i)
 		{
 			VkDescriptorImageInfo& imageInfo = imageInfos[i];
 			imageInfo.imageLayout	= VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 			imageInfo.sampler		= _textureSamplers[i]->getSamplerHandle();
-			imageInfo.imageView		= _textureImageViews[i]->getImageViewHandle();
+			imageInfo.imageView		= VK_NULL_HANDLE;
+
+			const int imageIndex = _sceneTextures[i].imageIndex;
+			if (hasTextureImage(static_cast<int>(i)) && imageIndex < static_cast<int>(_textureImageViews.size()))
+			{
+				imageInfo.imageView = _textureImageViews[imageIndex]->getImageViewHandle();
+			}
+			else
+			{
+				++numUnbound;
+			}
 		}
-		_descriptorSet->updateStorageBuffer({ _matrixBuffer }, 0, 1);
-		_descriptorSet->updateStorageBuffer({ _materialBuffer }, 1, 1);
-		_descriptorSet->updateImage(imageInfos, 2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+		if (numUnbound > 0)
+		{
+			VFS_WARN << numUnbound << " of " << _sceneTextures.size() << " textures have no decodable image and are left unbound";
+		}
+		_bindlessTable->updateTextures(_tableRange, imageInfos);
 	}
 
-	void GLTFScene::cmdDraw(VkCommandBuffer cmdBufferHandle, const PipelineLayoutPtr& pipelineLayout,
-							const uint32_t pushConstOffset)
+	VkSamplerCreateInfo GLTFScene::GetSamplerCreateInfo(const GLTFTexture& texture)
 	{
-		const VkPipelineLayout layoutHandle = pipelineLayout->getLayoutHandle();
-		CommandBuffer cmdBuffer(cmdBufferHandle);
+		VkSamplerCreateInfo samplerInfo = {};
+		samplerInfo.sType			 = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+		samplerInfo.pNext			 = nullptr;
+		samplerInfo.borderColor		 = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+		samplerInfo.anisotropyEnable = VK_TRUE;
+		samplerInfo.maxAnisotropy	 = 1.0f;
+		samplerInfo.compareOp		 = VK_COMPARE_OP_NEVER;
+		samplerInfo.compareEnable	 = VK_FALSE;
+		samplerInfo.mipLodBias		 = 0.0f;
+		samplerInfo.minLod			 = 0.0f;
+		samplerInfo.maxLod			 = VK_LOD_CLAMP_NONE;
+		samplerInfo.magFilter		 = texture.magFilter == TINYGLTF_TEXTURE_FILTER_NEAREST ? VK_FILTER_NEAREST : VK_FILTER_LINEAR;
+
+		switch (texture.minFilter)
+		{
+		case TINYGLTF_TEXTURE_FILTER_NEAREST:
+		case TINYGLTF_TEXTURE_FILTER_LINEAR:
+			// snowapril : filters without mipmap sample only the base level
+			samplerInfo.minFilter	= texture.minFilter == TINYGLTF_TEXTURE_FILTER_NEAREST ? VK_FILTER_NEAREST : VK_FILTER_LINEAR;
+			samplerInfo.mipmapMode	= VK_SAMPLER_MIPMAP_MODE_NEAREST;
+			samplerInfo.maxLod		= 0.25f;
+			break;
+		case TINYGLTF_TEXTURE_FILTER_NEAREST_MIPMAP_NEAREST:
+			samplerInfo.minFilter	= VK_FILTER_NEAREST;
+			samplerInfo.mipmapMode	= VK_SAMPLER_MIPMAP_MODE_NEAREST;
+			break;
+		case TINYGLTF_TEXTURE_FILTER_LINEAR_MIPMAP_NEAREST:
+			samplerInfo.minFilter	= VK_FILTER_LINEAR;
+			samplerInfo.mipmapMode	= VK_SAMPLER_MIPMAP_MODE_NEAREST;
+			break;
+		case TINYGLTF_TEXTURE_FILTER_NEAREST_MIPMAP_LINEAR:
+			samplerInfo.minFilter	= VK_FILTER_NEAREST;
+			samplerInfo.mipmapMode	= VK_SAMPLER_MIPMAP_MODE_LINEAR;
+			break;
+		default:
+			samplerInfo.minFilter	= VK_FILTER_LINEAR;
+			samplerInfo.mipmapMode	= VK_SAMPLER_MIPMAP_MODE_LINEAR;
+			break;
+		}
+
+		auto GetAddressMode = [](int wrap) -> VkSamplerAddressMode {
+			switch (wrap)
+			{
+			case TINYGLTF_TEXTURE_WRAP_CLAMP_TO_EDGE:	return VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+			case TINYGLTF_TEXTURE_WRAP_MIRRORED_REPEAT: return VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT;
+			default:									return VK_SAMPLER_ADDRESS_MODE_REPEAT;
+			}
+		};
+		samplerInfo.addressModeU = GetAddressMode(texture.wrapS);
+		samplerInfo.addressModeV = GetAddressMode(texture.wrapT);
+		samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+		return samplerInfo;
+	}
 
-		std::vector<VkDeviceSize> offsets(_vertexBuffers.size(), 0);
-		cmdBuffer.bindVertexBuffers(_vertexBuffers, offsets);
-		cmdBuffer.bindIndexBuffer(_indexBuffer, 0, VK_INDEX_TYPE_UINT32);
-		cmdBuffer.bindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, layoutHandle, 1, { _descriptorSet }, {});
+	void GLTFScene::cmdDraw(VkCommandBuffer cmdBufferHandle, VkIndexType indexType)
+	{
+		// Indirect commands of one index type are contiguous in the draw range of this scene
+		const uint32_t firstDraw = _tableRange.firstDraw + (indexType == VK_INDEX_TYPE_UINT16 ? 0 : _numDraws16);
+		const uint32_t numDraws	 = indexType == VK_INDEX_TYPE_UINT16 ? _numDraws16 :
+								   static_cast<uint32_t>(_drawCommands.size()) - _numDraws16;
+		if (numDraws == 0)
+		{
+			return;
+		}
 
+		CommandBuffer cmdBuffer(cmdBufferHandle);
 		DebugUtils::ScopedCmdLabel scope = _debugUtil.scopeLabel(cmdBufferHandle, "Scene Rendering");
 
-		uint32_t instanceIndex = 0;
-		uint32_t lastMaterialIndex = UINT32_MAX;
-		for (const GLTFNode& sceneNode : _sceneNodes)
+		// Geometry pool and bindless table are bound by the caller
+		cmdBuffer.drawIndexedIndirect(_bindlessTable->getIndirectBuffer(), firstDraw * sizeof(VkDrawIndexedIndirectCommand),
+									  numDraws, sizeof(VkDrawIndexedIndirectCommand));
+	}
+
+	void GLTFScene::gatherDrawSlots(VkIndexType indexType, std::vector<uint32_t>* drawSlots) const
+	{
+		const uint32_t firstDraw = _tableRange.firstDraw + (indexType == VK_INDEX_TYPE_UINT16 ? 0 : _numDraws16);
+		const uint32_t numDraws	 = indexType == VK_INDEX_TYPE_UINT16 ? _numDraws16 :
+								   static_cast<uint32_t>(_drawCommands.size()) - _numDraws16;
+		for (uint32_t i = 0; i < numDraws; ++i)
 		{
-			for (uint32_t meshIdx : sceneNode.primMeshes)
-			{
-				GLTFPrimMesh& primMesh = _scenePrimMeshes[meshIdx];
-				if (static_cast<uint32_t>(primMesh.materialIndex) != lastMaterialIndex)
-				{
-					lastMaterialIndex = primMesh.materialIndex;
-				}
-		
-				uint32_t pushValues[] = { instanceIndex, lastMaterialIndex };
-				cmdBuffer.pushConstants(layoutHandle, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-					pushConstOffset, sizeof(pushValues), pushValues);
-		
-				cmdBuffer.drawIndexed(primMesh.indexCount, 1, primMesh.firstIndex, primMesh.vertexOffset, 0);
-			}
-			++instanceIndex;
+			drawSlots->push_back(firstDraw + i);
+		}
+	}
+
+	void GLTFScene::gatherDrawSlots(const std::vector<uint32_t>& draws, std::vector<uint32_t>* drawSlots16,
+									std::vector<uint32_t>* drawSlots32) const
+	{
+		for (const uint32_t draw : draws)
+		{
+			std::vector<uint32_t>* drawSlots = draw < _numDraws16 ? drawSlots16 : drawSlots32;
+			drawSlots->push_back(_tableRange.firstDraw + draw);
 		}
 	}
 
@@ -519,6 +964,10 @@ namespace vfs
 			if (bModified)
 			{
 				uploadMatrixBuffer();
+
+				std::vector<BoundingBox<glm::vec3>> drawBoxes;
+				gatherDrawBoxes(&drawBoxes);
+				_drawBVH.refit(drawBoxes);
 			}
 			ImGui::TreePop();
 		}
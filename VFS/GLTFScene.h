@@ -6,7 +6,15 @@
 #include <pch.h>
 #include <Util/GLTFLoader.h>
 #include <VulkanFramework/DebugUtils.h>
+#include <VulkanFramework/Buffers/UploadManager.h>
 #include <BoundingBox.h>
+#include <GeometryPool.h>
+#include <BindlessTable.h>
+#include <BoundingVolumeHierarchy.h>
+#include <Util/VertexQuantizer.h>
+
+struct GltfShadeMaterial;
+struct GltfDrawData;
 
 namespace vfs
 {
@@ -14,44 +22,109 @@ namespace vfs
 	{
 	public:
 		explicit GLTFScene() = default;
-		explicit GLTFScene(DevicePtr device, const char* scenePath, 
-						   const QueuePtr& queue, VertexFormat format);
+		explicit GLTFScene(DevicePtr device, const char* scenePath, const GeometryPoolPtr& geometryPool,
+						   const BindlessTablePtr& bindlessTable, const UploadManagerPtr& uploadManager, VertexFormat format);
 				~GLTFScene();
 
 	public:
-		bool initialize			(DevicePtr device, const char* scenePath, 
-								 const QueuePtr& queue, VertexFormat format);
-		void cmdDraw			(VkCommandBuffer cmdBuffer, const PipelineLayoutPtr& pipelineLayout,
-								 const uint32_t pushConstOffset);
+		bool initialize			(DevicePtr device, const char* scenePath, const GeometryPoolPtr& geometryPool,
+								 const BindlessTablePtr& bindlessTable, const UploadManagerPtr& uploadManager, VertexFormat format);
+		//! CPU side import, creation of GPU resources and allocation of pool and table ranges, safe to run on any thread
+		bool importScene		(DevicePtr device, const char* scenePath, const GeometryPoolPtr& geometryPool,
+								 const BindlessTablePtr& bindlessTable, VertexFormat format);
+		//! Record and submit uploads of the imported scene on the queue of the given upload manager
+		bool uploadScene		(const UploadManagerPtr& uploadManager);
+		//! Barriers moving ownership of all scene resources between queue families,
+		//! recorded as release on the source queue and as acquire on the destination queue
+		void getQueueTransferBarriers(uint32_t srcFamily, uint32_t dstFamily,
+									  std::vector<VkBufferMemoryBarrier>* bufferBarriers,
+									  std::vector<VkImageMemoryBarrier>* imageBarriers) const;
+		//! Draw primitives of the given index type with one indirect draw,
+		//! geometry pool buffers and bindless table must be bound already
+		void cmdDraw			(VkCommandBuffer cmdBuffer, VkIndexType indexType);
+		//! Append draw table slots of primitives with the given index type
+		void gatherDrawSlots	(VkIndexType indexType, std::vector<uint32_t>* drawSlots) const;
+		//! Append draw table slots of the given scene draws, which are primitives of the draw BVH
+		void gatherDrawSlots	(const std::vector<uint32_t>& draws, std::vector<uint32_t>* drawSlots16,
+								 std::vector<uint32_t>* drawSlots32) const;
 		void drawGUI			(void);
-		void allocateDescriptor	(const DescriptorPoolPtr& pool, const DescriptorSetLayoutPtr& layout);
+		//! Write textures of the scene into its bindless table range, called on the render thread
+		void updateTextureDescriptors(void);
 
 		inline BoundingBox<glm::vec3> getSceneBoundingBox(void) const
 		{
 			return BoundingBox<glm::vec3>(_sceneDim.min, _sceneDim.max);
 		}
-		inline DescriptorSetPtr getDescriptorSet(void) const
+		//! World boxes of scene draws, refitted whenever node transforms are edited from GUI
+		inline const BoundingVolumeHierarchy& getDrawBVH(void) const
+		{
+			return _drawBVH;
+		}
+		//! Triangle count of the largest draw, bounds the triangle index of the visibility buffer
+		inline uint32_t getMaxDrawTriangles(void) const
+		{
+			return _maxDrawTriangles;
+		}
+		//! Material and matrix edits from GUI are uploaded through this upload manager
+		inline void setUploadManager(const UploadManagerPtr& uploadManager)
 		{
-			return _descriptorSet;
+			_uploadManager = uploadManager;
 		}
 	private:
-		bool uploadBuffer			(void);
-		bool uploadImage			(void);
+		bool uploadSceneData		(void);
 		bool uploadMaterialBuffer	(void);
 		bool uploadMatrixBuffer		(void);
+		void enqueueTableWriteBarrier(void);
+		void gatherMaterials		(std::vector<GltfShadeMaterial>* materials) const;
+		bool hasTextureImage		(int textureIndex) const;
+		void gatherMatrices			(std::vector<std::pair<glm::mat4, glm::mat4>>* matrices) const;
+		void computeDecodeTransforms(const StreamView<glm::vec3>& positions);
+		void buildDrawCommands		(void);
+		void gatherDrawBoxes		(std::vector<BoundingBox<glm::vec3>>* drawBoxes) const;
+		void gatherIndirectCommands	(std::vector<VkDrawIndexedIndirectCommand>* indirectCommands,
+									 std::vector<GltfDrawData>* drawData) const;
+		void cmdUploadBuffer		(CommandBuffer* cmdBuffer, const UploadManager::Allocation& staging,
+									 uint64_t* stagingOffset);
+		void cmdUploadImage			(CommandBuffer* cmdBuffer, const UploadManager::Allocation& staging,
+									 uint64_t* stagingOffset);
+		void cmdGenerateMipmaps		(CommandBuffer* cmdBuffer, const ImagePtr& imageBuffer,
+									 uint32_t width, uint32_t height, uint32_t mipLevels);
+
+		static VkSamplerCreateInfo GetSamplerCreateInfo(const GLTFTexture& texture);
+
+	private:
+		//! Indexed draw of a primitive, firstIndex is relative to the region of its index type
+		struct DrawCommand
+		{
+			uint32_t	instanceIndex	{ 0 };
+			uint32_t	nodeIndex		{ 0 };
+			uint32_t	primMeshIndex	{ 0 };
+			uint32_t	firstIndex		{ 0 };
+			VkIndexType	indexType		{ VK_INDEX_TYPE_UINT32 };
+		};
 
 	private:
 		std::vector<ImagePtr>		_textureImages;
 		std::vector<ImageViewPtr>	_textureImageViews;
-		std::vector<SamplerPtr>		_textureSamplers;
-		std::vector<BufferPtr>		_vertexBuffers;
-		BufferPtr					_indexBuffer	 {		nullptr		  };
+		std::vector<SamplerPtr>		_textureSamplers;	 // Per texture, shared through the sampler cache
+		SamplerCachePtr				_samplerCache	 {		nullptr		  };
+		GeometryPoolPtr				_geometryPool	 {		nullptr		  };
+		GeometryPool::Allocation	_geometry;			 // Vertex and index ranges of this scene in the pool
+		bool						_bGeometryAllocated { false };
+		BindlessTablePtr			_bindlessTable	 {		nullptr		  };
+		BindlessTable::Allocation	_tableRange;		 // Matrix, material, texture and draw ranges of this scene in the table
+		bool						_bTableAllocated { false };
+		std::vector<VertexQuantizer::DecodeTransform> _decodeTransforms; // Empty unless vertex streams are packed
+		std::vector<DrawCommand>	_drawCommands;		 // 16-bit indexed draws come first, in draw table order
+		uint32_t					_numDraws16		 {			0		  }; // Number of leading 16-bit indexed draws
+		uint32_t					_maxDrawTriangles {			0		  }; // Triangle count of the largest draw command
+		BoundingVolumeHierarchy		_drawBVH;			 // Over world boxes of draw commands, in draw table order
+		std::vector<uint32_t>		_regionFirstIndices; // First index of each primitive in its index region
+		VkDeviceSize				_index32Offset	 {			0		  }; // Byte offset of 32-bit region in the index range
 		DevicePtr					_device			 {		nullptr		  };
-		QueuePtr					_queue			 {		nullptr		  };
+		std::string					_scenePath;
+		UploadManagerPtr			_uploadManager	 {		nullptr		  };
 		VertexFormat				_format			 { VertexFormat::None };
-		BufferPtr					_materialBuffer	 {		nullptr		  };
-		BufferPtr					_matrixBuffer	 {		nullptr		  };
-		DescriptorSetPtr			_descriptorSet	 {		nullptr		  };
 		DebugUtils					_debugUtil;
 	};
 }
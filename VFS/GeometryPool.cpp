@@ -0,0 +1,171 @@
+// Author : Jihong Shin (snowapril)
+
+#include <pch.h>
+#include <GeometryPool.h>
+#include <Common/Logger.h>
+#include <VulkanFramework/Device.h>
+#include <VulkanFramework/DebugUtils.h>
+#include <VulkanFramework/Buffers/Buffer.h>
+#include <VulkanFramework/Commands/CommandBuffer.h>
+#include <imgui/imgui.h>
+
+namespace vfs
+{
+	namespace
+	{
+		constexpr VertexFormat kStreamFormats[GeometryPool::kNumVertexStreams] = {
+			VertexFormat::Position3, VertexFormat::Normal3, VertexFormat::TexCoord2, VertexFormat::Tangent4
+		};
+		constexpr const char* kStreamNames[GeometryPool::kNumVertexStreams] = {
+			"Geometry Pool(Position)", "Geometry Pool(Normal)", "Geometry Pool(TexCoord)", "Geometry Pool(Tangent)"
+		};
+	}
+
+	GeometryPool::GeometryPool(DevicePtr device, VertexFormat format, uint32_t maxNumVertices, uint64_t indexArenaSize)
+	{
+		assert(initialize(device, format, maxNumVertices, indexArenaSize));
+	}
+
+	GeometryPool::~GeometryPool()
+	{
+		destroyGeometryPool();
+	}
+
+	void GeometryPool::destroyGeometryPool(void)
+	{
+		for (BufferPtr& vertexBuffer : _vertexBuffers)
+		{
+			vertexBuffer.reset();
+		}
+		_indexBuffer.reset();
+		_vertexArena.reset(0);
+		_indexArena.reset(0);
+		_device.reset();
+	}
+
+	bool GeometryPool::initialize(DevicePtr device, VertexFormat format, uint32_t maxNumVertices, uint64_t indexArenaSize)
+	{
+		_device = device;
+		DebugUtils debugUtil(_device);
+
+		const VertexFormat packing = format & VertexFormat::Quantized;
+		for (uint32_t stream = 0; stream < kNumVertexStreams; ++stream)
+		{
+			if (!static_cast<bool>(format & kStreamFormats[stream]))
+			{
+				continue;
+			}
+
+			_vertexStrides[stream] = VertexHelper::GetNumBytes(kStreamFormats[stream] | packing);
+			_vertexBuffers[stream] = std::make_shared<Buffer>(_device->getMemoryAllocator(),
+															  static_cast<uint64_t>(maxNumVertices) * _vertexStrides[stream],
+															  VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+															  VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+															  VMA_MEMORY_USAGE_GPU_ONLY);
+			debugUtil.setObjectName(_vertexBuffers[stream]->getBufferHandle(), kStreamNames[stream]);
+		}
+
+		_indexBuffer = std::make_shared<Buffer>(_device->getMemoryAllocator(), indexArenaSize,
+												VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+												VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+												VMA_MEMORY_USAGE_GPU_ONLY);
+		debugUtil.setObjectName(_indexBuffer->getBufferHandle(), "Geometry Pool(Index)");
+
+		_vertexArena.reset(maxNumVertices);
+		_indexArena.reset(indexArenaSize);
+		return true;
+	}
+
+	bool GeometryPool::allocate(uint32_t vertexCount, uint64_t indexSize, Allocation* allocation)
+	{
+		std::lock_guard<std::mutex> lock(_arenaMutex);
+
+		// snowapril : empty ranges are not tracked by the arenas
+		uint64_t baseVertex{ 0 }, indexOffset{ 0 };
+		if (vertexCount > 0 && !_vertexArena.allocate(vertexCount, 1, &baseVertex))
+		{
+			VFS_ERROR << "Geometry pool has no free range of " << vertexCount << " vertices";
+			return false;
+		}
+		if (indexSize > 0 && !_indexArena.allocate(indexSize, kIndexAlignment, &indexOffset))
+		{
+			VFS_ERROR << "Geometry pool has no free range of " << indexSize << " index bytes";
+			if (vertexCount > 0)
+			{
+				_vertexArena.free(baseVertex, vertexCount);
+			}
+			return false;
+		}
+
+		allocation->baseVertex	= static_cast<uint32_t>(baseVertex);
+		allocation->vertexCount = vertexCount;
+		allocation->indexOffset = indexOffset;
+		allocation->indexSize	= indexSize;
+		return true;
+	}
+
+	void GeometryPool::free(const Allocation& allocation)
+	{
+		std::lock_guard<std::mutex> lock(_arenaMutex);
+		if (allocation.vertexCount > 0)
+		{
+			_vertexArena.free(allocation.baseVertex, allocation.vertexCount);
+		}
+		if (allocation.indexSize > 0)
+		{
+			_indexArena.free(allocation.indexOffset, allocation.indexSize);
+		}
+	}
+
+	void GeometryPool::cmdBindVertexBuffers(CommandBuffer* cmdBuffer) const
+	{
+		std::vector<BufferPtr> vertexBuffers;
+		for (const BufferPtr& vertexBuffer : _vertexBuffers)
+		{
+			if (vertexBuffer != nullptr)
+			{
+				vertexBuffers.push_back(vertexBuffer);
+			}
+		}
+		cmdBuffer->bindVertexBuffers(vertexBuffers, std::vector<VkDeviceSize>(vertexBuffers.size(), 0));
+	}
+
+	void GeometryPool::drawGUI(void)
+	{
+		std::lock_guard<std::mutex> lock(_arenaMutex);
+		const float vertexUsage = _vertexArena.getCapacity() > 0 ?
+			static_cast<float>(_vertexArena.getUsedSize()) / _vertexArena.getCapacity() : 0.0f;
+		const float indexUsage = _indexArena.getCapacity() > 0 ?
+			static_cast<float>(_indexArena.getUsedSize()) / _indexArena.getCapacity() : 0.0f;
+		ImGui::Text("Vertices : %llu / %llu", _vertexArena.getUsedSize(), _vertexArena.getCapacity());
+		ImGui::ProgressBar(vertexUsage);
+		ImGui::Text("Index Bytes : %llu / %llu", _indexArena.getUsedSize(), _indexArena.getCapacity());
+		ImGui::ProgressBar(indexUsage);
+	}
+
+	void GeometryPool::getQueueTransferBarriers(const Allocation& allocation, uint32_t srcFamily, uint32_t dstFamily,
+												std::vector<VkBufferMemoryBarrier>* bufferBarriers) const
+	{
+		for (uint32_t stream = 0; stream < kNumVertexStreams; ++stream)
+		{
+			if (_vertexBuffers[stream] != nullptr && allocation.vertexCount > 0)
+			{
+				VkBufferMemoryBarrier barrier = _vertexBuffers[stream]->generateMemoryBarrier(VK_ACCESS_TRANSFER_WRITE_BIT,
+																							  VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT,
+																							  srcFamily, dstFamily);
+				barrier.offset	= static_cast<VkDeviceSize>(allocation.baseVertex)	* _vertexStrides[stream];
+				barrier.size	= static_cast<VkDeviceSize>(allocation.vertexCount) * _vertexStrides[stream];
+				bufferBarriers->push_back(barrier);
+			}
+		}
+
+		if (allocation.indexSize > 0)
+		{
+			VkBufferMemoryBarrier barrier = _indexBuffer->generateMemoryBarrier(VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_INDEX_READ_BIT,
+																				srcFamily, dstFamily);
+			barrier.offset	= allocation.indexOffset;
+			barrier.size	= allocation.indexSize;
+			bufferBarriers->push_back(barrier);
+		}
+	}
+}
@@ -0,0 +1,77 @@
+// Author : Jihong Shin (snowapril)
+
+#if !defined(VFS_GEOMETRY_POOL_H)
+#define VFS_GEOMETRY_POOL_H
+
+#include <pch.h>
+#include <Common/VertexFormat.h>
+#include <Util/RangeAllocator.h>
+#include <mutex>
+
+namespace vfs
+{
+	//! Device local vertex and index arenas shared by every scene. Each vertex stream
+	//! of the given format lives in one buffer of fixed capacity, so all scenes are drawn
+	//! after binding these buffers once. Scenes suballocate a range of vertices and index
+	//! bytes, and draw with base vertex and first index pointing into their ranges.
+	//! 16-bit and 32-bit indices share the index arena, ranges are aligned to 4 bytes
+	//! so that first index of either type is a whole number.
+	class GeometryPool : NonCopyable
+	{
+	public:
+		explicit GeometryPool() = default;
+		explicit GeometryPool(DevicePtr device, VertexFormat format, uint32_t maxNumVertices, uint64_t indexArenaSize);
+				~GeometryPool();
+
+		static constexpr uint32_t kNumVertexStreams = 4;
+		static constexpr uint64_t kIndexAlignment	= sizeof(uint32_t);
+
+		struct Allocation
+		{
+			uint32_t baseVertex	 { 0 };
+			uint32_t vertexCount { 0 };
+			uint64_t indexOffset { 0 }; // Byte offset in the index arena
+			uint64_t indexSize	 { 0 };
+		};
+
+	public:
+		void destroyGeometryPool(void);
+		bool initialize			(DevicePtr device, VertexFormat format, uint32_t maxNumVertices, uint64_t indexArenaSize);
+		//! Thread safe, scenes allocate their ranges while being imported on the loader thread
+		bool allocate			(uint32_t vertexCount, uint64_t indexSize, Allocation* allocation);
+		//! Ranges must not be used by GPU anymore when freed
+		void free				(const Allocation& allocation);
+		void cmdBindVertexBuffers(CommandBuffer* cmdBuffer) const;
+		void drawGUI			(void);
+		//! Ranged barriers covering the given allocation in every arena
+		void getQueueTransferBarriers(const Allocation& allocation, uint32_t srcFamily, uint32_t dstFamily,
+									  std::vector<VkBufferMemoryBarrier>* bufferBarriers) const;
+
+		//! Returns nullptr if the stream is not part of the pool format
+		inline BufferPtr getVertexBuffer(uint32_t stream) const
+		{
+			assert(stream < kNumVertexStreams);
+			return _vertexBuffers[stream];
+		}
+		inline uint32_t getVertexStride(uint32_t stream) const
+		{
+			assert(stream < kNumVertexStreams);
+			return _vertexStrides[stream];
+		}
+		inline BufferPtr getIndexBuffer(void) const
+		{
+			return _indexBuffer;
+		}
+
+	private:
+		DevicePtr			_device			{ nullptr };
+		BufferPtr			_vertexBuffers	[kNumVertexStreams];	// Position, Normal, TexCoord, Tangent
+		uint32_t			_vertexStrides	[kNumVertexStreams] = {};
+		BufferPtr			_indexBuffer	{ nullptr };
+		RangeAllocator		_vertexArena;	// In vertices
+		RangeAllocator		_indexArena;	// In bytes
+		mutable std::mutex	_arenaMutex;
+	};
+}
+
+#endif
@@ -1,16 +1,21 @@
 // Author : Jihong Shin (snowapril)
 
 #include <pch.h>
+#include <Util/EngineConfig.h>
 #include <LoaderThread.h>
 #include <VulkanFramework/Device.h>
 #include <VulkanFramework/Queue.h>
 #include <VulkanFramework/Commands/CommandPool.h>
 #include <VulkanFramework/Commands/CommandBuffer.h>
+#include <VulkanFramework/Buffers/UploadManager.h>
 #include <VulkanFramework/QueryPool.h>
 #include <VulkanFramework/Sync/Fence.h>
+#include <VulkanFramework/Sync/SubmissionScheduler.h>
 #include <RenderPass/Octree/SparseVoxelizer.h>
 #include <RenderPass/Octree/OctreeBuilder.h>
 #include <GLTFScene.h>
+#include <GeometryPool.h>
+#include <BindlessTable.h>
 
 namespace vfs
 {
@@ -64,14 +69,28 @@ namespace vfs
         vfs::CommandPoolPtr loaderCmdPool = std::make_shared<vfs::CommandPool>(_device, _loaderQueue,
             VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
     
-        std::shared_ptr<vfs::GLTFScene> scene = std::make_shared<vfs::GLTFScene>(_device, scenePath, _loaderQueue, 
-                                                                 vfs::VertexFormat::Position3Normal3TexCoord2Tangent4);
+        vfs::SubmissionSchedulerPtr loaderScheduler = std::make_shared<vfs::SubmissionScheduler>(_loaderQueue);
+        vfs::UploadManagerPtr loaderUploadManager = std::make_shared<vfs::UploadManager>(_device, loaderScheduler, 
+                                                                                           vfs::DEFAULT_UPLOAD_RING_SIZE);
+    
+        const vfs::VertexFormat sceneFormat = vfs::VertexFormat::Position3Normal3TexCoord2Tangent4 |
+            (vfs::DEFAULT_PACKED_VERTEX_FORMAT ? vfs::VertexFormat::Quantized : vfs::VertexFormat::None);
+        vfs::GeometryPoolPtr geometryPool = std::make_shared<vfs::GeometryPool>(_device, sceneFormat, vfs::DEFAULT_GEOMETRY_POOL_VERTICES,
+                                                                                vfs::DEFAULT_GEOMETRY_POOL_INDEX_SIZE);
+        vfs::BindlessTablePtr bindlessTable = std::make_shared<vfs::BindlessTable>(_device, vfs::DEFAULT_BINDLESS_MATRICES,
+                                                                                   vfs::DEFAULT_BINDLESS_MATERIALS,
+                                                                                   vfs::DEFAULT_BINDLESS_TEXTURES,
+                                                                                   vfs::DEFAULT_BINDLESS_DRAWS);
+        std::shared_ptr<vfs::GLTFScene> scene = std::make_shared<vfs::GLTFScene>(_device, scenePath, geometryPool, bindlessTable,
+                                                                                 loaderUploadManager, sceneFormat);
+        // snowapril : scene is consumed on other queue, so its upload must be completed here
+        loaderUploadManager->flush();
     
         // TODO(snowapril) : replace below nullptr to valid light
         // std::shared_ptr<vfs::SparseVoxelizer> voxelizer = std::make_shared<vfs::SparseVoxelizer>(_device, scene, nullptr, _octreeLevel);
-        // voxelizer->preVoxelize(loaderCmdPool);
+        // voxelizer->preVoxelize(loaderCmdPool, loaderUploadManager);
         // 
-        // std::shared_ptr<vfs::OctreeBuilder> builder = std::make_shared<vfs::OctreeBuilder>(_device, loaderCmdPool, voxelizer);
+        // std::shared_ptr<vfs::OctreeBuilder> builder = std::make_shared<vfs::OctreeBuilder>(_device, loaderUploadManager, voxelizer);
         // 
         // vfs::QueryPool profiler(_device, 4);
         // {
@@ -18,6 +18,7 @@
 #include <VulkanFramework/Sync/Fence.h>
 #include <VulkanFramework/Queue.h>
 #include <VulkanFramework/Buffers/Buffer.h>
+#include <VulkanFramework/Buffers/UploadManager.h>
 
 namespace vfs
 {
@@ -47,7 +48,7 @@ namespace vfs
 	BorderWrapper& BorderWrapper::createDescriptors(const ImageView* opacityImageView,
 													const ImageView* radianceImageView,
 													const Sampler* clipmapSampler,
-													const CommandPoolPtr& cmdPool)
+													const UploadManagerPtr& uploadManager)
 	{
 		std::vector<VkDescriptorPoolSize> poolSizes = {
 			{VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,  1},
@@ -72,17 +73,7 @@ namespace vfs
 		borderWrappingDesc.faceCount = DEFAULT_VOXEL_FACE_COUNT;
 		borderWrappingDesc.clipRegionCount = DEFAULT_CLIP_REGION_COUNT;
 
-		Buffer stagingBuffer(_device->getMemoryAllocator(), sizeof(BorderWrappingDesc),
-			VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY);
-		stagingBuffer.uploadData(&borderWrappingDesc, sizeof(BorderWrappingDesc));
-
-		cmdPool->submitOnce([&](CommandBuffer cmdBuffer) {
-			VkBufferCopy copyRegion = {};
-			copyRegion.size = sizeof(BorderWrappingDesc);
-			copyRegion.srcOffset = 0;
-			copyRegion.dstOffset = 0;
-			cmdBuffer.copyBuffer(&stagingBuffer, _borderWrappingDescBuffer, { copyRegion });
-		});
+		uploadManager->uploadBuffer(_borderWrappingDescBuffer, &borderWrappingDesc, sizeof(BorderWrappingDesc), 0);
 
 		_opacityDescSet->updateUniformBuffer({ _borderWrappingDescBuffer }, 1, 1);
 		_radianceDescSet->updateUniformBuffer({ _borderWrappingDescBuffer }, 1, 1);
@@ -20,7 +20,7 @@ namespace vfs
 		BorderWrapper&	createDescriptors		(const ImageView* opacityImageView,
 												 const ImageView* radianceImageView,
 												 const Sampler* clipmapSampler,
-												 const CommandPoolPtr& cmdPool);
+												 const UploadManagerPtr& uploadManager);
 		BorderWrapper&	createPipeline			(void);
 		void			destroyBorderWrapper	(void);
 
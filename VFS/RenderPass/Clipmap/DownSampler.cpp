@@ -15,7 +15,7 @@
 #include <VulkanFramework/Images/Sampler.h>
 #include <VulkanFramework/Sync/Fence.h>
 #include <VulkanFramework/Queue.h>
-#include <VulkanFramework/Buffers/Buffer.h>
+#include <VulkanFramework/Buffers/FrameUniformAllocator.h>
 
 namespace vfs
 {
@@ -32,12 +32,9 @@ namespace vfs
 
 	void DownSampler::destroyDownSampler(void)
 	{
-		for (uint32_t i = 0; i < DEFAULT_CLIP_REGION_COUNT - 1; ++i)
-		{
-			_opacityDownSampleDescSet[i].reset();
-			_radianceDownSampleDescSet[i].reset();
-			_downSampleDescBuffer[i].reset();
-		}
+		_opacityDownSampleDescSet.reset();
+		_radianceDownSampleDescSet.reset();
+		_uniformAllocator.reset();
 		_opacityDownSamplePipeline.reset();
 		_radianceDownSamplePipeline.reset();
 		_pipelineLayout.reset();
@@ -48,17 +45,20 @@ namespace vfs
 
 	DownSampler& DownSampler::createDescriptors(const ImageView* opacityImageView, 
 												const ImageView* radianceImageView, 
-												const Sampler* clipmapSampler)
+												const Sampler* clipmapSampler,
+												const FrameUniformAllocatorPtr& uniformAllocator)
 	{
+		_uniformAllocator = uniformAllocator;
+
 		std::vector<VkDescriptorPoolSize> poolSizes = {
-			{VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,  1},
-			{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1},
+			{VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,			2},
+			{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 2},
 		};
-		_descPool = std::make_shared<DescriptorPool>(_device, poolSizes, 2 * (DEFAULT_CLIP_REGION_COUNT - 1), 0);
+		_descPool = std::make_shared<DescriptorPool>(_device, poolSizes, 2, 0);
 
 		_descLayout = std::make_shared<DescriptorSetLayout>(_device);
 		_descLayout->addBinding(VK_SHADER_STAGE_COMPUTE_BIT, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,  0);
-		_descLayout->addBinding(VK_SHADER_STAGE_COMPUTE_BIT, 1, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 0);
+		_descLayout->addBinding(VK_SHADER_STAGE_COMPUTE_BIT, 1, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 0);
 		_descLayout->createDescriptorSetLayout(0);
 
 		VkDescriptorImageInfo opacityImageInfo = {};
@@ -71,20 +71,16 @@ namespace vfs
 		radianceImageInfo.sampler		= clipmapSampler->getSamplerHandle();
 		radianceImageInfo.imageLayout	= VK_IMAGE_LAYOUT_GENERAL;
 
-		for (uint32_t i = 0; i < DEFAULT_CLIP_REGION_COUNT - 1; ++i)
-		{
-			_downSampleDescBuffer[i] = std::make_shared<Buffer>(_device->getMemoryAllocator(), sizeof(DownSampleDesc),
-				VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
-
-			_opacityDownSampleDescSet[i]  = std::make_shared<DescriptorSet>(_device, _descPool, _descLayout, 1);
-			_radianceDownSampleDescSet[i] = std::make_shared<DescriptorSet>(_device, _descPool, _descLayout, 1);
+		// snowapril : every clip level shares one set per mode, per-dispatch parameters are
+		//			   fed through dynamic offsets into the frame uniform buffer
+		_opacityDownSampleDescSet  = std::make_shared<DescriptorSet>(_device, _descPool, _descLayout, 1);
+		_radianceDownSampleDescSet = std::make_shared<DescriptorSet>(_device, _descPool, _descLayout, 1);
 
-			_opacityDownSampleDescSet[i]->updateUniformBuffer({ _downSampleDescBuffer[i] }, 1, 1);
-			_radianceDownSampleDescSet[i]->updateUniformBuffer({ _downSampleDescBuffer[i] }, 1, 1);
+		_opacityDownSampleDescSet->updateDynamicUniformBuffer(_uniformAllocator->getBuffer(), sizeof(DownSampleDesc), 1);
+		_radianceDownSampleDescSet->updateDynamicUniformBuffer(_uniformAllocator->getBuffer(), sizeof(DownSampleDesc), 1);
 
-			_opacityDownSampleDescSet[i]->updateImage({ opacityImageInfo }, 0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE);
-			_radianceDownSampleDescSet[i]->updateImage({ radianceImageInfo }, 0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE);
-		}
+		_opacityDownSampleDescSet->updateImage({ opacityImageInfo }, 0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE);
+		_radianceDownSampleDescSet->updateImage({ radianceImageInfo }, 0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE);
 		
 		return *this;
 	}
@@ -123,7 +119,11 @@ namespace vfs
 		downSampleDesc.clipLevel			= clipLevel;
 		downSampleDesc.clipmapResolution	= DEFAULT_VOXEL_RESOLUTION;
 		downSampleDesc.downSampleRegionSize = DEFAULT_DOWNSAMPLE_REGION_SIZE;
-		_downSampleDescBuffer[clipLevel - 1]->uploadData(&downSampleDesc, sizeof(DownSampleDesc));
+		const uint32_t descOffset = _uniformAllocator->allocate(&downSampleDesc, sizeof(DownSampleDesc));
+		if (descOffset == FrameUniformAllocator::kInvalidOffset)
+		{
+			return;
+		}
 
 		VkImageMemoryBarrier imageBarrier = image->generateMemoryBarrier(
 			VK_ACCESS_SHADER_WRITE_BIT,
@@ -139,15 +139,13 @@ namespace vfs
 		{
 		case DownSampleMode::OpacityMode:
 			cmdBuffer.bindPipeline(_opacityDownSamplePipeline);
-			_opacityDownSampleDescSet[clipLevel - 1]->updateUniformBuffer({ _downSampleDescBuffer[clipLevel - 1] }, 1, 1);
 			cmdBuffer.bindDescriptorSets(VK_PIPELINE_BIND_POINT_COMPUTE, _pipelineLayout->getLayoutHandle(),
-										 0, { _opacityDownSampleDescSet[clipLevel - 1] }, {});
+										 0, { _opacityDownSampleDescSet }, { descOffset });
 			break;
 		case DownSampleMode::RadianceMode:
 			cmdBuffer.bindPipeline(_radianceDownSamplePipeline);
-			_radianceDownSampleDescSet[clipLevel - 1]->updateUniformBuffer({ _downSampleDescBuffer[clipLevel - 1] }, 1, 1);
 			cmdBuffer.bindDescriptorSets(VK_PIPELINE_BIND_POINT_COMPUTE, _pipelineLayout->getLayoutHandle(),
-										 0, { _radianceDownSampleDescSet[clipLevel - 1] }, {});
+										 0, { _radianceDownSampleDescSet }, { descOffset });
 			break;
 		default:
 			assert(mode >= DownSampleMode::Last);
@@ -22,7 +22,8 @@ namespace vfs
 	public:
 		DownSampler& createDescriptors		(const ImageView* opacityImageView, 
 											 const ImageView* radianceImageView, 
-											 const Sampler* sampler);
+											 const Sampler* sampler,
+											 const FrameUniformAllocatorPtr& uniformAllocator);
 		DownSampler& createPipeline			(void);
 		void		 destroyDownSampler		(void);
 
@@ -65,9 +66,9 @@ namespace vfs
 		PipelineLayoutPtr			_pipelineLayout				{ nullptr };
 		ComputePipelinePtr			_opacityDownSamplePipeline	{ nullptr };
 		ComputePipelinePtr			_radianceDownSamplePipeline	{ nullptr };
-		std::array<BufferPtr,			DEFAULT_CLIP_REGION_COUNT - 1> _downSampleDescBuffer		{ nullptr };
-		std::array<DescriptorSetPtr,	DEFAULT_CLIP_REGION_COUNT - 1> _opacityDownSampleDescSet	{ nullptr };
-		std::array<DescriptorSetPtr,	DEFAULT_CLIP_REGION_COUNT - 1> _radianceDownSampleDescSet	{ nullptr };
+		FrameUniformAllocatorPtr	_uniformAllocator			{ nullptr };
+		DescriptorSetPtr			_opacityDownSampleDescSet	{ nullptr };
+		DescriptorSetPtr			_radianceDownSampleDescSet	{ nullptr };
 	};
 };
 
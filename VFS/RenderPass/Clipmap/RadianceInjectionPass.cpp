@@ -26,6 +26,7 @@
 #include <RenderPass/Clipmap/DownSampler.h>
 #include <DirectionalLight.h>
 #include <SceneManager.h>
+#include <RenderPass/DrawCuller.h>
 
 namespace vfs
 {
@@ -86,6 +87,24 @@ namespace vfs
 													VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL) }
 		);
 
+		// Clip levels updated in this frame draw only primitives overlapping their region
+		{
+			const std::array<ClipmapRegion, DEFAULT_CLIP_REGION_COUNT>* clipmapRegions = _renderPassManager->get<std::array<ClipmapRegion, DEFAULT_CLIP_REGION_COUNT>>("ClipmapRegions");
+			std::vector<DrawCuller::CullView> cullViews;
+			for (uint32_t clipLevel = 0; clipLevel < DEFAULT_CLIP_REGION_COUNT; ++clipLevel)
+			{
+				if (_frameIndex % kUpdateRegionLevelOffsets[clipLevel] == 0)
+				{
+					cullViews.push_back(DrawCuller::FromClipmapRegion(clipmapRegions->at(clipLevel)));
+				}
+			}
+			if (cullViews.empty() == false)
+			{
+				DrawCuller* drawCuller = _renderPassManager->get<DrawCuller>("DrawCuller");
+				_firstCullView = drawCuller->cmdCull(cmdBuffer, cullViews, "Radiance Injection");
+			}
+		}
+
 		_voxelizer->beginRenderPass(frameLayout);
 	}
 
@@ -141,18 +160,24 @@ namespace vfs
 
 			cmdBuffer.bindPipeline(_pipeline);
 			cmdBuffer.bindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelineLayout->getLayoutHandle(), 2, {	_descriptorSet	  }, {});
-			cmdBuffer.bindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelineLayout->getLayoutHandle(), 4, { _lightDescriptorSet}, {});
+			const DirectionalLight* dirLight = _renderPassManager->get<DirectionalLight>("DirectionalLight");
+			cmdBuffer.bindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelineLayout->getLayoutHandle(), 4, { _lightDescriptorSet},
+										 { dirLight->getLightDescOffset(), dirLight->getViewProjectionOffset() });
 
 			const std::array<ClipmapRegion, DEFAULT_CLIP_REGION_COUNT>* clipmapRegions = _renderPassManager->get<std::array<ClipmapRegion, DEFAULT_CLIP_REGION_COUNT>>("ClipmapRegions");
-			SceneManager* sceneManager = _renderPassManager->get<SceneManager>("SceneManager");
+			DrawCuller* drawCuller = _renderPassManager->get<DrawCuller>("DrawCuller");
 
+			uint32_t cullView = _firstCullView;
 			for (uint32_t clipLevel = 0; clipLevel < DEFAULT_CLIP_REGION_COUNT; ++clipLevel)
 			{
 				if (_frameIndex % kUpdateRegionLevelOffsets[clipLevel] == 0)
 				{
-					cmdBuffer.bindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelineLayout->getLayoutHandle(), 3, { _voxelizer->getVoxelDescSet(clipLevel) }, {});
-					_voxelizer->cmdVoxelize(cmdBuffer.getHandle(), clipmapRegions->at(clipLevel), clipLevel);
-					sceneManager->cmdDraw(cmdBuffer.getHandle(), _pipelineLayout, 0);
+					if (_voxelizer->cmdVoxelize(cmdBuffer.getHandle(), _pipelineLayout->getLayoutHandle(), 3,
+												clipmapRegions->at(clipLevel), clipLevel))
+					{
+						drawCuller->cmdDraw(cmdBuffer.getHandle(), _pipelineLayout, cullView);
+					}
+					cullView = cullView == DrawCuller::kNoCulling ? cullView : cullView + 1;
 				}
 			}
 		}
@@ -200,7 +225,7 @@ namespace vfs
 		// Descriptors for directional lights
 		poolSizes = {
 			{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1 },
-			{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2 },
+			{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 2 },
 		};
 		_lightDescriptorPool = std::make_shared<DescriptorPool>(_device, poolSizes, 1, 0);
 
@@ -209,8 +234,8 @@ namespace vfs
 		_lightDescriptorLayout->addBinding(VK_SHADER_STAGE_FRAGMENT_BIT, 1, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 0);
 		_lightDescriptorLayout->addBinding(VK_SHADER_STAGE_FRAGMENT_BIT, 2, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 0);
 		_lightDescriptorLayout->addBinding(VK_SHADER_STAGE_FRAGMENT_BIT, 3, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 0);
-		_lightDescriptorLayout->addBinding(VK_SHADER_STAGE_FRAGMENT_BIT, 4, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,		  0);
-		_lightDescriptorLayout->addBinding(VK_SHADER_STAGE_FRAGMENT_BIT, 5, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,		  0);
+		_lightDescriptorLayout->addBinding(VK_SHADER_STAGE_FRAGMENT_BIT, 4, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 0);
+		_lightDescriptorLayout->addBinding(VK_SHADER_STAGE_FRAGMENT_BIT, 5, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 0);
 		_lightDescriptorLayout->createDescriptorSetLayout(0);
 
 		_lightDescriptorSet = std::make_shared<DescriptorSet>(_device, _lightDescriptorPool, _lightDescriptorLayout, 1);
@@ -232,8 +257,8 @@ namespace vfs
 		imageInfo.imageLayout	= VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
 		_lightDescriptorSet->updateImage({ imageInfo }, 3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
 
-		_lightDescriptorSet->updateUniformBuffer({ dirLight->getLightDescBuffer() }, 4, 1);
-		_lightDescriptorSet->updateUniformBuffer({ dirLight->getViewProjectionBuffer() }, 5, 1);
+		_lightDescriptorSet->updateDynamicUniformBuffer(dirLight->getLightDescBuffer(), dirLight->getLightDescRange(), 4);
+		_lightDescriptorSet->updateDynamicUniformBuffer(dirLight->getViewProjectionBuffer(), dirLight->getViewProjectionRange(), 5);
 		return *this;
 	}
 	
@@ -246,7 +271,7 @@ namespace vfs
 		_pipelineLayout->initialize(
 			_device, 
 			{ globalDescLayout, sceneManager->getDescriptorLayout(), _descriptorLayout, _voxelizer->getVoxelDescLayout(), _lightDescriptorLayout },
-			{ sceneManager->getDefaultPushConstant() }
+			{}
 		);
 
 		PipelineConfig config;
@@ -286,7 +311,7 @@ namespace vfs
 		config.colorBlendInfo.pAttachments			= &colorBlendAttachment;
 
 		_pipeline = std::make_shared<GraphicsPipeline>(_device);
-		_pipeline->attachShaderModule(VK_SHADER_STAGE_VERTEX_BIT,	"Shaders/msaaInjectRadiance.vert.spv", nullptr);
+		_pipeline->attachShaderModule(VK_SHADER_STAGE_VERTEX_BIT,	"Shaders/msaaInjectRadiance.vert.spv", sceneManager->getVertexSpecializationInfo());
 		_pipeline->attachShaderModule(VK_SHADER_STAGE_GEOMETRY_BIT, "Shaders/msaaInjectRadiance.geom.spv", nullptr);
 		_pipeline->attachShaderModule(VK_SHADER_STAGE_FRAGMENT_BIT, "Shaders/msaaInjectRadiance.frag.spv", nullptr);
 		_pipeline->createPipeline(&config);
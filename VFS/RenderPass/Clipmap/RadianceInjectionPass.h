@@ -47,6 +47,7 @@ namespace vfs
 		SamplerPtr				_shadowSampler;
 		uint32_t				_voxelResolution;
 		uint32_t				_frameIndex{ 0 };
+		uint32_t				_firstCullView{ 0 };
 	};
 };
 
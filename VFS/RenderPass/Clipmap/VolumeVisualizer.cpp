@@ -5,6 +5,7 @@
 #include <Camera.h>
 #include <VulkanFramework/Device.h>
 #include <VulkanFramework/Buffers/Buffer.h>
+#include <VulkanFramework/Buffers/UploadManager.h>
 #include <VulkanFramework/Descriptors/DescriptorPool.h>
 #include <VulkanFramework/Descriptors/DescriptorSetLayout.h>
 #include <VulkanFramework/Descriptors/DescriptorSet.h>
@@ -28,7 +29,7 @@ namespace vfs
 		// Do nothing
 	}
 
-	VolumeVisualizer& VolumeVisualizer::buildPointClouds(const CommandPoolPtr& cmdPool, uint32_t resolution)
+	VolumeVisualizer& VolumeVisualizer::buildPointClouds(const UploadManagerPtr& uploadManager, uint32_t resolution)
 	{
 		_pointClouds.reserve(resolution * resolution * resolution);
 		for (uint32_t i = 0; i < resolution; ++i)
@@ -56,27 +57,8 @@ namespace vfs
 			VMA_MEMORY_USAGE_GPU_ONLY
 		);
 
-		Buffer stagingBuffer(allocator, sizeof(glm::vec3) * _pointClouds.size(),
-							 VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY);
-		stagingBuffer.uploadData(_pointClouds.data(), sizeof(glm::vec3) * _pointClouds.size());
-
-		CommandBuffer cmdBuffer(cmdPool->allocateCommandBuffer());
-		{
-			cmdBuffer.beginRecord(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
-
-			VkBufferCopy copyRegion = {};
-			copyRegion.size = sizeof(glm::vec3) * _pointClouds.size();
-			copyRegion.srcOffset = 0;
-			copyRegion.dstOffset = 0;
-			cmdBuffer.copyBuffer(&stagingBuffer, _volumePointCloudBuffer, { copyRegion });
-
-			cmdBuffer.endRecord();
-		}
-
-		Fence fence(_device, 1, 0);
-		cmdPool->getQueue()->submitCmdBuffer({ cmdBuffer }, &fence);
-
-		fence.waitForAllFences(UINT64_MAX);
+		// snowapril : point clouds are copied into staging memory here, safe to clear right after
+		uploadManager->uploadBuffer(_volumePointCloudBuffer, _pointClouds.data(), sizeof(glm::vec3) * _pointClouds.size(), 0);
 
 		_numPoints = static_cast<uint32_t>(_pointClouds.size());
 		_pointClouds.clear();
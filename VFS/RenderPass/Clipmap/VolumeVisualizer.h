@@ -18,7 +18,7 @@ namespace vfs
 				~VolumeVisualizer() = default;
 
 	public:
-		VolumeVisualizer& buildPointClouds		(const CommandPoolPtr& cmdPool, uint32_t resolution);
+		VolumeVisualizer& buildPointClouds		(const UploadManagerPtr& uploadManager, uint32_t resolution);
 		VolumeVisualizer& createDescriptorSet	(ImageViewPtr tagetImageView, SamplerPtr targetSampler);
 		VolumeVisualizer& createPipelines		(VkRenderPass renderPass);
 
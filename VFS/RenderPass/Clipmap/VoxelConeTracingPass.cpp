@@ -80,7 +80,9 @@ namespace vfs
 		cmdBuffer.bindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelineLayout->getLayoutHandle(), 0, { frameLayout->globalDescSet }, {});
 		cmdBuffer.bindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelineLayout->getLayoutHandle(), 1, {		_gbufferDescriptorSet }, {});
 		cmdBuffer.bindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelineLayout->getLayoutHandle(), 2, {			   _descriptorSet }, {});
-		cmdBuffer.bindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelineLayout->getLayoutHandle(), 3, {		   _lightDescriptorSet}, {});
+		const DirectionalLight* dirLight = _renderPassManager->get<DirectionalLight>("DirectionalLight");
+		cmdBuffer.bindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelineLayout->getLayoutHandle(), 3, {		   _lightDescriptorSet},
+									 { dirLight->getLightDescOffset(), dirLight->getViewProjectionOffset() });
 
 		std::array<ClipmapRegion, DEFAULT_CLIP_REGION_COUNT>* clipmapRegions =
 			_renderPassManager->get<std::array<ClipmapRegion, DEFAULT_CLIP_REGION_COUNT>>("ClipmapRegions");
@@ -231,6 +233,7 @@ namespace vfs
 		std::vector<VkDescriptorPoolSize> poolSizes = {
 			{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 8 },
 			{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,		10 },
+			{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 2 },
 		};
 		_descriptorPool = std::make_shared<DescriptorPool>(_device, poolSizes, 3, 0);
 
@@ -285,8 +288,8 @@ namespace vfs
 
 		_lightDescriptorLayout = std::make_shared<DescriptorSetLayout>(_device);
 		_lightDescriptorLayout->addBinding(VK_SHADER_STAGE_FRAGMENT_BIT, 0, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 0);
-		_lightDescriptorLayout->addBinding(VK_SHADER_STAGE_FRAGMENT_BIT, 1, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 0);
-		_lightDescriptorLayout->addBinding(VK_SHADER_STAGE_FRAGMENT_BIT, 2, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 0);
+		_lightDescriptorLayout->addBinding(VK_SHADER_STAGE_FRAGMENT_BIT, 1, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 0);
+		_lightDescriptorLayout->addBinding(VK_SHADER_STAGE_FRAGMENT_BIT, 2, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 0);
 		_lightDescriptorLayout->createDescriptorSetLayout(0);
 
 		_lightDescriptorSet = std::make_shared<DescriptorSet>(_device, _descriptorPool, _lightDescriptorLayout, 1);
@@ -300,8 +303,8 @@ namespace vfs
 		shadowMapInfo.imageLayout	= VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
 
 		_lightDescriptorSet->updateImage({ shadowMapInfo }, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
-		_lightDescriptorSet->updateUniformBuffer({ dirLight->getLightDescBuffer() }, 1, 1);
-		_lightDescriptorSet->updateUniformBuffer({ dirLight->getViewProjectionBuffer() }, 2, 1);
+		_lightDescriptorSet->updateDynamicUniformBuffer(dirLight->getLightDescBuffer(), dirLight->getLightDescRange(), 1);
+		_lightDescriptorSet->updateDynamicUniformBuffer(dirLight->getViewProjectionBuffer(), dirLight->getViewProjectionRange(), 2);
 
 		return *this;
 	}
@@ -355,7 +358,9 @@ namespace vfs
 
 		_pipeline = std::make_shared<GraphicsPipeline>(_device);
 		_pipeline->attachShaderModule(VK_SHADER_STAGE_VERTEX_BIT,	"Shaders/voxelConeTracing.vert.spv", nullptr);
-		_pipeline->attachShaderModule(VK_SHADER_STAGE_FRAGMENT_BIT, "Shaders/voxelConeTracing.frag.spv", nullptr);
+		// GBuffer normal is decoded according to its layout
+		const VkSpecializationInfo* gbufferSpecInfo = _renderPassManager->get<VkSpecializationInfo>("GBufferSpecializationInfo");
+		_pipeline->attachShaderModule(VK_SHADER_STAGE_FRAGMENT_BIT, "Shaders/voxelConeTracing.frag.spv", gbufferSpecInfo);
 		_pipeline->createPipeline(&config);
 		return *this;
 	}
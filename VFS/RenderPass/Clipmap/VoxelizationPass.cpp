@@ -22,12 +22,13 @@
 #include <VulkanFramework/Pipelines/GraphicsPipeline.h>
 #include <VulkanFramework/Pipelines/PipelineLayout.h>
 #include <VulkanFramework/Pipelines/PipelineConfig.h>
-#include <VulkanFramework/Sync/Fence.h>
+#include <VulkanFramework/Sync/SubmissionScheduler.h>
 #include <VulkanFramework/FrameLayout.h>
 #include <VulkanFramework/Queue.h>
 #include <VulkanFramework/Utils.h>
 #include <Camera.h>
 #include <SceneManager.h>
+#include <RenderPass/DrawCuller.h>
 #include <imgui/imgui.h>
 #include <imgui/imgui_impl_vulkan.h>
 
@@ -150,6 +151,21 @@ namespace vfs
 			}
 		}
 
+		// Each revoxelization region draws only primitives overlapping its box, often a thin slab
+		std::vector<DrawCuller::CullView> cullViews;
+		for (uint32_t i = 0; i < DEFAULT_CLIP_REGION_COUNT; ++i)
+		{
+			for (const ClipmapRegion& region : _revoxelizationRegions[i])
+			{
+				cullViews.push_back(DrawCuller::FromClipmapRegion(region));
+			}
+		}
+		if (cullViews.empty() == false)
+		{
+			DrawCuller* drawCuller = _renderPassManager->get<DrawCuller>("DrawCuller");
+			_firstCullView = drawCuller->cmdCull(cmdBuffer, cullViews, "Voxelization");
+		}
+
 		_voxelizer->beginRenderPass(frameLayout);
 	}
 
@@ -197,15 +213,18 @@ namespace vfs
 			
 			cmdBuffer.bindPipeline(_pipeline);
 			cmdBuffer.bindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelineLayout->getLayoutHandle(), 2, { _descriptorSet }, {});
-			SceneManager* sceneManager = _renderPassManager->get<SceneManager>("SceneManager");
+			DrawCuller* drawCuller = _renderPassManager->get<DrawCuller>("DrawCuller");
+			uint32_t cullView = _firstCullView;
 			for (uint32_t i = 0; i < DEFAULT_CLIP_REGION_COUNT; ++i)
 			{
 				for (const ClipmapRegion& region : _revoxelizationRegions[i])
 				{
 					// voxelize given region
-					cmdBuffer.bindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelineLayout->getLayoutHandle(), 3, { _voxelizer->getVoxelDescSet(i) }, {});
-					_voxelizer->cmdVoxelize(frameLayout->commandBuffer, region, i);
-					sceneManager->cmdDraw(frameLayout->commandBuffer, _pipelineLayout, 0);
+					if (_voxelizer->cmdVoxelize(frameLayout->commandBuffer, _pipelineLayout->getLayoutHandle(), 3, region, i))
+					{
+						drawCuller->cmdDraw(frameLayout->commandBuffer, _pipelineLayout, cullView);
+					}
+					cullView = cullView == DrawCuller::kNoCulling ? cullView : cullView + 1;
 				}
 			}
 		}
@@ -277,25 +296,28 @@ namespace vfs
 
 		const uint32_t clipWidth  = (_voxelResolution + DEFAULT_VOXEL_BORDER) * DEFAULT_VOXEL_FACE_COUNT;
 		const uint32_t clipHeight = (_voxelResolution + DEFAULT_VOXEL_BORDER) * DEFAULT_CLIP_REGION_COUNT;
+
+		// Every slice is copied by one command buffer, so the opacity volume is transitioned once
+		std::vector<VkImageMemoryBarrier> sliceDstBarriers, sliceReadBarriers;
 		for (uint32_t i = 0; i < 130; ++i)
 		{
 			ImagePtr& imageBuffer = _opacitySlice[i].first;
-			
-			CommandBuffer cmdBuffer(copyCmdPool.allocateCommandBuffer());
-			cmdBuffer.beginRecord(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+			sliceDstBarriers.push_back(imageBuffer->generateMemoryBarrier(0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_ASPECT_COLOR_BIT,
+				VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL));
+			sliceReadBarriers.push_back(imageBuffer->generateMemoryBarrier(VK_ACCESS_TRANSFER_WRITE_BIT, 0, VK_IMAGE_ASPECT_COLOR_BIT,
+				VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL));
+		}
+		sliceDstBarriers.push_back(_voxelOpacity->generateMemoryBarrier(0, 0, VK_IMAGE_ASPECT_COLOR_BIT,
+			VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL));
 
-			cmdBuffer.pipelineBarrier(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
-				0, {}, {},
-				{ _voxelOpacity->generateMemoryBarrier(0, 0, VK_IMAGE_ASPECT_COLOR_BIT,
-														VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL) }
-			);
-			
-			cmdBuffer.pipelineBarrier(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
-				0, {}, {},
-				{ imageBuffer->generateMemoryBarrier(0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_ASPECT_COLOR_BIT,
-				VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) }
-			);
+		CommandBuffer cmdBuffer(copyCmdPool.allocateCommandBuffer());
+		cmdBuffer.beginRecord(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+
+		cmdBuffer.pipelineBarrier(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+			0, {}, {}, sliceDstBarriers);
 
+		for (uint32_t i = 0; i < 130; ++i)
+		{
 			VkImageCopy copyRegion = {};
 			copyRegion.srcOffset = { 0, 0, static_cast<int32_t>(i) };
 			copyRegion.srcSubresource.aspectMask		= VK_IMAGE_ASPECT_COLOR_BIT;
@@ -310,26 +332,24 @@ namespace vfs
 			copyRegion.extent = { clipWidth, clipHeight, 1 };
 
 			vkCmdCopyImage(cmdBuffer.getHandle(), _voxelOpacity->getImageHandle(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-				imageBuffer->getImageHandle(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copyRegion);
+				_opacitySlice[i].first->getImageHandle(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copyRegion);
+		}
 
-			cmdBuffer.pipelineBarrier(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
-				0, {}, {},
-				{ imageBuffer->generateMemoryBarrier(VK_ACCESS_TRANSFER_WRITE_BIT, 0, VK_IMAGE_ASPECT_COLOR_BIT,
-				VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) }
-			);
-			
-			cmdBuffer.pipelineBarrier(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-				0, {}, {},
-				{ _voxelOpacity->generateMemoryBarrier(0, VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_ASPECT_COLOR_BIT,
-														VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL) }
-			);
+		cmdBuffer.pipelineBarrier(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+			0, {}, {}, sliceReadBarriers);
 
-			cmdBuffer.endRecord();
+		cmdBuffer.pipelineBarrier(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+			0, {}, {},
+			{ _voxelOpacity->generateMemoryBarrier(0, VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_ASPECT_COLOR_BIT,
+													VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL) }
+		);
 
-			Fence fence(_device, 1, 0);
-			_queue->submitCmdBuffer({ cmdBuffer }, &fence);
-			fence.waitForAllFences(UINT64_MAX);
-		}
+		cmdBuffer.endRecord();
+
+		// snowapril : copy pool is destroyed on return, so the single submission is waited here
+		SubmissionScheduler* scheduler = _renderPassManager->get<SubmissionScheduler>("GraphicsScheduler");
+		assert(scheduler->getQueue() == _queue);
+		scheduler->wait(scheduler->submit({ cmdBuffer.getHandle() }));
 	}
 
 	VoxelizationPass& VoxelizationPass::createVoxelClipmap(uint32_t extentLevel0)
@@ -387,7 +407,7 @@ namespace vfs
 		_pipelineLayout->initialize(
 			_device,
 			{ globalDescLayout, sceneManager->getDescriptorLayout(), _descriptorLayout, _voxelizer->getVoxelDescLayout() },
-			{ sceneManager->getDefaultPushConstant() }
+			{}
 		);
 
 		PipelineConfig config;
@@ -427,7 +447,7 @@ namespace vfs
 		config.colorBlendInfo.pAttachments			= &colorBlendAttachment;
 
 		_pipeline = std::make_shared<GraphicsPipeline>(_device);
-		_pipeline->attachShaderModule(VK_SHADER_STAGE_VERTEX_BIT,	"Shaders/msaaVoxelizer.vert.spv", nullptr);
+		_pipeline->attachShaderModule(VK_SHADER_STAGE_VERTEX_BIT,	"Shaders/msaaVoxelizer.vert.spv", sceneManager->getVertexSpecializationInfo());
 		_pipeline->attachShaderModule(VK_SHADER_STAGE_GEOMETRY_BIT, "Shaders/msaaVoxelizer.geom.spv", nullptr);
 		_pipeline->attachShaderModule(VK_SHADER_STAGE_FRAGMENT_BIT, "Shaders/msaaVoxelizer.frag.spv", nullptr);
 		_pipeline->createPipeline(&config);
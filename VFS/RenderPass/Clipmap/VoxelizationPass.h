@@ -56,6 +56,7 @@ namespace vfs
 		std::array<std::vector<ClipmapRegion>,	DEFAULT_CLIP_REGION_COUNT> _revoxelizationRegions;
 		std::array<int32_t, DEFAULT_CLIP_REGION_COUNT> _clipMinChange{ 2, 2, 2, 2, 2, 1 };
 		uint32_t				_voxelResolution;
+		uint32_t				_firstCullView		{ 0 };
 		bool					_fullRevoxelization	{ true };
 
 		std::vector<std::pair<ImagePtr, ImageViewPtr>> _opacitySlice;
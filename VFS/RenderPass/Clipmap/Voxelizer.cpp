@@ -3,7 +3,7 @@
 #include <pch.h>
 #include <RenderPass/Clipmap/Voxelizer.h>
 #include <VulkanFramework/Commands/CommandBuffer.h>
-#include <VulkanFramework/Buffers/Buffer.h>
+#include <VulkanFramework/Buffers/FrameUniformAllocator.h>
 #include <VulkanFramework/Device.h>
 #include <VulkanFramework/Descriptors/DescriptorSetLayout.h>
 #include <VulkanFramework/Descriptors/DescriptorSet.h>
@@ -33,10 +33,10 @@ namespace vfs
 
 
 	Voxelizer::Voxelizer(CommandPoolPtr cmdPool, uint32_t voxelResolution,
-						 VkExtent2D framebufferExtent)
+						 VkExtent2D framebufferExtent, const FrameUniformAllocatorPtr& uniformAllocator)
 		: RenderPassBase(cmdPool)
 	{
-		assert(initializeVoxelizer(voxelResolution, framebufferExtent));
+		assert(initializeVoxelizer(voxelResolution, framebufferExtent, uniformAllocator));
 	}
 
 	Voxelizer::~Voxelizer()
@@ -44,7 +44,8 @@ namespace vfs
 		// Do nothing
 	}
 
-	bool Voxelizer::initializeVoxelizer(uint32_t voxelResolution, VkExtent2D framebufferExtent)
+	bool Voxelizer::initializeVoxelizer(uint32_t voxelResolution, VkExtent2D framebufferExtent,
+										const FrameUniformAllocatorPtr& uniformAllocator)
 	{
 		_voxelResolution = voxelResolution;
 		
@@ -52,7 +53,7 @@ namespace vfs
 		createRenderPass();
 		createFramebuffer(framebufferExtent);
 		createVoxelClipmap();
-		createDescriptors();
+		createDescriptors(uniformAllocator);
 		return true;
 	}
 
@@ -119,33 +120,28 @@ namespace vfs
 		return *this;
 	}
 
-	Voxelizer& Voxelizer::createDescriptors(void)
+	Voxelizer& Voxelizer::createDescriptors(const FrameUniformAllocatorPtr& uniformAllocator)
 	{
+		_uniformAllocator = uniformAllocator;
+
 		// Descriptors for voxelization info buffers
 		std::vector<VkDescriptorPoolSize> poolSizes = {
-			{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 3},
+			{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 3},
 		};
-		_voxelDescPool = std::make_shared<DescriptorPool>(_device, poolSizes, DEFAULT_CLIP_REGION_COUNT, 0);
+		_voxelDescPool = std::make_shared<DescriptorPool>(_device, poolSizes, 1, 0);
 
 		_voxelDescLayout = std::make_shared<DescriptorSetLayout>(_device);
-		_voxelDescLayout->addBinding(VK_SHADER_STAGE_GEOMETRY_BIT, 0, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 0);
-		_voxelDescLayout->addBinding(VK_SHADER_STAGE_GEOMETRY_BIT, 1, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 0);
-		_voxelDescLayout->addBinding(VK_SHADER_STAGE_FRAGMENT_BIT, 2, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 0);
+		_voxelDescLayout->addBinding(VK_SHADER_STAGE_GEOMETRY_BIT, 0, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 0);
+		_voxelDescLayout->addBinding(VK_SHADER_STAGE_GEOMETRY_BIT, 1, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 0);
+		_voxelDescLayout->addBinding(VK_SHADER_STAGE_FRAGMENT_BIT, 2, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 0);
 		_voxelDescLayout->createDescriptorSetLayout(0);
 
-		for (uint32_t i = 0; i < DEFAULT_CLIP_REGION_COUNT; ++i)
-		{
-			_voxelDescSets[i] = std::make_shared<DescriptorSet>(_device, _voxelDescPool, _voxelDescLayout, 1);
-			_clipmapBuffers[i] = std::make_shared<Buffer>(_device->getMemoryAllocator(), sizeof(VoxelizationDesc),
-				VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
-			_voxelDescSets[i]->updateUniformBuffer({ _clipmapBuffers[i] }, 2, 1);
-			_viewportBuffers[i] = std::make_shared<Buffer>(_device->getMemoryAllocator(), sizeof(glm::uvec2) * 3,
-				VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
-			_voxelDescSets[i]->updateUniformBuffer({ _viewportBuffers[i] }, 0, 1);
-			_viewProjBuffers[i] = std::make_shared<Buffer>(_device->getMemoryAllocator(), sizeof(glm::mat4) * 6,
-				VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
-			_voxelDescSets[i]->updateUniformBuffer({ _viewProjBuffers[i] }, 1, 1);
-		}
+		// snowapril : one set serves every clip level and region, each cmdVoxelize call
+		//			   writes its own slices and binds them through dynamic offsets
+		_voxelDescSet = std::make_shared<DescriptorSet>(_device, _voxelDescPool, _voxelDescLayout, 1);
+		_voxelDescSet->updateDynamicUniformBuffer(_uniformAllocator->getBuffer(), sizeof(glm::uvec2) * 3,	0);
+		_voxelDescSet->updateDynamicUniformBuffer(_uniformAllocator->getBuffer(), sizeof(glm::mat4) * 6,	1);
+		_voxelDescSet->updateDynamicUniformBuffer(_uniformAllocator->getBuffer(), sizeof(VoxelizationDesc),	2);
 
 		return *this;
 	}
@@ -222,14 +218,10 @@ namespace vfs
 		(void)frameLayout;
 	}
 
-	void Voxelizer::cmdVoxelize(VkCommandBuffer cmdBufferHandle, const ClipmapRegion& region, uint32_t clipLevel)
+	bool Voxelizer::cmdVoxelize(VkCommandBuffer cmdBufferHandle, VkPipelineLayout pipelineLayout, uint32_t descSetIndex,
+								const ClipmapRegion& region, uint32_t clipLevel)
 	{
-		if (_clipmapBuffers[clipLevel] == nullptr)
-		{
-			_clipmapBuffers[clipLevel] = std::make_shared<Buffer>(_device->getMemoryAllocator(), sizeof(VoxelizationDesc),
-																   VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
-			_voxelDescSets[clipLevel]->updateUniformBuffer({ _clipmapBuffers[clipLevel] }, 2, 1);
-		}
+		assert(clipLevel < DEFAULT_CLIP_REGION_COUNT);
 
 		VoxelizationDesc vxDesc;
 		vxDesc.regionMinCorner = glm::vec3(region.minCorner) * region.voxelSize - glm::vec3(1e-6f);
@@ -239,8 +231,8 @@ namespace vfs
 		extendedRegion.extent		= extendedRegion.extent + DEFAULT_VOXEL_BORDER;
 		extendedRegion.minCorner	-= 1;
 
-		setViewport(cmdBufferHandle, extendedRegion.extent, clipLevel);
-		setViewProjection(cmdBufferHandle, extendedRegion, clipLevel);
+		const uint32_t viewportOffset = setViewport(cmdBufferHandle, extendedRegion.extent);
+		const uint32_t viewProjOffset = setViewProjection(extendedRegion);
 		
 		const std::array<ClipmapRegion, DEFAULT_CLIP_REGION_COUNT>* clipmapRegions = _renderPassManager->get<std::array<ClipmapRegion, DEFAULT_CLIP_REGION_COUNT>>("ClipmapRegions");
 		const ClipmapRegion& targetRegion = clipmapRegions->at(clipLevel);
@@ -257,21 +249,23 @@ namespace vfs
 		
 		vxDesc.clipmapResolution = static_cast<int32_t>(_voxelResolution);
 
-		// Upload Voxelization description staging buffer
+		const uint32_t clipmapOffset = _uniformAllocator->allocate(&vxDesc, sizeof(VoxelizationDesc));
+		if (viewportOffset == FrameUniformAllocator::kInvalidOffset ||
+			viewProjOffset == FrameUniformAllocator::kInvalidOffset ||
+			clipmapOffset  == FrameUniformAllocator::kInvalidOffset)
+		{
+			return false;
+		}
+
+		// Dynamic offsets must be given in binding order
 		CommandBuffer cmdBuffer(cmdBufferHandle);
-		_clipmapBuffers[clipLevel]->uploadData(&vxDesc, sizeof(VoxelizationDesc));
+		cmdBuffer.bindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, descSetIndex, { _voxelDescSet },
+									 { viewportOffset, viewProjOffset, clipmapOffset });
+		return true;
 	}
 
-	void Voxelizer::setViewport(VkCommandBuffer cmdBufferHandle, glm::uvec3 viewportSize, uint32_t clipLevel)
+	uint32_t Voxelizer::setViewport(VkCommandBuffer cmdBufferHandle, glm::uvec3 viewportSize)
 	{
-		assert(clipLevel < DEFAULT_CLIP_REGION_COUNT);
-		if (_viewportBuffers[clipLevel] == nullptr)
-		{
-			_viewportBuffers[clipLevel] = std::make_shared<Buffer>(_device->getMemoryAllocator(), sizeof(glm::uvec2) * 3,
-																   VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
-			_voxelDescSets[clipLevel]->updateUniformBuffer({ _viewportBuffers[clipLevel] }, 0, 1);
-		}
-
 		CommandBuffer cmdBuffer(cmdBufferHandle);
 		std::vector<VkViewport> viewports{
 			{ 0.0f, 0.0f, static_cast<float>(viewportSize.z), static_cast<float>(viewportSize.y), 0.0f, 1.0f},
@@ -292,19 +286,11 @@ namespace vfs
 			{viewportSize.x, viewportSize.z},
 			{viewportSize.x, viewportSize.y}
 		};
-		_viewportBuffers[clipLevel]->uploadData(&viewportSizes[0], sizeof(glm::uvec2) * 3);
+		return _uniformAllocator->allocate(&viewportSizes[0], sizeof(glm::uvec2) * 3);
 	}
 
-	void Voxelizer::setViewProjection(VkCommandBuffer cmdBufferHandle, const ClipmapRegion& region, uint32_t clipLevel)
+	uint32_t Voxelizer::setViewProjection(const ClipmapRegion& region)
 	{
-		assert(clipLevel < DEFAULT_CLIP_REGION_COUNT);
-		if (_viewProjBuffers[clipLevel] == nullptr)
-		{
-			_viewProjBuffers[clipLevel] = std::make_shared<Buffer>(_device->getMemoryAllocator(), sizeof(glm::mat4) * 6,
-																   VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
-			_voxelDescSets[clipLevel]->updateUniformBuffer({ _viewProjBuffers[clipLevel] }, 1, 1);
-		}
-
 		const glm::vec3 regionGlobal	= glm::vec3(region.extent) * region.voxelSize;
 		const glm::vec3 minCornerGlobal = glm::vec3(region.minCorner) * region.voxelSize;
 		const glm::vec3 eye				= minCornerGlobal + glm::vec3(0.0f, 0.0f, regionGlobal.z);
@@ -321,9 +307,8 @@ namespace vfs
 		{
 			viewProj[i + 3] = glm::inverse(viewProj[i]);
 		}
-		
-		CommandBuffer cmdBuffer(cmdBufferHandle);
-		_viewProjBuffers[clipLevel]->uploadData(&viewProj[0], sizeof(glm::mat4) * 6);
+
+		return _uniformAllocator->allocate(&viewProj[0], sizeof(glm::mat4) * 6);
 	}
 
 	void Voxelizer::processWindowResize(int width, int height)
@@ -21,19 +21,24 @@ namespace vfs
 	public:
 		explicit Voxelizer(CommandPoolPtr cmdPool, uint32_t voxelResolution);
 		explicit Voxelizer(CommandPoolPtr cmdPool, uint32_t voxelResolution,
-						   VkExtent2D framebufferExtent);
+						   VkExtent2D framebufferExtent, const FrameUniformAllocatorPtr& uniformAllocator);
 				~Voxelizer();
 
 	public:
-		bool initializeVoxelizer(uint32_t voxelResolution, VkExtent2D framebufferExtent);
+		bool initializeVoxelizer(uint32_t voxelResolution, VkExtent2D framebufferExtent,
+								 const FrameUniformAllocatorPtr& uniformAllocator);
 
 		Voxelizer& createAttachments	(VkExtent2D resolution);
 		Voxelizer& createRenderPass		(void);
 		Voxelizer& createFramebuffer	(VkExtent2D resolution);
-		Voxelizer& createDescriptors	(void);
+		Voxelizer& createDescriptors	(const FrameUniformAllocatorPtr& uniformAllocator);
 		Voxelizer& createVoxelClipmap	(void);
 		
-		void cmdVoxelize(VkCommandBuffer cmdBufferHandle, const ClipmapRegion& region, uint32_t clipLevel);
+		//! Record viewport states and bind voxelization descriptor set to the given set index
+		//! of the pipeline layout, with per-region parameters written to frame uniform slices.
+		//! Returns false if the slices could not be allocated, draws of the region must be skipped then
+		bool cmdVoxelize(VkCommandBuffer cmdBufferHandle, VkPipelineLayout pipelineLayout, uint32_t descSetIndex,
+						 const ClipmapRegion& region, uint32_t clipLevel);
 		
 		void processWindowResize(int width, int height) override;
 
@@ -54,17 +59,12 @@ namespace vfs
 		{
 			return _voxelDescLayout;
 		}
-		inline DescriptorSetPtr getVoxelDescSet(uint32_t clipmapLevel) const
-		{
-			assert(clipmapLevel < _voxelDescSets.size());
-			return _voxelDescSets[clipmapLevel];
-		}
 	private:
 		void onBeginRenderPass	(const FrameLayout* frameLayout) override;
 		void onEndRenderPass	(const FrameLayout* frameLayout) override;
 		void onUpdate			(const FrameLayout* frameLayout) override;
-		void setViewport		(VkCommandBuffer cmdBufferHandle, glm::uvec3 viewportSize, uint32_t clipLevel);
-		void setViewProjection	(VkCommandBuffer cmdBufferHandle, const ClipmapRegion& region, uint32_t clipLevel);
+		uint32_t setViewport		(VkCommandBuffer cmdBufferHandle, glm::uvec3 viewportSize);
+		uint32_t setViewProjection	(const ClipmapRegion& region);
 
 		struct VoxelizationDesc {
 			glm::vec3	regionMinCorner;
@@ -86,10 +86,8 @@ namespace vfs
 		FramebufferPtr				_framebuffer			{ nullptr };
 		DescriptorPoolPtr			_voxelDescPool			{ nullptr };
 		DescriptorSetLayoutPtr		_voxelDescLayout		{ nullptr };
-		std::array<DescriptorSetPtr, DEFAULT_CLIP_REGION_COUNT> _voxelDescSets;
-		std::array<BufferPtr,		 DEFAULT_CLIP_REGION_COUNT>	_viewProjBuffers;
-		std::array<BufferPtr,		 DEFAULT_CLIP_REGION_COUNT>	_viewportBuffers;
-		std::array<BufferPtr,		 DEFAULT_CLIP_REGION_COUNT>	_clipmapBuffers;
+		DescriptorSetPtr			_voxelDescSet			{ nullptr };
+		FrameUniformAllocatorPtr	_uniformAllocator		{ nullptr };
 		uint32_t					_voxelResolution		{ 0u };
 	};
 };
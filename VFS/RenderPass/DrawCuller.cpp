@@ -0,0 +1,573 @@
+// Author : Jihong Shin (snowapril)
+
+#include <pch.h>
+#include <RenderPass/DrawCuller.h>
+#include <SceneManager.h>
+#include <GeometryPool.h>
+#include <BindlessTable.h>
+#include <RenderPass/HiZPyramid.h>
+#include <Common/Logger.h>
+#include <VulkanFramework/Device.h>
+#include <VulkanFramework/DebugUtils.h>
+#include <VulkanFramework/Buffers/Buffer.h>
+#include <VulkanFramework/Buffers/FrameUniformAllocator.h>
+#include <VulkanFramework/Descriptors/DescriptorPool.h>
+#include <VulkanFramework/Descriptors/DescriptorSet.h>
+#include <VulkanFramework/Descriptors/DescriptorSetLayout.h>
+#include <VulkanFramework/Pipelines/ComputePipeline.h>
+#include <VulkanFramework/Pipelines/PipelineLayout.h>
+#include <VulkanFramework/Pipelines/PipelineConfig.h>
+#include <Common/CPUTimer.h>
+#include <imgui/imgui.h>
+#include <algorithm>
+#include <cstring>
+
+namespace vfs
+{
+	namespace
+	{
+		constexpr uint32_t kCullGroupSize		= 64; // local_size_x of drawCulling.comp
+		constexpr uint64_t kCountsPerView		= 2;  // Survivors with 16-bit and 32-bit indices
+		constexpr uint64_t kCountStride			= kCountsPerView * sizeof(uint32_t);
+		constexpr uint64_t kCommandStride		= sizeof(VkDrawIndexedIndirectCommand);
+		constexpr uint32_t kSceneDrawList		= UINT32_MAX; // List offset reading the scene draw list instead of candidates
+		constexpr uint32_t kEarlyPhase			= UINT32_MAX; // Input view of early occlusion phase, draws are read from the list
+		constexpr uint32_t kOcclusionViews		= 4;		  // Visible and deferred views of early phase, then disoccluded and occluded
+
+		VkMemoryBarrier MakeMemoryBarrier(VkAccessFlags srcAccess, VkAccessFlags dstAccess)
+		{
+			VkMemoryBarrier memoryBarrier = {};
+			memoryBarrier.sType			= VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			memoryBarrier.pNext			= nullptr;
+			memoryBarrier.srcAccessMask	= srcAccess;
+			memoryBarrier.dstAccessMask	= dstAccess;
+			return memoryBarrier;
+		}
+	}
+
+	DrawCuller::DrawCuller(DevicePtr device)
+		: _device(device)
+	{
+		// Do nothing
+	}
+
+	DrawCuller::~DrawCuller()
+	{
+		destroyDrawCuller();
+	}
+
+	void DrawCuller::destroyDrawCuller(void)
+	{
+		for (BufferPtr& readbackBuffer : _readbackBuffers)
+		{
+			readbackBuffer.reset();
+		}
+		_candidateBuffer.reset();
+		_countBuffer.reset();
+		_culledBuffer.reset();
+		_uniformAllocator.reset();
+		_occlusionPipeline.reset();
+		_occlusionLayout.reset();
+		_pyramidDescLayout.reset();
+		_cullingPipeline.reset();
+		_pipelineLayout.reset();
+		_descSet.reset();
+		_descLayout.reset();
+		_descPool.reset();
+		_sceneManager = nullptr;
+		_device.reset();
+	}
+
+	DrawCuller::CullView DrawCuller::FromViewProjection(const glm::mat4& viewProj)
+	{
+		// snowapril : planes are rows of the matrix combined with the w row, near plane is taken
+		//			   from -w <= z which also holds for the zero to one depth range
+		const glm::mat4 rows = glm::transpose(viewProj);
+		CullView view;
+		view.planes[0] = rows[3] + rows[0];
+		view.planes[1] = rows[3] - rows[0];
+		view.planes[2] = rows[3] + rows[1];
+		view.planes[3] = rows[3] - rows[1];
+		view.planes[4] = rows[3] + rows[2];
+		view.planes[5] = rows[3] - rows[2];
+		for (glm::vec4& plane : view.planes)
+		{
+			plane /= glm::length(glm::vec3(plane));
+		}
+		return view;
+	}
+
+	DrawCuller::CullView DrawCuller::FromBoundingBox(const glm::vec3& boxMin, const glm::vec3& boxMax)
+	{
+		CullView view;
+		view.planes[0] = glm::vec4( 1.0f,  0.0f,  0.0f, -boxMin.x);
+		view.planes[1] = glm::vec4(-1.0f,  0.0f,  0.0f,  boxMax.x);
+		view.planes[2] = glm::vec4( 0.0f,  1.0f,  0.0f, -boxMin.y);
+		view.planes[3] = glm::vec4( 0.0f, -1.0f,  0.0f,  boxMax.y);
+		view.planes[4] = glm::vec4( 0.0f,  0.0f,  1.0f, -boxMin.z);
+		view.planes[5] = glm::vec4( 0.0f,  0.0f, -1.0f,  boxMax.z);
+		return view;
+	}
+
+	DrawCuller::CullView DrawCuller::FromClipmapRegion(const ClipmapRegion& region)
+	{
+		const glm::vec3 boxMin = glm::vec3(region.minCorner - 1) * region.voxelSize;
+		const glm::vec3 boxMax = glm::vec3(region.minCorner + glm::ivec3(region.extent) + 1) * region.voxelSize;
+		return FromBoundingBox(boxMin, boxMax);
+	}
+
+	DrawCuller& DrawCuller::createDescriptors(SceneManager* sceneManager, const FrameUniformAllocatorPtr& uniformAllocator)
+	{
+		_sceneManager		= sceneManager;
+		_uniformAllocator	= uniformAllocator;
+		DebugUtils debugUtil(_device);
+
+		_culledBuffer = std::make_shared<Buffer>(_device->getMemoryAllocator(),
+												 static_cast<uint64_t>(DEFAULT_CULL_VIEWS) * DEFAULT_CULL_VIEW_DRAWS * kCommandStride,
+												 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+												 VMA_MEMORY_USAGE_GPU_ONLY);
+		debugUtil.setObjectName(_culledBuffer->getBufferHandle(), "Culled Draw Commands");
+
+		_countBuffer = std::make_shared<Buffer>(_device->getMemoryAllocator(), DEFAULT_CULL_VIEWS * kCountStride,
+												VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+												VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+												VMA_MEMORY_USAGE_GPU_ONLY);
+		debugUtil.setObjectName(_countBuffer->getBufferHandle(), "Culled Draw Counts");
+
+		// Counts are copied per frame in flight, and read back once the frame index comes around again
+		for (BufferPtr& readbackBuffer : _readbackBuffers)
+		{
+			readbackBuffer = std::make_shared<Buffer>(_device->getMemoryAllocator(), DEFAULT_CULL_VIEWS * kCountStride,
+													  VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_TO_CPU);
+		}
+
+		// Draws listed by BVH queries are written from host, one range per frame in flight
+		_candidateBuffer = std::make_shared<Buffer>(_device->getMemoryAllocator(),
+													static_cast<uint64_t>(MAX_NUM_FRAMES) * DEFAULT_CULL_FRAME_CANDIDATES * sizeof(uint32_t),
+													VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
+		debugUtil.setObjectName(_candidateBuffer->getBufferHandle(), "Culling Candidate Draws");
+
+		std::vector<VkDescriptorPoolSize> poolSizes = {
+			{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,			7},
+			{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1},
+		};
+		_descPool = std::make_shared<DescriptorPool>(_device, poolSizes, 1, 0);
+
+		_descLayout = std::make_shared<DescriptorSetLayout>(_device);
+		_descLayout->addBinding(VK_SHADER_STAGE_COMPUTE_BIT, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,			0);
+		_descLayout->addBinding(VK_SHADER_STAGE_COMPUTE_BIT, 1, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,			0);
+		_descLayout->addBinding(VK_SHADER_STAGE_COMPUTE_BIT, 2, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,			0);
+		_descLayout->addBinding(VK_SHADER_STAGE_COMPUTE_BIT, 3, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,			0);
+		_descLayout->addBinding(VK_SHADER_STAGE_COMPUTE_BIT, 4, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,			0);
+		_descLayout->addBinding(VK_SHADER_STAGE_COMPUTE_BIT, 5, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,			0);
+		_descLayout->addBinding(VK_SHADER_STAGE_COMPUTE_BIT, 6, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,	0);
+		_descLayout->addBinding(VK_SHADER_STAGE_COMPUTE_BIT, 7, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,			0);
+		_descLayout->createDescriptorSetLayout(0);
+
+		// snowapril : views of every cmdCull call are fed through dynamic offsets into the frame uniform buffer
+		const BindlessTablePtr bindlessTable = _sceneManager->getBindlessTable();
+		_descSet = std::make_shared<DescriptorSet>(_device, _descPool, _descLayout, 1);
+		_descSet->updateStorageBuffer({ bindlessTable->getMatrixBuffer()	}, 0, 1);
+		_descSet->updateStorageBuffer({ bindlessTable->getDrawBuffer()		}, 1, 1);
+		_descSet->updateStorageBuffer({ bindlessTable->getIndirectBuffer()	}, 2, 1);
+		_descSet->updateStorageBuffer({ _sceneManager->getDrawListBuffer()	}, 3, 1);
+		_descSet->updateStorageBuffer({ _culledBuffer						}, 4, 1);
+		_descSet->updateStorageBuffer({ _countBuffer						}, 5, 1);
+		_descSet->updateDynamicUniformBuffer(_uniformAllocator->getBuffer(), sizeof(CullViewDesc), 6);
+		_descSet->updateStorageBuffer({ _candidateBuffer					}, 7, 1);
+
+		// Pyramid sets are allocated by each HiZPyramid, occlusion culling binds them at set 1
+		_pyramidDescLayout = std::make_shared<DescriptorSetLayout>(_device);
+		_pyramidDescLayout->addBinding(VK_SHADER_STAGE_COMPUTE_BIT, 0, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 0);
+		_pyramidDescLayout->createDescriptorSetLayout(0);
+
+		return *this;
+	}
+
+	DrawCuller& DrawCuller::createPipeline(void)
+	{
+		assert(_descLayout != nullptr); // snowapril : Descriptor set layout must be initialized first
+
+		VkPushConstantRange pushConstRange = {};
+		pushConstRange.offset		= 0;
+		pushConstRange.size			= sizeof(CullPushConstant);
+		pushConstRange.stageFlags	= VK_SHADER_STAGE_COMPUTE_BIT;
+
+		_pipelineLayout = std::make_shared<PipelineLayout>();
+		_pipelineLayout->initialize(_device, { _descLayout }, { pushConstRange });
+
+		PipelineConfig config;
+		config.pipelineLayout = _pipelineLayout->getLayoutHandle();
+
+		_cullingPipeline = std::make_shared<ComputePipeline>();
+		_cullingPipeline->initialize(_device);
+		_cullingPipeline->attachShaderModule(VK_SHADER_STAGE_COMPUTE_BIT, "Shaders/drawCulling.comp.spv", nullptr);
+		_cullingPipeline->createPipeline(&config);
+
+		VkPushConstantRange occlusionConstRange = {};
+		occlusionConstRange.offset		= 0;
+		occlusionConstRange.size		= sizeof(OcclusionPushConstant);
+		occlusionConstRange.stageFlags	= VK_SHADER_STAGE_COMPUTE_BIT;
+
+		_occlusionLayout = std::make_shared<PipelineLayout>();
+		_occlusionLayout->initialize(_device, { _descLayout, _pyramidDescLayout }, { occlusionConstRange });
+
+		PipelineConfig occlusionConfig;
+		occlusionConfig.pipelineLayout = _occlusionLayout->getLayoutHandle();
+
+		_occlusionPipeline = std::make_shared<ComputePipeline>();
+		_occlusionPipeline->initialize(_device);
+		_occlusionPipeline->attachShaderModule(VK_SHADER_STAGE_COMPUTE_BIT, "Shaders/occlusionCulling.comp.spv", nullptr);
+		_occlusionPipeline->createPipeline(&occlusionConfig);
+
+		return *this;
+	}
+
+	void DrawCuller::beginFrame(uint32_t frameIndex)
+	{
+		assert(frameIndex < MAX_NUM_FRAMES);
+		_frameIndex			= frameIndex;
+		_numFrameCandidates = 0;
+
+		std::vector<ViewRecord>& frameViews = _frameViews[_frameIndex];
+		if (frameViews.empty())
+		{
+			return;
+		}
+
+		std::vector<uint32_t> counts(frameViews.size() * kCountsPerView);
+		_readbackBuffers[_frameIndex]->downloadData(counts.data(), counts.size() * sizeof(uint32_t));
+
+		// Views of one pass are summed up, passes are listed in the order they were culled
+		_statistics.clear();
+		for (size_t i = 0; i < frameViews.size(); ++i)
+		{
+			const ViewRecord& record = frameViews[i];
+			auto iter = std::find_if(_statistics.begin(), _statistics.end(), [&record](const PassStatistics& statistics) {
+				return statistics.passName == record.passName;
+			});
+			if (iter == _statistics.end())
+			{
+				iter = _statistics.insert(_statistics.end(), PassStatistics{ record.passName, 0, 0, 0, 0, 0.0f });
+			}
+			// Nothing is dispatched for empty draw list, so its counts are never written
+			const uint32_t numSurvivors = record.numDraws > 0 ? counts[i * kCountsPerView] + counts[i * kCountsPerView + 1] : 0;
+			iter->numTested			+= record.numSceneDraws;
+			iter->numListed			+= record.numListed;
+			iter->numDrawn			+= record.kind == ViewKind::Drawn	 ? numSurvivors : 0;
+			iter->numOccluded		+= record.kind == ViewKind::Occluded ? numSurvivors : 0;
+			iter->queryMilliSeconds += record.queryMilliSeconds;
+		}
+		frameViews.clear();
+	}
+
+	uint32_t DrawCuller::cmdCull(CommandBuffer cmdBuffer, const std::vector<CullView>& views, const char* passName)
+	{
+		assert(!views.empty() && views.size() <= kMaxBatchViews);
+		const uint32_t numViews		 = static_cast<uint32_t>(views.size());
+		const uint32_t numSceneDraws = _sceneManager->getNumListedDraws();
+
+		uint32_t listOffset, numDraws16, numDraws;
+		float queryMilliSeconds;
+		listDraws(views, passName, &listOffset, &numDraws16, &numDraws, &queryMilliSeconds);
+
+		std::vector<ViewRecord>& frameViews = _frameViews[_frameIndex];
+		const uint32_t firstView = static_cast<uint32_t>(frameViews.size());
+		if (firstView + numViews > DEFAULT_CULL_VIEWS || numDraws > DEFAULT_CULL_VIEW_DRAWS)
+		{
+			if (!_bOverflowWarned)
+			{
+				VFS_WARN << "Draw culling is out of capacity, " << passName << " draws every scene primitive";
+				_bOverflowWarned = true;
+			}
+			return kNoCulling;
+		}
+		for (uint32_t i = 0; i < numViews; ++i)
+		{
+			frameViews.push_back({ passName, ViewKind::Drawn, numDraws16, numDraws, numDraws, numSceneDraws,
+								   i == 0 ? queryMilliSeconds : 0.0f });
+		}
+		if (numDraws == 0)
+		{
+			return firstView;
+		}
+
+		CullViewDesc viewDesc = {};
+		std::copy(views.begin(), views.end(), viewDesc.views);
+		const uint32_t descOffset = _uniformAllocator->allocate(&viewDesc, sizeof(CullViewDesc));
+		if (descOffset == FrameUniformAllocator::kInvalidOffset)
+		{
+			frameViews.resize(firstView);
+			return kNoCulling;
+		}
+
+		CullPushConstant pushConst = {};
+		pushConst.firstView		= firstView;
+		pushConst.numDraws16	= numDraws16;
+		pushConst.numDraws		= numDraws;
+		pushConst.viewCapacity	= DEFAULT_CULL_VIEW_DRAWS;
+		pushConst.listOffset	= listOffset;
+
+		cmdResetCounts(cmdBuffer, firstView, numViews);
+		cmdBuffer.bindPipeline(_cullingPipeline);
+		cmdBuffer.bindDescriptorSets(VK_PIPELINE_BIND_POINT_COMPUTE, _pipelineLayout->getLayoutHandle(),
+									 0, { _descSet }, { descOffset });
+		cmdBuffer.pushConstants(_pipelineLayout->getLayoutHandle(), VK_SHADER_STAGE_COMPUTE_BIT,
+								0, sizeof(CullPushConstant), &pushConst);
+		cmdBuffer.dispatch((numDraws + kCullGroupSize - 1) / kCullGroupSize, numViews, 1);
+		cmdCopyCounts(cmdBuffer, firstView, numViews);
+		return firstView;
+	}
+
+	uint32_t DrawCuller::cmdCullOccluded(CommandBuffer cmdBuffer, const CullView& view, const HiZPyramid* pyramid, const char* passName)
+	{
+		const uint32_t numSceneDraws = _sceneManager->getNumListedDraws();
+
+		uint32_t listOffset, numDraws16, numDraws;
+		float queryMilliSeconds;
+		listDraws({ view }, passName, &listOffset, &numDraws16, &numDraws, &queryMilliSeconds);
+
+		// snowapril : room for the late phase is reserved here, so that deferred draws are never dropped
+		std::vector<ViewRecord>& frameViews = _frameViews[_frameIndex];
+		const uint32_t firstView = static_cast<uint32_t>(frameViews.size());
+		if (firstView + kOcclusionViews > DEFAULT_CULL_VIEWS || numDraws > DEFAULT_CULL_VIEW_DRAWS)
+		{
+			if (!_bOverflowWarned)
+			{
+				VFS_WARN << "Draw culling is out of capacity, " << passName << " draws every scene primitive";
+				_bOverflowWarned = true;
+			}
+			return kNoCulling;
+		}
+		frameViews.push_back({ passName, ViewKind::Drawn,	 numDraws16, numDraws, numDraws, numSceneDraws, queryMilliSeconds });
+		frameViews.push_back({ passName, ViewKind::Deferred, numDraws16, numDraws, 0,		 0,				0.0f			  });
+		if (numDraws == 0)
+		{
+			return firstView;
+		}
+
+		CullViewDesc viewDesc = {};
+		viewDesc.views[0] = view;
+		const uint32_t descOffset = _uniformAllocator->allocate(&viewDesc, sizeof(CullViewDesc));
+		if (descOffset == FrameUniformAllocator::kInvalidOffset)
+		{
+			frameViews.resize(firstView);
+			return kNoCulling;
+		}
+
+		cmdResetCounts(cmdBuffer, firstView, 2);
+		if (pyramid->isValid())
+		{
+			const VkExtent2D depthResolution = pyramid->getDepthResolution();
+			OcclusionPushConstant pushConst = {};
+			pushConst.pyramidViewProj	= pyramid->getViewProjection();
+			pushConst.depthSize			= glm::uvec2(depthResolution.width, depthResolution.height);
+			pushConst.firstView			= firstView;
+			pushConst.numDraws16		= numDraws16;
+			pushConst.numDraws			= numDraws;
+			pushConst.viewCapacity		= DEFAULT_CULL_VIEW_DRAWS;
+			pushConst.listOffset		= listOffset;
+			pushConst.inputView			= kEarlyPhase;
+			pushConst.numLevels			= pyramid->getNumLevels();
+
+			cmdBuffer.bindPipeline(_occlusionPipeline);
+			cmdBuffer.bindDescriptorSets(VK_PIPELINE_BIND_POINT_COMPUTE, _occlusionLayout->getLayoutHandle(),
+										 0, { _descSet, pyramid->getSamplingDescriptorSet() }, { descOffset });
+			cmdBuffer.pushConstants(_occlusionLayout->getLayoutHandle(), VK_SHADER_STAGE_COMPUTE_BIT,
+									0, sizeof(OcclusionPushConstant), &pushConst);
+		}
+		else
+		{
+			// Nothing to test against yet, frustum survivors are all visible and none is deferred
+			CullPushConstant pushConst = {};
+			pushConst.firstView		= firstView;
+			pushConst.numDraws16	= numDraws16;
+			pushConst.numDraws		= numDraws;
+			pushConst.viewCapacity	= DEFAULT_CULL_VIEW_DRAWS;
+			pushConst.listOffset	= listOffset;
+
+			cmdBuffer.bindPipeline(_cullingPipeline);
+			cmdBuffer.bindDescriptorSets(VK_PIPELINE_BIND_POINT_COMPUTE, _pipelineLayout->getLayoutHandle(),
+										 0, { _descSet }, { descOffset });
+			cmdBuffer.pushConstants(_pipelineLayout->getLayoutHandle(), VK_SHADER_STAGE_COMPUTE_BIT,
+									0, sizeof(CullPushConstant), &pushConst);
+		}
+		cmdBuffer.dispatch((numDraws + kCullGroupSize - 1) / kCullGroupSize, 1, 1);
+		cmdCopyCounts(cmdBuffer, firstView, 2);
+		return firstView;
+	}
+
+	uint32_t DrawCuller::cmdCullDisoccluded(CommandBuffer cmdBuffer, uint32_t deferredView, const HiZPyramid* pyramid, const char* passName)
+	{
+		if (deferredView == kNoCulling)
+		{
+			return kNoCulling;
+		}
+		assert(pyramid->isValid()); // snowapril : pyramid must be built from depth of the visible draws first
+
+		std::vector<ViewRecord>& frameViews = _frameViews[_frameIndex];
+		const uint32_t firstView	= static_cast<uint32_t>(frameViews.size());
+		const uint32_t numDraws16	= frameViews[deferredView].numDraws16;
+		const uint32_t numDraws		= frameViews[deferredView].numDraws;
+		assert(firstView + 2 <= DEFAULT_CULL_VIEWS);
+		frameViews.push_back({ passName, ViewKind::Drawn,	 numDraws16, numDraws, 0, 0, 0.0f });
+		frameViews.push_back({ passName, ViewKind::Occluded, numDraws16, numDraws, 0, 0, 0.0f });
+		if (numDraws == 0)
+		{
+			return firstView;
+		}
+
+		const VkExtent2D depthResolution = pyramid->getDepthResolution();
+		OcclusionPushConstant pushConst = {};
+		pushConst.pyramidViewProj	= pyramid->getViewProjection();
+		pushConst.depthSize			= glm::uvec2(depthResolution.width, depthResolution.height);
+		pushConst.firstView			= firstView;
+		pushConst.numDraws16		= numDraws16;
+		pushConst.numDraws			= numDraws;
+		pushConst.viewCapacity		= DEFAULT_CULL_VIEW_DRAWS;
+		pushConst.listOffset		= kSceneDrawList;
+		pushConst.inputView			= deferredView;
+		pushConst.numLevels			= pyramid->getNumLevels();
+
+		// Views are not read by the late phase, any offset into the frame uniforms is valid
+		cmdResetCounts(cmdBuffer, firstView, 2);
+		cmdBuffer.bindPipeline(_occlusionPipeline);
+		cmdBuffer.bindDescriptorSets(VK_PIPELINE_BIND_POINT_COMPUTE, _occlusionLayout->getLayoutHandle(),
+									 0, { _descSet, pyramid->getSamplingDescriptorSet() }, { 0 });
+		cmdBuffer.pushConstants(_occlusionLayout->getLayoutHandle(), VK_SHADER_STAGE_COMPUTE_BIT,
+								0, sizeof(OcclusionPushConstant), &pushConst);
+		cmdBuffer.dispatch((numDraws + kCullGroupSize - 1) / kCullGroupSize, 1, 1);
+		cmdCopyCounts(cmdBuffer, firstView, 2);
+		return firstView;
+	}
+
+	void DrawCuller::listDraws(const std::vector<CullView>& views, const char* passName, uint32_t* listOffset,
+							   uint32_t* numDraws16, uint32_t* numDraws, float* queryMilliSeconds)
+	{
+		// Narrow the scene draw list down to draws which may overlap any of the views
+		CPUTimer queryTimer;
+		*listOffset = kSceneDrawList;
+		*numDraws16 = _sceneManager->getNumListedDraws16();
+		*numDraws	= _sceneManager->getNumListedDraws();
+		if (_bQueryCandidates && *numDraws > 0 && !listCandidates(views, listOffset, numDraws16, numDraws))
+		{
+			if (!_bCandidateWarned)
+			{
+				VFS_WARN << "Culling candidates are out of capacity, " << passName << " culls the whole scene draw list";
+				_bCandidateWarned = true;
+			}
+			*numDraws16 = _sceneManager->getNumListedDraws16();
+			*numDraws	= _sceneManager->getNumListedDraws();
+		}
+		*queryMilliSeconds = _bQueryCandidates ? queryTimer.elapsedMilliSeconds() : 0.0f;
+	}
+
+	void DrawCuller::cmdResetCounts(CommandBuffer cmdBuffer, uint32_t firstView, uint32_t numViews)
+	{
+		// Survivors of earlier frames may still be drawn, copied or read by late occlusion phase, wait for them before overwriting
+		cmdBuffer.pipelineBarrier(VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+								  VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, {}, {}, {});
+		cmdBuffer.fillBuffer(_countBuffer, firstView * kCountStride, numViews * kCountStride, 0);
+		cmdBuffer.pipelineBarrier(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+								  { MakeMemoryBarrier(VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT) },
+								  {}, {});
+	}
+
+	void DrawCuller::cmdCopyCounts(CommandBuffer cmdBuffer, uint32_t firstView, uint32_t numViews)
+	{
+		// Late occlusion phase reads survivors of the early phase in compute
+		cmdBuffer.pipelineBarrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+								  VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+								  { MakeMemoryBarrier(VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT |
+																				 VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_SHADER_READ_BIT) },
+								  {}, {});
+
+		// Statistics only, read back on beginFrame of the same frame index
+		const VkDeviceSize countOffset	= firstView * kCountStride;
+		const VkDeviceSize countSize	= numViews	* kCountStride;
+		cmdBuffer.copyBuffer(_countBuffer.get(), _readbackBuffers[_frameIndex], { { countOffset, countOffset, countSize } });
+		cmdBuffer.pipelineBarrier(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0,
+								  { MakeMemoryBarrier(VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_HOST_READ_BIT) }, {}, {});
+	}
+
+	bool DrawCuller::listCandidates(const std::vector<CullView>& views, uint32_t* listOffset, uint32_t* numDraws16, uint32_t* numDraws)
+	{
+		_sceneManager->queryDrawSlots(views.data(), static_cast<uint32_t>(views.size()), &_candidates, numDraws16);
+		*numDraws = static_cast<uint32_t>(_candidates.size());
+		if (_numFrameCandidates + *numDraws > DEFAULT_CULL_FRAME_CANDIDATES)
+		{
+			return false;
+		}
+
+		// snowapril : range of this frame index is free once the frame is begun, same as frame uniforms
+		*listOffset = _frameIndex * DEFAULT_CULL_FRAME_CANDIDATES + _numFrameCandidates;
+		const uint64_t byteOffset = static_cast<uint64_t>(*listOffset) * sizeof(uint32_t);
+		const uint64_t byteSize	  = static_cast<uint64_t>(*numDraws)   * sizeof(uint32_t);
+		if (byteSize > 0)
+		{
+			std::memcpy(static_cast<uint8_t*>(_candidateBuffer->getMappedData()) + byteOffset, _candidates.data(), byteSize);
+			_candidateBuffer->flushMemory(byteOffset, byteSize);
+		}
+		_numFrameCandidates += *numDraws;
+		return true;
+	}
+
+	void DrawCuller::cmdDraw(VkCommandBuffer cmdBufferHandle, const PipelineLayoutPtr& pipelineLayout, uint32_t viewIndex)
+	{
+		if (viewIndex == kNoCulling)
+		{
+			_sceneManager->cmdDraw(cmdBufferHandle, pipelineLayout);
+			return;
+		}
+
+		const ViewRecord& record	= _frameViews[_frameIndex][viewIndex];
+		const uint32_t numDraws16	= record.numDraws16;
+		const uint32_t numDraws		= record.numDraws;
+		if (numDraws == 0)
+		{
+			return;
+		}
+
+		// snowapril : survivors of 16-bit indexed draws are compacted to the front of the view range,
+		//			   32-bit ones start right after the room reserved for every listed 16-bit draw
+		CommandBuffer cmdBuffer(cmdBufferHandle);
+		_sceneManager->cmdBindGeometry(&cmdBuffer, pipelineLayout);
+		const BufferPtr		indexBuffer = _sceneManager->getGeometryPool()->getIndexBuffer();
+		const VkDeviceSize	viewOffset	= static_cast<VkDeviceSize>(viewIndex) * DEFAULT_CULL_VIEW_DRAWS * kCommandStride;
+		const VkDeviceSize	countOffset = viewIndex * kCountStride;
+		if (numDraws16 > 0)
+		{
+			cmdBuffer.bindIndexBuffer(indexBuffer, 0, VK_INDEX_TYPE_UINT16);
+			cmdBuffer.drawIndexedIndirectCount(_culledBuffer, viewOffset, _countBuffer, countOffset,
+											   numDraws16, kCommandStride);
+		}
+		if (numDraws > numDraws16)
+		{
+			cmdBuffer.bindIndexBuffer(indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+			cmdBuffer.drawIndexedIndirectCount(_culledBuffer, viewOffset + numDraws16 * kCommandStride,
+											   _countBuffer, countOffset + sizeof(uint32_t),
+											   numDraws - numDraws16, kCommandStride);
+		}
+	}
+
+	void DrawCuller::drawGUI(void)
+	{
+		if (ImGui::TreeNode("Draw Culling"))
+		{
+			ImGui::Checkbox("List draws by BVH queries", &_bQueryCandidates);
+			float frameQueryMilliSeconds = 0.0f;
+			for (const PassStatistics& statistics : _statistics)
+			{
+				const float drawnRatio = statistics.numTested > 0 ?
+					static_cast<float>(statistics.numDrawn) / statistics.numTested : 0.0f;
+				ImGui::Text("%s : %u drawn / %u listed / %u culled (%u occluded)", statistics.passName.c_str(), statistics.numDrawn,
+							statistics.numListed, statistics.numTested - statistics.numDrawn, statistics.numOccluded);
+				ImGui::Text("BVH query : %.3f ms", statistics.queryMilliSeconds);
+				ImGui::ProgressBar(drawnRatio);
+				frameQueryMilliSeconds += statistics.queryMilliSeconds;
+			}
+			ImGui::Text("BVH queries per frame : %.3f ms", frameQueryMilliSeconds);
+			ImGui::TreePop();
+		}
+	}
+};
@@ -0,0 +1,167 @@
+// Author : Jihong Shin (snowapril)
+
+#if !defined(VFS_DRAW_CULLER_H)
+#define VFS_DRAW_CULLER_H
+
+#include <pch.h>
+#include <Util/EngineConfig.h>
+#include <BoundingVolumeHierarchy.h>
+#include <RenderPass/Clipmap/ClipmapRegion.h>
+#include <VulkanFramework/Commands/CommandBuffer.h>
+#include <array>
+#include <string>
+
+namespace vfs
+{
+	class SceneManager;
+	class HiZPyramid;
+
+	//! Culls world bounding boxes of every listed scene draw against views of a pass in
+	//! one compute dispatch, and compacts survivors of each view into its own range of
+	//! indexed indirect commands drawn with the count written by the shader.
+	//! Draws are listed per dispatch by querying scene BVHs with all views of the pass,
+	//! or taken from the whole scene draw list if queries are disabled or out of room.
+	//! Culling must be recorded outside of render passes, before the draws of its views.
+	class DrawCuller : NonCopyable
+	{
+	public:
+		explicit DrawCuller(DevicePtr device);
+				~DrawCuller();
+
+		//! Returned when the view could not be culled, its draws fall back to all scene draws
+		static constexpr uint32_t kNoCulling	= UINT32_MAX;
+		//! Voxelization culls up to three revoxelization slabs of every clip level at once
+		static constexpr uint32_t kMaxBatchViews = DEFAULT_CLIP_REGION_COUNT * 3;
+
+		//! Six inward facing planes, same planes are used for BVH queries on CPU
+		using CullView = Frustum;
+
+		static CullView FromViewProjection	(const glm::mat4& viewProj);
+		static CullView FromBoundingBox		(const glm::vec3& boxMin, const glm::vec3& boxMax);
+		//! Region box grown by one voxel, voxelizer rasterizes a border around its region
+		static CullView FromClipmapRegion	(const ClipmapRegion& region);
+
+	public:
+		DrawCuller& createDescriptors	(SceneManager* sceneManager, const FrameUniformAllocatorPtr& uniformAllocator);
+		DrawCuller& createPipeline		(void);
+		void		destroyDrawCuller	(void);
+
+		//! Read back statistics of the frame which used this index last time, GPU must be done with it
+		void	 beginFrame	(uint32_t frameIndex);
+		//! Returns index of the first view, consecutive views follow in the given order.
+		//! Pass name is kept until statistics are read back, give a string literal
+		uint32_t cmdCull	(CommandBuffer cmdBuffer, const std::vector<CullView>& views, const char* passName);
+		//! Early phase of occlusion culling, frustum survivors are tested against the pyramid built last frame.
+		//! Returns the first of two views, visible draws and the ones deferred to cmdCullDisoccluded
+		uint32_t cmdCullOccluded	(CommandBuffer cmdBuffer, const CullView& view, const HiZPyramid* pyramid, const char* passName);
+		//! Late phase of occlusion culling, deferred draws are tested against the pyramid built this frame.
+		//! Returns the first of two views, disoccluded draws and the ones which stay occluded
+		uint32_t cmdCullDisoccluded	(CommandBuffer cmdBuffer, uint32_t deferredView, const HiZPyramid* pyramid, const char* passName);
+		//! Draw survivors of the view, scene geometry is bound at set 1 of the given layout
+		void	 cmdDraw	(VkCommandBuffer cmdBuffer, const PipelineLayoutPtr& pipelineLayout, uint32_t viewIndex);
+		void	 drawGUI	(void);
+
+		//! Version of candidate range and readback buffer written this frame
+		inline uint32_t getFrameIndex(void) const
+		{
+			return _frameIndex;
+		}
+		//! Layout of the pyramid sampling set bound at set 1 of occlusion culling (occlusionCulling.comp)
+		inline DescriptorSetLayoutPtr getPyramidDescLayout(void) const
+		{
+			return _pyramidDescLayout;
+		}
+
+	private:
+		struct CullPushConstant
+		{
+			uint32_t firstView;		// 4
+			uint32_t numDraws16;	// 8
+			uint32_t numDraws;		// 12
+			uint32_t viewCapacity;	// 16
+			uint32_t listOffset;	// 20
+		};
+
+		struct OcclusionPushConstant
+		{
+			glm::mat4	pyramidViewProj;	// 64
+			glm::uvec2	depthSize;			// 72
+			uint32_t	firstView;			// 76
+			uint32_t	numDraws16;			// 80
+			uint32_t	numDraws;			// 84
+			uint32_t	viewCapacity;		// 88
+			uint32_t	listOffset;			// 92
+			uint32_t	inputView;			// 96
+			uint32_t	numLevels;			// 100
+		};
+
+		struct CullViewDesc
+		{
+			CullView views[kMaxBatchViews];
+		};
+
+		//! Only survivors of drawn views count as drawn, deferred views are intermediate
+		enum class ViewKind : uint32_t
+		{
+			Drawn		= 0,
+			Deferred	= 1,
+			Occluded	= 2,
+		};
+
+		struct ViewRecord
+		{
+			const char* passName;
+			ViewKind	kind;
+			uint32_t	numDraws16;			// Listed draws with 16-bit indices
+			uint32_t	numDraws;			// Listed draws culled in the shader
+			uint32_t	numListed;			// Listed draws counted in statistics, zero for later views of the same draws
+			uint32_t	numSceneDraws;		// Draws of all published scenes, zero for later views of the same draws
+			float		queryMilliSeconds;	// BVH query time of the dispatch, on its first view only
+		};
+
+		struct PassStatistics
+		{
+			std::string passName;
+			uint32_t	numDrawn			{ 0 };
+			uint32_t	numListed			{ 0 };
+			uint32_t	numTested			{ 0 };
+			uint32_t	numOccluded			{ 0 };
+			float		queryMilliSeconds	{ 0.0f };
+		};
+
+		//! Write draw list of the views into the candidate range of this frame, returns false if out of room
+		bool listCandidates(const std::vector<CullView>& views, uint32_t* listOffset, uint32_t* numDraws16, uint32_t* numDraws);
+		//! Candidates of the views if queries are enabled and fit, otherwise the scene draw list
+		void listDraws		(const std::vector<CullView>& views, const char* passName, uint32_t* listOffset,
+							 uint32_t* numDraws16, uint32_t* numDraws, float* queryMilliSeconds);
+		void cmdResetCounts	(CommandBuffer cmdBuffer, uint32_t firstView, uint32_t numViews);
+		void cmdCopyCounts	(CommandBuffer cmdBuffer, uint32_t firstView, uint32_t numViews);
+
+	private:
+		DevicePtr					_device				{ nullptr };
+		SceneManager*				_sceneManager		{ nullptr };
+		DescriptorPoolPtr			_descPool			{ nullptr };
+		DescriptorSetLayoutPtr		_descLayout			{ nullptr };
+		DescriptorSetPtr			_descSet			{ nullptr };
+		PipelineLayoutPtr			_pipelineLayout		{ nullptr };
+		ComputePipelinePtr			_cullingPipeline	{ nullptr };
+		DescriptorSetLayoutPtr		_pyramidDescLayout	{ nullptr };
+		PipelineLayoutPtr			_occlusionLayout	{ nullptr };
+		ComputePipelinePtr			_occlusionPipeline	{ nullptr };
+		FrameUniformAllocatorPtr	_uniformAllocator	{ nullptr };
+		BufferPtr					_culledBuffer		{ nullptr };	// DEFAULT_CULL_VIEW_DRAWS commands per view
+		BufferPtr					_countBuffer		{ nullptr };	// 16-bit and 32-bit indexed survivor counts per view
+		BufferPtr					_candidateBuffer	{ nullptr };	// DEFAULT_CULL_FRAME_CANDIDATES draw slots per frame
+		std::vector<uint32_t>		_candidates;
+		uint32_t					_numFrameCandidates	{ 0 };
+		std::array<BufferPtr,				MAX_NUM_FRAMES> _readbackBuffers;
+		std::array<std::vector<ViewRecord>, MAX_NUM_FRAMES> _frameViews;
+		std::vector<PassStatistics>	_statistics;
+		uint32_t					_frameIndex			{ 0 };
+		bool						_bOverflowWarned	{ false };
+		bool						_bCandidateWarned	{ false };
+		bool						_bQueryCandidates	{ true };
+	};
+};
+
+#endif
@@ -14,12 +14,18 @@
 #include <VulkanFramework/RenderPass/Framebuffer.h>
 #include <VulkanFramework/RenderPass/RenderPass.h>
 #include <VulkanFramework/Pipelines/GraphicsPipeline.h>
+#include <VulkanFramework/Pipelines/ComputePipeline.h>
 #include <VulkanFramework/Pipelines/PipelineLayout.h>
 #include <VulkanFramework/Pipelines/PipelineConfig.h>
 #include <VulkanFramework/FrameLayout.h>
 #include <VulkanFramework/Utils.h>
+#include <Common/Logger.h>
 #include <Camera.h>
 #include <SceneManager.h>
+#include <BindlessTable.h>
+#include <GeometryPool.h>
+#include <RenderPass/DrawCuller.h>
+#include <RenderPass/HiZPyramid.h>
 #include <imgui/imgui.h>
 #include <imgui/imgui_impl_vulkan.h>
 
@@ -41,6 +47,20 @@ namespace vfs
 
 	GBufferPass::~GBufferPass()
 	{
+		_hiZPyramid.reset();
+		_resolvePipeline.reset();
+		_resolvePipelineLayout.reset();
+		_resolveDescSet.reset();
+		_resolveDescLayout.reset();
+		_resolveDescPool.reset();
+		_visibilityPipeline.reset();
+		_visibilityFramebuffer.reset();
+		_visibilityResumeRenderPass.reset();
+		_visibilityRenderPass.reset();
+		_visibilityAttachment = {};
+		_depthEqualPipeline.reset();
+		_depthPrepassPipeline.reset();
+		_resumeRenderPass.reset();
 		_framebuffer.reset();
 	}
 
@@ -53,6 +73,7 @@ namespace vfs
 		createRenderPass();
 		createFramebuffer();
 		createPipeline(globalDescLayout);
+		createHiZPyramid();
 		return true;
 	}
 
@@ -60,21 +81,12 @@ namespace vfs
 	{
 		VkSampler commonSampler = _colorSampler->getSamplerHandle();
 
-		_gbufferDebugDescSets.push_back(ImGui_ImplVulkan_AddTexture(
-			commonSampler, _attachments[0].imageView->getImageViewHandle(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
-		));
-		_gbufferDebugDescSets.push_back(ImGui_ImplVulkan_AddTexture(
-			commonSampler, _attachments[1].imageView->getImageViewHandle(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
-		));
-		_gbufferDebugDescSets.push_back(ImGui_ImplVulkan_AddTexture(
-			commonSampler, _attachments[2].imageView->getImageViewHandle(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
-		));
-		_gbufferDebugDescSets.push_back(ImGui_ImplVulkan_AddTexture(
-			commonSampler, _attachments[3].imageView->getImageViewHandle(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
-		));
-		_gbufferDebugDescSets.push_back(ImGui_ImplVulkan_AddTexture(
-			commonSampler, _attachments[4].imageView->getImageViewHandle(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
-		));
+		for (size_t i = 0; i < _attachments.size() - 1; ++i)
+		{
+			_gbufferDebugDescSets.push_back(ImGui_ImplVulkan_AddTexture(
+				commonSampler, _attachments[i].imageView->getImageViewHandle(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+			));
+		}
 		return true;
 	}
 
@@ -82,6 +94,26 @@ namespace vfs
 	{
 		CommandBuffer cmdBuffer(frameLayout->commandBuffer);
 
+		// Path is chosen once per frame, visibility texel can not address more draws or triangles than its index bits
+		const SceneManager* sceneManager = _renderPassManager->get<SceneManager>("SceneManager");
+		const bool bDrawsFit	 = sceneManager->getNumListedDraws() <= kVisibilityMaxDraws;
+		const bool bTrianglesFit = sceneManager->getMaxDrawTriangles() <= kVisibilityMaxTriangles;
+		_bVisibilityFrame = _bVisibilityBuffer && _bVisibilitySupported && bDrawsFit && bTrianglesFit;
+		if (_bVisibilityBuffer && _bVisibilitySupported && !_bVisibilityFrame && !_bVisibilityWarned)
+		{
+			if (!bDrawsFit)
+			{
+				VFS_WARN << "Visibility buffer addresses up to " << kVisibilityMaxDraws << " draws, "
+						 << "scene has " << sceneManager->getNumListedDraws() << ". Falling back to GBuffer draws";
+			}
+			else
+			{
+				VFS_WARN << "Visibility buffer addresses up to " << kVisibilityMaxTriangles << " triangles per draw, "
+						 << "largest draw has " << sceneManager->getMaxDrawTriangles() << ". Falling back to GBuffer draws";
+			}
+			_bVisibilityWarned = true;
+		}
+
 		//VkImageMemoryBarrier barrier = _attachments.back().image->generateMemoryBarrier(
 		//	VK_ACCESS_MEMORY_READ_BIT, VK_ACCESS_MEMORY_WRITE_BIT, VK_IMAGE_ASPECT_DEPTH_BIT,
 		//	VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL
@@ -89,22 +121,86 @@ namespace vfs
 		//cmdBuffer.pipelineBarrier(VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, 
 		//	0, {}, {}, { barrier });
 
-		std::vector<VkClearValue> clearValues(_attachments.size());
-		for (size_t i = 0; i < clearValues.size(); ++i)
+		// Primitives outside of the camera frustum are culled before the render pass begins,
+		// with occlusion culling the ones hidden behind last frame depth are deferred to the late phase
+		const Camera* camera = _renderPassManager->get<Camera>("MainCamera");
+		DrawCuller* drawCuller = _renderPassManager->get<DrawCuller>("DrawCuller");
+		const DrawCuller::CullView cullView = DrawCuller::FromViewProjection(camera->getViewProjection());
+		if (_bOcclusionCulling)
 		{
-			if (i == clearValues.size() - 1)
-			{
-				clearValues[i].depthStencil = { 1.0f, 0 };
-			}
-			else
+			_cullView = drawCuller->cmdCullOccluded(cmdBuffer, cullView, _hiZPyramid.get(), "GBuffer");
+		}
+		else
+		{
+			_cullView = drawCuller->cmdCull(cmdBuffer, { cullView }, "GBuffer");
+			_hiZPyramid->invalidate();
+		}
+
+		beginGBufferPass(frameLayout, false);
+	}
+
+	void GBufferPass::onEndRenderPass(const FrameLayout* frameLayout)
+	{
+		CommandBuffer cmdBuffer(frameLayout->commandBuffer);
+		cmdBuffer.endRenderPass();
+
+		//VkImageMemoryBarrier barrier = _attachments.back().image->generateMemoryBarrier(
+		//	VK_ACCESS_MEMORY_WRITE_BIT, VK_ACCESS_MEMORY_READ_BIT, VK_IMAGE_ASPECT_DEPTH_BIT,
+		//	VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL
+		//);
+		//cmdBuffer.pipelineBarrier(VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 
+		//	0, {}, {}, { barrier });
+
+		// snowapril : culling fell back to every scene draw, nothing was deferred
+		if (_bOcclusionCulling && _cullView != DrawCuller::kNoCulling)
+		{
+			// Pyramid of the visible draws is used by the late phase now, and by the early phase of next frame
+			const Camera* camera = _renderPassManager->get<Camera>("MainCamera");
+			DrawCuller* drawCuller = _renderPassManager->get<DrawCuller>("DrawCuller");
+			_hiZPyramid->cmdBuild(cmdBuffer, camera->getViewProjection());
+			_lateCullView = drawCuller->cmdCullDisoccluded(cmdBuffer, _cullView + 1, _hiZPyramid.get(), "GBuffer");
+
+			beginGBufferPass(frameLayout, true);
+			drawCulledView(frameLayout, _lateCullView);
+			cmdBuffer.endRenderPass();
+		}
+
+		if (_bVisibilityFrame)
+		{
+			cmdResolveVisibility(frameLayout);
+		}
+	}
+
+	void GBufferPass::beginGBufferPass(const FrameLayout* frameLayout, bool bResume)
+	{
+		CommandBuffer cmdBuffer(frameLayout->commandBuffer);
+
+		if (_bVisibilityFrame)
+		{
+			// snowapril : empty texels keep all bits set, see VISIBILITY_EMPTY
+			std::vector<VkClearValue> clearValues(2);
+			clearValues[0].color.uint32[0]	= UINT32_MAX;
+			clearValues[1].depthStencil		= { 1.0f, 0 };
+			cmdBuffer.beginRenderPass(bResume ? _visibilityResumeRenderPass : _visibilityRenderPass,
+									  _visibilityFramebuffer, clearValues);
+		}
+		else
+		{
+			std::vector<VkClearValue> clearValues(_attachments.size());
+			for (size_t i = 0; i < clearValues.size(); ++i)
 			{
-				clearValues[i].color = { 0.0f, 0.0f, 0.0f, 1.0f };
+				if (i == clearValues.size() - 1)
+				{
+					clearValues[i].depthStencil = { 1.0f, 0 };
+				}
+				else
+				{
+					clearValues[i].color = { 0.0f, 0.0f, 0.0f, 1.0f };
+				}
 			}
+			cmdBuffer.beginRenderPass(bResume ? _resumeRenderPass : _renderPass, _framebuffer, clearValues);
 		}
 
-		cmdBuffer.beginRenderPass(_renderPass, _framebuffer, clearValues);
-		_pipeline->bindPipeline(frameLayout->commandBuffer);
-
 		VkViewport viewport = {};
 		viewport.x			= 0;
 		viewport.y			= 0;
@@ -124,47 +220,129 @@ namespace vfs
 			{ frameLayout->globalDescSet }, {});
 	}
 
-	void GBufferPass::onEndRenderPass(const FrameLayout* frameLayout)
+	void GBufferPass::drawCulledView(const FrameLayout* frameLayout, uint32_t viewIndex)
 	{
-		CommandBuffer cmdBuffer(frameLayout->commandBuffer);
-		cmdBuffer.endRenderPass();
-
-		//VkImageMemoryBarrier barrier = _attachments.back().image->generateMemoryBarrier(
-		//	VK_ACCESS_MEMORY_WRITE_BIT, VK_ACCESS_MEMORY_READ_BIT, VK_IMAGE_ASPECT_DEPTH_BIT,
-		//	VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL
-		//);
-		//cmdBuffer.pipelineBarrier(VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 
-		//	0, {}, {}, { barrier });
+		// snowapril : every pipeline shares the layout, so global set stays bound across them
+		DrawCuller* drawCuller = _renderPassManager->get<DrawCuller>("DrawCuller");
+		if (_bVisibilityFrame)
+		{
+			// Visibility texels are cheap enough to be written without depth prepass
+			_visibilityPipeline->bindPipeline(frameLayout->commandBuffer);
+		}
+		else if (_bDepthPrepass)
+		{
+			_depthPrepassPipeline->bindPipeline(frameLayout->commandBuffer);
+			drawCuller->cmdDraw(frameLayout->commandBuffer, _pipelineLayout, viewIndex);
+			_depthEqualPipeline->bindPipeline(frameLayout->commandBuffer);
+		}
+		else
+		{
+			_pipeline->bindPipeline(frameLayout->commandBuffer);
+		}
+		drawCuller->cmdDraw(frameLayout->commandBuffer, _pipelineLayout, viewIndex);
 	}
 
 	void GBufferPass::onUpdate(const FrameLayout* frameLayout)
+	{
+		drawCulledView(frameLayout, _cullView);
+	}
+
+	void GBufferPass::cmdResolveVisibility(const FrameLayout* frameLayout)
 	{
 		CommandBuffer cmdBuffer(frameLayout->commandBuffer);
-		
-		SceneManager* sceneManager = _renderPassManager->get<SceneManager>("SceneManager");
-		sceneManager->cmdDraw(frameLayout->commandBuffer, _pipelineLayout, 0);
+
+		// GBuffer contents of the last frame are not needed anymore, lighting passes of it are done reading them
+		std::vector<VkImageMemoryBarrier> barriers;
+		for (size_t i = 0; i < _attachments.size() - 1; ++i)
+		{
+			barriers.push_back(_attachments[i].image->generateMemoryBarrier(
+				VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_ASPECT_COLOR_BIT,
+				VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL
+			));
+		}
+		cmdBuffer.pipelineBarrier(VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+								  VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, {}, {}, barriers);
+
+		const Camera* camera = _renderPassManager->get<Camera>("MainCamera");
+		const SceneManager* sceneManager = _renderPassManager->get<SceneManager>("SceneManager");
+
+		ResolvePushConstant pushConst;
+		pushConst.viewProj		= camera->getViewProjection();
+		pushConst.resolution	= glm::uvec2(_gbufferResolution.width, _gbufferResolution.height);
+
+		cmdBuffer.bindPipeline(_resolvePipeline);
+		cmdBuffer.bindDescriptorSets(VK_PIPELINE_BIND_POINT_COMPUTE, _resolvePipelineLayout->getLayoutHandle(), 0,
+			{ sceneManager->getBindlessTable()->getDescriptorSet(), _resolveDescSet }, {});
+		cmdBuffer.pushConstants(_resolvePipelineLayout->getLayoutHandle(), VK_SHADER_STAGE_COMPUTE_BIT,
+								0, sizeof(ResolvePushConstant), &pushConst);
+		cmdBuffer.dispatch((_gbufferResolution.width + 7) / 8, (_gbufferResolution.height + 7) / 8, 1);
+
+		// Lighting passes sample resolved GBuffer exactly as if the fat path had written it
+		for (VkImageMemoryBarrier& barrier : barriers)
+		{
+			barrier.srcAccessMask	= VK_ACCESS_SHADER_WRITE_BIT;
+			barrier.dstAccessMask	= VK_ACCESS_SHADER_READ_BIT;
+			barrier.oldLayout		= VK_IMAGE_LAYOUT_GENERAL;
+			barrier.newLayout		= VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		}
+		cmdBuffer.pipelineBarrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+								  VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+								  0, {}, {}, barriers);
+	}
+
+	const char* GBufferPass::getShadingPathName(void) const
+	{
+		if (_bVisibilityFrame)
+		{
+			return "GBuffer Pass (Visibility Buffer)";
+		}
+		return _bDepthPrepass ? "GBuffer Pass (Depth Prepass)" : "GBuffer Pass";
 	}
 
 	void GBufferPass::drawGUI(void)
 	{
 		// Print GBuffer Pass elapsed time
+		if (ImGui::TreeNode("GBuffer Settings"))
+		{
+			ImGui::Checkbox("Hi-Z occlusion culling", &_bOcclusionCulling);
+			ImGui::Checkbox("Depth prepass", &_bDepthPrepass);
+			if (_bVisibilitySupported)
+			{
+				ImGui::Checkbox("Visibility buffer", &_bVisibilityBuffer);
+			}
+			else
+			{
+				ImGui::Text("Visibility buffer : GBuffer formats are not supported as storage images");
+			}
+
+			// Bytes per pixel written by rasterization, visibility path writes the same GBuffer later in compute
+			const uint64_t numPixels = static_cast<uint64_t>(_gbufferResolution.width) * _gbufferResolution.height;
+			const uint32_t depthBytes = 4, visibilityBytes = 4;
+			ImGui::Text("Layout : %s, %u bytes per pixel", _bPackedGBuffer ? "Packed" : "Fat", _colorBytesPerPixel);
+			ImGui::Text("Rasterized : %.1f MB (GBuffer), %.1f MB (Visibility)",
+						static_cast<float>(numPixels * (_colorBytesPerPixel + depthBytes)) / (1024.0f * 1024.0f),
+						static_cast<float>(numPixels * (visibilityBytes + depthBytes)) / (1024.0f * 1024.0f));
+			ImGui::Text("Visibility attachment : %.1f MB",
+						static_cast<float>(numPixels * visibilityBytes) / (1024.0f * 1024.0f));
+			ImGui::TreePop();
+		}
 	}
 
 	void GBufferPass::drawDebugInfo(void)
 	{
 		if (ImGui::TreeNode("GBuffer Images"))
 		{
-			ImGui::Image(_gbufferDebugDescSets[0], ImVec2(64.0f, 64.0f));
-			ImGui::SameLine();
-			ImGui::Image(_gbufferDebugDescSets[1], ImVec2(64.0f, 64.0f));
-			ImGui::SameLine();
-			ImGui::Image(_gbufferDebugDescSets[2], ImVec2(64.0f, 64.0f));
-			ImGui::SameLine();
-			ImGui::Image(_gbufferDebugDescSets[3], ImVec2(64.0f, 64.0f));
-			ImGui::SameLine();
-			ImGui::Image(_gbufferDebugDescSets[4], ImVec2(64.0f, 64.0f));
+			for (size_t i = 0; i < _gbufferDebugDescSets.size(); ++i)
+			{
+				if (i > 0)
+				{
+					ImGui::SameLine();
+				}
+				ImGui::Image(_gbufferDebugDescSets[i], ImVec2(64.0f, 64.0f));
+			}
 			ImGui::TreePop();
 		}
+		_hiZPyramid->drawDebugInfo("GBuffer Hi-Z Pyramid");
 	}
 
 	GBufferPass& GBufferPass::createAttachments(void)
@@ -174,50 +352,86 @@ namespace vfs
 
 		const VkExtent3D attachmentExtent = { _gbufferResolution.width, _gbufferResolution.height, 1 };
 		
+		// snowapril : packed layout needs both packed formats as color attachments, otherwise fat layout is used
+		if (_bPackedGBuffer &&
+			!(isFormatFeatureSupported(_device, VK_FORMAT_A2B10G10R10_UNORM_PACK32, VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT) &&
+			  isFormatFeatureSupported(_device, VK_FORMAT_B10G11R11_UFLOAT_PACK32,	VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT)))
+		{
+			VFS_WARN << "Packed GBuffer formats are not supported as color attachments. Falling back to fat GBuffer";
+			_bPackedGBuffer = false;
+		}
+		const VkFormat normalFormat		= _bPackedGBuffer ? VK_FORMAT_A2B10G10R10_UNORM_PACK32 : VK_FORMAT_R16G16B16A16_SFLOAT;
+		const VkFormat emissionFormat	= _bPackedGBuffer ? VK_FORMAT_B10G11R11_UFLOAT_PACK32	: VK_FORMAT_R16G16B16A16_SFLOAT;
+		_colorBytesPerPixel				= _bPackedGBuffer ? 16 : 32;
+
+		// Visibility resolve writes every color attachment as storage image, RGBA8 and RGBA16F storage is always supported
+		_bVisibilitySupported = isFormatFeatureSupported(_device, normalFormat,	  VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT) &&
+								isFormatFeatureSupported(_device, emissionFormat, VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT);
+		const VkImageUsageFlags colorUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+											 (_bVisibilitySupported ? VK_IMAGE_USAGE_STORAGE_BIT : 0);
+
 		const VkSampleCountFlagBits maxSampleCount = VK_SAMPLE_COUNT_1_BIT; // getMaximumSampleCounts(_device);
 		// 00. Diffuse
-		_attachments.push_back({ createAttachment(attachmentExtent, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, maxSampleCount) });
+		_attachments.push_back({ createAttachment(attachmentExtent, VK_FORMAT_R8G8B8A8_UNORM, colorUsage, maxSampleCount) });
 
-		// 01. Normal
-		_attachments.push_back({ createAttachment(attachmentExtent, VK_FORMAT_R16G16B16A16_SFLOAT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, maxSampleCount) });
+		// 01. Normal, or tangent frame of packed layout
+		_attachments.push_back({ createAttachment(attachmentExtent, normalFormat, colorUsage, maxSampleCount) });
 
 		// 02. Specular
-		_attachments.push_back({ createAttachment(attachmentExtent, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, maxSampleCount) });
+		_attachments.push_back({ createAttachment(attachmentExtent, VK_FORMAT_R8G8B8A8_UNORM, colorUsage, maxSampleCount) });
 
 		// 03. Emission
-		_attachments.push_back({ createAttachment(attachmentExtent, VK_FORMAT_R16G16B16A16_SFLOAT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, maxSampleCount) });
+		_attachments.push_back({ createAttachment(attachmentExtent, emissionFormat, colorUsage, maxSampleCount) });
 
-		// 04. Tangent
-		_attachments.push_back({ createAttachment(attachmentExtent, VK_FORMAT_R16G16B16A16_SFLOAT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, maxSampleCount) });
+		// 04. Tangent, folded into the tangent frame of packed layout
+		if (!_bPackedGBuffer)
+		{
+			_attachments.push_back({ createAttachment(attachmentExtent, VK_FORMAT_R16G16B16A16_SFLOAT, colorUsage, maxSampleCount) });
+		}
 
 		// 05. Depth
 		_attachments.push_back({ createAttachment(attachmentExtent, VK_FORMAT_D32_SFLOAT, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, maxSampleCount)});
 
+		// Draw and triangle index of the visibility path, resolved into the attachments above
+		_visibilityAttachment = createAttachment(attachmentExtent, VK_FORMAT_R32_UINT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_STORAGE_BIT, maxSampleCount);
+
 		// Create sampler for color attachments
 		_colorSampler = std::make_shared<Sampler>(_device, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, VK_FILTER_LINEAR, 1.0f);
 
+		// Shaders reading or writing the GBuffer are specialized to its layout (gbufferPacking.glsl)
+		_bPackedSpecConstant			= _bPackedGBuffer ? VK_TRUE : VK_FALSE;
+		_gbufferSpecEntry.constantID	= kPackedGBufferConstantID;
+		_gbufferSpecEntry.offset		= 0;
+		_gbufferSpecEntry.size			= sizeof(VkBool32);
+		_gbufferSpecInfo.mapEntryCount	= 1;
+		_gbufferSpecInfo.pMapEntries	= &_gbufferSpecEntry;
+		_gbufferSpecInfo.dataSize		= sizeof(VkBool32);
+		_gbufferSpecInfo.pData			= &_bPackedSpecConstant;
+
 		// Share gbuffer contents with other render-passes
+		const FramebufferAttachment& tangentAttachment = _attachments[_bPackedGBuffer ? 1 : 4];
 		_renderPassManager->put("DiffuseImageView",		_attachments[0].imageView.get());
 		_renderPassManager->put("NormalImageView",		_attachments[1].imageView.get());
 		_renderPassManager->put("SpecularImageView",	_attachments[2].imageView.get());
 		_renderPassManager->put("EmissionImageView",	_attachments[3].imageView.get());
-		_renderPassManager->put("TangentImageView",		_attachments[4].imageView.get());
-		_renderPassManager->put("DepthImageView",		_attachments[5].imageView.get());
+		_renderPassManager->put("TangentImageView",		tangentAttachment.imageView.get());
+		_renderPassManager->put("DepthImageView",		_attachments.back().imageView.get());
 		_renderPassManager->put("GBufferSampler",		_colorSampler.get());
+		_renderPassManager->put("GBufferSpecializationInfo", &_gbufferSpecInfo);
 
 #if defined(_DEBUG)
-		_debugUtils.setObjectName(_attachments[0].image->getImageHandle(),			"GBuffer(Diffuse)"		);
-		_debugUtils.setObjectName(_attachments[0].imageView->getImageViewHandle(),	"GBuffer(Diffuse) View"	);
-		_debugUtils.setObjectName(_attachments[1].image->getImageHandle(),			"GBuffer(Normal)"		);
-		_debugUtils.setObjectName(_attachments[1].imageView->getImageViewHandle(),	"GBuffer(Normal) View"	);
-		_debugUtils.setObjectName(_attachments[2].image->getImageHandle(),			"GBuffer(Specular)"		);
-		_debugUtils.setObjectName(_attachments[2].imageView->getImageViewHandle(),	"GBuffer(Specular) View");
-		_debugUtils.setObjectName(_attachments[3].image->getImageHandle(),			"GBuffer(Emission)"		);
-		_debugUtils.setObjectName(_attachments[3].imageView->getImageViewHandle(),	"GBuffer(Emission) View");
-		_debugUtils.setObjectName(_attachments[4].image->getImageHandle(),			"GBuffer(Tangent)"		);
-		_debugUtils.setObjectName(_attachments[4].imageView->getImageViewHandle(),	"GBuffer(Tangent) View");
-		_debugUtils.setObjectName(_attachments[5].image->getImageHandle(),			"GBuffer(Depth)"		);
-		_debugUtils.setObjectName(_attachments[5].imageView->getImageViewHandle(),	"GBuffer(Depth) View"	);
+		const char* kFatNames[]	   = { "GBuffer(Diffuse)", "GBuffer(Normal)",		 "GBuffer(Specular)", "GBuffer(Emission)", "GBuffer(Tangent)" };
+		const char* kPackedNames[] = { "GBuffer(Diffuse)", "GBuffer(TangentFrame)", "GBuffer(Specular)", "GBuffer(Emission)" };
+		for (size_t i = 0; i < _attachments.size() - 1; ++i)
+		{
+			const std::string name = _bPackedGBuffer ? kPackedNames[i] : kFatNames[i];
+			_debugUtils.setObjectName(_attachments[i].image->getImageHandle(),			name.c_str());
+			_debugUtils.setObjectName(_attachments[i].imageView->getImageViewHandle(),	(name + " View").c_str());
+		}
+		_debugUtils.setObjectName(_attachments.back().image->getImageHandle(),			"GBuffer(Depth)"		);
+		_debugUtils.setObjectName(_attachments.back().imageView->getImageViewHandle(),	"GBuffer(Depth) View"	);
+		_debugUtils.setObjectName(_visibilityAttachment.image->getImageHandle(),		"GBuffer(Visibility)"	);
+		_debugUtils.setObjectName(_visibilityAttachment.imageView->getImageViewHandle(), "GBuffer(Visibility) View");
 		_debugUtils.setObjectName(_colorSampler->getSamplerHandle(),				"GBuffer Sampler"		);
 #endif
 
@@ -228,7 +442,21 @@ namespace vfs
 	{
 		assert(_attachments.empty() == false); // snowapril : Attachments must be filled first
 		_renderPass.reset();
+		_resumeRenderPass.reset();
+
+		// snowapril : resume pass is compatible with the first one, so both share the framebuffer
+		_renderPass			= createGBufferRenderPass(false);
+		_resumeRenderPass	= createGBufferRenderPass(true);
+
+		_visibilityRenderPass.reset();
+		_visibilityResumeRenderPass.reset();
+		_visibilityRenderPass		= createVisibilityRenderPass(false);
+		_visibilityResumeRenderPass = createVisibilityRenderPass(true);
+		return *this;
+	}
 
+	RenderPassPtr GBufferPass::createGBufferRenderPass(bool bResume) const
+	{
 		uint32_t attachmentOffset = 0;
 
 		std::vector<VkAttachmentDescription> attachmentDesc;
@@ -240,24 +468,25 @@ namespace vfs
 			VkAttachmentDescription tempDesc = {};
 			tempDesc.format			= _attachments[i].image->getImageFormat();
 			tempDesc.samples		= VK_SAMPLE_COUNT_1_BIT; // getMaximumSampleCounts(_device);
-			tempDesc.loadOp			= VK_ATTACHMENT_LOAD_OP_CLEAR;
+			tempDesc.loadOp			= bResume ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR;
 			tempDesc.storeOp		= VK_ATTACHMENT_STORE_OP_STORE;
 			tempDesc.stencilLoadOp	= VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 			tempDesc.stencilStoreOp	= VK_ATTACHMENT_STORE_OP_DONT_CARE;
-			tempDesc.initialLayout	= VK_IMAGE_LAYOUT_UNDEFINED;
 			if (i == _attachments.size() - 1)
 			{
-				tempDesc.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+				tempDesc.initialLayout	= bResume ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
+				tempDesc.finalLayout	= VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
 			}
 			else
 			{
-				tempDesc.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+				tempDesc.initialLayout	= bResume ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
+				tempDesc.finalLayout	= VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 				colorAttachmentRefs.push_back({ attachmentOffset++, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL });
 			}
 			attachmentDesc.emplace_back(std::move(tempDesc));
 		}
 
-		std::vector<VkSubpassDependency> subpassDependencies(2, VkSubpassDependency{});
+		std::vector<VkSubpassDependency> subpassDependencies(4, VkSubpassDependency{});
 		subpassDependencies[0].srcSubpass		= VK_SUBPASS_EXTERNAL;
 		subpassDependencies[0].dstSubpass		= 0;
 		subpassDependencies[0].srcStageMask		= VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
@@ -274,6 +503,23 @@ namespace vfs
 		subpassDependencies[1].dstAccessMask	= VK_ACCESS_MEMORY_READ_BIT;
 		subpassDependencies[1].dependencyFlags	= VK_DEPENDENCY_BY_REGION_BIT;
 
+		// Depth is reduced into the Hi-Z pyramid between the first pass and the resume pass
+		subpassDependencies[2].srcSubpass		= VK_SUBPASS_EXTERNAL;
+		subpassDependencies[2].dstSubpass		= 0;
+		subpassDependencies[2].srcStageMask		= VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+		subpassDependencies[2].srcAccessMask	= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		subpassDependencies[2].dstStageMask		= VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+		subpassDependencies[2].dstAccessMask	= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		subpassDependencies[2].dependencyFlags	= 0;
+
+		subpassDependencies[3].srcSubpass		= 0;
+		subpassDependencies[3].dstSubpass		= VK_SUBPASS_EXTERNAL;
+		subpassDependencies[3].srcStageMask		= VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+		subpassDependencies[3].srcAccessMask	= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		subpassDependencies[3].dstStageMask		= VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+		subpassDependencies[3].dstAccessMask	= VK_ACCESS_SHADER_READ_BIT;
+		subpassDependencies[3].dependencyFlags	= 0;
+
 		VkAttachmentReference depthAttachmentRef = {};
 		depthAttachmentRef.layout		= VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 		depthAttachmentRef.attachment	= attachmentOffset++;
@@ -284,9 +530,78 @@ namespace vfs
 		subpassDesc.pDepthStencilAttachment = &depthAttachmentRef;
 		subpassDesc.pipelineBindPoint		= VK_PIPELINE_BIND_POINT_GRAPHICS;
 
-		_renderPass = std::make_shared<RenderPass>();
-		assert(_renderPass->initialize(_device, attachmentDesc, subpassDependencies, { subpassDesc }));
-		return *this;
+		RenderPassPtr renderPass = std::make_shared<RenderPass>();
+		assert(renderPass->initialize(_device, attachmentDesc, subpassDependencies, { subpassDesc }));
+		return renderPass;
+	}
+
+	RenderPassPtr GBufferPass::createVisibilityRenderPass(bool bResume) const
+	{
+		std::vector<VkAttachmentDescription> attachmentDesc(2, VkAttachmentDescription{});
+		attachmentDesc[0].format			= _visibilityAttachment.image->getImageFormat();
+		attachmentDesc[0].samples			= VK_SAMPLE_COUNT_1_BIT;
+		attachmentDesc[0].loadOp			= bResume ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR;
+		attachmentDesc[0].storeOp			= VK_ATTACHMENT_STORE_OP_STORE;
+		attachmentDesc[0].stencilLoadOp		= VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		attachmentDesc[0].stencilStoreOp	= VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		attachmentDesc[0].initialLayout		= bResume ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_UNDEFINED;
+		attachmentDesc[0].finalLayout		= VK_IMAGE_LAYOUT_GENERAL;
+
+		// snowapril : depth is shared with GBuffer path so Hi-Z pyramid and later passes see the same depth
+		attachmentDesc[1]					= attachmentDesc[0];
+		attachmentDesc[1].format			= _attachments.back().image->getImageFormat();
+		attachmentDesc[1].initialLayout		= bResume ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
+		attachmentDesc[1].finalLayout		= VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+
+		std::vector<VkSubpassDependency> subpassDependencies(4, VkSubpassDependency{});
+		subpassDependencies[0].srcSubpass		= VK_SUBPASS_EXTERNAL;
+		subpassDependencies[0].dstSubpass		= 0;
+		subpassDependencies[0].srcStageMask		= VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+		subpassDependencies[0].srcAccessMask	= VK_ACCESS_MEMORY_READ_BIT;
+		subpassDependencies[0].dstStageMask		= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		subpassDependencies[0].dstAccessMask	= VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		subpassDependencies[0].dependencyFlags	= VK_DEPENDENCY_BY_REGION_BIT;
+
+		// Resolve of the last frame must be done reading visibility before it is cleared
+		subpassDependencies[1].srcSubpass		= VK_SUBPASS_EXTERNAL;
+		subpassDependencies[1].dstSubpass		= 0;
+		subpassDependencies[1].srcStageMask		= VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+		subpassDependencies[1].srcAccessMask	= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		subpassDependencies[1].dstStageMask		= VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT |
+												  VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		subpassDependencies[1].dstAccessMask	= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+												  VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		subpassDependencies[1].dependencyFlags	= 0;
+
+		subpassDependencies[2].srcSubpass		= 0;
+		subpassDependencies[2].dstSubpass		= VK_SUBPASS_EXTERNAL;
+		subpassDependencies[2].srcStageMask		= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		subpassDependencies[2].srcAccessMask	= VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		subpassDependencies[2].dstStageMask		= VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+		subpassDependencies[2].dstAccessMask	= VK_ACCESS_MEMORY_READ_BIT;
+		subpassDependencies[2].dependencyFlags	= VK_DEPENDENCY_BY_REGION_BIT;
+
+		// Visibility and depth are read by resolve, Hi-Z reduction and lighting passes
+		subpassDependencies[3].srcSubpass		= 0;
+		subpassDependencies[3].dstSubpass		= VK_SUBPASS_EXTERNAL;
+		subpassDependencies[3].srcStageMask		= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+		subpassDependencies[3].srcAccessMask	= VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		subpassDependencies[3].dstStageMask		= VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+		subpassDependencies[3].dstAccessMask	= VK_ACCESS_SHADER_READ_BIT;
+		subpassDependencies[3].dependencyFlags	= 0;
+
+		VkAttachmentReference colorAttachmentRef = { 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+		VkAttachmentReference depthAttachmentRef = { 1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+
+		VkSubpassDescription subpassDesc = {};
+		subpassDesc.colorAttachmentCount	= 1;
+		subpassDesc.pColorAttachments		= &colorAttachmentRef;
+		subpassDesc.pDepthStencilAttachment = &depthAttachmentRef;
+		subpassDesc.pipelineBindPoint		= VK_PIPELINE_BIND_POINT_GRAPHICS;
+
+		RenderPassPtr renderPass = std::make_shared<RenderPass>();
+		assert(renderPass->initialize(_device, attachmentDesc, subpassDependencies, { subpassDesc }));
+		return renderPass;
 	}
 
 	GBufferPass& GBufferPass::createFramebuffer(void)
@@ -300,6 +615,11 @@ namespace vfs
 			imageViews[i] = _attachments[i].imageView->getImageViewHandle();
 		}
 		_framebuffer = std::make_shared<Framebuffer>(_device, imageViews, _renderPass->getHandle(), _gbufferResolution);
+
+		_visibilityFramebuffer.reset();
+		_visibilityFramebuffer = std::make_shared<Framebuffer>(_device, std::vector<VkImageView>{
+			_visibilityAttachment.imageView->getImageViewHandle(), _attachments.back().imageView->getImageViewHandle()
+		}, _visibilityRenderPass->getHandle(), _gbufferResolution);
 		return *this;
 	}
 
@@ -312,7 +632,7 @@ namespace vfs
 		_pipelineLayout->initialize(
 			_device, 
 			{ globalDescLayout, sceneManager->getDescriptorLayout() }, 
-			{ sceneManager->getDefaultPushConstant() }
+			{}
 		);
 
 		PipelineConfig config;
@@ -358,9 +678,118 @@ namespace vfs
 		// }
 
 		_pipeline = std::make_shared<GraphicsPipeline>(_device);
-		_pipeline->attachShaderModule(VK_SHADER_STAGE_VERTEX_BIT,	"Shaders/gBufferPass.vert.spv", nullptr);
-		_pipeline->attachShaderModule(VK_SHADER_STAGE_FRAGMENT_BIT, "Shaders/gBufferPass.frag.spv", nullptr);
+		_pipeline->attachShaderModule(VK_SHADER_STAGE_VERTEX_BIT,	"Shaders/gBufferPass.vert.spv", sceneManager->getVertexSpecializationInfo());
+		_pipeline->attachShaderModule(VK_SHADER_STAGE_FRAGMENT_BIT, "Shaders/gBufferPass.frag.spv", &_gbufferSpecInfo);
 		_pipeline->createPipeline(&config);
+
+		// Same vertex shader keeps depth of both variants bit identical (invariant gl_Position)
+		config.depthStencilInfo.depthWriteEnable	= VK_FALSE;
+		config.depthStencilInfo.depthCompareOp		= VK_COMPARE_OP_EQUAL;
+		_depthEqualPipeline = std::make_shared<GraphicsPipeline>(_device);
+		_depthEqualPipeline->attachShaderModule(VK_SHADER_STAGE_VERTEX_BIT,	  "Shaders/gBufferPass.vert.spv", sceneManager->getVertexSpecializationInfo());
+		_depthEqualPipeline->attachShaderModule(VK_SHADER_STAGE_FRAGMENT_BIT, "Shaders/gBufferPass.frag.spv", &_gbufferSpecInfo);
+		_depthEqualPipeline->createPipeline(&config);
+
+		// Prepass only evaluates alpha test of masked materials, every color write is masked out
+		config.depthStencilInfo.depthWriteEnable	= VK_TRUE;
+		config.depthStencilInfo.depthCompareOp		= VK_COMPARE_OP_LESS;
+		for (VkPipelineColorBlendAttachmentState& blendState : config.colorBlendAttachments)
+		{
+			blendState.colorWriteMask = 0;
+		}
+		_depthPrepassPipeline = std::make_shared<GraphicsPipeline>(_device);
+		_depthPrepassPipeline->attachShaderModule(VK_SHADER_STAGE_VERTEX_BIT,	"Shaders/gBufferPass.vert.spv", sceneManager->getVertexSpecializationInfo());
+		_depthPrepassPipeline->attachShaderModule(VK_SHADER_STAGE_FRAGMENT_BIT, "Shaders/gBufferPrepass.frag.spv", nullptr);
+		_depthPrepassPipeline->createPipeline(&config);
+
+		// Visibility pipeline writes one integer attachment with the same depth states as GBuffer pipeline
+		config.colorBlendAttachments.assign(1, colorBlend);
+		config.colorBlendInfo.attachmentCount	= 1;
+		config.colorBlendInfo.pAttachments		= config.colorBlendAttachments.data();
+		config.renderPass = _visibilityRenderPass->getHandle();
+		_visibilityPipeline = std::make_shared<GraphicsPipeline>(_device);
+		_visibilityPipeline->attachShaderModule(VK_SHADER_STAGE_VERTEX_BIT,	"Shaders/visibilityBuffer.vert.spv", sceneManager->getVertexSpecializationInfo());
+		_visibilityPipeline->attachShaderModule(VK_SHADER_STAGE_FRAGMENT_BIT, "Shaders/visibilityBuffer.frag.spv", nullptr);
+		_visibilityPipeline->createPipeline(&config);
+
+		if (_bVisibilitySupported)
+		{
+			createResolvePipeline(sceneManager);
+		}
+		return *this;
+	}
+
+	void GBufferPass::createResolvePipeline(SceneManager* sceneManager)
+	{
+		const GeometryPoolPtr& geometryPool = sceneManager->getGeometryPool();
+
+		std::vector<VkDescriptorPoolSize> poolSizes = {
+			{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2 + GeometryPool::kNumVertexStreams},
+			{VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,	static_cast<uint32_t>(_attachments.size())},
+		};
+		_resolveDescPool = std::make_shared<DescriptorPool>(_device, poolSizes, 1, 0);
+
+		// Binding layout follows visibilityResolve.comp, geometry streams first and images after them
+		_resolveDescLayout = std::make_shared<DescriptorSetLayout>(_device);
+		uint32_t binding = 0;
+		for (; binding < 2 + GeometryPool::kNumVertexStreams; ++binding)
+		{
+			_resolveDescLayout->addBinding(VK_SHADER_STAGE_COMPUTE_BIT, binding, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 0);
+		}
+		for (size_t i = 0; i < _attachments.size(); ++i, ++binding)
+		{
+			_resolveDescLayout->addBinding(VK_SHADER_STAGE_COMPUTE_BIT, binding, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 0);
+		}
+		_resolveDescLayout->createDescriptorSetLayout(0);
+
+		_resolveDescSet = std::make_shared<DescriptorSet>(_device, _resolveDescPool, _resolveDescLayout, 1);
+		_resolveDescSet->updateStorageBuffer({ sceneManager->getBindlessTable()->getIndirectBuffer() }, 0, 1);
+		_resolveDescSet->updateStorageBuffer({ geometryPool->getIndexBuffer() }, 1, 1);
+		for (uint32_t stream = 0; stream < GeometryPool::kNumVertexStreams; ++stream)
+		{
+			_resolveDescSet->updateStorageBuffer({ geometryPool->getVertexBuffer(stream) }, 2 + stream, 1);
+		}
+
+		// snowapril : visibility first, then every color attachment in GBuffer order
+		binding = 2 + GeometryPool::kNumVertexStreams;
+		VkDescriptorImageInfo imageInfo = {};
+		imageInfo.imageView		= _visibilityAttachment.imageView->getImageViewHandle();
+		imageInfo.imageLayout	= VK_IMAGE_LAYOUT_GENERAL;
+		_resolveDescSet->updateImage({ imageInfo }, binding++, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE);
+		for (size_t i = 0; i < _attachments.size() - 1; ++i)
+		{
+			imageInfo.imageView = _attachments[i].imageView->getImageViewHandle();
+			_resolveDescSet->updateImage({ imageInfo }, binding++, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE);
+		}
+
+		VkPushConstantRange pushConstRange = {};
+		pushConstRange.offset		= 0;
+		pushConstRange.size			= sizeof(ResolvePushConstant);
+		pushConstRange.stageFlags	= VK_SHADER_STAGE_COMPUTE_BIT;
+
+		_resolvePipelineLayout = std::make_shared<PipelineLayout>();
+		_resolvePipelineLayout->initialize(_device, { sceneManager->getDescriptorLayout(), _resolveDescLayout }, { pushConstRange });
+
+		PipelineConfig config;
+		config.pipelineLayout = _resolvePipelineLayout->getLayoutHandle();
+
+		_resolvePipeline = std::make_shared<ComputePipeline>();
+		_resolvePipeline->initialize(_device);
+		// snowapril : storage image formats can not be specialized, so each layout has its own resolve shader
+		const char* resolveShader = _bPackedGBuffer ? "Shaders/visibilityResolvePacked.comp.spv" : "Shaders/visibilityResolve.comp.spv";
+		_resolvePipeline->attachShaderModule(VK_SHADER_STAGE_COMPUTE_BIT, resolveShader, sceneManager->getVertexSpecializationInfo());
+		_resolvePipeline->createPipeline(&config);
+	}
+
+	GBufferPass& GBufferPass::createHiZPyramid(void)
+	{
+		assert(_attachments.empty() == false); // snowapril : Depth attachment must be created first
+		const DrawCuller* drawCuller = _renderPassManager->get<DrawCuller>("DrawCuller");
+
+		_hiZPyramid = std::make_unique<HiZPyramid>(_device);
+		_hiZPyramid->createPyramid(_gbufferResolution)
+					.createDescriptors(_attachments.back().imageView.get(), drawCuller->getPyramidDescLayout())
+					.createPipeline();
 		return *this;
 	}
 
@@ -4,9 +4,13 @@
 #define VFS_GBUFFER_PASS_H
 
 #include <RenderPass/RenderPassBase.h>
+#include <Util/EngineConfig.h>
 
 namespace vfs
 {
+	class HiZPyramid;
+	class SceneManager;
+
 	class GBufferPass : public RenderPassBase
 	{
 	public:
@@ -16,6 +20,13 @@ namespace vfs
 							 const DescriptorSetLayoutPtr& globalDescLayout);
 		~GBufferPass();
 
+		//! Visibility texel keeps 14 bits of draw table index above 18 bits of triangle index (visibility.glsl)
+		static constexpr uint32_t kVisibilityMaxDraws = 1u << 14;
+		//! VISIBILITY_TRIANGLE_BITS of visibility.glsl, larger draws would alias triangle indices
+		static constexpr uint32_t kVisibilityMaxTriangles = 1u << 18;
+		//! PACKED_GBUFFER of gbufferPacking.glsl, above constants of every shader reading the GBuffer
+		static constexpr uint32_t kPackedGBufferConstantID = 8;
+
 	public:
 		bool initializeGBufferPass	(VkExtent2D resolution,
 									 const DescriptorSetLayoutPtr& globalDescLayout);
@@ -25,6 +36,8 @@ namespace vfs
 		GBufferPass& createRenderPass		(void);
 		GBufferPass& createFramebuffer		(void);
 		GBufferPass& createPipeline			(const DescriptorSetLayoutPtr& globalDescLayout);
+		//! Draw culler must be registered to the render pass manager first
+		GBufferPass& createHiZPyramid		(void);
 		
 		void drawGUI		(void) override;
 		void drawDebugInfo	(void) override;
@@ -40,15 +53,67 @@ namespace vfs
 		{
 			return _colorSampler;
 		}
+		//! Specialization of shaders reading or writing the GBuffer, also shared as "GBufferSpecializationInfo"
+		inline const VkSpecializationInfo* getSpecializationInfo(void) const
+		{
+			return &_gbufferSpecInfo;
+		}
+		//! Path the last frame was drawn with, timing of each path is plotted separately
+		const char* getShadingPathName(void) const;
 	private:
 		void onBeginRenderPass	(const FrameLayout* frameLayout) override;
 		void onEndRenderPass	(const FrameLayout* frameLayout) override;
 		void onUpdate			(const FrameLayout* frameLayout) override;
 
+		//! Resume pass loads attachments written by the first pass instead of clearing them
+		RenderPassPtr createGBufferRenderPass(bool bResume) const;
+		//! Visibility pass rasterizes draw and triangle index only, sharing the depth attachment
+		RenderPassPtr createVisibilityRenderPass(bool bResume) const;
+		//! Begin render pass of the current path, resume pass loads attachments written by the first one
+		void beginGBufferPass	(const FrameLayout* frameLayout, bool bResume);
+		//! Draw survivors of the view, preceded by depth only draws if depth prepass is enabled
+		void drawCulledView		(const FrameLayout* frameLayout, uint32_t viewIndex);
+		//! Reconstruct attributes of visible triangles and write the GBuffer the fat path would write
+		void cmdResolveVisibility(const FrameLayout* frameLayout);
+		void createResolvePipeline(SceneManager* sceneManager);
+
+		struct ResolvePushConstant
+		{
+			glm::mat4	viewProj;	// 64
+			glm::uvec2	resolution;	// 72
+		};
+
 	private:
 		SamplerPtr		_colorSampler;
 		VkExtent2D		_gbufferResolution{ 0, 0 };
 		FramebufferPtr	_framebuffer;
+		GraphicsPipelinePtr _depthPrepassPipeline;	// Writes depth only, color writes are masked
+		GraphicsPipelinePtr _depthEqualPipeline;	// GBuffer pipeline shading only the front most fragments
+		RenderPassPtr	_resumeRenderPass;	// Loads attachments to draw disoccluded primitives
+		FramebufferAttachment	_visibilityAttachment;		// R32 draw and triangle index
+		RenderPassPtr			_visibilityRenderPass;
+		RenderPassPtr			_visibilityResumeRenderPass;
+		FramebufferPtr			_visibilityFramebuffer;
+		GraphicsPipelinePtr		_visibilityPipeline;
+		DescriptorPoolPtr		_resolveDescPool;
+		DescriptorSetLayoutPtr	_resolveDescLayout;
+		DescriptorSetPtr		_resolveDescSet;
+		PipelineLayoutPtr		_resolvePipelineLayout;
+		ComputePipelinePtr		_resolvePipeline;
+		std::unique_ptr<HiZPyramid> _hiZPyramid;
+		uint32_t		_cullView			{ 0 };
+		uint32_t		_lateCullView		{ 0 };
+		bool			_bOcclusionCulling	{ true };
+		bool			_bDepthPrepass		{ false };
+		bool			_bVisibilityBuffer	{ false };
+		bool			_bVisibilityFrame	{ false };	// Path of the frame being recorded
+		bool			_bVisibilityWarned	{ false };
+		bool			_bVisibilitySupported { false };	// Every color attachment format supports storage writes
+		bool			_bPackedGBuffer		{ DEFAULT_PACKED_GBUFFER };
+		uint32_t		_colorBytesPerPixel	{ 0 };
+		VkBool32					_bPackedSpecConstant{ VK_FALSE };
+		VkSpecializationMapEntry	_gbufferSpecEntry	{ };
+		VkSpecializationInfo		_gbufferSpecInfo	{ };
 
 		// Debug Info
 		std::vector<VkDescriptorSet> _gbufferDebugDescSets;
@@ -0,0 +1,251 @@
+// Author : Jihong Shin (snowapril)
+
+#include <pch.h>
+#include <RenderPass/HiZPyramid.h>
+#include <VulkanFramework/Device.h>
+#include <VulkanFramework/DebugUtils.h>
+#include <VulkanFramework/Descriptors/DescriptorPool.h>
+#include <VulkanFramework/Descriptors/DescriptorSet.h>
+#include <VulkanFramework/Descriptors/DescriptorSetLayout.h>
+#include <VulkanFramework/Images/Image.h>
+#include <VulkanFramework/Images/ImageView.h>
+#include <VulkanFramework/Images/Sampler.h>
+#include <VulkanFramework/Pipelines/ComputePipeline.h>
+#include <VulkanFramework/Pipelines/PipelineLayout.h>
+#include <VulkanFramework/Pipelines/PipelineConfig.h>
+#include <imgui/imgui.h>
+#include <imgui/imgui_impl_vulkan.h>
+#include <algorithm>
+
+namespace vfs
+{
+	namespace
+	{
+		constexpr uint32_t kReductionGroupSize = 8; // local_size_x and local_size_y of hiZReduction.comp
+	}
+
+	HiZPyramid::HiZPyramid(DevicePtr device)
+		: _device(device)
+	{
+		// Do nothing
+	}
+
+	HiZPyramid::~HiZPyramid()
+	{
+		destroyHiZPyramid();
+	}
+
+	void HiZPyramid::destroyHiZPyramid(void)
+	{
+		_levelDebugDescSets.clear();
+		_reductionPipeline.reset();
+		_pipelineLayout.reset();
+		_samplingDescSet.reset();
+		_reductionDescSets.clear();
+		_reductionDescLayout.reset();
+		_descPool.reset();
+		_pyramidSampler.reset();
+		_levelViews.clear();
+		_pyramidView.reset();
+		_pyramidImage.reset();
+		_device.reset();
+	}
+
+	HiZPyramid& HiZPyramid::createPyramid(VkExtent2D depthResolution)
+	{
+		// snowapril : levels are halved until both sides reach one texel, starting from half resolution
+		_depthResolution = depthResolution;
+		_numLevels		 = 0;
+		for (uint32_t size = std::max(depthResolution.width, depthResolution.height); size > 1; size >>= 1)
+		{
+			++_numLevels;
+		}
+		assert(_numLevels > 0);
+
+		VkImageCreateInfo imageInfo = Image::GetDefaultImageCreateInfo();
+		imageInfo.extent	= { std::max(depthResolution.width >> 1, 1u), std::max(depthResolution.height >> 1, 1u), 1 };
+		imageInfo.format	= VK_FORMAT_R32_SFLOAT;
+		imageInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageInfo.mipLevels = _numLevels;
+		imageInfo.usage		= VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+		_pyramidImage = std::make_shared<Image>(_device->getMemoryAllocator(), VMA_MEMORY_USAGE_GPU_ONLY, imageInfo);
+		_pyramidView  = std::make_shared<ImageView>(_device, _pyramidImage, VK_IMAGE_ASPECT_COLOR_BIT, _numLevels);
+
+		_levelViews.clear();
+		for (uint32_t level = 0; level < _numLevels; ++level)
+		{
+			VkImageViewCreateInfo levelViewInfo = ImageView::GetDefaultImageViewInfo();
+			levelViewInfo.format						= VK_FORMAT_R32_SFLOAT;
+			levelViewInfo.viewType						= VK_IMAGE_VIEW_TYPE_2D;
+			levelViewInfo.subresourceRange.aspectMask	= VK_IMAGE_ASPECT_COLOR_BIT;
+			levelViewInfo.subresourceRange.baseMipLevel = level;
+			_levelViews.emplace_back(std::make_shared<ImageView>(_device, _pyramidImage, levelViewInfo));
+		}
+
+		// Texels are fetched directly, sampler state only has to cover every level
+		_pyramidSampler = std::make_shared<Sampler>(_device, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, VK_FILTER_NEAREST,
+													static_cast<float>(_numLevels));
+
+		DebugUtils debugUtil(_device);
+		debugUtil.setObjectName(_pyramidImage->getImageHandle(), "HiZ Pyramid");
+		debugUtil.setObjectName(_pyramidView->getImageViewHandle(), "HiZ Pyramid View");
+		_bInitialLayout = true;
+		_bValid			= false;
+		return *this;
+	}
+
+	HiZPyramid& HiZPyramid::createDescriptors(const ImageView* depthImageView, const DescriptorSetLayoutPtr& samplingLayout)
+	{
+		assert(_pyramidImage != nullptr); // snowapril : Pyramid must be created first
+
+		std::vector<VkDescriptorPoolSize> poolSizes = {
+			{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, _numLevels + 1},
+			{VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,			_numLevels * 2},
+		};
+		_descPool = std::make_shared<DescriptorPool>(_device, poolSizes, _numLevels + 1, 0);
+
+		_reductionDescLayout = std::make_shared<DescriptorSetLayout>(_device);
+		_reductionDescLayout->addBinding(VK_SHADER_STAGE_COMPUTE_BIT, 0, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 0);
+		_reductionDescLayout->addBinding(VK_SHADER_STAGE_COMPUTE_BIT, 1, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,		   0);
+		_reductionDescLayout->addBinding(VK_SHADER_STAGE_COMPUTE_BIT, 2, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,		   0);
+		_reductionDescLayout->createDescriptorSetLayout(0);
+
+		VkDescriptorImageInfo depthInfo = {};
+		depthInfo.sampler		= _pyramidSampler->getSamplerHandle();
+		depthInfo.imageView		= depthImageView->getImageViewHandle();
+		depthInfo.imageLayout	= VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+
+		// snowapril : level zero reads depth, its source level binding is left pointing at itself unused
+		_reductionDescSets.clear();
+		for (uint32_t level = 0; level < _numLevels; ++level)
+		{
+			VkDescriptorImageInfo srcInfo = {};
+			srcInfo.imageView	= _levelViews[level > 0 ? level - 1 : 0]->getImageViewHandle();
+			srcInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+			VkDescriptorImageInfo dstInfo = {};
+			dstInfo.imageView	= _levelViews[level]->getImageViewHandle();
+			dstInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+			DescriptorSetPtr descSet = std::make_shared<DescriptorSet>(_device, _descPool, _reductionDescLayout, 1);
+			descSet->updateImage({ depthInfo }, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+			descSet->updateImage({ srcInfo	 }, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE);
+			descSet->updateImage({ dstInfo	 }, 2, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE);
+			_reductionDescSets.emplace_back(std::move(descSet));
+		}
+
+		VkDescriptorImageInfo pyramidInfo = {};
+		pyramidInfo.sampler		= _pyramidSampler->getSamplerHandle();
+		pyramidInfo.imageView	= _pyramidView->getImageViewHandle();
+		pyramidInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+		_samplingDescSet = std::make_shared<DescriptorSet>(_device, _descPool, samplingLayout, 1);
+		_samplingDescSet->updateImage({ pyramidInfo }, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+
+		_levelDebugDescSets.clear();
+		for (const ImageViewPtr& levelView : _levelViews)
+		{
+			_levelDebugDescSets.push_back(ImGui_ImplVulkan_AddTexture(
+				_pyramidSampler->getSamplerHandle(), levelView->getImageViewHandle(), VK_IMAGE_LAYOUT_GENERAL
+			));
+		}
+		return *this;
+	}
+
+	HiZPyramid& HiZPyramid::createPipeline(void)
+	{
+		assert(_reductionDescLayout != nullptr); // snowapril : Descriptor set layout must be initialized first
+
+		VkPushConstantRange pushConstRange = {};
+		pushConstRange.offset		= 0;
+		pushConstRange.size			= sizeof(ReductionPushConstant);
+		pushConstRange.stageFlags	= VK_SHADER_STAGE_COMPUTE_BIT;
+
+		_pipelineLayout = std::make_shared<PipelineLayout>();
+		_pipelineLayout->initialize(_device, { _reductionDescLayout }, { pushConstRange });
+
+		PipelineConfig config;
+		config.pipelineLayout = _pipelineLayout->getLayoutHandle();
+
+		_reductionPipeline = std::make_shared<ComputePipeline>();
+		_reductionPipeline->initialize(_device);
+		_reductionPipeline->attachShaderModule(VK_SHADER_STAGE_COMPUTE_BIT, "Shaders/hiZReduction.comp.spv", nullptr);
+		_reductionPipeline->createPipeline(&config);
+
+		return *this;
+	}
+
+	void HiZPyramid::cmdBuild(CommandBuffer cmdBuffer, const glm::mat4& viewProj)
+	{
+		// Depth written by the render pass is read by the first level,
+		// earlier culling and debug view of the pyramid must be done reading it before it is overwritten
+		VkMemoryBarrier depthBarrier = {};
+		depthBarrier.sType			= VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		depthBarrier.pNext			= nullptr;
+		depthBarrier.srcAccessMask	= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		depthBarrier.dstAccessMask	= VK_ACCESS_SHADER_READ_BIT;
+
+		VkImageMemoryBarrier pyramidBarrier = _pyramidImage->generateMemoryBarrier(
+			VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_ASPECT_COLOR_BIT,
+			_bInitialLayout ? VK_IMAGE_LAYOUT_UNDEFINED : VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL
+		);
+		pyramidBarrier.subresourceRange.levelCount = _numLevels;
+		cmdBuffer.pipelineBarrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+								  VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+								  VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, { depthBarrier }, {}, { pyramidBarrier });
+		_bInitialLayout = false;
+
+		cmdBuffer.bindPipeline(_reductionPipeline);
+		glm::ivec2 srcSize(_depthResolution.width, _depthResolution.height);
+		for (uint32_t level = 0; level < _numLevels; ++level)
+		{
+			ReductionPushConstant pushConst = {};
+			pushConst.srcSize		= srcSize;
+			pushConst.dstSize		= glm::max(srcSize / 2, glm::ivec2(1));
+			pushConst.bFromDepth	= level == 0 ? 1 : 0;
+
+			cmdBuffer.bindDescriptorSets(VK_PIPELINE_BIND_POINT_COMPUTE, _pipelineLayout->getLayoutHandle(),
+										 0, { _reductionDescSets[level] }, {});
+			cmdBuffer.pushConstants(_pipelineLayout->getLayoutHandle(), VK_SHADER_STAGE_COMPUTE_BIT,
+									0, sizeof(ReductionPushConstant), &pushConst);
+			cmdBuffer.dispatch((pushConst.dstSize.x + kReductionGroupSize - 1) / kReductionGroupSize,
+							   (pushConst.dstSize.y + kReductionGroupSize - 1) / kReductionGroupSize, 1);
+
+			// Next level reads this one, occlusion culling reads every level after the last one
+			VkImageMemoryBarrier levelBarrier = _pyramidImage->generateMemoryBarrier(
+				VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_ASPECT_COLOR_BIT,
+				VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL
+			);
+			levelBarrier.subresourceRange.baseMipLevel = level;
+			cmdBuffer.pipelineBarrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+									  VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+									  0, {}, {}, { levelBarrier });
+			srcSize = pushConst.dstSize;
+		}
+
+		_viewProj = viewProj;
+		_bValid	  = true;
+	}
+
+	void HiZPyramid::invalidate(void)
+	{
+		_bValid = false;
+	}
+
+	void HiZPyramid::drawDebugInfo(const char* name)
+	{
+		if (ImGui::TreeNode(name))
+		{
+			if (_bValid)
+			{
+				ImGui::SliderInt("Level", &_debugLevel, 0, static_cast<int>(_numLevels) - 1);
+				const float aspect = static_cast<float>(_depthResolution.height) / _depthResolution.width;
+				ImGui::Image(_levelDebugDescSets[_debugLevel], ImVec2(256.0f, 256.0f * aspect));
+			}
+			else
+			{
+				ImGui::Text("Pyramid is not built");
+			}
+			ImGui::TreePop();
+		}
+	}
+};
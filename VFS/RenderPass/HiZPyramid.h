@@ -0,0 +1,87 @@
+// Author : Jihong Shin (snowapril)
+
+#if !defined(VFS_HIZ_PYRAMID_H)
+#define VFS_HIZ_PYRAMID_H
+
+#include <pch.h>
+#include <VulkanFramework/Commands/CommandBuffer.h>
+
+namespace vfs
+{
+	//! Farthest depth pyramid of a depth attachment, reduced with one compute dispatch per level.
+	//! Level zero is half of the depth resolution, the last texel of an odd sized level also
+	//! covers the remaining texel so that every level conservatively bounds the depth below it.
+	//! Pyramid stays in general layout, sampled by occlusion culling and written by reduction.
+	class HiZPyramid : NonCopyable
+	{
+	public:
+		explicit HiZPyramid(DevicePtr device);
+				~HiZPyramid();
+
+	public:
+		HiZPyramid& createPyramid		(VkExtent2D depthResolution);
+		//! Sampling set of the pyramid is allocated with the layout given by occlusion culling
+		HiZPyramid& createDescriptors	(const ImageView* depthImageView, const DescriptorSetLayoutPtr& samplingLayout);
+		HiZPyramid& createPipeline		(void);
+		void		destroyHiZPyramid	(void);
+
+		//! Reduce depth rendered with the given view projection, depth must be in depth read only layout
+		void cmdBuild		(CommandBuffer cmdBuffer, const glm::mat4& viewProj);
+		//! Early occlusion test passes every draw until the pyramid is built again
+		void invalidate		(void);
+		void drawDebugInfo	(const char* name);
+
+		inline bool isValid(void) const
+		{
+			return _bValid;
+		}
+		inline const glm::mat4& getViewProjection(void) const
+		{
+			return _viewProj;
+		}
+		inline VkExtent2D getDepthResolution(void) const
+		{
+			return _depthResolution;
+		}
+		inline uint32_t getNumLevels(void) const
+		{
+			return _numLevels;
+		}
+		inline DescriptorSetPtr getSamplingDescriptorSet(void) const
+		{
+			return _samplingDescSet;
+		}
+
+	private:
+		struct ReductionPushConstant
+		{
+			glm::ivec2 srcSize;		// 8
+			glm::ivec2 dstSize;		// 16
+			uint32_t   bFromDepth;	// 20
+		};
+
+	private:
+		DevicePtr					_device				{ nullptr };
+		ImagePtr					_pyramidImage		{ nullptr };
+		ImageViewPtr				_pyramidView		{ nullptr };	// Every level, sampled by occlusion culling
+		std::vector<ImageViewPtr>	_levelViews;						// One level each, written by reduction
+		SamplerPtr					_pyramidSampler		{ nullptr };
+		DescriptorPoolPtr			_descPool			{ nullptr };
+		DescriptorSetLayoutPtr		_reductionDescLayout{ nullptr };
+		std::vector<DescriptorSetPtr> _reductionDescSets;				// Per level, reading the level below it
+		DescriptorSetPtr			_samplingDescSet	{ nullptr };
+		PipelineLayoutPtr			_pipelineLayout		{ nullptr };
+		ComputePipelinePtr			_reductionPipeline	{ nullptr };
+		glm::mat4					_viewProj			{ 1.0f };
+		VkExtent2D					_depthResolution	{ 0, 0 };
+		uint32_t					_numLevels			{ 0 };
+		bool						_bValid				{ false };
+		bool						_bInitialLayout		{ true };	// Pyramid is not transitioned to general layout yet
+
+		// Debug Info
+		std::vector<VkDescriptorSet> _levelDebugDescSets;
+		int							_debugLevel			{ 0 };
+	};
+};
+
+#endif
@@ -16,15 +16,16 @@
 #include <VulkanFramework/Device.h>
 #include <VulkanFramework/Buffers/Buffer.h>
 #include <VulkanFramework/Buffers/BufferView.h>
+#include <VulkanFramework/Buffers/UploadManager.h>
 #include <VulkanFramework/Queue.h>
 #include <VulkanFramework/Commands/CommandPool.h>
 #include <Counter.h>
 
 namespace vfs
 {
-	OctreeBuilder::OctreeBuilder(DevicePtr device, const CommandPoolPtr& cmdPool, std::shared_ptr<SparseVoxelizer> voxelizer)
+	OctreeBuilder::OctreeBuilder(DevicePtr device, const UploadManagerPtr& uploadManager, std::shared_ptr<SparseVoxelizer> voxelizer)
 	{
-		assert(initialize(device, cmdPool, voxelizer));
+		assert(initialize(device, uploadManager, voxelizer));
 	}
 
 	OctreeBuilder::~OctreeBuilder()
@@ -53,13 +54,13 @@ namespace vfs
 		_voxelizer.reset();
 	}
 
-	bool OctreeBuilder::initialize(DevicePtr device, const CommandPoolPtr& cmdPool, std::shared_ptr<SparseVoxelizer> voxelizer)
+	bool OctreeBuilder::initialize(DevicePtr device, const UploadManagerPtr& uploadManager, std::shared_ptr<SparseVoxelizer> voxelizer)
 	{
 		_device		= device;
 		_voxelizer	= voxelizer;
 		_level		= _voxelizer->getLevel();
 
-		if (!initializeBuffers(cmdPool))
+		if (!initializeBuffers(uploadManager))
 		{
 			return false;
 		}
@@ -81,7 +82,7 @@ namespace vfs
 		return true;
 	}
 
-	bool OctreeBuilder::initializeBuffers(const CommandPoolPtr& cmdPool)
+	bool OctreeBuilder::initializeBuffers(const UploadManagerPtr& uploadManager)
 	{
 		const VmaAllocator allocator = _device->getMemoryAllocator();
 		
@@ -120,7 +121,8 @@ namespace vfs
 		{
 			return false;
 		}
-		_octreeNodeCounter->resetCounter(cmdPool);
+		_octreeNodeCounter->resetCounter(uploadManager);
+		uploadManager->submit();
 
 		VFS_INFO << "Octree node allocated : " << _numOctreeNodes / 1000 << " KB";
 		return true;
@@ -15,12 +15,12 @@ namespace vfs
 	{
 	public:
 		explicit OctreeBuilder() = default;
-		explicit OctreeBuilder(DevicePtr device, const CommandPoolPtr& cmdPool, std::shared_ptr<SparseVoxelizer> voxelizer);
+		explicit OctreeBuilder(DevicePtr device, const UploadManagerPtr& uploadManager, std::shared_ptr<SparseVoxelizer> voxelizer);
 				~OctreeBuilder();
 
 	public:
 		void destroyOctreeBuilder	(void);
-		bool initialize				(DevicePtr device, const CommandPoolPtr& cmdPool, std::shared_ptr<SparseVoxelizer> voxelizer);
+		bool initialize				(DevicePtr device, const UploadManagerPtr& uploadManager, std::shared_ptr<SparseVoxelizer> voxelizer);
 		void cmdBuild				(VkCommandBuffer cmdBuffer);
 		void transferOwnership		(VkCommandBuffer cmdBuffer, VkPipelineStageFlags srcStage, 
 									 VkPipelineStageFlags dstStage, uint32_t srcQueueFamily, 
@@ -40,7 +40,7 @@ namespace vfs
 			return _octreeBuffer;
 		}
 	private:
-		bool initializeBuffers			(const CommandPoolPtr& cmdPool);
+		bool initializeBuffers			(const UploadManagerPtr& uploadManager);
 		bool initializeDescriptors		(void);
 		bool initializePipelineLayout	(void);
 		bool initializePipelines		(void);
@@ -5,6 +5,7 @@
 #include <Camera.h>
 #include <VulkanFramework/Device.h>
 #include <VulkanFramework/Buffers/Buffer.h>
+#include <VulkanFramework/Buffers/UploadManager.h>
 #include <VulkanFramework/Descriptors/DescriptorPool.h>
 #include <VulkanFramework/Descriptors/DescriptorSetLayout.h>
 #include <VulkanFramework/Pipelines/GraphicsPipeline.h>
@@ -57,7 +58,7 @@ namespace vfs
 		return true;
 	}
 
-	void OctreeVisualizer::buildPointClouds(const CommandPoolPtr& cmdPool)
+	void OctreeVisualizer::buildPointClouds(const CommandPoolPtr& cmdPool, const UploadManagerPtr& uploadManager)
 	{
 		std::vector<glm::uvec2> nodeData;
 		_octreeBuilder->readOctreeNodes(cmdPool, &nodeData);
@@ -127,27 +128,7 @@ namespace vfs
 			VMA_MEMORY_USAGE_GPU_ONLY
 		);
 
-		Buffer stagingBuffer(allocator, sizeof(glm::uvec3) * _pointClouds.size(),
-							 VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY);
-		stagingBuffer.uploadData(_pointClouds.data(), sizeof(glm::uvec3) * _pointClouds.size());
-
-		CommandBuffer cmdBuffer(cmdPool->allocateCommandBuffer());
-		{
-			cmdBuffer.beginRecord(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
-
-			VkBufferCopy copyRegion = {};
-			copyRegion.size = sizeof(glm::uvec3) * _pointClouds.size();
-			copyRegion.srcOffset = 0;
-			copyRegion.dstOffset = 0;
-			cmdBuffer.copyBuffer(&stagingBuffer, _octreeVertexBuffer, { copyRegion });
-
-			cmdBuffer.endRecord();
-		}
-
-		Fence fence(_device, 1, 0);
-		cmdPool->getQueue()->submitCmdBuffer({ cmdBuffer }, &fence);
-
-		fence.waitForAllFences(UINT64_MAX);
+		uploadManager->uploadBuffer(_octreeVertexBuffer, _pointClouds.data(), sizeof(glm::uvec3) * _pointClouds.size(), 0);
 	}
 
 	void OctreeVisualizer::cmdDraw(const FrameLayout* frame)
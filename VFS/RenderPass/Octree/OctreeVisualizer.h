@@ -25,7 +25,7 @@ namespace vfs
 		void destroyOctreeVisualizer(void);
 		bool initialize				(DevicePtr device, CameraPtr camera, 
 									 std::shared_ptr<OctreeBuilder> builder, VkRenderPass renderPass);
-		void buildPointClouds		(const CommandPoolPtr& cmdPool);
+		void buildPointClouds		(const CommandPoolPtr& cmdPool, const UploadManagerPtr& uploadManager);
 		void cmdDraw				(const FrameLayout* frame);
 
 	private:
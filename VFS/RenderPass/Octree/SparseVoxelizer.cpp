@@ -5,6 +5,7 @@
 #include <Common/Logger.h>
 #include <VulkanFramework/Commands/CommandBuffer.h>
 #include <VulkanFramework/Commands/CommandPool.h>
+#include <VulkanFramework/Buffers/UploadManager.h>
 #include <VulkanFramework/Queue.h>
 #include <VulkanFramework/Images/Image.h>
 #include <VulkanFramework/Images/ImageView.h>
@@ -12,6 +13,7 @@
 #include <VulkanFramework/Device.h>
 #include <VulkanFramework/Pipelines/PipelineConfig.h>
 #include <VulkanFramework/Sync/Fence.h>
+#include <VulkanFramework/Sync/SubmissionScheduler.h>
 #include <VulkanFramework/RenderPass/RenderPass.h>
 #include <VulkanFramework/Pipelines/PipelineLayout.h>
 #include <VulkanFramework/Descriptors/DescriptorPool.h>
@@ -130,14 +132,14 @@ namespace vfs
 		// Light descriptor set
 		poolSizes = {
 			{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1},
-			{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2},
+			{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 2},
 		};
 		_lightDescriptorPool = std::make_shared<DescriptorPool>(_device, poolSizes, 1, 0);
 
 		_lightDescriptorLayout = std::make_shared<DescriptorSetLayout>(_device);
 		_lightDescriptorLayout->addBinding(VK_SHADER_STAGE_FRAGMENT_BIT, 0, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 0);
-		_lightDescriptorLayout->addBinding(VK_SHADER_STAGE_FRAGMENT_BIT, 1, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 0);
-		_lightDescriptorLayout->addBinding(VK_SHADER_STAGE_FRAGMENT_BIT, 2, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 0);
+		_lightDescriptorLayout->addBinding(VK_SHADER_STAGE_FRAGMENT_BIT, 1, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 0);
+		_lightDescriptorLayout->addBinding(VK_SHADER_STAGE_FRAGMENT_BIT, 2, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 0);
 		_lightDescriptorLayout->createDescriptorSetLayout(0);
 
 		_lightDescriptorSet = std::make_shared<DescriptorSet>(_device, _lightDescriptorPool, _lightDescriptorLayout, 1);
@@ -150,8 +152,9 @@ namespace vfs
 		shadowMapInfo.imageLayout	= VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
 
 		_lightDescriptorSet->updateImage({ shadowMapInfo }, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
-		_lightDescriptorSet->updateUniformBuffer({ light->getLightDescBuffer() }, 1, 1);
-		_lightDescriptorSet->updateUniformBuffer({ light->getViewProjectionBuffer() }, 2, 1);
+		_lightDescriptorSet->updateDynamicUniformBuffer(light->getLightDescBuffer(), light->getLightDescRange(), 1);
+		_lightDescriptorSet->updateDynamicUniformBuffer(light->getViewProjectionBuffer(), light->getViewProjectionRange(), 2);
+		_light = light;
 
 		// Voxelization Descriptor set
 		_viewProjBuffer = std::make_shared<Buffer>(_device->getMemoryAllocator(), sizeof(glm::mat4) * 6,
@@ -183,10 +186,10 @@ namespace vfs
 
 	bool SparseVoxelizer::initializePipelineLayout(void)
 	{
-		VkPushConstantRange scenePushConst = _sceneManager->getDefaultPushConstant();
+		// Voxel resolution and count mode, scene indices are fetched from the bindless draw table
 		VkPushConstantRange pushConstRange = {};
 		pushConstRange.offset		= 0;
-		pushConstRange.size			= sizeof(uint32_t) * 2 + scenePushConst.size;
+		pushConstRange.size			= sizeof(uint32_t) * 2;
 		pushConstRange.stageFlags	= VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
 
 		_pipelineLayout = std::make_shared<PipelineLayout>();
@@ -238,16 +241,18 @@ namespace vfs
 		config.colorBlendInfo.pAttachments			= &colorBlendAttachment;
 
 		_pipeline = std::make_shared<GraphicsPipeline>(_device);
-		_pipeline->attachShaderModule(VK_SHADER_STAGE_VERTEX_BIT,	"Shaders/voxelizer.vert.spv", nullptr);
+		_pipeline->attachShaderModule(VK_SHADER_STAGE_VERTEX_BIT,	"Shaders/voxelizer.vert.spv", _sceneManager->getVertexSpecializationInfo());
 		_pipeline->attachShaderModule(VK_SHADER_STAGE_GEOMETRY_BIT, "Shaders/voxelizer.geom.spv", nullptr);
 		_pipeline->attachShaderModule(VK_SHADER_STAGE_FRAGMENT_BIT, "Shaders/voxelizer.frag.spv", nullptr);
 		_pipeline->createPipeline(&config);
 		return true;
 	}
 
-	void SparseVoxelizer::preVoxelize(const CommandPoolPtr& cmdPool)
+	void SparseVoxelizer::preVoxelize(const CommandPoolPtr& cmdPool, const UploadManagerPtr& uploadManager)
 	{
-		_counter->resetCounter(cmdPool);
+		assert(cmdPool->getQueue() == uploadManager->getQueue()); // snowapril : reset must be ordered before voxelization
+		_counter->resetCounter(uploadManager);
+		uploadManager->enqueue();
 
 		CommandBuffer cmdBuffer(cmdPool->allocateCommandBuffer());
 		{
@@ -261,23 +266,24 @@ namespace vfs
 			cmdBuffer.bindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelineLayout->getLayoutHandle(),
 				0, { _descriptorSet }, {});
 			cmdBuffer.bindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelineLayout->getLayoutHandle(),
-				2, { _lightDescriptorSet }, {});
+				2, { _lightDescriptorSet }, { _light->getLightDescOffset(), _light->getViewProjectionOffset() });
 			cmdBuffer.bindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelineLayout->getLayoutHandle(),
 				3, { _voxelDescSet }, {});
 			uint32_t pushValues[] = { _voxelResolution, 1 };
 			cmdBuffer.pushConstants(_pipelineLayout->getLayoutHandle(), VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(pushValues), pushValues);
 			
-			_sceneManager->cmdDraw(cmdBuffer.getHandle(), _pipelineLayout, sizeof(pushValues));
+			_sceneManager->cmdDraw(cmdBuffer.getHandle(), _pipelineLayout);
 			cmdBuffer.endRenderPass();
 			cmdBuffer.endRecord();
 		}
 
-		Fence fence(_device, 1, 0);
-		cmdPool->getQueue()->submitCmdBuffer({ cmdBuffer }, &fence);
-		fence.waitForAllFences(UINT64_MAX);
+		// Counter reset and voxelization reach the queue in one submission, waited once for the readback
+		SubmissionSchedulerPtr scheduler = uploadManager->getScheduler();
+		scheduler->wait(scheduler->enqueue({ cmdBuffer.getHandle() }));
 		
 		_voxelFragmentCount = _counter->readCounterValue(cmdPool);
-		_counter->resetCounter(cmdPool);
+		_counter->resetCounter(uploadManager);
+		uploadManager->submit();
 
 		// TODO(snowapril) : fragment list update
 		_fragmentList = std::make_shared<Buffer>();
@@ -315,12 +321,12 @@ namespace vfs
 		cmdBuffer.bindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelineLayout->getLayoutHandle(),
 			0, { _descriptorSet }, {});
 		cmdBuffer.bindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelineLayout->getLayoutHandle(),
-			2, { _lightDescriptorSet }, {});
+			2, { _lightDescriptorSet }, { _light->getLightDescOffset(), _light->getViewProjectionOffset() });
 		cmdBuffer.bindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelineLayout->getLayoutHandle(),
 			3, { _voxelDescSet }, {});
 		uint32_t pushValues[] = { _voxelResolution, 0 };
 		cmdBuffer.pushConstants(_pipelineLayout->getLayoutHandle(), VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(uint32_t) * 2, pushValues);
-		_sceneManager->cmdDraw(cmdBuffer.getHandle(), _pipelineLayout, sizeof(pushValues));
+		_sceneManager->cmdDraw(cmdBuffer.getHandle(), _pipelineLayout);
 
 		cmdBuffer.endRenderPass();
 	}
@@ -31,7 +31,7 @@ namespace vfs
 		void destroyVoxelizer	(void);
 		bool initialize			(std::shared_ptr<Device> device, std::shared_ptr<SceneManager> sceneManager,
 								 DirectionalLight* light, const uint32_t octreeLevel);
-		void preVoxelize		(const CommandPoolPtr& cmdPool);
+		void preVoxelize		(const CommandPoolPtr& cmdPool, const UploadManagerPtr& uploadManager);
 		void cmdVoxelize		(VkCommandBuffer cmdBuffer);
 		void readVoxelFragments	(const CommandPoolPtr& cmdPool, OUT std::vector<glm::uvec3>* readData);
 
@@ -82,6 +82,7 @@ namespace vfs
 		BufferPtr						_sceneDimBuffer			{ nullptr };
 		RenderPassPtr					_renderPass				{ nullptr };
 		SamplerPtr						_shadowSampler			{ nullptr };
+		DirectionalLight*				_light					{ nullptr };	// Versioned light descriptions are bound at its offsets
 		VkSampleCountFlagBits			_sampleCount			{ VK_SAMPLE_COUNT_1_BIT };
 		uint32_t						_voxelResolution		{ 0 };
 		uint32_t						_voxelFragmentCount		{ 0 };
@@ -21,6 +21,8 @@
 #include <imgui/imgui.h>
 #include <Camera.h>
 #include <SceneManager.h>
+#include <RenderPass/DrawCuller.h>
+#include <RenderPass/HiZPyramid.h>
 
 namespace vfs
 {
@@ -32,13 +34,58 @@ namespace vfs
 
 	ReflectiveShadowMapPass::~ReflectiveShadowMapPass()
 	{
-		// Do nothing
+		_hiZPyramid.reset();
 	}
 
 	void ReflectiveShadowMapPass::onBeginRenderPass(const FrameLayout* frameLayout)
 	{
 		CommandBuffer cmdBuffer(frameLayout->commandBuffer);
 
+		// Every pass reading the light this frame binds the version written here
+		_directionalLight->beginFrame(frameLayout->frameIndex);
+
+		// Primitives outside of the light frustum never reach the shadow map,
+		// with occlusion culling the ones hidden behind last frame shadow map are deferred to the late phase
+		DrawCuller* drawCuller = _renderPassManager->get<DrawCuller>("DrawCuller");
+		const DrawCuller::CullView cullView = DrawCuller::FromViewProjection(_directionalLight->getViewProjection());
+		if (_bOcclusionCulling)
+		{
+			_cullView = drawCuller->cmdCullOccluded(cmdBuffer, cullView, _hiZPyramid.get(), "RSM");
+		}
+		else
+		{
+			_cullView = drawCuller->cmdCull(cmdBuffer, { cullView }, "RSM");
+			_hiZPyramid->invalidate();
+		}
+
+		beginRSMPass(frameLayout, _renderPass);
+	}
+
+	void ReflectiveShadowMapPass::onEndRenderPass(const FrameLayout* frameLayout)
+	{
+		CommandBuffer cmdBuffer(frameLayout->commandBuffer);
+		cmdBuffer.endRenderPass();
+
+		// snowapril : culling fell back to every scene draw, nothing was deferred
+		if (!_bOcclusionCulling || _cullView == DrawCuller::kNoCulling)
+		{
+			return;
+		}
+
+		// Pyramid of the visible draws is used by the late phase now, and by the early phase of next frame
+		DrawCuller* drawCuller = _renderPassManager->get<DrawCuller>("DrawCuller");
+		_hiZPyramid->cmdBuild(cmdBuffer, _directionalLight->getViewProjection());
+		_lateCullView = drawCuller->cmdCullDisoccluded(cmdBuffer, _cullView + 1, _hiZPyramid.get(), "RSM");
+
+		beginRSMPass(frameLayout, _resumeRenderPass);
+		drawCuller->cmdDraw(frameLayout->commandBuffer, _pipelineLayout, _lateCullView);
+		cmdBuffer.endRenderPass();
+	}
+
+	void ReflectiveShadowMapPass::beginRSMPass(const FrameLayout* frameLayout, const RenderPassPtr& renderPass)
+	{
+		CommandBuffer cmdBuffer(frameLayout->commandBuffer);
+
 		std::vector<VkClearValue> clearValues(_attachments.size() + 1);
 		for (size_t i = 0; i < clearValues.size(); ++i)
 		{
@@ -51,7 +98,7 @@ namespace vfs
 				clearValues[i].color = { 0.0f, 0.0f, 0.0f, 1.0f };
 			}
 		}
-		cmdBuffer.beginRenderPass(_renderPass, _framebuffer, clearValues);
+		cmdBuffer.beginRenderPass(renderPass, _framebuffer, clearValues);
 		_pipeline->bindPipeline(frameLayout->commandBuffer);
 
 		VkViewport viewport = {};
@@ -70,21 +117,15 @@ namespace vfs
 		
 		cmdBuffer.setScissor({ scissor });
 		cmdBuffer.bindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelineLayout->getLayoutHandle(), 2,
-			{ _descriptorSet }, {});
-	}
-
-	void ReflectiveShadowMapPass::onEndRenderPass(const FrameLayout* frameLayout)
-	{
-		CommandBuffer cmdBuffer(frameLayout->commandBuffer);
-		cmdBuffer.endRenderPass();
+			{ _descriptorSet }, { _directionalLight->getViewProjectionOffset(), _directionalLight->getLightDescOffset() });
 	}
 
 	void ReflectiveShadowMapPass::onUpdate(const FrameLayout* frameLayout)
 	{
 		CommandBuffer cmdBuffer(frameLayout->commandBuffer);
 	
-		SceneManager* sceneManager = _renderPassManager->get<SceneManager>("SceneManager");
-		sceneManager->cmdDraw(frameLayout->commandBuffer, _pipelineLayout, 0);
+		DrawCuller* drawCuller = _renderPassManager->get<DrawCuller>("DrawCuller");
+		drawCuller->cmdDraw(frameLayout->commandBuffer, _pipelineLayout, _cullView);
 	}
 
 	void ReflectiveShadowMapPass::drawGUI(void)
@@ -92,10 +133,16 @@ namespace vfs
 		if (ImGui::TreeNode("Shadow Settings"))
 		{
 			_directionalLight->drawGUI();
+			ImGui::Checkbox("Hi-Z occlusion culling", &_bOcclusionCulling);
 			ImGui::TreePop();
 		}
 	}
 
+	void ReflectiveShadowMapPass::drawDebugInfo(void)
+	{
+		_hiZPyramid->drawDebugInfo("Shadow Map Hi-Z Pyramid");
+	}
+
 	ReflectiveShadowMapPass& ReflectiveShadowMapPass::setDirectionalLight(std::unique_ptr<DirectionalLight>&& dirLight)
 	{
 		// Move framebuffer and directional light to proper storage
@@ -113,8 +160,15 @@ namespace vfs
 		_framebuffer = std::make_shared<Framebuffer>(_device, imageViews, _renderPass->getHandle(), _shadowMapResolution);
 
 		// Descriptor set update
-		_descriptorSet->updateUniformBuffer({ _directionalLight->getViewProjectionBuffer() }, 0, 1);
-		_descriptorSet->updateUniformBuffer({ _directionalLight->getLightDescBuffer() }, 1, 1);
+		_descriptorSet->updateDynamicUniformBuffer(_directionalLight->getViewProjectionBuffer(), _directionalLight->getViewProjectionRange(), 0);
+		_descriptorSet->updateDynamicUniformBuffer(_directionalLight->getLightDescBuffer(), _directionalLight->getLightDescRange(), 1);
+
+		// Shadow map is reduced into the pyramid after the visible draws
+		const DrawCuller* drawCuller = _renderPassManager->get<DrawCuller>("DrawCuller");
+		_hiZPyramid = std::make_unique<HiZPyramid>(_device);
+		_hiZPyramid->createPyramid(_shadowMapResolution)
+					.createDescriptors(_directionalLight->getShadowMapView().get(), drawCuller->getPyramidDescLayout())
+					.createPipeline();
 
 		_renderPassManager->put("DirectionalLight", _directionalLight.get());
 		return *this;
@@ -165,6 +219,15 @@ namespace vfs
 	ReflectiveShadowMapPass& ReflectiveShadowMapPass::createRenderPass(void)
 	{
 		assert(_attachments.empty() == false); // snowapril : Attachments must be filled first
+
+		// snowapril : resume pass is compatible with the first one, so both share the framebuffer
+		_renderPass			= createRSMRenderPass(false);
+		_resumeRenderPass	= createRSMRenderPass(true);
+		return *this;
+	}
+
+	RenderPassPtr ReflectiveShadowMapPass::createRSMRenderPass(bool bResume) const
+	{
 		uint32_t attachmentOffset = 0;
 
 		std::vector<VkAttachmentDescription> attachmentDesc;
@@ -176,11 +239,11 @@ namespace vfs
 			VkAttachmentDescription tempDesc = {};
 			tempDesc.format			= _attachments[i].image->getImageFormat();
 			tempDesc.samples		= VK_SAMPLE_COUNT_1_BIT;
-			tempDesc.loadOp			= VK_ATTACHMENT_LOAD_OP_CLEAR;
+			tempDesc.loadOp			= bResume ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR;
 			tempDesc.storeOp		= VK_ATTACHMENT_STORE_OP_STORE;
 			tempDesc.stencilLoadOp	= VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 			tempDesc.stencilStoreOp	= VK_ATTACHMENT_STORE_OP_DONT_CARE;
-			tempDesc.initialLayout	= VK_IMAGE_LAYOUT_UNDEFINED;
+			tempDesc.initialLayout	= bResume ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
 			tempDesc.finalLayout	= VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 			attachmentDesc.emplace_back(std::move(tempDesc));
 			colorAttachmentRefs.push_back({ attachmentOffset++, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL });
@@ -189,15 +252,15 @@ namespace vfs
 		VkAttachmentDescription tempDesc = {};
 		tempDesc.format			= VK_FORMAT_D32_SFLOAT;
 		tempDesc.samples		= VK_SAMPLE_COUNT_1_BIT;
-		tempDesc.loadOp			= VK_ATTACHMENT_LOAD_OP_CLEAR;
+		tempDesc.loadOp			= bResume ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR;
 		tempDesc.storeOp		= VK_ATTACHMENT_STORE_OP_STORE;
 		tempDesc.stencilLoadOp	= VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 		tempDesc.stencilStoreOp	= VK_ATTACHMENT_STORE_OP_DONT_CARE;
-		tempDesc.initialLayout	= VK_IMAGE_LAYOUT_UNDEFINED;
+		tempDesc.initialLayout	= bResume ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
 		tempDesc.finalLayout	= VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
 		attachmentDesc.emplace_back(std::move(tempDesc));
 
-		std::vector<VkSubpassDependency> subpassDependencies(2, VkSubpassDependency{});
+		std::vector<VkSubpassDependency> subpassDependencies(4, VkSubpassDependency{});
 		subpassDependencies[0].srcSubpass		= VK_SUBPASS_EXTERNAL;
 		subpassDependencies[0].dstSubpass		= 0;
 		subpassDependencies[0].srcStageMask		= VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
@@ -214,6 +277,23 @@ namespace vfs
 		subpassDependencies[1].dstAccessMask	= VK_ACCESS_MEMORY_READ_BIT;
 		subpassDependencies[1].dependencyFlags	= VK_DEPENDENCY_BY_REGION_BIT;
 
+		// Shadow map is reduced into the Hi-Z pyramid between the first pass and the resume pass
+		subpassDependencies[2].srcSubpass		= VK_SUBPASS_EXTERNAL;
+		subpassDependencies[2].dstSubpass		= 0;
+		subpassDependencies[2].srcStageMask		= VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+		subpassDependencies[2].srcAccessMask	= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		subpassDependencies[2].dstStageMask		= VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+		subpassDependencies[2].dstAccessMask	= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		subpassDependencies[2].dependencyFlags	= 0;
+
+		subpassDependencies[3].srcSubpass		= 0;
+		subpassDependencies[3].dstSubpass		= VK_SUBPASS_EXTERNAL;
+		subpassDependencies[3].srcStageMask		= VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+		subpassDependencies[3].srcAccessMask	= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		subpassDependencies[3].dstStageMask		= VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+		subpassDependencies[3].dstAccessMask	= VK_ACCESS_SHADER_READ_BIT;
+		subpassDependencies[3].dependencyFlags	= 0;
+
 		VkAttachmentReference depthAttachmentRef = {};
 		depthAttachmentRef.layout		= VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 		depthAttachmentRef.attachment	= attachmentOffset++;
@@ -224,9 +304,9 @@ namespace vfs
 		subpassDesc.pDepthStencilAttachment = &depthAttachmentRef;
 		subpassDesc.pipelineBindPoint		= VK_PIPELINE_BIND_POINT_GRAPHICS;
 
-		_renderPass = std::make_shared<RenderPass>();
-		assert(_renderPass->initialize(_device, attachmentDesc, subpassDependencies, { subpassDesc }));
-		return *this;
+		RenderPassPtr renderPass = std::make_shared<RenderPass>();
+		assert(renderPass->initialize(_device, attachmentDesc, subpassDependencies, { subpassDesc }));
+		return renderPass;
 	}
 
 	ReflectiveShadowMapPass& ReflectiveShadowMapPass::createPipeline(const DescriptorSetLayoutPtr& globalDescLayout)
@@ -235,13 +315,13 @@ namespace vfs
 		SceneManager* sceneManager = _renderPassManager->get<SceneManager>("SceneManager");
 
 		std::vector<VkDescriptorPoolSize> poolSizes = {
-			{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2}
+			{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 2}
 		};
 		_descriptorPool = std::make_shared<DescriptorPool>(_device, poolSizes, 1, 0);
 
 		_descriptorLayout = std::make_shared<DescriptorSetLayout>(_device);
-		_descriptorLayout->addBinding(VK_SHADER_STAGE_VERTEX_BIT,   0, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 0);
-		_descriptorLayout->addBinding(VK_SHADER_STAGE_FRAGMENT_BIT, 1, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 0);
+		_descriptorLayout->addBinding(VK_SHADER_STAGE_VERTEX_BIT,   0, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 0);
+		_descriptorLayout->addBinding(VK_SHADER_STAGE_FRAGMENT_BIT, 1, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 0);
 		_descriptorLayout->createDescriptorSetLayout(0);
 
 		_descriptorSet = std::make_shared<DescriptorSet>(_device, _descriptorPool, _descriptorLayout, 1);
@@ -250,7 +330,7 @@ namespace vfs
 		_pipelineLayout->initialize(
 			_device, 
 			{ globalDescLayout, sceneManager->getDescriptorLayout(), _descriptorLayout }, 
-			{ sceneManager->getDefaultPushConstant() }
+			{}
 		);
 
 		PipelineConfig config;
@@ -282,7 +362,7 @@ namespace vfs
 		config.colorBlendInfo.pAttachments = config.colorBlendAttachments.data();
 		
 		_pipeline = std::make_shared<GraphicsPipeline>(_device);
-		_pipeline->attachShaderModule(VK_SHADER_STAGE_VERTEX_BIT,	"Shaders/reflectiveShadowPass.vert.spv", nullptr);
+		_pipeline->attachShaderModule(VK_SHADER_STAGE_VERTEX_BIT,	"Shaders/reflectiveShadowPass.vert.spv", sceneManager->getVertexSpecializationInfo());
 		_pipeline->attachShaderModule(VK_SHADER_STAGE_FRAGMENT_BIT, "Shaders/reflectiveShadowPass.frag.spv", nullptr);
 		_pipeline->createPipeline(&config);
 		return *this;
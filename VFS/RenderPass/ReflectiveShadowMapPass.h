@@ -9,6 +9,8 @@
 namespace vfs
 {
 	class GLTFScene;
+	class HiZPyramid;
+
 	class ReflectiveShadowMapPass : public RenderPassBase
 	{
 	public:
@@ -19,10 +21,12 @@ namespace vfs
 	public:
 		ReflectiveShadowMapPass& createAttachments		(void);
 		ReflectiveShadowMapPass& createRenderPass		(void);
+		//! Hi-Z pyramid of the shadow map is created here, draw culler must be registered first
 		ReflectiveShadowMapPass& setDirectionalLight	(std::unique_ptr<DirectionalLight>&& dirLight);
 		ReflectiveShadowMapPass& createPipeline			(const DescriptorSetLayoutPtr& globalDescLayout);
 		
-		void drawGUI(void) override;
+		void drawGUI		(void) override;
+		void drawDebugInfo	(void) override;
 
 		inline const FramebufferAttachment& getDepthAttachment(void) const
 		{
@@ -34,10 +38,20 @@ namespace vfs
 		void onEndRenderPass	(const FrameLayout* frameLayout) override;
 		void onUpdate			(const FrameLayout* frameLayout) override;
 
+		//! Resume pass loads attachments written by the first pass instead of clearing them
+		RenderPassPtr createRSMRenderPass(bool bResume) const;
+		//! Begin one of the render passes sharing the framebuffer, and bind pipeline and dynamic states
+		void beginRSMPass		(const FrameLayout* frameLayout, const RenderPassPtr& renderPass);
+
 	private:
 		std::unique_ptr<DirectionalLight>				_directionalLight;
 		FramebufferPtr									_framebuffer;
+		RenderPassPtr									_resumeRenderPass;	// Loads attachments to draw disoccluded primitives
+		std::unique_ptr<HiZPyramid>						_hiZPyramid;
 		VkExtent2D				_shadowMapResolution	{ 0, 0 };
+		uint32_t				_cullView				{ 0 };
+		uint32_t				_lateCullView			{ 0 };
+		bool					_bOcclusionCulling		{ true };
 		SamplerPtr				_rsmSampler				{ nullptr };
 		BufferPtr				_viewProjBuffer			{ nullptr };
 		DescriptorSetPtr		_descriptorSet			{ nullptr };
@@ -38,6 +38,7 @@ namespace vfs
 	{
 		CommandBuffer cmdBuffer(frameLayout->commandBuffer);
 		_pipeline->bindPipeline(frameLayout->commandBuffer);
+		_directionalLight->beginFrame(frameLayout->frameIndex);
 
 		VkViewport viewport = {};
 		viewport.x			= 0;
@@ -55,7 +56,7 @@ namespace vfs
 		
 		cmdBuffer.setScissor({ scissor });
 		cmdBuffer.bindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelineLayout->getLayoutHandle(), 2,
-			{ _descriptorSet }, {});
+			{ _descriptorSet }, { _directionalLight->getViewProjectionOffset() });
 
 		VkClearValue depthClear;
 		depthClear.depthStencil = { 1.0f, 0 };
@@ -73,7 +74,7 @@ namespace vfs
 		CommandBuffer cmdBuffer(frameLayout->commandBuffer);
 
 		SceneManager* sceneManager = _renderPassManager->get<SceneManager>("SceneManager");
-		sceneManager->cmdDraw(frameLayout->commandBuffer, _pipelineLayout, 0);
+		sceneManager->cmdDraw(frameLayout->commandBuffer, _pipelineLayout);
 	}
 
 	void ShadowMapPass::drawGUI(void)
@@ -93,7 +94,7 @@ namespace vfs
 		_framebuffer = std::make_shared<Framebuffer>(_device, imageViews, _renderPass->getHandle(), _shadowMapResolution);
 
 		// Descriptor set update
-		_descriptorSet->updateUniformBuffer({ _directionalLight->getViewProjectionBuffer() }, 0, 1);
+		_descriptorSet->updateDynamicUniformBuffer(_directionalLight->getViewProjectionBuffer(), _directionalLight->getViewProjectionRange(), 0);
 
 		_renderPassManager->put("DirectionalLight", _directionalLight.get());
 		return *this;
@@ -148,12 +149,12 @@ namespace vfs
 		SceneManager* sceneManager = _renderPassManager->get<SceneManager>("SceneManager");
 
 		std::vector<VkDescriptorPoolSize> poolSizes = {
-			{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1}
+			{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1}
 		};
 		_descriptorPool = std::make_shared<DescriptorPool>(_device, poolSizes, 1, 0);
 
 		_descriptorLayout = std::make_shared<DescriptorSetLayout>(_device);
-		_descriptorLayout->addBinding(VK_SHADER_STAGE_VERTEX_BIT, 0, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 0);
+		_descriptorLayout->addBinding(VK_SHADER_STAGE_VERTEX_BIT, 0, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 0);
 		_descriptorLayout->createDescriptorSetLayout(0);
 
 		_descriptorSet = std::make_shared<DescriptorSet>(_device, _descriptorPool, _descriptorLayout, 1);
@@ -162,7 +163,7 @@ namespace vfs
 		_pipelineLayout->initialize(
 			_device, 
 			{ globalDescLayout, sceneManager->getDescriptorLayout(), _descriptorLayout },
-			{ sceneManager->getDefaultPushConstant() }
+			{}
 		);
 
 		PipelineConfig config;
@@ -11,8 +11,10 @@
 #include <VulkanFramework/RenderPass/RenderPass.h>
 #include <VulkanFramework/RenderPass/Framebuffer.h>
 #include <VulkanFramework/Commands/CommandPool.h>
+#include <VulkanFramework/Sync/SubmissionScheduler.h>
 #include <VulkanFramework/Utils.h>
 #include <VulkanFramework/Window.h>
+#include <algorithm>
 #include <thread>
 #include <chrono>
 
@@ -20,9 +22,10 @@ namespace vfs
 {
 	Renderer::Renderer(vfs::DevicePtr device,
 					   vfs::CommandPoolPtr mainCmdPool,
+					   vfs::SubmissionSchedulerPtr scheduler,
 					   std::unique_ptr<SwapChain>&& swapChain)
 	{
-		assert(initialize(device, mainCmdPool, std::move(swapChain)));
+		assert(initialize(device, mainCmdPool, scheduler, std::move(swapChain)));
 	}
 	
 	Renderer::~Renderer()
@@ -35,6 +38,7 @@ namespace vfs
 		_mainCmdPool->freeCommandBuffers(_commandBuffers);
 		_commandBuffers.clear();
 		_swapChain.reset();
+		_scheduler.reset();
 		if (_surface != VK_NULL_HANDLE)
 		{
 			vkDestroySurfaceKHR(_device->getVulkanInstance(), _surface, nullptr);
@@ -45,12 +49,14 @@ namespace vfs
 	
 	bool Renderer::initialize(vfs::DevicePtr device,
 							  vfs::CommandPoolPtr mainCmdPool,
+							  vfs::SubmissionSchedulerPtr scheduler,
 							  std::unique_ptr<SwapChain>&& swapChain)
 	{
 		_device			= device;
 		_mainCmdPool	= mainCmdPool;
+		_scheduler		= scheduler;
 		_swapChain		= std::move(swapChain);
-		_commandBuffers = _mainCmdPool->allocateMultipleCommandBuffer(DEFAULT_NUM_FRAMES);
+		_commandBuffers = _mainCmdPool->allocateMultipleCommandBuffer(MAX_NUM_FRAMES);
 		_surface		= _swapChain->getSurfaceHandle();
 
 		return true;
@@ -67,8 +73,18 @@ namespace vfs
 	VkCommandBuffer Renderer::beginFrame(void)
 	{
 		assert(!_isFrameStarted);
+
+		// Only CPU wait of the frame loop, throttles recording to the number of frames in flight.
+		// Deferred releases of retired submissions run here as well
+		const bool bFrameRetired = _scheduler->wait(_frameValues[_currentFrameIndex]);
+		_scheduler->collect();
+		if (!bFrameRetired && _scheduler->isLost())
+		{
+			// snowapril : failed submission was reported by endFrame, nothing reaches the queue anymore
+			return VK_NULL_HANDLE;
+		}
 	
-		VkResult result = _swapChain->acquireNextImage(&_currentImageIndex);
+		VkResult result = _swapChain->acquireNextImage(_currentFrameIndex, &_currentImageIndex);
 		if (result == VK_ERROR_OUT_OF_DATE_KHR)
 		{
 			recreateSwapChain();
@@ -89,6 +105,7 @@ namespace vfs
 		}
 	
 		_isFrameStarted = true;
+		_frameIndexSerials[_currentFrameIndex] = ++_frameSerial;
 		return currentCommandBuffer;
 	}
 	
@@ -99,8 +116,29 @@ namespace vfs
 		VkCommandBuffer& currentCommandBuffer = getCurrentCommandBuffer();
 		vkEndCommandBuffer(currentCommandBuffer);
 
-		VkResult result = _swapChain->submitCommandBuffer(&currentCommandBuffer, &_currentImageIndex,
-														  _waitSemaphores, _signalSemaphores);
+		// snowapril : images are only written by submissions on this queue in submission order,
+		//			   so the image available semaphore is enough to reuse an image still being presented
+		_waitSemaphores.push_back(_swapChain->getImageAvailableSemaphore(_currentFrameIndex));
+		_waitValues.push_back(0);
+		_waitStageMasks.push_back(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+		_signalSemaphores.push_back(_swapChain->getRenderFinishedSemaphore(_currentFrameIndex));
+
+		// Submissions enqueued during the frame reach the queue together with the main pass
+		_frameValues[_currentFrameIndex] = _scheduler->enqueue({ currentCommandBuffer }, _waitSemaphores, _waitValues, _waitStageMasks,
+															   _signalSemaphores, std::vector<uint64_t>(_signalSemaphores.size(), 0));
+		VkResult result = VK_ERROR_DEVICE_LOST;
+		if (_scheduler->flush())
+		{
+			result = _swapChain->present(_currentImageIndex, _signalSemaphores);
+		}
+		else
+		{
+			VFS_ERROR << "Failed to submit frame " << _frameSerial;
+		}
+		_waitSemaphores.clear();
+		_waitValues.clear();
+		_waitStageMasks.clear();
+		_signalSemaphores.clear();
 		if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || _swapChain->getWindowPtr()->wasWindowResized())
 		{
 			_swapChain->getWindowPtr()->setWindowResizedFlag(false);
@@ -108,7 +146,7 @@ namespace vfs
 		}
 		
 		_isFrameStarted = false;
-		_currentFrameIndex = (_currentFrameIndex + 1) % DEFAULT_NUM_FRAMES;
+		_currentFrameIndex = (_currentFrameIndex + 1) % _numFrames;
 	}
 	
 	void Renderer::beginRenderPass(VkCommandBuffer commandBuffer)
@@ -155,13 +193,71 @@ namespace vfs
 		vkCmdEndRenderPass(commandBuffer);
 	}
 
-	void Renderer::addWaitSemaphore(VkSemaphore semaphore)
+	void Renderer::addWaitSemaphore(VkSemaphore semaphore, uint64_t waitValue, VkPipelineStageFlags waitStageMask)
 	{
 		_waitSemaphores.emplace_back(semaphore);
+		_waitValues.emplace_back(waitValue);
+		_waitStageMasks.emplace_back(waitStageMask);
 	}
 
 	void Renderer::addSignalSemaphore(VkSemaphore semaphore)
 	{
 		_signalSemaphores.emplace_back(semaphore);
 	}
+
+	void Renderer::setNumFrames(uint32_t numFrames)
+	{
+		assert(!_isFrameStarted);
+		numFrames = std::max(1u, std::min(numFrames, MAX_NUM_FRAMES));
+		if (numFrames == _numFrames)
+		{
+			return;
+		}
+
+		// snowapril : every frame must be retired before frame indices are remapped
+		vkDeviceWaitIdle(_device->getDeviceHandle());
+		_numFrames			= numFrames;
+		_currentFrameIndex	= 0;
+	}
+
+	void Renderer::validateFrameVersion(const char* resourceName, uint32_t version)
+	{
+		if (!_bValidateFrameHazards)
+		{
+			return;
+		}
+
+		assert(version < MAX_NUM_FRAMES);
+		std::array<uint64_t, MAX_NUM_FRAMES>& versionSerials = _versionSerials[resourceName];
+		const uint64_t lastSerial = versionSerials[version];
+		if (lastSerial != 0 && !isFrameSerialRetired(lastSerial))
+		{
+			VFS_ERROR << "Frame " << _frameSerial << " uses version " << version << " of " << resourceName
+					  << " while frame " << lastSerial << " is still using it";
+			++_numFrameHazards;
+		}
+		versionSerials[version] = _frameSerial;
+	}
+
+	bool Renderer::isSubmissionLost(void) const
+	{
+		return _scheduler->isLost();
+	}
+
+	bool Renderer::isFrameSerialRetired(uint64_t frameSerial)
+	{
+		if (frameSerial == _frameSerial)
+		{
+			return true;
+		}
+		for (uint32_t frameIndex = 0; frameIndex < MAX_NUM_FRAMES; ++frameIndex)
+		{
+			if (_frameIndexSerials[frameIndex] == frameSerial)
+			{
+				return _scheduler->isCompleted(_frameValues[frameIndex]);
+			}
+		}
+		// Frame index was reused by later frame, which waited this serial to be retired
+		return true;
+	}
 };
\ No newline at end of file
@@ -5,7 +5,11 @@
 
 #include <pch.h>
 #include <SwapChain.h>
+#include <Util/EngineConfig.h>
+#include <array>
 #include <memory>
+#include <string>
+#include <unordered_map>
 
 namespace vfs
 {
@@ -15,6 +19,7 @@ namespace vfs
 		explicit Renderer() = default;
 		explicit Renderer(vfs::DevicePtr device,
 						  vfs::CommandPoolPtr mainCmdPool,
+						  vfs::SubmissionSchedulerPtr scheduler,
 						  std::unique_ptr<SwapChain>&& swapChain);
 				~Renderer();
 	
@@ -22,14 +27,25 @@ namespace vfs
 		void			destroyRenderer			(void);
 		bool			initialize				(vfs::DevicePtr device,
 												 vfs::CommandPoolPtr mainCmdPool,
+												 vfs::SubmissionSchedulerPtr scheduler,
 												 std::unique_ptr<SwapChain>&& swapChain);
 		bool			recreateSwapChain		(void);
 		VkCommandBuffer beginFrame				(void);
 		void			endFrame				(void);
 		void			beginRenderPass			(VkCommandBuffer commandBuffer);
 		void			endRenderPass			(VkCommandBuffer commandBuffer);
-		void			addWaitSemaphore		(VkSemaphore semaphore);
+		//! Semaphores added during a frame are waited or signaled by its submission only.
+		//! Wait value is ignored for binary semaphores, signaled ones must be binary as present waits them
+		void			addWaitSemaphore		(VkSemaphore semaphore, uint64_t waitValue, VkPipelineStageFlags waitStageMask);
 		void			addSignalSemaphore		(VkSemaphore semaphore);
+		//! Waits until device is idle and cycles given number of frame indices from the next frame,
+		//! must be called outside of a frame. Clamped to [1, MAX_NUM_FRAMES]
+		void			setNumFrames			(uint32_t numFrames);
+		//! Test mode, every frame reports versions of per-frame resources it writes or reads.
+		//! A version used by another frame which is still on GPU is logged as a hazard
+		void			validateFrameVersion	(const char* resourceName, uint32_t version);
+		//! A frame submission failed, later frames can never be submitted
+		bool			isSubmissionLost		(void) const;
 
 		inline VkCommandBuffer& getCurrentCommandBuffer(void)
 		{
@@ -43,22 +59,52 @@ namespace vfs
 		{
 			return _swapChain->getMinImageCount();
 		}
+		inline uint32_t			getNumFrames(void) const
+		{
+			return _numFrames;
+		}
+		inline void				setFrameHazardValidation(bool bValidate)
+		{
+			_bValidateFrameHazards = bValidate;
+		}
+		inline bool				isFrameHazardValidationEnabled(void) const
+		{
+			return _bValidateFrameHazards;
+		}
+		inline uint32_t			getNumFrameHazards(void) const
+		{
+			return _numFrameHazards;
+		}
 		inline RenderPassPtr	getSwapChainRenderPass(void) const
 		{
 			return _swapChain->getRenderPass();
 		}
 	
+	private:
+		//! Serial of the frame being recorded counts as retired, it is not on GPU yet
+		bool			isFrameSerialRetired	(uint64_t frameSerial);
+
 	private:
 		std::vector<VkCommandBuffer>		_commandBuffers;
 		std::vector<VkSemaphore>			_waitSemaphores;
+		std::vector<uint64_t>				_waitValues;
+		std::vector<VkPipelineStageFlags>	_waitStageMasks;
 		std::vector<VkSemaphore>			_signalSemaphores;
 		DevicePtr							_device				{ nullptr };
 		CommandPoolPtr						_mainCmdPool		{ nullptr };
+		SubmissionSchedulerPtr				_scheduler			{ nullptr };
 		std::unique_ptr<SwapChain>			_swapChain			{ nullptr };
 		VkSurfaceKHR						_surface			{ VK_NULL_HANDLE };
 		uint32_t							_currentImageIndex	{ 0 };
 		uint32_t							_currentFrameIndex	{ 0 };
+		uint32_t							_numFrames			{ DEFAULT_NUM_FRAMES };
 		bool								_isFrameStarted		{ false };
+		bool								_bValidateFrameHazards { DEFAULT_VALIDATE_FRAME_HAZARDS };
+		uint32_t							_numFrameHazards	{ 0 };
+		uint64_t							_frameSerial		{ 0 };	// Serial of the current frame, starts from one
+		std::array<uint64_t, MAX_NUM_FRAMES> _frameIndexSerials { };	// Serial last submitted with each frame index
+		std::array<uint64_t, MAX_NUM_FRAMES> _frameValues		{ };	// Scheduler value of the last frame of each index
+		std::unordered_map<std::string, std::array<uint64_t, MAX_NUM_FRAMES>> _versionSerials;	// Serial last used each version
 	};
 };
 
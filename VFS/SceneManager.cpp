@@ -4,8 +4,16 @@
 #include <SceneManager.h>
 #include <VulkanFramework/Device.h>
 #include <VulkanFramework/Queue.h>
-#include <VulkanFramework/Descriptors/DescriptorSetLayout.h>
-#include <VulkanFramework/Descriptors/DescriptorPool.h>
+#include <VulkanFramework/Buffers/UploadManager.h>
+#include <VulkanFramework/Commands/CommandBuffer.h>
+#include <VulkanFramework/Buffers/Buffer.h>
+#include <VulkanFramework/DebugUtils.h>
+#include <VulkanFramework/Sync/SubmissionScheduler.h>
+#include <VulkanFramework/Sync/TimelineSemaphore.h>
+#include <Util/EngineConfig.h>
+#include <Common/Logger.h>
+#include <Common/Utils.h>
+#include <VulkanFramework/Pipelines/PipelineLayout.h>
 #include <tinyfiledialogs/tinyfiledialogs.h>
 #include <GUI/ImGuiUtil.h>
 #include <imgui/imgui.h>
@@ -13,9 +21,9 @@
 
 namespace vfs
 {
-	SceneManager::SceneManager(const QueuePtr& queue, VertexFormat format)
+	SceneManager::SceneManager(const UploadManagerPtr& uploadManager, const QueuePtr& loaderQueue, VertexFormat format)
 	{
-		assert(initialize(queue, format));
+		assert(initialize(uploadManager, loaderQueue, format));
 	}
 
 	SceneManager::~SceneManager()
@@ -23,63 +31,317 @@ namespace vfs
 		destroySceneManager();
 	}
 
-	bool SceneManager::initialize(const QueuePtr& queue, VertexFormat format)
+	bool SceneManager::initialize(const UploadManagerPtr& uploadManager, const QueuePtr& loaderQueue, VertexFormat format)
 	{
-		_device = queue->getDevicePtr();
-		_queue = queue;
+		_device = uploadManager->getDevicePtr();
+		_uploadManager = uploadManager;
+		_loaderQueue = loaderQueue;
 		_commonFormat = format;
 
-		const std::vector<VkDescriptorPoolSize> poolSizes = {
-			{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER , 2},
-			{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, kMaxNumTexturePerScene },
-		};
-		_descPool = std::make_shared<DescriptorPool>(_device, poolSizes, kMaxNumScenes, 0);
+		// Every scene suballocates its vertices and indices from here, no buffer is created per scene
+		_geometryPool = std::make_shared<GeometryPool>(_device, _commonFormat, DEFAULT_GEOMETRY_POOL_VERTICES,
+													   DEFAULT_GEOMETRY_POOL_INDEX_SIZE);
+
+		// Uploads of each loaded scene signal the next value, graphics queue waits for it before first use
+		_loadTimeline = std::make_shared<TimelineSemaphore>();
+		if (!_loadTimeline->initialize(_device, _loadTimelineValue))
+		{
+			return false;
+		}
 
-		_descLayout = std::make_shared<DescriptorSetLayout>(_device);
-		_descLayout->addBinding(VK_SHADER_STAGE_VERTEX_BIT, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 0);
-		_descLayout->addBinding(VK_SHADER_STAGE_FRAGMENT_BIT, 1, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 0);
-		_descLayout->addBinding(VK_SHADER_STAGE_FRAGMENT_BIT, 2, kMaxNumTexturePerScene, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-			VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT);
-		return _descLayout->createDescriptorSetLayout(0);
+		// Vertex shaders decode packed normal and tangent streams by this constant (vertex.glsl)
+		_bPackedVertex = static_cast<bool>(_commonFormat & VertexFormat::Quantized) ? VK_TRUE : VK_FALSE;
+		_vertexSpecEntry.constantID	= 0;
+		_vertexSpecEntry.offset		= 0;
+		_vertexSpecEntry.size		= sizeof(VkBool32);
+		_vertexSpecInfo.mapEntryCount	= 1;
+		_vertexSpecInfo.pMapEntries		= &_vertexSpecEntry;
+		_vertexSpecInfo.dataSize		= sizeof(VkBool32);
+		_vertexSpecInfo.pData			= &_bPackedVertex;
+
+		// Matrices, materials, textures and draws of all scenes are reached through this single descriptor set
+		_bindlessTable = std::make_shared<BindlessTable>(_device, DEFAULT_BINDLESS_MATRICES, DEFAULT_BINDLESS_MATERIALS,
+														 DEFAULT_BINDLESS_TEXTURES, DEFAULT_BINDLESS_DRAWS);
+
+		// Live draw slots are listed here for GPU culling, rewritten whenever scenes are published
+		_drawListBuffer = std::make_shared<Buffer>(_device->getMemoryAllocator(), DEFAULT_BINDLESS_DRAWS * sizeof(uint32_t),
+												   VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+												   VMA_MEMORY_USAGE_GPU_ONLY);
+		DebugUtils debugUtil(_device);
+		debugUtil.setObjectName(_drawListBuffer->getBufferHandle(), "Scene Draw List");
+		return true;
 	}
 
 	void SceneManager::destroySceneManager(void)
 	{
+		// snowapril : import in progress cannot be cancelled, wait for it to finish
+		for (std::unique_ptr<SceneLoadJob>& job : _loadJobs)
+		{
+			if (job->thread.joinable())
+			{
+				job->thread.join();
+			}
+		}
+		_loadJobs.clear();
+
+		// Pending upload batch may still wait on the timeline semaphore
+		if (_uploadManager != nullptr)
+		{
+			_uploadManager->flush();
+		}
+		_loadTimeline.reset();
+		_loaderQueue.reset();
 		_scenes.clear();
-		_descLayout.reset();
-		_queue.reset();
+		_geometryPool.reset();
+		_bindlessTable.reset();
+		_drawListBuffer.reset();
+		_uploadManager.reset();
 		_device.reset();
 	}
 
 	void SceneManager::addScene(const char* scenePath)
 	{
-		std::shared_ptr<GLTFScene> scene = std::make_shared<GLTFScene>();
-		if (scene->initialize(_device, scenePath, _queue, _commonFormat))
+		std::unique_ptr<SceneLoadJob> job = std::make_unique<SceneLoadJob>();
+		job->path	= scenePath;
+		job->scene	= std::make_shared<GLTFScene>();
+		_loadJobs.emplace_back(std::move(job));
+
+		// Scenes are loaded one by one, import already spreads over all cores and
+		// submissions on the loader queue must not overlap
+		if (_loadJobs.size() == 1)
 		{
-			// Allocate descriptor set
-			scene->allocateDescriptor(_descPool, _descLayout);
+			startNextLoad();
+		}
+	}
+
+	void SceneManager::startNextLoad(void)
+	{
+		SceneLoadJob* job = _loadJobs.front().get();
+		job->timelineValue	= ++_loadTimelineValue;
+		job->state			= LoadState::Importing;
+		job->thread			= std::thread(&SceneManager::loadSceneWorker, this, job);
+	}
 
-			// Update total bounding box
-			_sceneBoundingBox.updateBoundingBox(scene->getSceneBoundingBox());
+	void SceneManager::loadSceneWorker(SceneLoadJob* job)
+	{
+		job->scene->setProgressCallback([job](float progress) {
+			job->progress.store(progress);
+		});
+
+		if (!job->scene->importScene(_device, job->path.c_str(), _geometryPool, _bindlessTable, _commonFormat))
+		{
+			job->state		 = LoadState::Failed;
+			job->bWorkerDone = true;
+			return;
+		}
 
-			_scenes.emplace_back(std::move(scene));
+		// Without dedicated loader queue the render thread records the upload on publish
+		if (_loaderQueue == nullptr)
+		{
+			job->state		 = LoadState::Imported;
+			job->bWorkerDone = true;
+			return;
 		}
+
+		SubmissionSchedulerPtr loaderScheduler = std::make_shared<SubmissionScheduler>(_loaderQueue);
+		UploadManagerPtr loaderUploadManager = std::make_shared<UploadManager>(_device, loaderScheduler, DEFAULT_UPLOAD_RING_SIZE);
+		if (!job->scene->uploadScene(loaderUploadManager))
+		{
+			job->state		 = LoadState::Failed;
+			job->bWorkerDone = true;
+			return;
+		}
+
+		// Release half of the queue family ownership transfer, acquired by the graphics queue on publish
+		const uint32_t loaderFamily	  = _loaderQueue->getFamilyIndex();
+		const uint32_t graphicsFamily = _uploadManager->getQueue()->getFamilyIndex();
+		if (loaderFamily != graphicsFamily)
+		{
+			std::vector<VkBufferMemoryBarrier> bufferBarriers;
+			std::vector<VkImageMemoryBarrier> imageBarriers;
+			job->scene->getQueueTransferBarriers(loaderFamily, graphicsFamily, &bufferBarriers, &imageBarriers);
+			loaderUploadManager->enqueueCommand([&](CommandBuffer cmdBuffer) {
+				cmdBuffer.pipelineBarrier(VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+										  {}, bufferBarriers, imageBarriers);
+			});
+		}
+
+		loaderUploadManager->addSignalSemaphore(_loadTimeline->getHandle(), job->timelineValue);
+		loaderUploadManager->submit();
+		job->state = LoadState::Submitted;
+
+		// Staging memory is kept until the loader queue has consumed it, render thread never waits for this
+		loaderUploadManager->flush();
+		job->bWorkerDone = true;
 	}
 
-	void SceneManager::cmdDraw(VkCommandBuffer cmdBuffer, const PipelineLayoutPtr& pipelineLayout,
-							   const uint32_t pushConstOffset)
+	void SceneManager::publishLoadedScenes(void)
 	{
+		if (_loadJobs.empty())
+		{
+			return;
+		}
+
+		SceneLoadJob* job = _loadJobs.front().get();
+		if (!job->bPublished)
+		{
+			switch (job->state.load())
+			{
+			case LoadState::Imported:
+				// Recorded into the pending batch which is submitted ahead of this frame
+				job->bPublished = true;
+				if (job->scene->uploadScene(_uploadManager))
+				{
+					publishScene(job->scene);
+				}
+				break;
+			case LoadState::Submitted:
+			{
+				job->bPublished = true;
+				const uint32_t loaderFamily	  = _loaderQueue->getFamilyIndex();
+				const uint32_t graphicsFamily = _uploadManager->getQueue()->getFamilyIndex();
+				if (loaderFamily != graphicsFamily)
+				{
+					std::vector<VkBufferMemoryBarrier> bufferBarriers;
+					std::vector<VkImageMemoryBarrier> imageBarriers;
+					job->scene->getQueueTransferBarriers(loaderFamily, graphicsFamily, &bufferBarriers, &imageBarriers);
+					_uploadManager->enqueueCommand([&](CommandBuffer cmdBuffer) {
+						cmdBuffer.pipelineBarrier(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0,
+												  {}, bufferBarriers, imageBarriers);
+					});
+				}
+
+				// GPU side handoff, frames keep being submitted while the loader queue finishes the upload
+				_uploadManager->addWaitSemaphore(_loadTimeline->getHandle(), job->timelineValue, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+				job->scene->setUploadManager(_uploadManager);
+				publishScene(job->scene);
+				break;
+			}
+			case LoadState::Failed:
+				job->bPublished = true;
+				VFS_ERROR << "Failed to load scene " << job->path;
+				break;
+			default:
+				break;
+			}
+		}
+
+		if (job->bPublished && job->bWorkerDone)
+		{
+			job->thread.join();
+			_loadJobs.pop_front();
+
+			if (!_loadJobs.empty())
+			{
+				startNextLoad();
+			}
+		}
+	}
+
+	void SceneManager::publishScene(const std::shared_ptr<GLTFScene>& scene)
+	{
+		scene->setProgressCallback(nullptr);
+
+		// Textures are written into the table while earlier frames may still use other slots of it
+		scene->updateTextureDescriptors();
+
+		// Update total bounding box
+		_sceneBoundingBox.updateBoundingBox(scene->getSceneBoundingBox());
+
+		_scenes.emplace_back(scene);
+		updateDrawList();
+	}
+
+	void SceneManager::updateDrawList(void)
+	{
+		std::vector<uint32_t> drawList;
+		_maxDrawTriangles = 0;
+		for (std::shared_ptr<GLTFScene>& scene : _scenes)
+		{
+			scene->gatherDrawSlots(VK_INDEX_TYPE_UINT16, &drawList);
+			_maxDrawTriangles = vfs::max(_maxDrawTriangles, scene->getMaxDrawTriangles());
+		}
+		const uint32_t numDraws16 = static_cast<uint32_t>(drawList.size());
 		for (std::shared_ptr<GLTFScene>& scene : _scenes)
 		{
-			scene->cmdDraw(cmdBuffer, pipelineLayout, pushConstOffset);
+			scene->gatherDrawSlots(VK_INDEX_TYPE_UINT32, &drawList);
+		}
+		if (drawList.empty())
+		{
+			return;
+		}
+
+		// snowapril : culling of frames in flight may still read the old list, the upload
+		//			   batch waits for compute shaders of earlier submissions before the copy
+		_uploadManager->enqueueCommand([](CommandBuffer cmdBuffer) {
+			cmdBuffer.pipelineBarrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, {}, {}, {});
+		});
+		if (!_uploadManager->uploadBuffer(_drawListBuffer, drawList.data(), drawList.size() * sizeof(uint32_t), 0))
+		{
+			VFS_ERROR << "Failed to upload scene draw list";
+			return;
+		}
+		_numListedDraws16 = numDraws16;
+		_numListedDraws	  = static_cast<uint32_t>(drawList.size());
+	}
+
+	void SceneManager::queryDrawSlots(const Frustum* frustums, uint32_t numFrustums, std::vector<uint32_t>* drawSlots,
+									  uint32_t* numDrawSlots16) const
+	{
+		drawSlots->clear();
+		std::vector<uint32_t> draws, drawSlots32;
+		for (const std::shared_ptr<GLTFScene>& scene : _scenes)
+		{
+			draws.clear();
+			scene->getDrawBVH().queryFrustums(frustums, numFrustums, &draws);
+			scene->gatherDrawSlots(draws, drawSlots, &drawSlots32);
+		}
+		*numDrawSlots16 = static_cast<uint32_t>(drawSlots->size());
+		drawSlots->insert(drawSlots->end(), drawSlots32.begin(), drawSlots32.end());
+	}
+
+	void SceneManager::cmdDraw(VkCommandBuffer cmdBuffer, const PipelineLayoutPtr& pipelineLayout)
+	{
+		if (_scenes.empty())
+		{
+			return;
+		}
+
+		// Vertex streams and bindless table of all scenes are bound once, index buffer once per index type
+		// snowapril : each scene issues one indirect draw per index type, matrix and material indices
+		//			   are fetched from the draw table by gl_InstanceIndex instead of push constants
+		CommandBuffer cmdBufferWrapper(cmdBuffer);
+		cmdBindGeometry(&cmdBufferWrapper, pipelineLayout);
+		for (const VkIndexType indexType : { VK_INDEX_TYPE_UINT16, VK_INDEX_TYPE_UINT32 })
+		{
+			cmdBufferWrapper.bindIndexBuffer(_geometryPool->getIndexBuffer(), 0, indexType);
+			for (std::shared_ptr<GLTFScene>& scene : _scenes)
+			{
+				scene->cmdDraw(cmdBuffer, indexType);
+			}
 		}
 	}
 
+	void SceneManager::cmdBindGeometry(CommandBuffer* cmdBuffer, const PipelineLayoutPtr& pipelineLayout) const
+	{
+		_geometryPool->cmdBindVertexBuffers(cmdBuffer);
+		cmdBuffer->bindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout->getLayoutHandle(), 1,
+									  { _bindlessTable->getDescriptorSet() }, {});
+	}
+
 	void SceneManager::drawGUI(void)
 	{
 		constexpr const char* kSceneExtensionFilter[] = { "*.gltf" };
 		static char scenePathBuf[256];
 
+		// Loading scenes are shown even with collapsed settings, rendering goes on meanwhile
+		for (const std::unique_ptr<SceneLoadJob>& job : _loadJobs)
+		{
+			const bool bQueued = job->state.load() == LoadState::Queued;
+			ImGui::TextUnformatted(job->path.c_str());
+			ImGui::ProgressBar(job->progress.load(), ImVec2(-1.0f, 0.0f), bQueued ? "Queued" : nullptr);
+		}
+
 		if (ImGui::TreeNode("Scene Settings"))
         {
             if (ImGui::BeginPopupModal("Scene Load", nullptr,
@@ -112,6 +374,17 @@ namespace vfs
                 ImGui::EndTooltip();
             }
 
+			if (ImGui::TreeNode("Geometry Pool"))
+			{
+				_geometryPool->drawGUI();
+				ImGui::TreePop();
+			}
+			if (ImGui::TreeNode("Bindless Table"))
+			{
+				_bindlessTable->drawGUI();
+				ImGui::TreePop();
+			}
+
 			for (std::shared_ptr<GLTFScene>& scene : _scenes)
 			{
 				scene->drawGUI();
@@ -127,6 +400,7 @@ namespace vfs
 			VertexFormat::Position3, VertexFormat::Normal3, VertexFormat::TexCoord2, VertexFormat::Tangent4
 		};
 		std::vector<VkVertexInputBindingDescription> bindingDescs;
+		const VertexFormat packing = _commonFormat & VertexFormat::Quantized;
 
 		uint32_t bindingPoint{ bindOffset };
 		for (uint32_t i = 0; i < sizeof(kFormats) / sizeof(VertexFormat); ++i)
@@ -134,7 +408,7 @@ namespace vfs
 			if (static_cast<int>(_commonFormat & kFormats[i]))
 			{
 				bindingDescs.push_back({
-					bindingPoint, VertexHelper::GetNumBytes(kFormats[i]), VK_VERTEX_INPUT_RATE_VERTEX
+					bindingPoint, VertexHelper::GetNumBytes(kFormats[i] | packing), VK_VERTEX_INPUT_RATE_VERTEX
 				});
 				bindingPoint += 1;
 			}
@@ -148,11 +422,12 @@ namespace vfs
 		std::vector<VkVertexInputAttributeDescription> attribDescs;
 
 		VkVertexInputAttributeDescription attrib = {};
+		const bool bPacked = static_cast<bool>(_commonFormat & VertexFormat::Quantized);
 
 		uint32_t location{ 0 }, bindingPoint{ bindOffset };
 		if (static_cast<int>(_commonFormat & VertexFormat::Position3))
 		{
-			attrib.format = VK_FORMAT_R32G32B32_SFLOAT;
+			attrib.format = bPacked ? VK_FORMAT_R16G16B16A16_UNORM : VK_FORMAT_R32G32B32_SFLOAT;
 			attrib.binding = bindingPoint;
 			attrib.offset = 0;
 			attrib.location = location;
@@ -162,7 +437,7 @@ namespace vfs
 		}
 		if (static_cast<int>(_commonFormat & VertexFormat::Normal3))
 		{
-			attrib.format = VK_FORMAT_R32G32B32_SFLOAT;
+			attrib.format = bPacked ? VK_FORMAT_R16G16_SNORM : VK_FORMAT_R32G32B32_SFLOAT;
 			attrib.binding = bindingPoint;
 			attrib.offset = 0;
 			attrib.location = location;
@@ -172,7 +447,7 @@ namespace vfs
 		}
 		if (static_cast<int>(_commonFormat & VertexFormat::TexCoord2))
 		{
-			attrib.format = VK_FORMAT_R32G32_SFLOAT;
+			attrib.format = bPacked ? VK_FORMAT_R16G16_SFLOAT : VK_FORMAT_R32G32_SFLOAT;
 			attrib.binding = bindingPoint;
 			attrib.offset = 0;
 			attrib.location = location;
@@ -182,7 +457,7 @@ namespace vfs
 		}
 		if (static_cast<int>(_commonFormat & VertexFormat::Tangent4))
 		{
-			attrib.format = VK_FORMAT_R32G32B32A32_SFLOAT;
+			attrib.format = bPacked ? VK_FORMAT_R8G8B8A8_SNORM : VK_FORMAT_R32G32B32A32_SFLOAT;
 			attrib.binding = bindingPoint;
 			attrib.offset = 0;
 			attrib.location = location;
@@ -193,13 +468,4 @@ namespace vfs
 
 		return attribDescs;
 	}
-
-	VkPushConstantRange	SceneManager::getDefaultPushConstant(void) const
-	{
-		VkPushConstantRange pushConst = {};
-		pushConst.offset		= 0;
-		pushConst.size			= sizeof(uint32_t) * 2;
-		pushConst.stageFlags	= VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-		return pushConst;
-	}
 }
\ No newline at end of file
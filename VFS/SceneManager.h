@@ -6,6 +6,10 @@
 #include <pch.h>
 #include <GLTFScene.h>
 #include <Common/VertexFormat.h>
+#include <atomic>
+#include <deque>
+#include <string>
+#include <thread>
 
 namespace vfs
 {
@@ -15,23 +19,35 @@ namespace vfs
 	{
 	public:
 		explicit SceneManager() = default;
-		explicit SceneManager(const QueuePtr& queue, VertexFormat format);
+		explicit SceneManager(const UploadManagerPtr& uploadManager, const QueuePtr& loaderQueue, VertexFormat format);
 				~SceneManager();
-
-		static constexpr uint32_t kMaxNumScenes			 =  10u;
-		static constexpr uint32_t kMaxNumTexturePerScene = 100u;
 	public:
-		bool initialize			(const QueuePtr& queue, VertexFormat format);
+		//! Scenes are uploaded on the loader queue if given, it must not share VkQueue with render thread
+		bool initialize			(const UploadManagerPtr& uploadManager, const QueuePtr& loaderQueue, VertexFormat format);
 		void destroySceneManager(void);
+		//! Queue the scene to be loaded on background thread, it is drawn once published
 		void addScene			(const char* scenePath);
+		//! Hand finished scenes over to the render thread, call before recording passes of the frame
+		void publishLoadedScenes(void);
 
-		void cmdDraw			(VkCommandBuffer cmdBuffer, const PipelineLayoutPtr& pipelineLayout,
-								 const uint32_t pushConstOffset);
+		//! Draw all scenes with indirect draws, bindless table is bound at set 1 of the given layout
+		void cmdDraw			(VkCommandBuffer cmdBuffer, const PipelineLayoutPtr& pipelineLayout);
+		//! Bind vertex streams and bindless table shared by every scene draw, index buffer is left to the caller
+		void cmdBindGeometry	(CommandBuffer* cmdBuffer, const PipelineLayoutPtr& pipelineLayout) const;
+		//! Draw table slots of published scene draws whose world boxes are not outside of at least one
+		//! of the frustums, queried from scene BVHs. 16-bit indexed draws come first as in the draw list
+		void queryDrawSlots		(const Frustum* frustums, uint32_t numFrustums, std::vector<uint32_t>* drawSlots,
+								 uint32_t* numDrawSlots16) const;
 		void drawGUI			(void);
 
 		std::vector<VkVertexInputBindingDescription>	getVertexInputBindingDesc	(uint32_t bindOffset) const;
 		std::vector<VkVertexInputAttributeDescription>	getVertexInputAttribDesc	(uint32_t bindOffset) const;
-		VkPushConstantRange								getDefaultPushConstant		(void) const;
+
+		//! Specialization of vertex shaders consuming scene vertex streams
+		inline const VkSpecializationInfo* getVertexSpecializationInfo(void) const
+		{
+			return &_vertexSpecInfo;
+		}
 
 		inline const BoundingBox<glm::vec3>& getSceneBoundingBox(void) const
 		{
@@ -42,19 +58,84 @@ namespace vfs
 			assert(index < _scenes.size());
 			return _scenes[index];
 		}
+		inline GeometryPoolPtr getGeometryPool(void) const
+		{
+			return _geometryPool;
+		}
+		inline BindlessTablePtr getBindlessTable(void) const
+		{
+			return _bindlessTable;
+		}
+		//! Layout of the bindless table, bound at set 1 by SceneManager::cmdDraw
 		inline DescriptorSetLayoutPtr getDescriptorLayout(void) const
 		{
-			return _descLayout;
+			return _bindlessTable->getDescriptorLayout();
+		}
+		//! Draw table slots of all published scenes, 16-bit indexed draws first (drawCulling.comp)
+		inline BufferPtr getDrawListBuffer(void) const
+		{
+			return _drawListBuffer;
+		}
+		inline uint32_t getNumListedDraws16(void) const
+		{
+			return _numListedDraws16;
+		}
+		inline uint32_t getNumListedDraws(void) const
+		{
+			return _numListedDraws;
 		}
+		//! Triangle count of the largest draw among published scenes
+		inline uint32_t getMaxDrawTriangles(void) const
+		{
+			return _maxDrawTriangles;
+		}
+
+	private:
+		enum class LoadState : uint32_t
+		{
+			Queued		= 0,
+			Importing	= 1, // CPU import on the loader thread
+			Imported	= 2, // Waiting for upload on the render thread, no dedicated loader queue
+			Submitted	= 3, // Uploads submitted on the loader queue, signaling timelineValue
+			Failed		= 4,
+		};
+
+		struct SceneLoadJob
+		{
+			std::string					path;
+			std::shared_ptr<GLTFScene>	scene;
+			std::thread					thread;
+			std::atomic<LoadState>		state			{ LoadState::Queued };
+			std::atomic<float>			progress		{ 0.0f };
+			std::atomic<bool>			bWorkerDone		{ false };
+			bool						bPublished		{ false };
+			uint64_t					timelineValue	{ 0 };
+		};
+
+		void startNextLoad	(void);
+		void loadSceneWorker(SceneLoadJob* job);
+		void publishScene	(const std::shared_ptr<GLTFScene>& scene);
+		void updateDrawList	(void);
 
 	private:
 		DevicePtr				_device;
-		QueuePtr				_queue;
-		DescriptorPoolPtr		_descPool;
-		DescriptorSetLayoutPtr	_descLayout;
+		UploadManagerPtr		_uploadManager;
+		QueuePtr				_loaderQueue;
+		TimelineSemaphorePtr	_loadTimeline;
+		uint64_t				_loadTimelineValue { 0 };
+		std::deque<std::unique_ptr<SceneLoadJob>> _loadJobs; // Front one is being loaded, one at a time
+		GeometryPoolPtr			_geometryPool;
+		BindlessTablePtr		_bindlessTable;
+		BufferPtr				_drawListBuffer;
+		uint32_t				_numListedDraws16 { 0 };
+		uint32_t				_numListedDraws	  { 0 };
+		uint32_t				_maxDrawTriangles { 0 };
 		std::vector<std::shared_ptr<GLTFScene>> _scenes;
 		BoundingBox<glm::vec3>	_sceneBoundingBox;
 		VertexFormat _commonFormat;
+		VkBool32					_bPackedVertex	 { VK_FALSE };
+		VkSpecializationMapEntry	_vertexSpecEntry {};
+		VkSpecializationInfo		_vertexSpecInfo	 {};
 	};
 }
 
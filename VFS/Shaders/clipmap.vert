@@ -1,5 +1,7 @@
 #version 450
 
+#include "gltf.glsl"
+
 layout (location = 0) in vec3 aPosition;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoord;
@@ -27,22 +29,21 @@ layout ( std430, set = 1, binding = 0) readonly buffer MatrixBuffer
 	NodeMatrix nodeMatrices[];
 } uModelMatrix;
 
-
-layout ( push_constant ) uniform PushConstants
+layout ( std430, set = 1, binding = 3) readonly buffer DrawBuffer
 {
-	uint instanceIndex;
-	uint materialIndex;
-} uPushConstants;
+	GltfDrawData draws[];
+} uDrawTable;
 
 void main()
 {
+	const uint matrixIndex = uDrawTable.draws[gl_InstanceIndex].matrixIndex;
 	texCoord 	= aTexCoord;
-	normal 		= (uModelMatrix.nodeMatrices[uPushConstants.instanceIndex].itModel * 
+	normal 		= (uModelMatrix.nodeMatrices[matrixIndex].itModel * 
 				   vec4(aNormal, 1.0)).xyz;
-	tangent 	= (uModelMatrix.nodeMatrices[uPushConstants.instanceIndex].itModel * 
+	tangent 	= (uModelMatrix.nodeMatrices[matrixIndex].itModel * 
 				   vec4(aTangent.xyz, 1.0)).xyz;
-	bitangent 	= (uModelMatrix.nodeMatrices[uPushConstants.instanceIndex].itModel * 
+	bitangent 	= (uModelMatrix.nodeMatrices[matrixIndex].itModel * 
 				   vec4((cross(normal, tangent) * aTangent.w), 1.0)).xyz;
 
-	gl_Position = uCamMatrix.viewProj * uModelMatrix.nodeMatrices[uPushConstants.instanceIndex].model * vec4(aPosition, 1.0);
+	gl_Position = uCamMatrix.viewProj * uModelMatrix.nodeMatrices[matrixIndex].model * vec4(aPosition, 1.0);
 }
\ No newline at end of file
@@ -1,5 +1,8 @@
 #version 450
 
+#include "vertex.glsl"
+#include "gltf.glsl"
+
 layout (location = 0) in vec3 aPosition;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoord;
@@ -9,8 +12,12 @@ layout (location = 0) out VS_OUT {
 	vec3 normal;
 	vec2 texCoord;
 	vec4 tangent;
+	flat uint materialIndex;
 } vs_out;
 
+// Depth prepass and depth equal GBuffer pass must produce bit identical depth
+invariant gl_Position;
+
 layout ( set = 0, binding = 0 ) uniform CamMatrix
 { 
  	mat4 uViewProj;
@@ -30,17 +37,19 @@ layout ( std430, set = 1, binding = 0) readonly buffer MatrixBuffer
 	NodeMatrix uNodeMatrices[];
 };
 
-layout ( push_constant ) uniform PushConstants
+layout ( std430, set = 1, binding = 3) readonly buffer DrawBuffer
 {
-	uint uInstanceIndex;
-	uint uMaterialIndex;
+	GltfDrawData uDraws[];
 };
 
 void main()
 {
+	GltfDrawData draw = uDraws[gl_InstanceIndex];
+	vs_out.materialIndex = draw.materialIndex;
 	vs_out.texCoord	 = aTexCoord;
-	vs_out.normal	 = (uNodeMatrices[uInstanceIndex].itModel * vec4(aNormal, 0.0)).xyz;
-	vs_out.tangent	 = vec4((uNodeMatrices[uInstanceIndex].itModel * vec4(aTangent.xyz, 0.0)).xyz, aTangent.w);
+	vs_out.normal	 = (uNodeMatrices[draw.matrixIndex].itModel * vec4(fetchNormal(aNormal), 0.0)).xyz;
+	vec4 tangent	 = fetchTangent(aTangent);
+	vs_out.tangent	 = vec4((uNodeMatrices[draw.matrixIndex].itModel * vec4(tangent.xyz, 0.0)).xyz, tangent.w);
 
-	gl_Position = uViewProj * uNodeMatrices[uInstanceIndex].model * vec4(aPosition, 1.0);
+	gl_Position = uViewProj * uNodeMatrices[draw.matrixIndex].model * vec4(aPosition, 1.0);
 }
\ No newline at end of file
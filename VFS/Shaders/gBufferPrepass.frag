@@ -0,0 +1,38 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+#include "gltf.glsl"
+
+layout (location = 0) in VS_OUT {
+	vec3 normal;
+	vec2 texCoord;
+	vec4 tangent;
+	flat uint materialIndex;
+} fs_in;
+
+layout ( std430, set = 1, binding = 1) readonly buffer MaterialBuffer
+{
+	GltfShadeMaterial uMaterials[];
+};
+
+layout ( set = 1, binding = 2 ) uniform sampler2D uTextures[]; // Bindless table of all scenes
+
+// Depth only, alpha tested fragments are discarded same as gBufferPass.frag
+void main()
+{
+	GltfShadeMaterial material = uMaterials[fs_in.materialIndex];
+	if (material.alphaMode == 0)
+	{
+		return;
+	}
+
+	float alpha = material.pbrBaseColorFactor.a;
+	if (material.pbrBaseColorTexture > -1)
+	{
+		alpha *= texture(uTextures[material.pbrBaseColorTexture], fs_in.texCoord).a;
+	}
+	if (alpha < material.alphaCutoff)
+	{
+		discard;
+	}
+}
@@ -0,0 +1,133 @@
+#if !defined(GBUFFER_GLSL)
+#define GBUFFER_GLSL
+
+// Material shading shared by gBufferPass.frag and visibilityResolve.comp.
+// uTextures bindless table must be declared before including this file
+
+#include "gltf.glsl"
+#include "gbufferPacking.glsl"
+
+#define MIN_ROUGHNESS 0.04
+
+struct GBufferTexel
+{
+	vec4 diffuse;	// Diffuse color and perceptual roughness
+	vec3 normal;	// World normal
+	vec4 specular;	// Specular color and metallic
+	vec3 emission;
+	vec4 tangent;	// World tangent and handedness
+};
+
+// Values of the GBuffer targets in attachment order, packed layout has no tangent target
+struct GBufferTargets
+{
+	vec4 diffuse;
+	vec4 normal;
+	vec4 specular;
+	vec4 emission;
+	vec4 tangent;
+};
+
+GBufferTargets encodeGBuffer(GBufferTexel texel, bool bPacked)
+{
+	GBufferTargets targets;
+	targets.diffuse	 = texel.diffuse;
+	targets.specular = texel.specular;
+	targets.emission = vec4(texel.emission, 1.0);
+	if (bPacked)
+	{
+		targets.normal	= encodeTangentFrame(texel.normal, texel.tangent);
+		targets.tangent	= vec4(0.0);
+	}
+	else
+	{
+		targets.normal	= vec4(texel.normal * 0.5 + 0.5, 1.0);
+		targets.tangent	= texel.tangent * 0.5 + 0.5;
+	}
+	return targets;
+}
+
+// Textures are sampled with explicit gradients, so that compute shading matches fragment shading
+vec4 sampleMaterialTexture(int textureIndex, vec2 texCoord, vec2 dUVdx, vec2 dUVdy)
+{
+	return textureGrad(uTextures[nonuniformEXT(textureIndex)], texCoord, dUVdx, dUVdy);
+}
+
+vec4 SRGBtoLinear(vec4 srgbIn, float gamma)
+{
+	return vec4(pow(srgbIn.xyz, vec3(gamma)), srgbIn.w);
+}
+
+vec3 getNormal(GltfShadeMaterial material, vec2 texCoord, vec2 dUVdx, vec2 dUVdy, vec3 normal, vec4 tangent)
+{
+	if (material.normalTexture > -1)
+	{
+		// Only xy is stored (BC5 keeps two channels), z is reconstructed from the unit length
+		vec3 normalSample;
+		normalSample.xy = 2.0 * sampleMaterialTexture(material.normalTexture, texCoord, dUVdx, dUVdy).rg - 1.0;
+		normalSample.z  = sqrt(max(1.0 - dot(normalSample.xy, normalSample.xy), 0.0));
+		
+		vec3 bitangent = cross(normal, tangent.xyz) * tangent.w;
+
+		return normalize(
+			normalSample.x * normalize(tangent.xyz) + 
+			normalSample.y * normalize(bitangent) 	+ 
+			normalSample.z * normalize(normal)
+		);
+	}
+	else
+	{
+		return normalize(normal);
+	}
+}
+
+// Texel is always written, returns false if the fragment is cut off by alpha test
+bool shadeGBuffer(GltfShadeMaterial material, vec2 texCoord, vec2 dUVdx, vec2 dUVdy, vec3 normal, vec4 tangent,
+				  out GBufferTexel texel)
+{
+	vec3 diffuseColor			= vec3(0.0);
+	vec3 specularColor			= vec3(0.0);
+	vec4 baseColor				= vec4(0.0, 0.0, 0.0, 1.0);
+	vec3 f0						= vec3(0.04);
+	float perceptualRoughness;
+	float metallic;
+
+	perceptualRoughness = material.pbrRoughnessFactor;
+	metallic = material.pbrMetallicFactor;
+	// Roughness is stored in the 'g' channel, metallic is stored in the 'b' channel
+	// This layout intentionally reserves the 'r' channel for (optional) occlusion map data
+	if (material.pbrMetallicRoughnessTexture > -1)
+	{
+		vec4 mrSample = sampleMaterialTexture(material.pbrMetallicRoughnessTexture, texCoord, dUVdx, dUVdy);
+		perceptualRoughness *= mrSample.g;
+		metallic *= mrSample.b;
+	}
+	else
+	{
+		perceptualRoughness = clamp(perceptualRoughness, MIN_ROUGHNESS, 1.0);
+		metallic = clamp(metallic, 0.0, 1.0);
+	}
+
+	baseColor = material.pbrBaseColorFactor;
+	if (material.pbrBaseColorTexture > -1)
+	{
+		baseColor *= sampleMaterialTexture(material.pbrBaseColorTexture, texCoord, dUVdx, dUVdy);
+	}
+	diffuseColor = baseColor.rgb * (vec3(1.0) - f0) * (1.0 - metallic);
+	specularColor = mix(f0, baseColor.rgb, metallic);
+
+	texel.diffuse  = vec4(diffuseColor, perceptualRoughness);
+	texel.specular = vec4(specularColor, metallic);
+	texel.normal   = getNormal(material, texCoord, dUVdx, dUVdy, normal, tangent);
+	texel.tangent  = vec4(normalize(tangent.xyz), tangent.w);
+	
+	vec3 emissionColor 			= material.emissiveFactor;
+	if (material.emissiveTexture > -1)
+	{
+		emissionColor *= SRGBtoLinear(sampleMaterialTexture(material.emissiveTexture, texCoord, dUVdx, dUVdy), 2.2).rgb;
+	}
+	texel.emission = emissionColor;
+	return material.alphaMode <= 0 || baseColor.a >= material.alphaCutoff;
+}
+
+#endif
@@ -0,0 +1,55 @@
+#if !defined(GBUFFER_PACKING_GLSL)
+#define GBUFFER_PACKING_GLSL
+
+// GBuffer layouts, see GBufferPass::createAttachments
+// Fat	  : diffuse RGBA8, normal RGBA16F, specular RGBA8, emission RGBA16F, tangent RGBA16F (32 bytes)
+// Packed : diffuse RGBA8, tangent frame A2B10G10R10, specular RGBA8, emission B10G11R11 (16 bytes)
+// Tangent frame keeps octahedral normal in xy, tangent angle around the normal in z and handedness in w
+layout ( constant_id = 8 ) const bool PACKED_GBUFFER = false;
+
+#include "octahedral.glsl"
+
+#define TANGENT_FRAME_NORMAL_STEPS 1023.0
+#define TANGENT_FRAME_TWO_PI 6.28318530718
+
+// Reference tangent of the normal, continuous except where the normal crosses z = 0
+// (Duff et al. 2017, "Building an Orthonormal Basis, Revisited")
+void tangentFrameBasis(vec3 normal, out vec3 basisX, out vec3 basisY)
+{
+	const float s = normal.z >= 0.0 ? 1.0 : -1.0;
+	const float a = -1.0 / (s + normal.z);
+	const float b = normal.x * normal.y * a;
+	basisX = vec3(1.0 + s * normal.x * normal.x * a, s * b, -s * normal.x);
+	basisY = vec3(b, s + normal.y * normal.y * a, -normal.y);
+}
+
+// Tangent is projected onto the plane of the normal, so decoded frame is orthonormal
+vec4 encodeTangentFrame(vec3 normal, vec4 tangent)
+{
+	// Basis is built from the normal as stored, so that decoding rebuilds the same basis
+	vec2 octahedral = round((encodeOctahedral(normal) * 0.5 + 0.5) * TANGENT_FRAME_NORMAL_STEPS) / TANGENT_FRAME_NORMAL_STEPS;
+	vec3 basisX, basisY;
+	tangentFrameBasis(decodeOctahedral(octahedral * 2.0 - 1.0), basisX, basisY);
+
+	const vec2 projected = vec2(dot(tangent.xyz, basisX), dot(tangent.xyz, basisY));
+	const float angle	 = dot(projected, projected) > 0.0 ? atan(projected.y, projected.x) : 0.0;
+	return vec4(octahedral, angle / TANGENT_FRAME_TWO_PI + 0.5, tangent.w < 0.0 ? 0.0 : 1.0);
+}
+
+void decodeTangentFrame(vec4 texel, out vec3 normal, out vec4 tangent)
+{
+	normal = decodeOctahedral(texel.xy * 2.0 - 1.0);
+
+	vec3 basisX, basisY;
+	tangentFrameBasis(normal, basisX, basisY);
+	const float angle = (texel.z - 0.5) * TANGENT_FRAME_TWO_PI;
+	tangent = vec4(basisX * cos(angle) + basisY * sin(angle), texel.w < 0.5 ? -1.0 : 1.0);
+}
+
+// Normal from the texel of the second GBuffer target of either layout
+vec3 decodeGBufferNormal(vec4 texel)
+{
+	return PACKED_GBUFFER ? decodeOctahedral(texel.xy * 2.0 - 1.0) : normalize(texel.xyz * 2.0 - 1.0);
+}
+
+#endif
@@ -25,4 +25,18 @@ struct GltfShadeMaterial
 	int padding;						// 80 
 };
 
+// Entry of the draw table, indexed by gl_InstanceIndex which starts at firstInstance of each indirect draw.
+// Bounds are given in the space of vertex positions fed to the model matrix (drawCulling.comp)
+struct GltfDrawData
+{
+	vec3 boundsMin;		// 12
+	uint matrixIndex;	// 16
+	vec3 boundsMax;		// 28
+	uint materialIndex;	// 32
+	uint indexSize;		// 36, bytes per index, triangles are fetched by visibilityResolve.comp
+	uint padding0;		// 40
+	uint padding1;		// 44
+	uint padding2;		// 48
+};
+
 #endif
\ No newline at end of file
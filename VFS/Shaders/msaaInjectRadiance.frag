@@ -1,4 +1,5 @@
 #version 450
+#extension GL_EXT_nonuniform_qualifier : require
 
 #include "gltf.glsl"
 #include "atomic.glsl"
@@ -7,13 +8,13 @@
 
 #define BORDER_WIDTH 1
 
-layout( constant_id = 0 ) const uint MAX_TEXTURE_NUM 	 = 69;
 layout( constant_id = 1 ) const uint NUM_POISSON_SAMPLES = 151;
 
 layout( location = 0 ) in GS_OUT {
 	vec3 position;
 	vec2 texCoord;
 	vec3 normal;
+	flat uint materialIndex;
 } fs_in;
 
 layout ( std430, set = 1, binding = 1) readonly buffer MaterialBuffer
@@ -21,7 +22,7 @@ layout ( std430, set = 1, binding = 1) readonly buffer MaterialBuffer
 	GltfShadeMaterial uMaterials[];
 };
 
-layout ( set = 1, binding = 2 ) uniform sampler2D uTextures[MAX_TEXTURE_NUM];
+layout ( set = 1, binding = 2 ) uniform sampler2D uTextures[]; // Bindless table of all scenes
 
 layout ( set = 2, binding = 0, r32ui ) volatile uniform uimage3D uVoxelRadiance;
 layout ( set = 2, binding = 1, rgba8 ) uniform readonly image3D uVoxelOpacity;
@@ -52,13 +53,6 @@ layout ( set = 4, binding = 5 ) uniform DirectionalLightShadow {
 	DirectionalLightShadowDesc uDirectionalLightShadow;
 };
 
-layout ( push_constant ) uniform PushConstants
-{
-	uint uInstanceIndex;
-	uint uMaterialIndex;
-	// uint uNumDirectionalLight;
-};
-
 vec3  worldPosToClipmap			(vec3 pos, float maxExtent);
 ivec3 calculateImageCoords		(vec3 worldPos);
 ivec3 calculateVoxelFaceIndex	(vec3 normal);
@@ -67,7 +61,7 @@ void  voxelAtomicRGBA8Avg6Faces	(ivec3 imageCoord, vec4 color);
 
 void main()
 {
-	GltfShadeMaterial material = uMaterials[uMaterialIndex];
+	GltfShadeMaterial material = uMaterials[fs_in.materialIndex];
 	ivec3 imageCoord = calculateImageCoords(fs_in.position);
 
 	if (material.occlusionTexture > -1 && texture(uTextures[material.occlusionTexture], fs_in.texCoord).r < 0.1)
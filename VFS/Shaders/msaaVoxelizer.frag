@@ -1,20 +1,21 @@
 #version 450
+#extension GL_EXT_nonuniform_qualifier : require
 
 #include "gltf.glsl"
 
-layout( constant_id = 0 ) const uint MAX_TEXTURE_NUM = 69;
 layout( constant_id = 1 ) const  int BORDER_WIDTH    = 1;
 
 layout( location = 0 ) in GS_OUT {
 	vec3 position;
 	vec2 texCoord;
+	flat uint materialIndex;
 } fs_in;
 
 layout ( std430, set = 1, binding = 1) readonly buffer MaterialBuffer
 {
 	GltfShadeMaterial uMaterials[];
 };
-layout ( set = 1, binding = 2 ) uniform sampler2D uTextures[MAX_TEXTURE_NUM];
+layout ( set = 1, binding = 2 ) uniform sampler2D uTextures[]; // Bindless table of all scenes
 
 layout ( set = 2, binding = 0, rgba8) uniform writeonly image3D uVoxelOpacity;
 
@@ -29,12 +30,6 @@ layout ( std140, set = 3, binding = 2 ) uniform VoxelizationDesc {
 	int 	uClipmapResolution;
 };
 
-layout ( push_constant ) uniform PushConstants
-{
-	uint uInstanceIndex;
-	uint uMaterialIndex;
-};
-
 vec3 worldPosToClipmap(vec3 pos, float maxExtent)
 {
 	return fract(pos / maxExtent);
@@ -59,7 +54,7 @@ void main()
 	if (any(lessThan(fs_in.position, uRegionMinCorner)) || any(greaterThan(fs_in.position, uRegionMaxCorner)))
 		discard;
 
-	GltfShadeMaterial material = uMaterials[uMaterialIndex];
+	GltfShadeMaterial material = uMaterials[fs_in.materialIndex];
 
 	if (material.occlusionTexture > -1 && texture(uTextures[material.occlusionTexture], fs_in.texCoord).r < 0.1)
 		discard;
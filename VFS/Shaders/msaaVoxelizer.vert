@@ -1,5 +1,8 @@
 #version 450
 
+#include "vertex.glsl"
+#include "gltf.glsl"
+
 layout (location = 0) in vec3 aPosition;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoord;
@@ -8,6 +11,7 @@ layout (location = 3) in vec4 aTangent;
 layout( location = 0 ) out VS_OUT {
 	vec3 normal;
 	vec2 texCoord;
+	flat uint materialIndex;
 } vs_out;
 
 struct NodeMatrix
@@ -22,16 +26,17 @@ layout ( std430, set = 1, binding = 0) readonly buffer MatrixBuffer
 };
 
 
-layout ( push_constant ) uniform PushConstants
+layout ( std430, set = 1, binding = 3) readonly buffer DrawBuffer
 {
-	uint uInstanceIndex;
-	uint uMaterialIndex;
+	GltfDrawData uDraws[];
 };
 
 void main()
 {
+	GltfDrawData draw = uDraws[gl_InstanceIndex];
+	vs_out.materialIndex = draw.materialIndex;
 	vs_out.texCoord  = aTexCoord;
-	vs_out.normal	 = (uNodeMatrices[uInstanceIndex].itModel * vec4(aNormal, 0.0)).xyz;
+	vs_out.normal	 = (uNodeMatrices[draw.matrixIndex].itModel * vec4(fetchNormal(aNormal), 0.0)).xyz;
 
-	gl_Position = uNodeMatrices[uInstanceIndex].model * vec4(aPosition, 1.0);
+	gl_Position = uNodeMatrices[draw.matrixIndex].model * vec4(aPosition, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,29 @@
+#if !defined(OCTAHEDRAL_GLSL)
+#define OCTAHEDRAL_GLSL
+
+// Unit directions mapped onto the octahedron unfolded to [-1, 1]^2, lower hemisphere folded over the diagonals
+
+vec2 encodeOctahedral(vec3 direction)
+{
+	direction /= abs(direction.x) + abs(direction.y) + abs(direction.z);
+	vec2 octahedral = direction.xy;
+	if (direction.z < 0.0)
+	{
+		vec2 signs = vec2(octahedral.x >= 0.0 ? 1.0 : -1.0, octahedral.y >= 0.0 ? 1.0 : -1.0);
+		octahedral = (1.0 - abs(octahedral.yx)) * signs;
+	}
+	return octahedral;
+}
+
+vec3 decodeOctahedral(vec2 octahedral)
+{
+	vec3 direction = vec3(octahedral, 1.0 - abs(octahedral.x) - abs(octahedral.y));
+	if (direction.z < 0.0)
+	{
+		vec2 signs = vec2(direction.x >= 0.0 ? 1.0 : -1.0, direction.y >= 0.0 ? 1.0 : -1.0);
+		direction.xy = (1.0 - abs(direction.yx)) * signs;
+	}
+	return normalize(direction);
+}
+
+#endif
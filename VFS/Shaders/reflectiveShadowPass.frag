@@ -1,16 +1,16 @@
 #version 450
+#extension GL_EXT_nonuniform_qualifier : require
 
 #include "light.glsl"
 #include "gltf.glsl"
 
-layout( constant_id = 0 ) const uint MAX_TEXTURE_NUM = 69;
-
 layout (location = 0) in VS_OUT {
 	vec3 position;
 	vec3 normal;
 	vec3 tangent;
 	vec3 bitangent;
 	vec2 texCoord;
+	flat uint materialIndex;
 } fs_in;
 
 layout (location = 0) out vec4 rsmPosition;
@@ -22,23 +22,17 @@ layout ( std430, set = 1, binding = 1) readonly buffer MaterialBuffer
 	GltfShadeMaterial uMaterials[];
 };
 
-layout ( set = 1, binding = 2 ) uniform sampler2D uTextures[MAX_TEXTURE_NUM];
+layout ( set = 1, binding = 2 ) uniform sampler2D uTextures[]; // Bindless table of all scenes
 
 layout ( set = 2, binding = 1 ) uniform DirectionalLight {
 	DirectionalLightDesc uDirectionalLight;
 };
 
-layout ( push_constant ) uniform PushConstants
-{
-	uint uInstanceIndex;
-	uint uMaterialIndex;
-};
-
 vec3 getNormal(int normalTexture);
 
 void main()
 {
-	GltfShadeMaterial material = uMaterials[uMaterialIndex];
+	GltfShadeMaterial material = uMaterials[fs_in.materialIndex];
 
 	if (material.occlusionTexture > -1 && texture(uTextures[material.occlusionTexture], fs_in.texCoord).r < 0.1)
 		discard;
@@ -59,8 +53,10 @@ vec3 getNormal(int normalTexture)
 {
 	if (normalTexture > -1)
 	{
-		vec3 normalSample = texture(uTextures[normalTexture], fs_in.texCoord).rgb;
-		normalSample = 2.0 * normalSample - 1.0;
+		// Only xy is stored (BC5 keeps two channels), z is reconstructed from the unit length
+		vec3 normalSample;
+		normalSample.xy = 2.0 * texture(uTextures[normalTexture], fs_in.texCoord).rg - 1.0;
+		normalSample.z  = sqrt(max(1.0 - dot(normalSample.xy, normalSample.xy), 0.0));
 		
 		return normalize(
 			normalSample.x * normalize(fs_in.tangent) + 
@@ -1,6 +1,8 @@
 #version 450
 
 #include "light.glsl"
+#include "vertex.glsl"
+#include "gltf.glsl"
 
 layout (location = 0) in vec3 aPosition;
 layout (location = 1) in vec3 aNormal;
@@ -13,6 +15,7 @@ layout (location = 0) out VS_OUT {
 	vec3 tangent;
 	vec3 bitangent;
 	vec2 texCoord;
+	flat uint materialIndex;
 } vs_out;
 
 struct NodeMatrix
@@ -31,19 +34,21 @@ layout ( set = 2, binding = 0 ) uniform DirectionalLightShadow
 	DirectionalLightShadowDesc uDirLightShadowDesc;
 };
 
-layout ( push_constant ) uniform PushConstants
+layout ( std430, set = 1, binding = 3) readonly buffer DrawBuffer
 {
-	uint uInstanceIndex;
-	uint uMaterialIndex;
+	GltfDrawData uDraws[];
 };
 
 void main()
 {
-	vec4 modelPos = uNodeMatrices[uInstanceIndex].model * vec4(aPosition, 1.0);
+	GltfDrawData draw = uDraws[gl_InstanceIndex];
+	vs_out.materialIndex = draw.materialIndex;
+	vec4 modelPos = uNodeMatrices[draw.matrixIndex].model * vec4(aPosition, 1.0);
 	vs_out.position = modelPos.xyz;
-	vs_out.normal	= (uNodeMatrices[uInstanceIndex].itModel * vec4(aNormal, 0.0)).xyz;
-	vs_out.tangent	 = (uNodeMatrices[uInstanceIndex].itModel * vec4(aTangent.xyz, 0.0)).xyz;
-	vs_out.bitangent = cross(vs_out.normal, vs_out.tangent) * aTangent.w;
+	vs_out.normal	= (uNodeMatrices[draw.matrixIndex].itModel * vec4(fetchNormal(aNormal), 0.0)).xyz;
+	vec4 tangent	 = fetchTangent(aTangent);
+	vs_out.tangent	 = (uNodeMatrices[draw.matrixIndex].itModel * vec4(tangent.xyz, 0.0)).xyz;
+	vs_out.bitangent = cross(vs_out.normal, vs_out.tangent) * tangent.w;
 	vs_out.texCoord = aTexCoord;
 
 	gl_Position = uDirLightShadowDesc.proj * uDirLightShadowDesc.view * modelPos;
@@ -1,5 +1,7 @@
 #version 450
 
+#include "gltf.glsl"
+
 layout (location = 0) in vec3 aPosition;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoord;
@@ -22,13 +24,13 @@ layout ( set = 2, binding = 0 ) uniform LightViewProj
 	mat4 uLightProj;
 };
 
-layout ( push_constant ) uniform PushConstants
+layout ( std430, set = 1, binding = 3) readonly buffer DrawBuffer
 {
-	uint uInstanceIndex;
-	uint uMaterialIndex;
+	GltfDrawData uDraws[];
 };
 
 void main()
 {
-	gl_Position = uLightProj * uLightView * uNodeMatrices[uInstanceIndex].model * vec4(aPosition, 1.0);
+	GltfDrawData draw = uDraws[gl_InstanceIndex];
+	gl_Position = uLightProj * uLightView * uNodeMatrices[draw.matrixIndex].model * vec4(aPosition, 1.0);
 }
\ No newline at end of file
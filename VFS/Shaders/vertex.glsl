@@ -0,0 +1,21 @@
+#if !defined(VERTEX_GLSL)
+#define VERTEX_GLSL
+
+// True if scene vertex streams are packed (VertexFormat::Quantized)
+// Normal stream holds octahedral coordinates in xy, tangent stream holds them in xy with handedness in w
+// Packed positions need no decoding here, dequantization is folded into the model matrix
+layout ( constant_id = 0 ) const bool PACKED_VERTEX = false;
+
+#include "octahedral.glsl"
+
+vec3 fetchNormal(vec3 attribute)
+{
+	return PACKED_VERTEX ? decodeOctahedral(attribute.xy) : attribute;
+}
+
+vec4 fetchTangent(vec4 attribute)
+{
+	return PACKED_VERTEX ? vec4(decodeOctahedral(attribute.xy), attribute.w) : attribute;
+}
+
+#endif
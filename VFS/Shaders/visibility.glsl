@@ -0,0 +1,25 @@
+#if !defined(VISIBILITY_GLSL)
+#define VISIBILITY_GLSL
+
+// Visibility texel packs draw table index in the high bits and triangle of the draw in the low bits,
+// up to 16384 draws (GBufferPass::kVisibilityMaxDraws) of up to 262144 triangles each (GBufferPass::kVisibilityMaxTriangles)
+#define VISIBILITY_TRIANGLE_BITS	18u
+#define VISIBILITY_TRIANGLE_MASK	((1u << VISIBILITY_TRIANGLE_BITS) - 1u)
+#define VISIBILITY_EMPTY			0xFFFFFFFFu // Clear value, no triangle covers the pixel
+
+uint packVisibility(uint drawIndex, uint triangleIndex)
+{
+	return (drawIndex << VISIBILITY_TRIANGLE_BITS) | (triangleIndex & VISIBILITY_TRIANGLE_MASK);
+}
+
+uint unpackDrawIndex(uint visibility)
+{
+	return visibility >> VISIBILITY_TRIANGLE_BITS;
+}
+
+uint unpackTriangleIndex(uint visibility)
+{
+	return visibility & VISIBILITY_TRIANGLE_MASK;
+}
+
+#endif
@@ -0,0 +1,40 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+#include "gltf.glsl"
+#include "visibility.glsl"
+
+layout (location = 0) in VS_OUT {
+	vec2 texCoord;
+	flat uint materialIndex;
+	flat uint drawIndex;
+} fs_in;
+
+layout (location = 0) out uint outVisibility;
+
+layout ( std430, set = 1, binding = 1) readonly buffer MaterialBuffer
+{
+	GltfShadeMaterial uMaterials[];
+};
+
+layout ( set = 1, binding = 2 ) uniform sampler2D uTextures[]; // Bindless table of all scenes
+
+void main()
+{
+	// Alpha tested fragments are discarded same as gBufferPass.frag
+	GltfShadeMaterial material = uMaterials[fs_in.materialIndex];
+	if (material.alphaMode > 0)
+	{
+		float alpha = material.pbrBaseColorFactor.a;
+		if (material.pbrBaseColorTexture > -1)
+		{
+			alpha *= texture(uTextures[material.pbrBaseColorTexture], fs_in.texCoord).a;
+		}
+		if (alpha < material.alphaCutoff)
+		{
+			discard;
+		}
+	}
+
+	outVisibility = packVisibility(fs_in.drawIndex, uint(gl_PrimitiveID));
+}
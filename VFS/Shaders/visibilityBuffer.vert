@@ -0,0 +1,47 @@
+#version 450
+
+#include "gltf.glsl"
+
+layout (location = 0) in vec3 aPosition;
+layout (location = 2) in vec2 aTexCoord;
+
+layout (location = 0) out VS_OUT {
+	vec2 texCoord;
+	flat uint materialIndex;
+	flat uint drawIndex;
+} vs_out;
+
+layout ( set = 0, binding = 0 ) uniform CamMatrix
+{ 
+ 	mat4 uViewProj;
+ 	mat4 uViewProjInv;
+ 	vec3 uEyePos;
+ 	int padding;
+};
+
+struct NodeMatrix
+{
+	mat4 model;
+	mat4 itModel;
+};
+
+layout ( std430, set = 1, binding = 0) readonly buffer MatrixBuffer
+{
+	NodeMatrix uNodeMatrices[];
+};
+
+layout ( std430, set = 1, binding = 3) readonly buffer DrawBuffer
+{
+	GltfDrawData uDraws[];
+};
+
+// Only position and texture coordinates for alpha test, other attributes are fetched by visibilityResolve.comp
+void main()
+{
+	GltfDrawData draw = uDraws[gl_InstanceIndex];
+	vs_out.texCoord		 = aTexCoord;
+	vs_out.materialIndex = draw.materialIndex;
+	vs_out.drawIndex	 = gl_InstanceIndex;
+
+	gl_Position = uViewProj * uNodeMatrices[draw.matrixIndex].model * vec4(aPosition, 1.0);
+}
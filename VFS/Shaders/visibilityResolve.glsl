@@ -0,0 +1,225 @@
+#if !defined(VISIBILITY_RESOLVE_GLSL)
+#define VISIBILITY_RESOLVE_GLSL
+
+// Body of visibility resolve shared by visibilityResolve.comp and visibilityResolvePacked.comp,
+// which differ only in formats of the GBuffer storage images
+
+#include "gltf.glsl"
+#include "vertex.glsl"
+#include "visibility.glsl"
+
+struct NodeMatrix
+{
+	mat4 model;
+	mat4 itModel;
+};
+
+struct DrawIndexedIndirectCommand
+{
+	uint indexCount;
+	uint instanceCount;
+	uint firstIndex;
+	int  vertexOffset;
+	uint firstInstance;
+};
+
+// Bindless table of all scenes
+layout ( std430, set = 0, binding = 0 ) readonly buffer MatrixBuffer
+{
+	NodeMatrix uNodeMatrices[];
+};
+
+layout ( std430, set = 0, binding = 1 ) readonly buffer MaterialBuffer
+{
+	GltfShadeMaterial uMaterials[];
+};
+
+layout ( set = 0, binding = 2 ) uniform sampler2D uTextures[];
+
+layout ( std430, set = 0, binding = 3 ) readonly buffer DrawBuffer
+{
+	GltfDrawData uDraws[];
+};
+
+// Geometry pool streams read as words, packed layouts follow SceneManager::getVertexInputAttribDesc
+layout ( std430, set = 1, binding = 0 ) readonly buffer IndirectBuffer
+{
+	DrawIndexedIndirectCommand uCommands[];
+};
+
+layout ( std430, set = 1, binding = 1 ) readonly buffer IndexBuffer
+{
+	uint uIndices[];
+};
+
+layout ( std430, set = 1, binding = 2 ) readonly buffer PositionBuffer
+{
+	uint uPositions[];
+};
+
+layout ( std430, set = 1, binding = 3 ) readonly buffer NormalBuffer
+{
+	uint uNormals[];
+};
+
+layout ( std430, set = 1, binding = 4 ) readonly buffer TexCoordBuffer
+{
+	uint uTexCoords[];
+};
+
+layout ( std430, set = 1, binding = 5 ) readonly buffer TangentBuffer
+{
+	uint uTangents[];
+};
+
+layout ( set = 1, binding = 6, r32ui ) uniform readonly uimage2D uVisibility;
+// GBuffer targets from binding 7 are declared by the resolve shader of each GBuffer layout
+
+layout ( push_constant ) uniform PushConstant
+{
+	mat4  uViewProj;	// 64
+	uvec2 uResolution;	// 72
+};
+
+#include "gbuffer.glsl"
+
+// Defined by the resolve shader of each GBuffer layout
+void storeGBufferTargets(ivec2 pixel, GBufferTargets targets);
+
+uint fetchIndex(uint firstIndex, uint indexSize, uint i)
+{
+	const uint index = firstIndex + i;
+	if (indexSize == 2)
+	{
+		const uint word = uIndices[index >> 1];
+		return (index & 1u) != 0 ? (word >> 16) : (word & 0xFFFFu);
+	}
+	return uIndices[index];
+}
+
+vec3 fetchPosition(uint vertex)
+{
+	// Packed positions are dequantized by the model matrix, same as the vertex input path
+	if (PACKED_VERTEX)
+	{
+		return vec3(unpackUnorm2x16(uPositions[vertex * 2]), unpackUnorm2x16(uPositions[vertex * 2 + 1]).x);
+	}
+	return uintBitsToFloat(uvec3(uPositions[vertex * 3], uPositions[vertex * 3 + 1], uPositions[vertex * 3 + 2]));
+}
+
+vec3 fetchNormalAttribute(uint vertex)
+{
+	if (PACKED_VERTEX)
+	{
+		return fetchNormal(vec3(unpackSnorm2x16(uNormals[vertex]), 0.0));
+	}
+	return uintBitsToFloat(uvec3(uNormals[vertex * 3], uNormals[vertex * 3 + 1], uNormals[vertex * 3 + 2]));
+}
+
+vec2 fetchTexCoord(uint vertex)
+{
+	if (PACKED_VERTEX)
+	{
+		return unpackHalf2x16(uTexCoords[vertex]);
+	}
+	return uintBitsToFloat(uvec2(uTexCoords[vertex * 2], uTexCoords[vertex * 2 + 1]));
+}
+
+vec4 fetchTangentAttribute(uint vertex)
+{
+	if (PACKED_VERTEX)
+	{
+		return fetchTangent(unpackSnorm4x8(uTangents[vertex]));
+	}
+	return uintBitsToFloat(uvec4(uTangents[vertex * 4], uTangents[vertex * 4 + 1], uTangents[vertex * 4 + 2], uTangents[vertex * 4 + 3]));
+}
+
+// Perspective correct barycentrics of the pixel and their screen space derivatives, from clip space corners.
+// Barycentrics are linear in screen space once divided by w, so they and 1 / w are interpolated
+// from the projected corners and then divided by the interpolated 1 / w
+void computeBarycentrics(vec4 clip0, vec4 clip1, vec4 clip2, vec2 pixelNdc, vec2 resolution,
+						 out vec3 lambda, out vec3 lambdaDdx, out vec3 lambdaDdy)
+{
+	const vec3 invW = 1.0 / vec3(clip0.w, clip1.w, clip2.w);
+	const vec2 ndc0 = clip0.xy * invW.x;
+	const vec2 ndc1 = clip1.xy * invW.y;
+	const vec2 ndc2 = clip2.xy * invW.z;
+
+	const float invDet = 1.0 / determinant(mat2(ndc2 - ndc1, ndc0 - ndc1));
+	vec3 ddx = vec3(ndc1.y - ndc2.y, ndc2.y - ndc0.y, ndc0.y - ndc1.y) * invDet * invW;
+	vec3 ddy = vec3(ndc2.x - ndc1.x, ndc0.x - ndc2.x, ndc1.x - ndc0.x) * invDet * invW;
+	float ddxSum = ddx.x + ddx.y + ddx.z;
+	float ddySum = ddy.x + ddy.y + ddy.z;
+
+	const vec2	delta		= pixelNdc - ndc0;
+	const float interpInvW	= invW.x + delta.x * ddxSum + delta.y * ddySum;
+	const float interpW		= 1.0 / interpInvW;
+	lambda = interpW * (vec3(invW.x, 0.0, 0.0) + delta.x * ddx + delta.y * ddy);
+
+	// One pixel step is two over resolution in normalized device coordinates
+	ddx	   *= 2.0 / resolution.x;
+	ddy	   *= 2.0 / resolution.y;
+	ddxSum *= 2.0 / resolution.x;
+	ddySum *= 2.0 / resolution.y;
+	lambdaDdx = (lambda * interpInvW + ddx) / (interpInvW + ddxSum) - lambda;
+	lambdaDdy = (lambda * interpInvW + ddy) / (interpInvW + ddySum) - lambda;
+}
+
+void main()
+{
+	const ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+	if (any(greaterThanEqual(uvec2(pixel), uResolution)))
+	{
+		return;
+	}
+
+	// Pixels no triangle covers keep the clear color of the GBuffer render pass
+	const uint visibility = imageLoad(uVisibility, pixel).r;
+	if (visibility == VISIBILITY_EMPTY)
+	{
+		const vec4 clearColor = vec4(0.0, 0.0, 0.0, 1.0);
+		storeGBufferTargets(pixel, GBufferTargets(clearColor, clearColor, clearColor, clearColor, clearColor));
+		return;
+	}
+
+	const uint drawIndex	 = unpackDrawIndex(visibility);
+	const uint triangleIndex = unpackTriangleIndex(visibility);
+	const GltfDrawData draw	 = uDraws[drawIndex];
+	const DrawIndexedIndirectCommand command = uCommands[drawIndex];
+	const NodeMatrix matrices = uNodeMatrices[draw.matrixIndex];
+
+	uint vertices[3];
+	vec4 clips[3];
+	for (uint i = 0; i < 3; ++i)
+	{
+		vertices[i] = uint(int(fetchIndex(command.firstIndex, draw.indexSize, triangleIndex * 3 + i)) + command.vertexOffset);
+		clips[i]	= uViewProj * matrices.model * vec4(fetchPosition(vertices[i]), 1.0);
+	}
+
+	const vec2 resolution = vec2(uResolution);
+	const vec2 pixelNdc	  = (vec2(pixel) + 0.5) / resolution * 2.0 - 1.0;
+	vec3 lambda, lambdaDdx, lambdaDdy;
+	computeBarycentrics(clips[0], clips[1], clips[2], pixelNdc, resolution, lambda, lambdaDdx, lambdaDdy);
+
+	// Attributes are interpolated same as the vertex shader outputs of gBufferPass.vert
+	const vec2 texCoords[3] = vec2[3](fetchTexCoord(vertices[0]), fetchTexCoord(vertices[1]), fetchTexCoord(vertices[2]));
+	const vec2 texCoord = texCoords[0] * lambda.x	 + texCoords[1] * lambda.y	  + texCoords[2] * lambda.z;
+	const vec2 dUVdx	= texCoords[0] * lambdaDdx.x + texCoords[1] * lambdaDdx.y + texCoords[2] * lambdaDdx.z;
+	const vec2 dUVdy	= texCoords[0] * lambdaDdy.x + texCoords[1] * lambdaDdy.y + texCoords[2] * lambdaDdy.z;
+
+	vec3 normal	 = vec3(0.0);
+	vec4 tangent = vec4(0.0);
+	for (uint i = 0; i < 3; ++i)
+	{
+		const vec4 vertexTangent = fetchTangentAttribute(vertices[i]);
+		normal	+= (matrices.itModel * vec4(fetchNormalAttribute(vertices[i]), 0.0)).xyz * lambda[i];
+		tangent += vec4((matrices.itModel * vec4(vertexTangent.xyz, 0.0)).xyz, vertexTangent.w) * lambda[i];
+	}
+
+	// Alpha test already passed in the visibility pass, shading is written regardless of it
+	GBufferTexel texel;
+	shadeGBuffer(uMaterials[draw.materialIndex], texCoord, dUVdx, dUVdy, normal, tangent, texel);
+	storeGBufferTargets(pixel, encodeGBuffer(texel, RESOLVE_PACKED_GBUFFER));
+}
+
+#endif
@@ -3,6 +3,7 @@
 #include "light.glsl"
 #include "brdf.glsl"
 #include "shadow.glsl"
+#include "gbufferPacking.glsl"
 
 layout ( constant_id = 0 ) const int MAX_DIRECTIONAL_LIGHT_NUM 	= 8;
 layout ( constant_id = 1 ) const int CLIP_LEVEL_COUNT 			= 6;
@@ -155,7 +156,7 @@ void main()
 	vec4 diffuse 				= texture(uDiffuseTexture, fs_in.texCoord);
 	vec3 diffuseColor 			= diffuse.rgb;
 	float perceptualRoughness 	= diffuse.a;
-	vec3 normal 				= normalize(texture(uNormalTexture, fs_in.texCoord).rgb * 2.0 - 1.0);
+	vec3 normal 				= decodeGBufferNormal(texture(uNormalTexture, fs_in.texCoord));
 	vec4 specular 				= texture(uSpecularTexture, fs_in.texCoord);
 	vec3 specularColor 			= specular.rgb;
 	float metallic 				= specular.a;
@@ -1,15 +1,15 @@
 #version 450
+#extension GL_EXT_nonuniform_qualifier : require
 
 #include "gltf.glsl"
 #include "light.glsl"
 #include "shadow.glsl"
 
-layout( constant_id = 0 ) const uint MAX_TEXTURE_NUM = 69;
-
 layout( location = 0 ) in GS_OUT {
     vec3 position;
     vec3 normal;
     vec2 texCoord;
+    flat uint materialIndex;
 } fs_in;
 
 layout ( std140, set = 0, binding = 0 ) buffer CounterStorageBuffer
@@ -25,7 +25,7 @@ layout ( std430, set = 1, binding = 1) readonly buffer MaterialBuffer
 {
 	GltfShadeMaterial uMaterials[];
 };
-layout ( set = 1, binding = 2 ) uniform sampler2D uTextures[MAX_TEXTURE_NUM];
+layout ( set = 1, binding = 2 ) uniform sampler2D uTextures[]; // Bindless table of all scenes
 
 layout ( set = 2, binding = 0 ) uniform sampler2D uShadowMaps;
 layout ( set = 2, binding = 1 ) uniform DirectionalLight {
@@ -39,15 +39,13 @@ layout ( push_constant ) uniform PushConstants
 {
 	uint uVoxelResolution;
 	uint uIsCountMode;
-	uint uInstanceIndex;
-	uint uMaterialIndex;
 };
 
 uint convVec4ToRGBA8( vec4 val);
 
 void main()
 {
-	GltfShadeMaterial material = uMaterials[uMaterialIndex];
+	GltfShadeMaterial material = uMaterials[fs_in.materialIndex];
 
 	if (material.occlusionTexture > -1 && texture(uTextures[material.occlusionTexture], fs_in.texCoord).r < 0.1)
 		discard;
@@ -43,7 +43,6 @@ namespace vfs
 		const VkDevice device = _device->getDeviceHandle();
 		_imageAvailableSemaphores.clear();
 		_renderFinishedSemaphores.clear();
-		_inFlightFences.clear();
 		_framebuffers.clear();
 		for (VkImageView& view : _swapChainImageViews)
 		{
@@ -107,73 +106,14 @@ namespace vfs
 		return true;
 	}
 	
-	VkResult SwapChain::submitCommandBuffer(VkCommandBuffer* commandBuffer, uint32_t* imageIndex,
-											std::vector<VkSemaphore> waitSemaphores,
-											std::vector<VkSemaphore> signalSemaphores)
+	VkResult SwapChain::acquireNextImage(uint32_t frameIndex, uint32_t* imageIndex)
 	{
-		if (_imagesInFlight[*imageIndex] != nullptr)
-		{
-			_imagesInFlight[*imageIndex]->waitForAllFences(UINT64_MAX);
-		}
-		_imagesInFlight[*imageIndex] = _inFlightFences[_currentFrameIndex].get();
-	
-		waitSemaphores.emplace_back(_imageAvailableSemaphores[_currentFrameIndex]->getHandle());
-		signalSemaphores.emplace_back(_renderFinishedSemaphores[_currentFrameIndex]->getHandle());
-
-		VkSubmitInfo submitInfo = {};
-		submitInfo.sType				= VK_STRUCTURE_TYPE_SUBMIT_INFO;
-		submitInfo.pNext				= nullptr;
-		submitInfo.commandBufferCount	= 1;
-		submitInfo.pCommandBuffers		= commandBuffer;
-		submitInfo.waitSemaphoreCount	= static_cast<uint32_t>(waitSemaphores.size());
-		submitInfo.pWaitSemaphores		= waitSemaphores.data();
-		submitInfo.signalSemaphoreCount = static_cast<uint32_t>(signalSemaphores.size());
-		submitInfo.pSignalSemaphores	= signalSemaphores.data();
-	
-		VkPipelineStageFlags stageFlags = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-		submitInfo.pWaitDstStageMask = &stageFlags;
-	
-		VkResult result = vkResetFences(_device->getDeviceHandle(), 1, &_inFlightFences[_currentFrameIndex]->getFence(0));
-		if (result != VK_SUCCESS)
-		{
-			return result;
-		}
-
-		result = vkQueueSubmit(_graphicsQueue->getQueueHandle(), 1, &submitInfo, _inFlightFences[_currentFrameIndex]->getFence(0));
-		if (result != VK_SUCCESS)
-		{
-			return result;
-		}
-		
-		VkPresentInfoKHR presentInfo = {};
-		presentInfo.sType				= VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-		presentInfo.pNext				= nullptr;
-		presentInfo.swapchainCount		= 1;
-		presentInfo.pSwapchains			= &_swapChainHandle;
-		presentInfo.pImageIndices		= imageIndex;
-		presentInfo.waitSemaphoreCount = static_cast<uint32_t>(signalSemaphores.size());
-		presentInfo.pWaitSemaphores		= signalSemaphores.data();
-		presentInfo.pResults			= nullptr;
-
-		result = vkQueuePresentKHR(_presentQueue->getQueueHandle(), &presentInfo);
-		if (result != VK_SUCCESS)
-		{
-			return result;
-		}
-
-		_currentFrameIndex = (_currentFrameIndex + 1) % vfs::DEFAULT_NUM_FRAMES;
-		return result;
-	}
-	
-	VkResult SwapChain::acquireNextImage(uint32_t* imageIndex)
-	{
-		_inFlightFences[_currentFrameIndex]->waitForAllFences(UINT64_MAX);
-	
+		assert(frameIndex < vfs::MAX_NUM_FRAMES);
 		VkResult result = vkAcquireNextImageKHR(
 			_device->getDeviceHandle(),
 			_swapChainHandle,
 			UINT64_MAX,
-			_imageAvailableSemaphores[_currentFrameIndex]->getHandle(),
+			_imageAvailableSemaphores[frameIndex]->getHandle(),
 			VK_NULL_HANDLE,
 			imageIndex
 		);
@@ -181,6 +121,21 @@ namespace vfs
 		return result;
 	}
 
+	VkResult SwapChain::present(uint32_t imageIndex, const std::vector<VkSemaphore>& waitSemaphores)
+	{
+		VkPresentInfoKHR presentInfo = {};
+		presentInfo.sType				= VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+		presentInfo.pNext				= nullptr;
+		presentInfo.swapchainCount		= 1;
+		presentInfo.pSwapchains			= &_swapChainHandle;
+		presentInfo.pImageIndices		= &imageIndex;
+		presentInfo.waitSemaphoreCount	= static_cast<uint32_t>(waitSemaphores.size());
+		presentInfo.pWaitSemaphores		= waitSemaphores.data();
+		presentInfo.pResults			= nullptr;
+
+		return vkQueuePresentKHR(_presentQueue->getQueueHandle(), &presentInfo);
+	}
+
 	bool SwapChain::initializeSwapChain(void)
 	{
 		SwapChain::SwapChainSupportDetails detail	= querySwapChainSupport(_device->getPhysicalDeviceHandle());
@@ -274,16 +229,13 @@ namespace vfs
 	{
 		VkDevice device = _device->getDeviceHandle();
 	
-		_imageAvailableSemaphores.reserve(vfs::DEFAULT_NUM_FRAMES);
-		_renderFinishedSemaphores.reserve(vfs::DEFAULT_NUM_FRAMES);
-		_inFlightFences.reserve(vfs::DEFAULT_NUM_FRAMES);
-		_imagesInFlight.resize(_swapChainImages.size(), nullptr);
+		_imageAvailableSemaphores.reserve(vfs::MAX_NUM_FRAMES);
+		_renderFinishedSemaphores.reserve(vfs::MAX_NUM_FRAMES);
 	
-		for (size_t i = 0; i < vfs::DEFAULT_NUM_FRAMES; ++i)
+		for (size_t i = 0; i < vfs::MAX_NUM_FRAMES; ++i)
 		{
 			_imageAvailableSemaphores.emplace_back(std::make_unique<vfs::Semaphore>(_device));
 			_renderFinishedSemaphores.emplace_back(std::make_unique<vfs::Semaphore>(_device));
-			_inFlightFences.emplace_back(std::make_shared<vfs::Fence>(_device, 1, VK_FENCE_CREATE_SIGNALED_BIT));
 		}
 		return true;
 	}
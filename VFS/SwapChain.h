@@ -4,7 +4,7 @@
 #define VFS_SWAPCHAIN_H
 
 #include <pch.h>
-#include <VulkanFramework/Sync/Fence.h>
+#include <Util/EngineConfig.h>
 #include <VulkanFramework/Sync/Semaphore.h>
 
 namespace vfs
@@ -26,10 +26,11 @@ namespace vfs
 												 vfs::QueuePtr presentQueue,
 												 vfs::WindowPtr window,
 												 VkSurfaceKHR surface);
-		VkResult			submitCommandBuffer	(VkCommandBuffer* commandBuffer, uint32_t* imageIndex, 
-												 std::vector<VkSemaphore> waitSemaphores,
-												 std::vector<VkSemaphore> signalSemaphores);
-		VkResult			acquireNextImage	(uint32_t* imageIndex);
+		//! Semaphores are indexed by the frame index given by the renderer, up to MAX_NUM_FRAMES.
+		//! Renderer must retire the last frame of the index before acquiring with it again
+		VkResult			acquireNextImage	(uint32_t frameIndex, uint32_t* imageIndex);
+		//! Present waits the given binary semaphores, signaled by the frame which rendered the image
+		VkResult			present				(uint32_t imageIndex, const std::vector<VkSemaphore>& waitSemaphores);
 
 		inline VkExtent2D		getSwapChainExtent(void) const
 		{
@@ -60,6 +61,16 @@ namespace vfs
 		{
 			return _surface;
 		}
+		inline VkSemaphore	getImageAvailableSemaphore(uint32_t frameIndex) const
+		{
+			assert(frameIndex < vfs::MAX_NUM_FRAMES);
+			return _imageAvailableSemaphores[frameIndex]->getHandle();
+		}
+		inline VkSemaphore	getRenderFinishedSemaphore(uint32_t frameIndex) const
+		{
+			assert(frameIndex < vfs::MAX_NUM_FRAMES);
+			return _renderFinishedSemaphores[frameIndex]->getHandle();
+		}
 	private:
 		bool				initializeSwapChain		(void);
 		bool				initializeImageViews	(void);
@@ -84,8 +95,6 @@ namespace vfs
 		std::vector<VkImageView>		 _swapChainImageViews;
 		std::vector<std::unique_ptr<vfs::Semaphore>> _imageAvailableSemaphores;
 		std::vector<std::unique_ptr<vfs::Semaphore>> _renderFinishedSemaphores;
-		std::vector<vfs::FencePtr>		 _inFlightFences;
-		std::vector<vfs::Fence*  >		 _imagesInFlight;
 		DevicePtr						 _device				{  		nullptr		  };
 		RenderPassPtr					 _renderPass			{		nullptr		  };
 		QueuePtr						 _graphicsQueue			{  		nullptr		  };
@@ -100,7 +109,6 @@ namespace vfs
 		VkSwapchainKHR					 _swapChainHandle		{	VK_NULL_HANDLE	  };
 		VkFormat						 _swapChainImageFormat	{ VK_FORMAT_UNDEFINED };
 		VkExtent2D						 _swapChainImageExtent	{ 0, 0 };
-		uint32_t						 _currentFrameIndex		{ 0 };
 	};
 };
 
@@ -24,6 +24,9 @@ namespace vfs
 	constexpr uint32_t		MIN_OCTREE_BRICK_NUM		= 1125000u;
 	constexpr uint32_t		MAX_OCTREE_BRICK_NUM		= 562500000u;
 
+	// GBuffer Configs
+	constexpr bool			DEFAULT_PACKED_GBUFFER			= false;	// Octahedral tangent frame and R11G11B10 emission, 16 bytes per pixel, lossy
+
 	// Voxel Cone Tracing Configs
 	constexpr uint32_t		DEFAULT_VOXEL_FACE_COUNT		= 6;
 	constexpr uint32_t		DEFAULT_CLIP_REGION_COUNT		= 6;
@@ -38,8 +41,29 @@ namespace vfs
 	// UIEngine Configs
 	constexpr uint32_t		MAX_LOG_COUNT				= 256u;
 
+	// Scene Import Configs
+	constexpr bool			DEFAULT_GENERATE_CPU_MIPMAPS	= true;
+	constexpr bool			DEFAULT_PACKED_VERTEX_FORMAT	= false;	// Quantized streams, lossy
+	constexpr bool			DEFAULT_OPTIMIZE_VERTEX_CACHE	= true;
+	constexpr bool			DEFAULT_COMPRESS_TEXTURES		= false;	// BC block compression, lossy
+	constexpr uint32_t		DEFAULT_GEOMETRY_POOL_VERTICES	= 4u * 1024u * 1024u;
+	constexpr uint64_t		DEFAULT_GEOMETRY_POOL_INDEX_SIZE = 64ull * 1024ull * 1024ull;
+	constexpr uint32_t		DEFAULT_BINDLESS_MATRICES		= 64u * 1024u;
+	constexpr uint32_t		DEFAULT_BINDLESS_MATERIALS		= 16u * 1024u;
+	constexpr uint32_t		DEFAULT_BINDLESS_TEXTURES		= 16u * 1024u;
+	constexpr uint32_t		DEFAULT_BINDLESS_DRAWS			= 64u * 1024u;
+
+	// Draw Culling Configs
+	constexpr uint32_t		DEFAULT_CULL_VIEWS				= 32u;			// Culled views per frame
+	constexpr uint32_t		DEFAULT_CULL_VIEW_DRAWS			= 16u * 1024u;	// Survivor capacity of each view
+	constexpr uint32_t		DEFAULT_CULL_FRAME_CANDIDATES	= 64u * 1024u;	// Draws listed by BVH queries per frame
+
 	// Application Configs
-	constexpr uint32_t		DEFAULT_NUM_FRAMES			= 2u;
+	constexpr uint32_t		DEFAULT_NUM_FRAMES			= 2u;	// Frames in flight at startup, changed at runtime up to MAX_NUM_FRAMES
+	constexpr uint32_t		MAX_NUM_FRAMES				= 4u;	// Versions of every per-frame resource
+	constexpr bool			DEFAULT_VALIDATE_FRAME_HAZARDS = false;
+	constexpr uint64_t		DEFAULT_UPLOAD_RING_SIZE	= 64ull * 1024ull * 1024ull;
+	constexpr uint64_t		DEFAULT_FRAME_UNIFORM_SIZE	= 256ull * 1024ull;
 }
 
 #endif
\ No newline at end of file
@@ -5,9 +5,13 @@
 
 namespace vfs
 {
+	class BindlessTable;
 	class Camera;
+	class GeometryPool;
 
+	using BindlessTablePtr = std::shared_ptr<BindlessTable>;
 	using CameraPtr = std::shared_ptr<Camera>;
+	using GeometryPoolPtr = std::shared_ptr<GeometryPool>;
 };
 
 #endif
\ No newline at end of file
@@ -6,11 +6,13 @@
 #include <Util/GLTFLoader.h>
 #include <Common/Logger.h>
 #include <string>
+#include <cstring>
+#include <algorithm>
 
 namespace vfs 
 {
 	template <typename Type>
-	bool GLTFLoader::GetAttributes(const tinygltf::Model& model, const tinygltf::Primitive& primitive, std::vector<Type>& attributes, const char* name)
+	bool GLTFLoader::GetAttributes(const tinygltf::Model& model, const tinygltf::Primitive& primitive, Type* attributes, const char* name)
 	{
 		auto iter = primitive.attributes.find(name);
 		if (iter == primitive.attributes.end())
@@ -23,70 +25,103 @@ namespace vfs
 		const Type* bufData = reinterpret_cast<const Type*>(&(buffer.data[accessor.byteOffset + bufferView.byteOffset]));
 		const auto& numElements = accessor.count;
 
-		//! Supporting KHR_mesh_quantization
-		assert(accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT);
-
 		if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT)
 		{
 			if (bufferView.byteStride == 0)
 			{
-				attributes.insert(attributes.end(), bufData, bufData + numElements);
+				std::copy(bufData, bufData + numElements, attributes);
 			}
 			else
 			{
 				auto bufferByte = reinterpret_cast<const unsigned char*>(bufData);
 				for (size_t i = 0; i < numElements; ++i)
 				{
-					attributes.push_back(*reinterpret_cast<const Type*>(bufferByte));
+					attributes[i] = *reinterpret_cast<const Type*>(bufferByte);
 					bufferByte += bufferView.byteStride;
 				}
 			}
 		}
-		else //! The component is smaller than flaot and need to be covnerted (quantized)
+		else //! KHR_mesh_quantization, integer components are converted into float
 		{
-			//! vec3 or vec4
-			int numComponents = accessor.type;
-			//! unsigned byte or unsigned short.
-			int strideComponent = accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE ? 1 : 2;
+			const int numComponents = std::min(tinygltf::GetNumComponentsInType(static_cast<uint32_t>(accessor.type)),
+											   static_cast<int>(Type::length()));
+			const int componentSize = tinygltf::GetComponentSizeInBytes(static_cast<uint32_t>(accessor.componentType));
+			const int byteStride	= accessor.ByteStride(bufferView);
+			if (numComponents <= 0 || componentSize <= 0 || componentSize > 2 || byteStride <= 0)
+			{
+				VFS_ERROR << "Unknown attributes component type : " << accessor.componentType << " is not supported";
+				return false;
+			}
 
-			size_t byteStride = bufferView.byteStride > 0 ? bufferView.byteStride : numComponents * strideComponent;
 			auto bufferByte = reinterpret_cast<const unsigned char*>(bufData);
 			for (size_t i = 0; i < numElements; ++i)
 			{
-				Type vecValue;
-
-				auto bufferByteData = bufferByte;
+				// snowapril : missing components (e.g. alpha of RGB color) are filled with one
+				Type vecValue(1.0f);
 				for (int c = 0; c < numComponents; ++c)
 				{
-					float value = *reinterpret_cast<const float*>(bufferByteData);
-					switch (accessor.componentType)
-					{
-					case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
-						vecValue[c] = value / std::numeric_limits<unsigned short>::max();
-						break;
-					case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
-						vecValue[c] = value / std::numeric_limits<unsigned char>::max();
-						break;
-					case TINYGLTF_COMPONENT_TYPE_SHORT:
-						vecValue[c] = std::max(value / std::numeric_limits<short>::max(), -1.0f);
-						break;
-					case TINYGLTF_COMPONENT_TYPE_BYTE:
-						vecValue[c] = std::max(value / std::numeric_limits<char>::max(), -1.0f);
-						break;
-					default:
-						VFS_ERROR << "Unknown attributes component type : " << accessor.componentType << " is not supported";
-						return false;
-					}
-					bufferByteData += strideComponent;
+					vecValue[c] = DequantizeComponent(bufferByte + c * componentSize, accessor.componentType, accessor.normalized);
 				}
+				attributes[i] = vecValue;
 				bufferByte += byteStride;
-				attributes.push_back(vecValue);
 			}
 		}
 
 		return true;
 	}
 
+	inline float GLTFLoader::DequantizeComponent(const unsigned char* data, int componentType, bool bNormalized)
+	{
+		// Normalized integers follow the conversion rules of glTF specification
+		switch (componentType)
+		{
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+		{
+			const float value = static_cast<float>(*data);
+			return bNormalized ? value / 255.0f : value;
+		}
+		case TINYGLTF_COMPONENT_TYPE_BYTE:
+		{
+			const float value = static_cast<float>(*reinterpret_cast<const int8_t*>(data));
+			return bNormalized ? std::max(value / 127.0f, -1.0f) : value;
+		}
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+		{
+			uint16_t value;
+			std::memcpy(&value, data, sizeof(uint16_t));
+			return bNormalized ? static_cast<float>(value) / 65535.0f : static_cast<float>(value);
+		}
+		case TINYGLTF_COMPONENT_TYPE_SHORT:
+		{
+			int16_t value;
+			std::memcpy(&value, data, sizeof(int16_t));
+			return bNormalized ? std::max(static_cast<float>(value) / 32767.0f, -1.0f) : static_cast<float>(value);
+		}
+		default:
+			assert(false); // snowapril : unsupported types are rejected in GetAttributes
+			return 0.0f;
+		}
+	}
+
+	template <typename Type>
+	GLTFLoader::StreamView<Type> GLTFLoader::getStream(const std::vector<Type>& stream, SceneCache::Section section) const
+	{
+		StreamView<Type> view;
+		const uint8_t* sectionData{ nullptr };
+		uint64_t sectionSize{ 0 };
+		if (_sceneCache.getSection(section, &sectionData, &sectionSize))
+		{
+			view.data  = reinterpret_cast<const Type*>(sectionData);
+			view.count = static_cast<size_t>(sectionSize / sizeof(Type));
+		}
+		else
+		{
+			view.data  = stream.data();
+			view.count = stream.size();
+		}
+		return view;
+	}
+
 	template <typename Type>
 	inline std::vector<Type> GLTFLoader::GetVector(const tinygltf::Value& value)
 	{
@@ -2,9 +2,14 @@
 
 #include <pch.h>
 #include <Util/GLTFLoader.h>
+#include <Util/MipmapGenerator.h>
+#include <Util/MeshOptimizer.h>
+#include <Util/TextureContainer.h>
 #include <Common/Logger.h>
+#include <Common/CPUTimer.h>
 #include <unordered_set>
 #include <cassert>
+#include <cctype>
 
 
 #pragma warning (push)
@@ -31,25 +36,68 @@
 
 #include <tinygltf/tiny_gltf.h>
 
+// snowapril : tinygltf is built without TINYGLTF_ENABLE_DRACO, it would decode all primitives
+//			   serially while parsing. Draco buffers are decoded per primitive in processMesh instead.
+#if defined(VFS_ENABLE_DRACO)
+#include <draco/compression/decode.h>
+#endif
+
 #pragma warning (pop)
 
 namespace vfs 
 {
-	GLTFImage::GLTFImage(std::string&& name_, uint32_t width_,
-						 uint32_t height_, std::vector<uint8_t>&& data_)
-		: name(std::move(name_)), width(width_), height(height_), data(std::move(data_))
+	GLTFImage::GLTFImage(std::string&& name_, uint32_t width_, uint32_t height_, 
+						 std::vector<uint8_t>&& data_, uint32_t mipLevels_, TextureFormat format_)
+		: name(std::move(name_)), width(width_), height(height_), data(std::move(data_)), mipLevels(mipLevels_), format(format_)
 	{ 
 	}
 
+	GLTFImage::GLTFImage(std::string&& name_, uint32_t width_, uint32_t height_, 
+						 const uint8_t* mappedData_, uint32_t mipLevels_, TextureFormat format_)
+		: name(std::move(name_)), width(width_), height(height_), mappedData(mappedData_), mipLevels(mipLevels_), format(format_)
+	{
+	}
+
+	uint64_t GLTFImage::getNumBytes(void) const
+	{
+		return TextureCompressor::GetMipChainSize(format, width, height, mipLevels);
+	}
+
 	bool GLTFLoader::loadScene(const char* filename, VertexFormat format)
 	{
 		assert(static_cast<int>(format & VertexFormat::Position3) && "Scene model must contain Position attribute");
+		// snowapril : source streams are always kept in fp32, packing is done by the consumer on upload
+		format = format & ~VertexFormat::Quantized;
+
+		// Try binary scene cache first, it skips json parsing, image decoding and attribute generation
+		uint64_t sourceHash{ 0 };
+		const bool bSourceHashed = SceneCache::HashFile(filename, &sourceHash);
+		if (bSourceHashed && loadSceneCache(filename, sourceHash, format))
+		{
+			reportProgress(kProgressImported);
+			return true;
+		}
+
+		// Worker pool lives only during the import
+		ThreadPool threadPool(ThreadPool::GetDefaultNumThreads());
 
 		tinygltf::Model model;
-		if (!LoadModel(&model, filename))
+		std::vector<uint32_t> imageMipLevels;
+		std::vector<TextureFormat> imageFormats;
+		if (!LoadModel(&model, filename, &threadPool, _bGenerateMipmaps, &imageMipLevels, &imageFormats))
 			return false;
+		reportProgress(kProgressImported * 0.5f);
+
+		// Counting pass, prefix sum of vertex and index counts gives each primitive
+		// its own output range so that primitives can be processed independently.
+		struct PrimitiveSource
+		{
+			const tinygltf::Primitive*	primitive;
+			const std::string*			name;
+		};
+		std::vector<PrimitiveSource> primitives;
 
-		uint32_t numVertices{ 0 }, numIndices{ 0 }, primCount{ 0 }, meshCount{ 0 };
+		uint32_t numVertices{ 0 }, numIndices{ 0 }, primCount{ 0 }, meshCount{ 0 }, dracoPrimCount{ 0 };
 		for (const auto& mesh : model.meshes)
 		{
 			std::vector<uint32_t> vPrim;
@@ -58,41 +106,73 @@ namespace vfs
 				if (prim.mode != TINYGLTF_MODE_TRIANGLES)
 					continue;
 
+				// Accessors of Draco primitive keep their counts, so ranges can be reserved before decoding
+				if (IsDracoCompressed(prim))
+				{
+#if defined(VFS_ENABLE_DRACO)
+					++dracoPrimCount;
+#else
+					VFS_ERROR << "Primitive of mesh " << mesh.name << " is Draco compressed, build with VFS_ENABLE_DRACO to decode it";
+					continue;
+#endif
+				}
+
+				GLTFPrimMesh primMesh;
+				primMesh.vertexOffset = numVertices;
+				primMesh.firstIndex	  = numIndices;
+
 				const auto& posAccessor = model.accessors[prim.attributes.find("POSITION")->second];
 				numVertices += static_cast<uint32_t>(posAccessor.count);
 				if (prim.indices > -1)
 				{
 					const auto& indexAccessor = model.accessors[prim.indices];
+					if (indexAccessor.componentType != TINYGLTF_PARAMETER_TYPE_UNSIGNED_INT	  &&
+						indexAccessor.componentType != TINYGLTF_PARAMETER_TYPE_UNSIGNED_SHORT &&
+						indexAccessor.componentType != TINYGLTF_PARAMETER_TYPE_UNSIGNED_BYTE)
+					{
+						VFS_ERROR << "Unknown index component type : " << indexAccessor.componentType << " is not supported";
+						numVertices = primMesh.vertexOffset;
+						continue;
+					}
 					numIndices += static_cast<uint32_t>(indexAccessor.count);
 				}
 				else
 				{
 					numIndices += static_cast<uint32_t>(posAccessor.count);
 				}
+				_scenePrimMeshes.push_back(primMesh);
+				primitives.push_back({ &prim, &mesh.name });
 				vPrim.push_back(primCount++);
 			}
 			_meshToPrimMap[meshCount++] = std::move(vPrim);
 		}
 
-		_positions.reserve(numVertices);
-		_indices.reserve(numIndices);
+		_positions.resize(numVertices);
+		_indices.resize(numIndices);
 		if (static_cast<int>(format & VertexFormat::Normal3))
-			_normals.reserve(numVertices);
+			_normals.resize(numVertices);
 		if (static_cast<int>(format & VertexFormat::Tangent4))
-			_tangents.reserve(numVertices);
+			_tangents.resize(numVertices);
 		if (static_cast<int>(format & VertexFormat::Color4))
-			_colors.reserve(numVertices);
+			_colors.resize(numVertices);
 		if (static_cast<int>(format & VertexFormat::TexCoord2))
-			_texCoords.reserve(numVertices);
+			_texCoords.resize(numVertices);
 
 		// Convert all mesh/primitves+ to a single primitive per mesh.
-		for (const auto& mesh : model.meshes)
+		// Every primitive writes only to its own range, no synchronization required.
+		CPUTimer primTimer;
+		threadPool.parallelFor(primCount, [&](uint32_t primIndex) {
+			const PrimitiveSource& source = primitives[primIndex];
+			processMesh(model, *source.primitive, format, *source.name, &_scenePrimMeshes[primIndex]);
+		});
+		VFS_INFO << primCount << " primitives processed, " << dracoPrimCount << " Draco compressed ( " 
+				 << primTimer.elapsedMilliSeconds() << " ms, " << threadPool.getNumThreads() << " threads )";
+
+		if (_bOptimizeVertexCache)
 		{
-			for (const auto& prim : mesh.primitives)
-			{
-				processMesh(model, prim, format, mesh.name);
-			}
+			optimizePrimMeshes(&threadPool);
 		}
+		reportProgress(kProgressImported * 0.7f);
 
 		// Transforming the scene hierarchy to a flat list.
 		int defaultScene = model.defaultScene > -1 ? model.defaultScene : 0;
@@ -108,62 +188,401 @@ namespace vfs
 
 		// Clear all temporal resources.
 		_meshToPrimMap.clear();
-		_u8Buffer.clear();
-		_u16Buffer.clear();
-		_u32Buffer.clear();
 
 		// Import materials from the model
 		importMaterials(model);
 
-		// Finally import images from the model
-		for (tinygltf::Texture& texture : model.textures)
+		// Finally import textures and their images from the model
+		importTextures(&model, imageMipLevels, imageFormats);
+		if (_bCompressTextures)
+		{
+			compressImages(&threadPool);
+		}
+		reportProgress(kProgressImported * 0.9f);
+
+		if (bSourceHashed && !writeSceneCache(filename, model, sourceHash, format))
 		{
-			tinygltf::Image& image = model.images[texture.source];
-			_images.emplace_back(std::move(image.name), image.width, image.height, std::move(image.image));
+			VFS_WARN << "Failed to write scene cache for " << filename;
 		}
 
+		reportProgress(kProgressImported);
 		return true;
 	}
 
-	void GLTFLoader::processMesh(const tinygltf::Model& model, const tinygltf::Primitive& mesh, VertexFormat format, const std::string& name)
+	void GLTFLoader::importTextures(tinygltf::Model* model, const std::vector<uint32_t>& imageMipLevels,
+									const std::vector<TextureFormat>& imageFormats)
 	{
-		GLTFPrimMesh resultMesh;
-		resultMesh.name = name;
-		resultMesh.materialIndex = mesh.material < 0 ? 0 : mesh.material;
-		resultMesh.vertexOffset = static_cast<uint32_t>(_positions.size());
-		resultMesh.firstIndex = static_cast<uint32_t>(_indices.size());
+		// Images of pre-compressed containers are preferred over the fallback source
+		auto GetUsableSource = [&](const tinygltf::Texture& texture) -> int {
+			for (const char* extensionName : { MSFT_TEXTURE_DDS_EXTENSION_NAME, KHR_TEXTURE_BASISU_EXTENSION_NAME })
+			{
+				auto extension = texture.extensions.find(extensionName);
+				if (extension == texture.extensions.end() || !extension->second.Has("source"))
+				{
+					continue;
+				}
 
+				const int source = extension->second.Get("source").Get<int>();
+				const bool bBlockCompressed = source > -1 && source < static_cast<int>(model->images.size()) &&
+											  TextureCompressor::IsBlockCompressed(imageFormats[source]);
+				// snowapril : block compressed images are skipped when compression is disabled
+				if (source > -1 && source < static_cast<int>(model->images.size()) &&
+					!model->images[source].image.empty() && (_bCompressTextures || !bBlockCompressed))
+				{
+					return source;
+				}
+			}
+			const bool bValidSource = texture.source > -1 && texture.source < static_cast<int>(model->images.size());
+			return bValidSource && !model->images[texture.source].image.empty() ? texture.source : -1;
+		};
+
+		// Images are imported once per source even if several textures refer to them
+		std::vector<int> imageRemap(model->images.size(), -1);
+		_sceneTextures.reserve(model->textures.size());
+		for (const tinygltf::Texture& texture : model->textures)
+		{
+			GLTFTexture sceneTexture;
+			if (texture.sampler > -1)
+			{
+				const tinygltf::Sampler& sampler = model->samplers[texture.sampler];
+				sceneTexture.magFilter	= sampler.magFilter;
+				sceneTexture.minFilter	= sampler.minFilter;
+				sceneTexture.wrapS		= sampler.wrapS;
+				sceneTexture.wrapT		= sampler.wrapT;
+			}
+
+			const int source = GetUsableSource(texture);
+			if (source < 0)
+			{
+				VFS_WARN << "Texture " << texture.name << " has no supported image source";
+			}
+			else
+			{
+				int& imageIndex = imageRemap[source];
+				if (imageIndex < 0)
+				{
+					tinygltf::Image& image = model->images[source];
+					imageIndex = static_cast<int>(_images.size());
+					_images.emplace_back(std::move(image.name), image.width, image.height, 
+										 std::move(image.image), imageMipLevels[source], imageFormats[source]);
+				}
+				sceneTexture.imageIndex = imageIndex;
+			}
+			_sceneTextures.push_back(sceneTexture);
+		}
+	}
+
+	void GLTFLoader::compressImages(ThreadPool* threadPool)
+	{
+		if (!_bGenerateMipmaps)
+		{
+			VFS_WARN << "Texture compression requires CPU mipmap generation, textures are kept uncompressed";
+			return;
+		}
+
+		// Format is chosen by the material slots sampling the image
+		enum SlotUsage : uint32_t
+		{
+			UsageColor			= 1 << 0,
+			UsageColorAlpha		= 1 << 1,
+			UsageNormal			= 1 << 2,
+		};
+		std::vector<uint32_t> usages(_images.size(), 0);
+		auto AddUsage = [&](int textureIndex, uint32_t usage) {
+			if (textureIndex > -1 && textureIndex < static_cast<int>(_sceneTextures.size()) &&
+				_sceneTextures[textureIndex].imageIndex > -1)
+			{
+				usages[_sceneTextures[textureIndex].imageIndex] |= usage;
+			}
+		};
+		for (const GLTFMaterial& material : _sceneMaterials)
+		{
+			// snowapril : alpha of opaque materials is never read
+			AddUsage(material.baseColorTexture,			material.alphaMode == 0 ? UsageColor : UsageColorAlpha);
+			AddUsage(material.metallicRoughnessTexture, UsageColor);
+			AddUsage(material.emissiveTexture,			UsageColor);
+			AddUsage(material.occlusionTexture,			UsageColor);
+			AddUsage(material.normalTexture,			UsageNormal);
+		}
+
+		CPUTimer compressTimer;
+		uint64_t numBytesBefore{ 0 }, numBytesAfter{ 0 };
+		std::vector<TextureFormat> targetFormats(_images.size(), TextureFormat::RGBA8);
+		for (size_t i = 0; i < _images.size(); ++i)
+		{
+			const GLTFImage& image = _images[i];
+			// Block formats cannot be blitted, so the whole mip chain must be generated on CPU
+			const bool bFullMipChain = image.mipLevels == MipmapGenerator::GetNumMipLevels(image.width, image.height);
+			if (image.format != TextureFormat::RGBA8 || !bFullMipChain)
+			{
+				continue;
+			}
+
+			// Normal maps shared with color slots keep uncompressed texels
+			const uint32_t usage = usages[i];
+			if (usage == UsageNormal)
+				targetFormats[i] = TextureFormat::BC5;
+			else if ((usage & UsageNormal) == 0 && (usage & UsageColorAlpha) != 0)
+				targetFormats[i] = TextureFormat::BC3;
+			else if ((usage & UsageNormal) == 0 && (usage & UsageColor) != 0)
+				targetFormats[i] = TextureFormat::BC1;
+			numBytesBefore += targetFormats[i] != TextureFormat::RGBA8 ? image.getNumBytes() : 0;
+		}
+
+		threadPool->parallelFor(static_cast<uint32_t>(_images.size()), [&](uint32_t imageIndex) {
+			GLTFImage& image = _images[imageIndex];
+			if (targetFormats[imageIndex] != TextureFormat::RGBA8)
+			{
+				std::vector<uint8_t> compressed;
+				TextureCompressor::CompressMipChain(targetFormats[imageIndex], image.data.data(), 
+													image.width, image.height, image.mipLevels, &compressed);
+				image.data	 = std::move(compressed);
+				image.format = targetFormats[imageIndex];
+			}
+		});
+
+		for (size_t i = 0; i < _images.size(); ++i)
+		{
+			numBytesAfter += targetFormats[i] != TextureFormat::RGBA8 ? _images[i].getNumBytes() : 0;
+		}
+		VFS_INFO << "Textures compressed ( " << compressTimer.elapsedMilliSeconds() << " ms ) "
+				 << (numBytesBefore >> 10) << " KB -> " << (numBytesAfter >> 10) << " KB";
+	}
+
+	void GLTFLoader::optimizePrimMeshes(ThreadPool* threadPool)
+	{
+		CPUTimer optimizeTimer;
+		const uint32_t primCount = static_cast<uint32_t>(_scenePrimMeshes.size());
+		std::vector<uint32_t> missesBefore(primCount, 0), missesAfter(primCount, 0);
+
+		// Primitives own disjoint ranges of every stream, so they are optimized independently
+		threadPool->parallelFor(primCount, [&](uint32_t primIndex) {
+			const GLTFPrimMesh& primMesh = _scenePrimMeshes[primIndex];
+			uint32_t* indices = _indices.data() + primMesh.firstIndex;
+
+			// snowapril : cache simulation is indexed by vertex as well, so range is checked before anything else
+			if (std::any_of(indices, indices + primMesh.indexCount, [&](uint32_t index) { return index >= primMesh.vertexCount; }))
+			{
+				VFS_WARN << "Primitive of " << primMesh.name << " has out of range indices, skip optimization";
+				return;
+			}
+
+			missesBefore[primIndex] = MeshOptimizer::CountCacheMisses(indices, primMesh.indexCount, primMesh.vertexCount,
+																	  MeshOptimizer::kSimulatedCacheSize);
+			missesAfter[primIndex]	= missesBefore[primIndex];
+
+			MeshOptimizer::OptimizeVertexCache(indices, primMesh.indexCount, primMesh.vertexCount);
+			missesAfter[primIndex] = MeshOptimizer::CountCacheMisses(indices, primMesh.indexCount, primMesh.vertexCount,
+																	 MeshOptimizer::kSimulatedCacheSize);
+
+			std::vector<uint32_t> remap;
+			MeshOptimizer::OptimizeVertexFetch(indices, primMesh.indexCount, primMesh.vertexCount, &remap);
+			MeshOptimizer::RemapVertexStream(_positions.data() + primMesh.vertexOffset, primMesh.vertexCount, remap);
+			if (!_normals.empty())
+				MeshOptimizer::RemapVertexStream(_normals.data()	+ primMesh.vertexOffset, primMesh.vertexCount, remap);
+			if (!_tangents.empty())
+				MeshOptimizer::RemapVertexStream(_tangents.data()	+ primMesh.vertexOffset, primMesh.vertexCount, remap);
+			if (!_colors.empty())
+				MeshOptimizer::RemapVertexStream(_colors.data()		+ primMesh.vertexOffset, primMesh.vertexCount, remap);
+			if (!_texCoords.empty())
+				MeshOptimizer::RemapVertexStream(_texCoords.data()	+ primMesh.vertexOffset, primMesh.vertexCount, remap);
+		});
+
+		// ACMR : transformed vertices per triangle, ATVR : transformed vertices per unique vertex
+		uint64_t numTriangles{ 0 }, numVertices{ 0 }, numMissesBefore{ 0 }, numMissesAfter{ 0 };
+		for (uint32_t primIndex = 0; primIndex < primCount; ++primIndex)
+		{
+			numTriangles	+= _scenePrimMeshes[primIndex].indexCount / 3;
+			numVertices		+= _scenePrimMeshes[primIndex].vertexCount;
+			numMissesBefore += missesBefore[primIndex];
+			numMissesAfter	+= missesAfter[primIndex];
+		}
+		const double triangleScale	= numTriangles > 0 ? 1.0 / static_cast<double>(numTriangles) : 0.0;
+		const double vertexScale	= numVertices  > 0 ? 1.0 / static_cast<double>(numVertices)	 : 0.0;
+		VFS_INFO << "Vertex cache optimized ( " << optimizeTimer.elapsedMilliSeconds() << " ms ) "
+				 << "ACMR " << numMissesBefore * triangleScale << " -> " << numMissesAfter * triangleScale << ", "
+				 << "ATVR " << numMissesBefore * vertexScale   << " -> " << numMissesAfter * vertexScale;
+	}
+
+	namespace
+	{
+		//! Attributes of KHR_draco_mesh_compression primitive, components are converted into float
+		struct DracoAttribute
+		{
+			int					numComponents { 0 };
+			std::vector<float>	values;
+		};
+
+		struct DracoPrimitive
+		{
+			uint32_t										numPoints { 0 };
+			std::vector<uint32_t>							indices;
+			std::unordered_map<std::string, DracoAttribute> attributes; // Keyed by glTF attribute semantic
+		};
+
+		bool DecodeDracoPrimitive(const tinygltf::Model& model, const tinygltf::Primitive& primitive, DracoPrimitive* decoded)
+		{
+#if defined(VFS_ENABLE_DRACO)
+			const tinygltf::Value& extension		= primitive.extensions.find(KHR_DRACO_MESH_EXTENSION_NAME)->second;
+			const tinygltf::Value& bufferViewValue	= extension.Get("bufferView");
+			const tinygltf::Value& attributesValue	= extension.Get("attributes");
+			if (!bufferViewValue.IsInt() || !attributesValue.IsObject() ||
+				bufferViewValue.Get<int>() < 0 || bufferViewValue.Get<int>() >= static_cast<int>(model.bufferViews.size()))
+			{
+				return false;
+			}
+
+			const tinygltf::BufferView& bufferView = model.bufferViews[bufferViewValue.Get<int>()];
+			const tinygltf::Buffer& buffer = model.buffers[bufferView.buffer];
+			if (bufferView.byteOffset + bufferView.byteLength > buffer.data.size())
+			{
+				return false;
+			}
+
+			draco::DecoderBuffer decoderBuffer;
+			decoderBuffer.Init(reinterpret_cast<const char*>(buffer.data.data() + bufferView.byteOffset), bufferView.byteLength);
+			draco::Decoder decoder;
+			auto decodeResult = decoder.DecodeMeshFromBuffer(&decoderBuffer);
+			if (!decodeResult.ok())
+			{
+				return false;
+			}
+			const std::unique_ptr<draco::Mesh>& dracoMesh = decodeResult.value();
+
+			// Decoded sizes must match the accessors, their counts reserved the output ranges
+			const auto& posAccessor = model.accessors[primitive.attributes.find("POSITION")->second];
+			const size_t numIndices = primitive.indices > -1 ? model.accessors[primitive.indices].count : posAccessor.count;
+			if (dracoMesh->num_points() != posAccessor.count || static_cast<size_t>(dracoMesh->num_faces()) * 3 != numIndices)
+			{
+				return false;
+			}
+
+			decoded->numPoints = dracoMesh->num_points();
+			decoded->indices.resize(numIndices);
+			for (draco::FaceIndex f(0); f < dracoMesh->num_faces(); ++f)
+			{
+				const draco::Mesh::Face& face = dracoMesh->face(f);
+				for (uint32_t c = 0; c < 3; ++c)
+				{
+					decoded->indices[f.value() * 3 + c] = face[c].value();
+				}
+			}
+
+			for (const auto& attribute : attributesValue.Get<tinygltf::Value::Object>())
+			{
+				const draco::PointAttribute* pointAttribute = attribute.second.IsInt() ? 
+					dracoMesh->GetAttributeByUniqueId(attribute.second.Get<int>()) : nullptr;
+				if (pointAttribute == nullptr)
+				{
+					return false;
+				}
+
+				DracoAttribute& decodedAttribute = decoded->attributes[attribute.first];
+				decodedAttribute.numComponents = pointAttribute->num_components();
+				decodedAttribute.values.resize(static_cast<size_t>(decoded->numPoints) * decodedAttribute.numComponents);
+				for (draco::PointIndex i(0); i < dracoMesh->num_points(); ++i)
+				{
+					float* value = decodedAttribute.values.data() + static_cast<size_t>(i.value()) * decodedAttribute.numComponents;
+					if (!pointAttribute->ConvertValue<float>(pointAttribute->mapped_index(i), 
+															 static_cast<int8_t>(decodedAttribute.numComponents), value))
+					{
+						return false;
+					}
+				}
+			}
+			return true;
+#else
+			(void)model; (void)primitive; (void)decoded;
+			return false;
+#endif
+		}
+
+		//! Same conversion as GetAttributes, missing components are filled with one
+		template <typename Type>
+		bool GetDracoAttributes(const DracoPrimitive& decoded, Type* attributes, const char* name)
+		{
+			auto iter = decoded.attributes.find(name);
+			if (iter == decoded.attributes.end())
+				return false;
+
+			const DracoAttribute& attribute = iter->second;
+			const int numComponents = std::min(attribute.numComponents, static_cast<int>(Type::length()));
+			for (uint32_t i = 0; i < decoded.numPoints; ++i)
+			{
+				Type vecValue(1.0f);
+				for (int c = 0; c < numComponents; ++c)
+				{
+					vecValue[c] = attribute.values[static_cast<size_t>(i) * attribute.numComponents + c];
+				}
+				attributes[i] = vecValue;
+			}
+			return true;
+		}
+	}
+
+	bool GLTFLoader::IsDracoCompressed(const tinygltf::Primitive& primitive)
+	{
+		return primitive.extensions.find(KHR_DRACO_MESH_EXTENSION_NAME) != primitive.extensions.end();
+	}
+
+	void GLTFLoader::processMesh(const tinygltf::Model& model, const tinygltf::Primitive& mesh, VertexFormat format, 
+								 const std::string& name, GLTFPrimMesh* resultMesh)
+	{
 		// Only triangles supported.
-		if (mesh.mode != TINYGLTF_MODE_TRIANGLES)
+		assert(mesh.mode == TINYGLTF_MODE_TRIANGLES);
+
+		resultMesh->name = name;
+		resultMesh->materialIndex = mesh.material < 0 ? 0 : mesh.material;
+
+		// Output ranges of this primitive, reserved by the counting pass
+		unsigned int* indices	= _indices.data()	+ resultMesh->firstIndex;
+		glm::vec3*	  positions = _positions.data() + resultMesh->vertexOffset;
+
+		// Draco compressed attributes are decoded on this worker, the others are read from their accessors as usual
+		DracoPrimitive draco;
+		const bool bDracoCompressed = IsDracoCompressed(mesh);
+		if (bDracoCompressed && !DecodeDracoPrimitive(model, mesh, &draco))
+		{
+			VFS_ERROR << "Failed to decode Draco compressed primitive of mesh " << name;
 			return;
+		}
+		auto getAttributes = [&](auto* attributes, const char* attributeName) {
+			return (bDracoCompressed && GetDracoAttributes(draco, attributes, attributeName)) ||
+				   GetAttributes(model, mesh, attributes, attributeName);
+		};
 
 		// Indices
-		if (mesh.indices > -1)
+		if (bDracoCompressed)
+		{
+			resultMesh->indexCount = static_cast<uint32_t>(draco.indices.size());
+			std::copy(draco.indices.begin(), draco.indices.end(), indices);
+		}
+		else if (mesh.indices > -1)
 		{
 			const tinygltf::Accessor& indexAccessor = model.accessors[mesh.indices];
 			const tinygltf::BufferView& bufferView = model.bufferViews[indexAccessor.bufferView];
 			const tinygltf::Buffer& buffer = model.buffers[bufferView.buffer];
 
-			resultMesh.indexCount = static_cast<uint32_t>(indexAccessor.count);
+			const unsigned char* indexData = &buffer.data[indexAccessor.byteOffset + bufferView.byteOffset];
+
+			resultMesh->indexCount = static_cast<uint32_t>(indexAccessor.count);
 			switch (indexAccessor.componentType)
 			{
 			case TINYGLTF_PARAMETER_TYPE_UNSIGNED_INT:
-				_u32Buffer.resize(indexAccessor.count);
-				std::memcpy(&_u32Buffer[0], &buffer.data[indexAccessor.byteOffset + bufferView.byteOffset], indexAccessor.count * sizeof(uint32_t));
-				_indices.insert(_indices.end(), std::make_move_iterator(_u32Buffer.begin()), std::make_move_iterator(_u32Buffer.end()));
+				std::memcpy(indices, indexData, indexAccessor.count * sizeof(uint32_t));
 				break;
 			case TINYGLTF_PARAMETER_TYPE_UNSIGNED_SHORT:
-				_u16Buffer.resize(indexAccessor.count);
-				std::memcpy(&_u16Buffer[0], &buffer.data[indexAccessor.byteOffset + bufferView.byteOffset], indexAccessor.count * sizeof(unsigned short));
-				_indices.insert(_indices.end(), std::make_move_iterator(_u16Buffer.begin()), std::make_move_iterator(_u16Buffer.end()));
+			{
+				const unsigned short* u16Data = reinterpret_cast<const unsigned short*>(indexData);
+				std::copy(u16Data, u16Data + indexAccessor.count, indices);
 				break;
+			}
 			case TINYGLTF_PARAMETER_TYPE_UNSIGNED_BYTE:
-				_u8Buffer.resize(indexAccessor.count);
-				std::memcpy(&_u8Buffer[0], &buffer.data[indexAccessor.byteOffset + bufferView.byteOffset], indexAccessor.count * sizeof(unsigned char));
-				_indices.insert(_indices.end(), std::make_move_iterator(_u8Buffer.begin()), std::make_move_iterator(_u8Buffer.end()));
+				std::copy(indexData, indexData + indexAccessor.count, indices);
 				break;
 			default:
-				VFS_ERROR << "Unknown index component type : " << indexAccessor.componentType << " is not supported";
+				// snowapril : unsupported types are already filtered out in the counting pass
+				assert(false);
 				return;
 			}
 		}
@@ -172,38 +591,39 @@ namespace vfs
 			// Primitive without indices, creating them
 			const auto& accessor = model.accessors[mesh.attributes.find("POSITION")->second];
 			for (uint32_t i = 0; i < accessor.count; ++i)
-				_indices.push_back(i);
-			resultMesh.indexCount = static_cast<uint32_t>(accessor.count);
+				indices[i] = i;
+			resultMesh->indexCount = static_cast<uint32_t>(accessor.count);
 		}
 
 		// POSITION
 		{
-			bool result = GetAttributes<glm::vec3>(model, mesh, _positions, "POSITION");
+			bool result = getAttributes(positions, "POSITION");
 
 			// Keeping the size of this primitive (spec says this is required information)
 			const auto& accessor = model.accessors[mesh.attributes.find("POSITION")->second];
-			resultMesh.vertexCount = static_cast<uint32_t>(accessor.count);
+			resultMesh->vertexCount = static_cast<uint32_t>(accessor.count);
 			if (accessor.minValues.empty() == false)
-				resultMesh.min = glm::vec3(accessor.minValues[0], accessor.minValues[1], accessor.minValues[2]);
+				resultMesh->min = glm::vec3(accessor.minValues[0], accessor.minValues[1], accessor.minValues[2]);
 			if (accessor.maxValues.empty() == false)
-				resultMesh.max = glm::vec3(accessor.maxValues[0], accessor.maxValues[1], accessor.maxValues[2]);
+				resultMesh->max = glm::vec3(accessor.maxValues[0], accessor.maxValues[1], accessor.maxValues[2]);
 		}
 
 		// NORMAL
 		if (static_cast<int>(format & VertexFormat::Normal3))
 		{
-			if (!GetAttributes<glm::vec3>(model, mesh, _normals, "NORMAL"))
+			glm::vec3* meshNormals = _normals.data() + resultMesh->vertexOffset;
+			if (!getAttributes(meshNormals, "NORMAL"))
 			{
 				// You need to compute the normals
-				std::vector<glm::vec3> meshNormals(resultMesh.vertexCount, glm::vec3(0.0f));
-				for (size_t i = 0; i < resultMesh.indexCount; i += 3)
+				std::fill(meshNormals, meshNormals + resultMesh->vertexCount, glm::vec3(0.0f));
+				for (size_t i = 0; i < resultMesh->indexCount; i += 3)
 				{
-					uint32_t idx0 = _indices[resultMesh.firstIndex + i + 0];
-					uint32_t idx1 = _indices[resultMesh.firstIndex + i + 1];
-					uint32_t idx2 = _indices[resultMesh.firstIndex + i + 2];
-					const auto& pos0 = _positions[resultMesh.vertexOffset + idx0];
-					const auto& pos1 = _positions[resultMesh.vertexOffset + idx1];
-					const auto& pos2 = _positions[resultMesh.vertexOffset + idx2];
+					uint32_t idx0 = indices[i + 0];
+					uint32_t idx1 = indices[i + 1];
+					uint32_t idx2 = indices[i + 2];
+					const auto& pos0 = positions[idx0];
+					const auto& pos1 = positions[idx1];
+					const auto& pos2 = positions[idx2];
 					const auto edge0 = glm::normalize(pos1 - pos0);
 					const auto edge1 = glm::normalize(pos2 - pos0);
 					const auto n = glm::normalize(glm::cross(edge0, edge1));
@@ -211,19 +631,19 @@ namespace vfs
 					meshNormals[idx1] += n;
 					meshNormals[idx2] += n;
 				}
-				_normals.insert(_normals.end(), std::make_move_iterator(meshNormals.begin()), std::make_move_iterator(meshNormals.end()));
 			}
 		}
 
 		// TEXCOORD2
 		if (static_cast<int>(format & VertexFormat::TexCoord2))
 		{
-			if (!GetAttributes<glm::vec2>(model, mesh, _texCoords, "TEXCOORD_0"))
+			glm::vec2* meshTexCoords = _texCoords.data() + resultMesh->vertexOffset;
+			if (!getAttributes(meshTexCoords, "TEXCOORD_0"))
 			{
 				// CubeMap projection
-				for (uint32_t i = 0; i < resultMesh.vertexCount; ++i)
+				for (uint32_t i = 0; i < resultMesh->vertexCount; ++i)
 				{
-					const auto& pos = _positions[resultMesh.vertexOffset + i];
+					const auto& pos = positions[i];
 					float absX = std::fabs(pos.x);
 					float absY = std::fabs(pos.y);
 					float absZ = std::fabs(pos.z);
@@ -292,7 +712,7 @@ namespace vfs
 					float u = (uc / mapAxis + 1.0f) * 0.5f;
 					float v = (vc / mapAxis + 1.0f) * 0.5f;
 
-					_texCoords.push_back(glm::vec2(u, v));
+					meshTexCoords[i] = glm::vec2(u, v);
 				}
 			}
 		}
@@ -300,21 +720,22 @@ namespace vfs
 		// TANGENT
 		if (static_cast<int>(format & VertexFormat::Tangent4))
 		{
-			if (!GetAttributes(model, mesh, _tangents, "TANGENT"))
+			glm::vec4* meshTangents = _tangents.data() + resultMesh->vertexOffset;
+			if (!getAttributes(meshTangents, "TANGENT"))
 			{
 				// Implementation in "Foundations of Game Engine Development : Volume2 Rendering"
-				std::vector<glm::vec3> tangents(resultMesh.vertexCount, glm::vec3(0.0f));
-				std::vector<glm::vec3> bitangents(resultMesh.vertexCount, glm::vec3(0.0f));
-				for (size_t i = 0; i < resultMesh.indexCount; i += 3)
+				std::vector<glm::vec3> tangents(resultMesh->vertexCount, glm::vec3(0.0f));
+				std::vector<glm::vec3> bitangents(resultMesh->vertexCount, glm::vec3(0.0f));
+				for (size_t i = 0; i < resultMesh->indexCount; i += 3)
 				{
 					// Local index
-					uint32_t idx0 = _indices[resultMesh.firstIndex + i + 0];
-					uint32_t idx1 = _indices[resultMesh.firstIndex + i + 1];
-					uint32_t idx2 = _indices[resultMesh.firstIndex + i + 2];
+					uint32_t idx0 = indices[i + 0];
+					uint32_t idx1 = indices[i + 1];
+					uint32_t idx2 = indices[i + 2];
 					// Global index
-					uint32_t gidx0 = idx0 + resultMesh.vertexOffset;
-					uint32_t gidx1 = idx1 + resultMesh.vertexOffset;
-					uint32_t gidx2 = idx2 + resultMesh.vertexOffset;
+					uint32_t gidx0 = idx0 + resultMesh->vertexOffset;
+					uint32_t gidx1 = idx1 + resultMesh->vertexOffset;
+					uint32_t gidx2 = idx2 + resultMesh->vertexOffset;
 
 					const auto& pos0 = _positions[gidx0];
 					const auto& pos1 = _positions[gidx1];
@@ -355,9 +776,9 @@ namespace vfs
 					bitangents[idx2] += bitangent;
 				}
 
-				for (uint32_t i = 0; i < resultMesh.vertexCount; ++i)
+				for (uint32_t i = 0; i < resultMesh->vertexCount; ++i)
 				{
-					const auto& n = _normals[resultMesh.vertexOffset + i];
+					const auto& n = _normals[resultMesh->vertexOffset + i];
 					const auto& t = tangents[i];
 					const auto& b = bitangents[i];
 
@@ -365,7 +786,7 @@ namespace vfs
 					glm::vec3 tangent = glm::normalize(t - n * glm::vec3(glm::dot(n, t)));
 					// Calculate the handedness
 					float handedness = (glm::dot(glm::cross(t, b), n) > 0.0f) ? 1.0f : -1.0f;
-					_tangents.emplace_back(tangent.x, tangent.y, tangent.z, handedness);
+					meshTangents[i] = glm::vec4(tangent.x, tangent.y, tangent.z, handedness);
 				}
 			}
 		}
@@ -373,26 +794,187 @@ namespace vfs
 		// COLOR
 		if (static_cast<int>(format & VertexFormat::Color4))
 		{
-			if (!GetAttributes(model, mesh, _colors, "COLOR_0"))
+			glm::vec4* meshColors = _colors.data() + resultMesh->vertexOffset;
+			if (!getAttributes(meshColors, "COLOR_0"))
 			{
-				_colors.insert(_colors.end(), resultMesh.vertexCount, glm::vec4(1.0f));
+				std::fill(meshColors, meshColors + resultMesh->vertexCount, glm::vec4(1.0f));
 			}
 		}
+	}
 
-		_scenePrimMeshes.emplace_back(resultMesh);
+	namespace
+	{
+		struct DecodedImage
+		{
+			int						width		{ 0 };
+			int						height		{ 0 };
+			uint32_t				mipLevels	{ 1 };
+			TextureFormat			format		{ TextureFormat::RGBA8 };
+			bool					bContainer	{ false }; // Decoded from DDS or KTX2 container
+			std::vector<uint8_t>	pixels;
+		};
+
+		struct ImageDecodeContext
+		{
+			ThreadPool* threadPool		 { nullptr };
+			bool		bGenerateMipmaps { false };
+			std::vector<std::pair<int, std::future<DecodedImage>>> jobs;
+		};
+
+		DecodedImage DecodeContainer(const std::vector<unsigned char>& encoded, bool bGenerateMipmaps)
+		{
+			DecodedImage decoded;
+			decoded.bContainer = true;
+
+			TextureContainer::Texture texture;
+			if (!TextureContainer::Load(encoded.data(), encoded.size(), &texture))
+			{
+				return decoded;
+			}
+
+			decoded.width		= static_cast<int>(texture.width);
+			decoded.height		= static_cast<int>(texture.height);
+			decoded.mipLevels	= texture.mipLevels;
+			decoded.format		= texture.format;
+			decoded.pixels		= std::move(texture.data);
+
+			// Uncompressed container without mip chain is handled like the other images
+			if (bGenerateMipmaps && texture.format == TextureFormat::RGBA8 && texture.mipLevels == 1)
+			{
+				decoded.mipLevels = MipmapGenerator::GetNumMipLevels(texture.width, texture.height);
+				MipmapGenerator::GenerateMipChain(&decoded.pixels, texture.width, texture.height, decoded.mipLevels);
+			}
+			return decoded;
+		}
+
+		DecodedImage DecodeImage(const std::vector<unsigned char>& encoded, bool bGenerateMipmaps)
+		{
+			DecodedImage decoded;
+			int component{ 0 };
+			// snowapril : force RGBA8 as the default loader does, 16bit images are converted here
+			stbi_uc* pixels = stbi_load_from_memory(encoded.data(), static_cast<int>(encoded.size()),
+													&decoded.width, &decoded.height, &component, STBI_rgb_alpha);
+			if (pixels == nullptr)
+			{
+				return decoded;
+			}
+
+			const size_t numBytes = static_cast<size_t>(decoded.width) * decoded.height * 4;
+			decoded.pixels.assign(pixels, pixels + numBytes);
+			stbi_image_free(pixels);
+
+			if (bGenerateMipmaps)
+			{
+				const uint32_t width  = static_cast<uint32_t>(decoded.width);
+				const uint32_t height = static_cast<uint32_t>(decoded.height);
+				decoded.mipLevels = MipmapGenerator::GetNumMipLevels(width, height);
+				MipmapGenerator::GenerateMipChain(&decoded.pixels, width, height, decoded.mipLevels);
+			}
+			return decoded;
+		}
+
+		// Image loader callback for tinygltf. Instead of decoding in place, the encoded bytes
+		// are copied and the decoding is deferred to the worker pool. The source bytes may
+		// be released right after this callback returns (external or data uri images).
+		bool LoadImageDataAsync(tinygltf::Image* image, const int imageIndex, std::string* err,
+								std::string* warn, int reqWidth, int reqHeight,
+								const unsigned char* bytes, int size, void* userData)
+		{
+			(void)warn;
+			(void)reqWidth;
+			(void)reqHeight;
+
+			ImageDecodeContext* context = static_cast<ImageDecodeContext*>(userData);
+			const bool bGenerateMipmaps = context->bGenerateMipmaps;
+
+			// DDS and KTX2 containers are parsed on the worker pool as well, extent is known after parsing
+			if (TextureContainer::IsContainer(bytes, static_cast<size_t>(size)))
+			{
+				auto encoded = std::make_shared<std::vector<unsigned char>>(bytes, bytes + size);
+				context->jobs.emplace_back(imageIndex, context->threadPool->enqueue([encoded, bGenerateMipmaps]() {
+					return DecodeContainer(*encoded, bGenerateMipmaps);
+				}));
+				return true;
+			}
+
+			int width{ 0 }, height{ 0 }, component{ 0 };
+			if (!stbi_info_from_memory(bytes, size, &width, &height, &component))
+			{
+				if (err)
+				{
+					(*err) += "Unknown image format for image[" + std::to_string(imageIndex) + 
+							  "] name = \"" + image->name + "\"\n";
+				}
+				return false;
+			}
+
+			image->width		= width;
+			image->height		= height;
+			image->component	= 4;
+			image->bits			= 8;
+			image->pixel_type	= TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE;
+
+			auto encoded = std::make_shared<std::vector<unsigned char>>(bytes, bytes + size);
+			context->jobs.emplace_back(imageIndex, context->threadPool->enqueue([encoded, bGenerateMipmaps]() {
+				return DecodeImage(*encoded, bGenerateMipmaps);
+			}));
+			return true;
+		}
 	}
 
-	bool GLTFLoader::LoadModel(tinygltf::Model* model, const char* filename)
+	bool GLTFLoader::LoadModel(tinygltf::Model* model, const char* filename, ThreadPool* threadPool, 
+							   bool bGenerateMipmaps, std::vector<uint32_t>* imageMipLevels,
+							   std::vector<TextureFormat>* imageFormats)
 	{
 		tinygltf::TinyGLTF loader;
 		std::string err, warn;
 
+		ImageDecodeContext context;
+		context.threadPool		 = threadPool;
+		context.bGenerateMipmaps = bGenerateMipmaps;
+		loader.SetImageLoader(LoadImageDataAsync, &context);
+
 		bool res = loader.LoadBinaryFromFile(model, &err, &warn, filename);
 		if (!res)
 		{
+			// Discard jobs from the failed attempt, they own their encoded bytes
+			for (auto& job : context.jobs)
+				job.second.wait();
+			context.jobs.clear();
 			res = loader.LoadASCIIFromFile(model, &err, &warn, filename);
 		}
 
+		// Gather decoded images, workers kept decoding while the rest of the gltf was parsed
+		imageMipLevels->assign(model->images.size(), 1);
+		imageFormats->assign(model->images.size(), TextureFormat::RGBA8);
+		for (auto& job : context.jobs)
+		{
+			DecodedImage decoded = job.second.get();
+			if (!res)
+			{
+				continue;
+			}
+
+			tinygltf::Image& image = model->images[job.first];
+			if (decoded.pixels.empty() && decoded.bContainer)
+			{
+				// Textures referring to this image fall back to their default source
+				VFS_WARN << "Unsupported texture container of image[" << job.first << "] " << image.name;
+				continue;
+			}
+			if (decoded.pixels.empty())
+			{
+				VFS_ERROR << "Failed to decode image[" << job.first << "] " << image.name;
+				res = false;
+				continue;
+			}
+			image.width		= decoded.width;
+			image.height	= decoded.height;
+			image.image		= std::move(decoded.pixels);
+			(*imageMipLevels)[job.first] = decoded.mipLevels;
+			(*imageFormats)[job.first]	 = decoded.format;
+		}
+
 		return res;
 	}
 
@@ -600,6 +1182,422 @@ namespace vfs
 		_texCoords.clear();
 		_indices.clear();
 		_images.clear();
+		_sceneCache.close();
+	}
+
+	namespace
+	{
+		std::string GetSceneCachePath(const char* filename)
+		{
+			return std::string(filename) + SceneCache::kFileExtension;
+		}
+
+		std::string GetSceneBaseDir(const char* filename)
+		{
+			const std::string path(filename);
+			const size_t separator = path.find_last_of("/\\");
+			return separator == std::string::npos ? std::string() : path.substr(0, separator + 1);
+		}
+
+		// Percent-decoding for external uris, same as tinygltf does before opening the file
+		std::string DecodeURI(const std::string& uri)
+		{
+			std::string decoded;
+			decoded.reserve(uri.size());
+			for (size_t i = 0; i < uri.size(); ++i)
+			{
+				if (uri[i] == '%' && i + 2 < uri.size() && 
+					std::isxdigit(static_cast<unsigned char>(uri[i + 1])) && 
+					std::isxdigit(static_cast<unsigned char>(uri[i + 2])))
+				{
+					decoded.push_back(static_cast<char>(std::stoi(uri.substr(i + 1, 2), nullptr, 16)));
+					i += 2;
+				}
+				else
+				{
+					decoded.push_back(uri[i]);
+				}
+			}
+			return decoded;
+		}
+	}
+
+	bool GLTFLoader::writeSceneCache(const char* filename, const tinygltf::Model& model, 
+									 uint64_t sourceHash, VertexFormat format) const
+	{
+		CPUTimer timer;
+		const std::string cachePath = GetSceneCachePath(filename);
+		const std::string baseDir	= GetSceneBaseDir(filename);
+
+		SceneCacheWriter writer;
+		if (!writer.begin(cachePath.c_str()))
+		{
+			return false;
+		}
+
+		// External files referenced by the gltf (.bin buffers and images).
+		// Their size and modification time are validated at load time.
+		std::vector<std::string> dependencies;
+		for (const tinygltf::Buffer& buffer : model.buffers)
+		{
+			if (!buffer.uri.empty() && !tinygltf::IsDataURI(buffer.uri))
+				dependencies.push_back(baseDir + DecodeURI(buffer.uri));
+		}
+		for (const tinygltf::Image& image : model.images)
+		{
+			if (!image.uri.empty() && !tinygltf::IsDataURI(image.uri))
+				dependencies.push_back(baseDir + DecodeURI(image.uri));
+		}
+
+		writer.beginSection(SceneCache::Section::Dependencies);
+		writer.write(static_cast<uint64_t>(dependencies.size()));
+		for (const std::string& dependency : dependencies)
+		{
+			uint64_t fileSize{ 0 };
+			int64_t modifiedTime{ 0 };
+			if (!SceneCache::GetFileStamp(dependency.c_str(), &fileSize, &modifiedTime))
+			{
+				return false;
+			}
+			writer.writeString(dependency);
+			writer.write(fileSize);
+			writer.write(modifiedTime);
+		}
+		writer.endSection();
+
+		writer.beginSection(SceneCache::Section::Tables);
+		writer.write(_sceneDim);
+
+		writer.write(static_cast<uint64_t>(_sceneMaterials.size()));
+		for (const GLTFMaterial& material : _sceneMaterials)
+		{
+			writer.writeString(material.name);
+			writer.write(material.baseColorFactor);
+			writer.write(material.baseColorTexture);
+			writer.write(material.metallicFactor);
+			writer.write(material.roughnessFactor);
+			writer.write(material.metallicRoughnessTexture);
+			writer.write(material.emissiveTexture);
+			writer.write(material.emissiveFactor);
+			writer.write(material.alphaMode);
+			writer.write(material.alphaCutoff);
+			writer.write(material.doubleSided);
+			writer.write(material.normalTexture);
+			writer.write(material.normalTextureScale);
+			writer.write(material.occlusionTexture);
+			writer.write(material.occlusionTextureStrength);
+		}
+
+		writer.write(static_cast<uint64_t>(_sceneNodes.size()));
+		for (const GLTFNode& node : _sceneNodes)
+		{
+			writer.write(node.world);
+			writer.write(node.local);
+			writer.write(node.translation);
+			writer.write(node.scale);
+			writer.write(node.rotation);
+			writer.writeVector(node.primMeshes);
+			writer.writeVector(node.childNodes);
+			writer.write(node.parentNode);
+			writer.write(node.nodeIndex);
+		}
+
+		writer.write(static_cast<uint64_t>(_scenePrimMeshes.size()));
+		for (const GLTFPrimMesh& primMesh : _scenePrimMeshes)
+		{
+			writer.write(primMesh.firstIndex);
+			writer.write(primMesh.indexCount);
+			writer.write(primMesh.vertexOffset);
+			writer.write(primMesh.vertexCount);
+			writer.write(primMesh.materialIndex);
+			writer.write(primMesh.min);
+			writer.write(primMesh.max);
+			writer.writeString(primMesh.name);
+		}
+
+		writer.write(static_cast<uint64_t>(_sceneCameras.size()));
+		for (const GLTFCamera& camera : _sceneCameras)
+		{
+			writer.write(camera.world);
+			writer.write(camera.eye);
+			writer.write(camera.center);
+			writer.write(camera.up);
+			writer.writeString(camera.camera.name);
+			writer.writeString(camera.camera.type);
+			writer.write(camera.camera.perspective.aspectRatio);
+			writer.write(camera.camera.perspective.yfov);
+			writer.write(camera.camera.perspective.zfar);
+			writer.write(camera.camera.perspective.znear);
+			writer.write(camera.camera.orthographic.xmag);
+			writer.write(camera.camera.orthographic.ymag);
+			writer.write(camera.camera.orthographic.zfar);
+			writer.write(camera.camera.orthographic.znear);
+		}
+
+		writer.write(static_cast<uint64_t>(_sceneLights.size()));
+		for (const GLTFLight& light : _sceneLights)
+		{
+			writer.write(light.world);
+			writer.writeString(light.light.name);
+			writer.writeString(light.light.type);
+			writer.writeVector(light.light.color);
+			writer.write(light.light.intensity);
+			writer.write(light.light.range);
+			writer.write(light.light.spot.innerConeAngle);
+			writer.write(light.light.spot.outerConeAngle);
+		}
+
+		writer.write(static_cast<uint64_t>(_sceneTextures.size()));
+		for (const GLTFTexture& texture : _sceneTextures)
+		{
+			writer.write(texture);
+		}
+
+		// Image records point into the Images section
+		writer.write(static_cast<uint64_t>(_images.size()));
+		uint64_t imageOffset{ 0 };
+		for (const GLTFImage& image : _images)
+		{
+			const uint64_t numBytes = image.data.size();
+			writer.writeString(image.name);
+			writer.write(image.width);
+			writer.write(image.height);
+			writer.write(image.mipLevels);
+			writer.write(image.format);
+			writer.write(imageOffset);
+			writer.write(numBytes);
+			imageOffset += (numBytes + SceneCache::kSectionAlignment - 1) & ~(SceneCache::kSectionAlignment - 1);
+		}
+		writer.endSection();
+
+		// Raw streams
+		writer.beginSection(SceneCache::Section::Positions);
+		writer.writeBytes(_positions.data(), _positions.size() * sizeof(glm::vec3));
+		writer.endSection();
+		writer.beginSection(SceneCache::Section::Normals);
+		writer.writeBytes(_normals.data(), _normals.size() * sizeof(glm::vec3));
+		writer.endSection();
+		writer.beginSection(SceneCache::Section::TexCoords);
+		writer.writeBytes(_texCoords.data(), _texCoords.size() * sizeof(glm::vec2));
+		writer.endSection();
+		writer.beginSection(SceneCache::Section::Tangents);
+		writer.writeBytes(_tangents.data(), _tangents.size() * sizeof(glm::vec4));
+		writer.endSection();
+		writer.beginSection(SceneCache::Section::Colors);
+		writer.writeBytes(_colors.data(), _colors.size() * sizeof(glm::vec4));
+		writer.endSection();
+		writer.beginSection(SceneCache::Section::Indices);
+		writer.writeBytes(_indices.data(), _indices.size() * sizeof(unsigned int));
+		writer.endSection();
+
+		writer.beginSection(SceneCache::Section::Images);
+		static const uint8_t kPadding[SceneCache::kSectionAlignment] = { 0 };
+		for (const GLTFImage& image : _images)
+		{
+			const uint64_t numBytes = image.data.size();
+			writer.writeBytes(image.data.data(), numBytes);
+			const uint64_t remainder = numBytes % SceneCache::kSectionAlignment;
+			if (remainder != 0)
+				writer.writeBytes(kPadding, SceneCache::kSectionAlignment - remainder);
+		}
+		writer.endSection();
+
+		if (!writer.end(sourceHash, format, getCacheImportFlags()))
+		{
+			return false;
+		}
+
+		VFS_INFO << cachePath << " scene cache written ( " << timer.elapsedSeconds() << " second )";
+		return true;
+	}
+
+	uint32_t GLTFLoader::getCacheImportFlags(void) const
+	{
+		uint32_t importFlags = SceneCache::ImportNone;
+		importFlags |= _bGenerateMipmaps		? SceneCache::ImportCPUMipmaps			: 0u;
+		importFlags |= _bOptimizeVertexCache	? SceneCache::ImportVertexCacheOpt		: 0u;
+		importFlags |= _bCompressTextures		? SceneCache::ImportCompressTextures	: 0u;
+		return importFlags;
+	}
+
+	bool GLTFLoader::loadSceneCache(const char* filename, uint64_t sourceHash, VertexFormat format)
+	{
+		const std::string cachePath = GetSceneCachePath(filename);
+		if (!_sceneCache.open(cachePath.c_str(), sourceHash, format, getCacheImportFlags()))
+		{
+			return false;
+		}
+
+		const uint8_t* sectionData{ nullptr };
+		uint64_t sectionSize{ 0 };
+
+		// Invalidate when any of external buffers or images has been modified
+		_sceneCache.getSection(SceneCache::Section::Dependencies, &sectionData, &sectionSize);
+		{
+			SceneCacheReader reader(sectionData, sectionSize);
+			uint64_t numDependencies{ 0 };
+			bool bValid = reader.read(&numDependencies);
+			for (uint64_t i = 0; bValid && i < numDependencies; ++i)
+			{
+				std::string dependency;
+				uint64_t cachedSize{ 0 }, fileSize{ 0 };
+				int64_t cachedTime{ 0 }, modifiedTime{ 0 };
+				bValid = reader.readString(&dependency) && reader.read(&cachedSize) && reader.read(&cachedTime) &&
+						 SceneCache::GetFileStamp(dependency.c_str(), &fileSize, &modifiedTime) &&
+						 cachedSize == fileSize && cachedTime == modifiedTime;
+			}
+			if (!bValid)
+			{
+				VFS_INFO << cachePath << " is outdated, re-importing the scene";
+				_sceneCache.close();
+				return false;
+			}
+		}
+
+		const uint8_t* imageData{ nullptr };
+		uint64_t imageDataSize{ 0 };
+		_sceneCache.getSection(SceneCache::Section::Images, &imageData, &imageDataSize);
+
+		_sceneCache.getSection(SceneCache::Section::Tables, &sectionData, &sectionSize);
+		SceneCacheReader reader(sectionData, sectionSize);
+		bool bValid = reader.read(&_sceneDim);
+
+		uint64_t count{ 0 };
+		bValid = bValid && reader.read(&count);
+		for (uint64_t i = 0; bValid && i < count; ++i)
+		{
+			GLTFMaterial material;
+			bValid = reader.readString(&material.name)				&&
+					 reader.read(&material.baseColorFactor)			&&
+					 reader.read(&material.baseColorTexture)		&&
+					 reader.read(&material.metallicFactor)			&&
+					 reader.read(&material.roughnessFactor)			&&
+					 reader.read(&material.metallicRoughnessTexture)&&
+					 reader.read(&material.emissiveTexture)			&&
+					 reader.read(&material.emissiveFactor)			&&
+					 reader.read(&material.alphaMode)				&&
+					 reader.read(&material.alphaCutoff)				&&
+					 reader.read(&material.doubleSided)				&&
+					 reader.read(&material.normalTexture)			&&
+					 reader.read(&material.normalTextureScale)		&&
+					 reader.read(&material.occlusionTexture)		&&
+					 reader.read(&material.occlusionTextureStrength);
+			_sceneMaterials.emplace_back(std::move(material));
+		}
+
+		bValid = bValid && reader.read(&count);
+		for (uint64_t i = 0; bValid && i < count; ++i)
+		{
+			GLTFNode node;
+			bValid = reader.read(&node.world)				&&
+					 reader.read(&node.local)				&&
+					 reader.read(&node.translation)			&&
+					 reader.read(&node.scale)				&&
+					 reader.read(&node.rotation)			&&
+					 reader.readVector(&node.primMeshes)	&&
+					 reader.readVector(&node.childNodes)	&&
+					 reader.read(&node.parentNode)			&&
+					 reader.read(&node.nodeIndex);
+			_sceneNodes.emplace_back(std::move(node));
+		}
+
+		bValid = bValid && reader.read(&count);
+		for (uint64_t i = 0; bValid && i < count; ++i)
+		{
+			GLTFPrimMesh primMesh;
+			bValid = reader.read(&primMesh.firstIndex)		&&
+					 reader.read(&primMesh.indexCount)		&&
+					 reader.read(&primMesh.vertexOffset)	&&
+					 reader.read(&primMesh.vertexCount)		&&
+					 reader.read(&primMesh.materialIndex)	&&
+					 reader.read(&primMesh.min)				&&
+					 reader.read(&primMesh.max)				&&
+					 reader.readString(&primMesh.name);
+			_scenePrimMeshes.emplace_back(std::move(primMesh));
+		}
+
+		bValid = bValid && reader.read(&count);
+		for (uint64_t i = 0; bValid && i < count; ++i)
+		{
+			GLTFCamera camera;
+			bValid = reader.read(&camera.world)								&&
+					 reader.read(&camera.eye)								&&
+					 reader.read(&camera.center)							&&
+					 reader.read(&camera.up)								&&
+					 reader.readString(&camera.camera.name)					&&
+					 reader.readString(&camera.camera.type)					&&
+					 reader.read(&camera.camera.perspective.aspectRatio)	&&
+					 reader.read(&camera.camera.perspective.yfov)			&&
+					 reader.read(&camera.camera.perspective.zfar)			&&
+					 reader.read(&camera.camera.perspective.znear)			&&
+					 reader.read(&camera.camera.orthographic.xmag)			&&
+					 reader.read(&camera.camera.orthographic.ymag)			&&
+					 reader.read(&camera.camera.orthographic.zfar)			&&
+					 reader.read(&camera.camera.orthographic.znear);
+			_sceneCameras.emplace_back(std::move(camera));
+		}
+
+		bValid = bValid && reader.read(&count);
+		for (uint64_t i = 0; bValid && i < count; ++i)
+		{
+			GLTFLight light;
+			bValid = reader.read(&light.world)						&&
+					 reader.readString(&light.light.name)			&&
+					 reader.readString(&light.light.type)			&&
+					 reader.readVector(&light.light.color)			&&
+					 reader.read(&light.light.intensity)			&&
+					 reader.read(&light.light.range)				&&
+					 reader.read(&light.light.spot.innerConeAngle)	&&
+					 reader.read(&light.light.spot.outerConeAngle);
+			_sceneLights.emplace_back(std::move(light));
+		}
+
+		bValid = bValid && reader.read(&count);
+		for (uint64_t i = 0; bValid && i < count; ++i)
+		{
+			GLTFTexture texture;
+			bValid = reader.read(&texture);
+			_sceneTextures.push_back(texture);
+		}
+
+		bValid = bValid && reader.read(&count);
+		for (uint64_t i = 0; bValid && i < count; ++i)
+		{
+			std::string name;
+			uint32_t width{ 0 }, height{ 0 }, mipLevels{ 0 };
+			TextureFormat format{ TextureFormat::RGBA8 };
+			uint64_t offset{ 0 }, numBytes{ 0 };
+			bValid = reader.readString(&name) && reader.read(&width) && reader.read(&height) &&
+					 reader.read(&mipLevels) && reader.read(&format) && reader.read(&offset) && reader.read(&numBytes) &&
+					 offset <= imageDataSize && numBytes <= imageDataSize - offset && format < TextureFormat::Count &&
+					 mipLevels >= 1 && mipLevels <= MipmapGenerator::GetNumMipLevels(width, height) &&
+					 numBytes == TextureCompressor::GetMipChainSize(format, width, height, mipLevels) &&
+					 (_bCompressTextures || !TextureCompressor::IsBlockCompressed(format)); // Cached on device with BC support
+			if (bValid)
+				_images.emplace_back(std::move(name), width, height, imageData + offset, mipLevels, format);
+		}
+
+		for (const GLTFTexture& texture : _sceneTextures)
+		{
+			bValid = bValid && texture.imageIndex < static_cast<int>(_images.size());
+		}
+
+		if (!bValid)
+		{
+			VFS_WARN << cachePath << " is corrupted, re-importing the scene";
+			_sceneMaterials.clear();
+			_sceneTextures.clear();
+			_sceneNodes.clear();
+			_scenePrimMeshes.clear();
+			_sceneCameras.clear();
+			_sceneLights.clear();
+			_images.clear();
+			_sceneCache.close();
+			return false;
+		}
+
+		VFS_INFO << filename << " loaded from scene cache";
+		return true;
 	}
 	
 };
\ No newline at end of file
@@ -5,13 +5,19 @@
 
 #include <pch.h>
 #include <Common/VertexFormat.h>
+#include <Util/SceneCache.h>
+#include <Util/TextureCompressor.h>
+#include <Util/EngineConfig.h>
+#include <Common/ThreadPool.h>
+#include <functional>
 #include <string>
 #include <unordered_map>
 
 namespace vfs
 {
 	//! KHR extension list (https://github.com/KhronosGroup/glTF/tree/master/extensions/2.0/Khronos)
-	#define KHR_DARCO_MESH_EXTENSION_NAME "KHR_draco_mesh_compression"
+	//! Draco primitives are decoded only if built with VFS_ENABLE_DRACO and draco library in Dependencies
+	#define KHR_DRACO_MESH_EXTENSION_NAME "KHR_draco_mesh_compression"
 	#define KHR_LIGHTS_PUNCTUAL_EXTENSION_NAME "KHR_lights_punctual"
 	#define KHR_MATERIALS_CLEARCOAT_EXTENSION_NAME "KHR_materials_clearcoat"
 	#define KHR_MATERIALS_PBR_SPECULAR_GLOSSINESS_EXTENSION_NAME "KHR_materials_pbrSpecularGlossiness"
@@ -21,6 +27,9 @@ namespace vfs
 	#define KHR_MATERIALS_VARIANTS_EXTENSION_NAME "KHR_materials_variants"
 	#define KHR_MESH_QUANTIZATION_EXTENSION_NAME "KHR_mesh_quantization"
 	#define KHR_TEXTURE_TRANSFORM_EXTENSION_NAME "KHR_texture_transform"
+	#define KHR_TEXTURE_BASISU_EXTENSION_NAME "KHR_texture_basisu"
+	//! Vendor extension list
+	#define MSFT_TEXTURE_DDS_EXTENSION_NAME "MSFT_texture_dds"
 
 	struct GLTFImage
 	{
@@ -28,9 +37,22 @@ namespace vfs
 		uint32_t			 width	{ 0 };
 		uint32_t			 height	{ 0 };
 		std::vector<uint8_t> data;
+		const uint8_t*		 mappedData { nullptr }; // Pixels living in the scene cache mapping
+		uint32_t			 mipLevels	{ 1 };		 // Greater than one if mip chain is pre-generated on CPU
+		TextureFormat		 format		{ TextureFormat::RGBA8 };
 
-		explicit GLTFImage(std::string&& name, uint32_t width, 
-						   uint32_t height, std::vector<uint8_t>&& data);
+		explicit GLTFImage(std::string&& name, uint32_t width, uint32_t height, 
+						   std::vector<uint8_t>&& data, uint32_t mipLevels, TextureFormat format);
+		explicit GLTFImage(std::string&& name, uint32_t width, uint32_t height, 
+						   const uint8_t* mappedData, uint32_t mipLevels, TextureFormat format);
+
+		//! Returns total size of pixels including pre-generated mip levels
+		uint64_t getNumBytes(void) const;
+
+		inline const uint8_t* getPixels(void) const
+		{
+			return mappedData != nullptr ? mappedData : data.data();
+		}
 	};
 
 	class GLTFLoader : NonCopyable
@@ -39,9 +61,37 @@ namespace vfs
 		explicit GLTFLoader() = default;
 		virtual ~GLTFLoader() = default;
 
+		//! Receives fraction of the import done so far, called on the importing thread
+		using ProgressCallback = std::function<void(float)>;
+		//! Progress reported once loadScene is done, the rest is left to the consumer uploading the scene
+		static constexpr float kProgressImported = 0.8f;
+
 	public:
 		bool loadScene(const char* filename, VertexFormat format);
 
+		//! Build full mip chain of textures on CPU while importing.
+		//! Otherwise mip levels are blitted on GPU after upload.
+		inline void setMipmapGeneration(bool bGenerateMipmaps)
+		{
+			_bGenerateMipmaps = bGenerateMipmaps;
+		}
+		//! Reorder triangles and vertices of each primitive for post-transform cache
+		//! and vertex fetch locality while importing.
+		inline void setVertexCacheOptimization(bool bOptimizeVertexCache)
+		{
+			_bOptimizeVertexCache = bOptimizeVertexCache;
+		}
+		//! Block compress textures while importing, format is chosen by the material slots using them.
+		//! Requires CPU mipmap generation, compressed images are kept in the scene cache.
+		inline void setTextureCompression(bool bCompressTextures)
+		{
+			_bCompressTextures = bCompressTextures;
+		}
+		inline void setProgressCallback(const ProgressCallback& progressCallback)
+		{
+			_progressCallback = progressCallback;
+		}
+
 	protected:
 		// Material model from gltf official
 		// https://github.com/KhronosGroup/glTF/blob/master/specification/2.0/README.md#reference-material
@@ -66,6 +116,16 @@ namespace vfs
 			float		occlusionTextureStrength{ 1.0f };
 		};
 
+		//! Texture is a pair of a deduplicated image and the state of its glTF sampler
+		struct GLTFTexture
+		{
+			int imageIndex	{ -1 };
+			int magFilter	{ -1 }; // snowapril : raw glTF enums, -1 if sampler leaves it undefined
+			int minFilter	{ -1 };
+			int wrapS		{ TINYGLTF_TEXTURE_WRAP_REPEAT };
+			int wrapT		{ TINYGLTF_TEXTURE_WRAP_REPEAT };
+		};
+
 		struct GLTFNode
 		{
 			glm::mat4 world		 { 1.0f };
@@ -118,6 +178,7 @@ namespace vfs
 		};
 
 		std::vector<GLTFMaterial>	_sceneMaterials;
+		std::vector<GLTFTexture>	_sceneTextures;
 		std::vector<GLTFNode>		_sceneNodes;
 		std::vector<GLTFPrimMesh>	_scenePrimMeshes;
 		std::vector<GLTFCamera>		_sceneCameras;
@@ -134,32 +195,70 @@ namespace vfs
 
 		SceneDimension _sceneDim;
 
+		//! Read-only view of a source stream, either owned by the loader or
+		//! pointing into the mapped scene cache when the scene was loaded from it.
+		template <typename Type>
+		struct StreamView
+		{
+			const Type* data  { nullptr };
+			size_t		count { 0 };
+
+			inline uint64_t getNumBytes(void) const
+			{
+				return static_cast<uint64_t>(count) * sizeof(Type);
+			}
+		};
+
+		template <typename Type>
+		StreamView<Type> getStream(const std::vector<Type>& stream, SceneCache::Section section) const;
+
 		void releaseSourceData();
+
+		inline void reportProgress(float progress) const
+		{
+			if (_progressCallback)
+				_progressCallback(progress);
+		}
 	private:
 		template <typename Type>
 		static bool					GetAttributes	(const tinygltf::Model& model, const tinygltf::Primitive& primitive, 
-													 std::vector<Type>& attributes, const char* name);
+													 Type* attributes, const char* name);
+		static float				DequantizeComponent(const unsigned char* data, int componentType, bool bNormalized);
 		template <typename Type>
 		static std::vector<Type>	GetVector		(const tinygltf::Value& value);
 		template <typename Type>
 		static void					GetValue		(const tinygltf::Value& value, const char* name, Type& val);
 
+		static bool			IsDracoCompressed(const tinygltf::Primitive& primitive);
 		static glm::mat4	GetLocalMatrix	(const GLTFNode& node);
-		static bool			LoadModel		(tinygltf::Model* model, const char* filename);
+		static bool			LoadModel		(tinygltf::Model* model, const char* filename, ThreadPool* threadPool, 
+											 bool bGenerateMipmaps, std::vector<uint32_t>* imageMipLevels,
+											 std::vector<TextureFormat>* imageFormats);
 		static void			GetTextureID	(const tinygltf::Value& value, const char* name, int& id);
 
 		void importMaterials		(const tinygltf::Model& model);
+		void importTextures			(tinygltf::Model* model, const std::vector<uint32_t>& imageMipLevels,
+									 const std::vector<TextureFormat>& imageFormats);
+		void compressImages			(ThreadPool* threadPool);
 		void processMesh			(const tinygltf::Model& model, const tinygltf::Primitive& mesh, 
-									 VertexFormat format, const std::string& name);
+									 VertexFormat format, const std::string& name, GLTFPrimMesh* resultMesh);
 		void processNode			(const tinygltf::Model& model, int nodeIdx, int parentIndex);
 		void updateNode				(int nodeIndex);
+		void optimizePrimMeshes		(ThreadPool* threadPool);
 		void calculateSceneDimension(void);
 		void computeCamera			(void);
+		//! Options which change imported data, part of the scene cache header
+		uint32_t getCacheImportFlags	(void) const;
+		bool loadSceneCache			(const char* filename, uint64_t sourceHash, VertexFormat format);
+		bool writeSceneCache		(const char* filename, const tinygltf::Model& model, 
+									 uint64_t sourceHash, VertexFormat format) const;
 
 		std::unordered_map<unsigned int, std::vector<unsigned int>> _meshToPrimMap;
-		std::vector<unsigned int>	_u32Buffer;
-		std::vector<unsigned short>	_u16Buffer;
-		std::vector<unsigned char>	_u8Buffer;
+		SceneCache					_sceneCache;
+		ProgressCallback			_progressCallback;
+		bool						_bGenerateMipmaps { DEFAULT_GENERATE_CPU_MIPMAPS };
+		bool						_bOptimizeVertexCache { DEFAULT_OPTIMIZE_VERTEX_CACHE };
+		bool						_bCompressTextures { DEFAULT_COMPRESS_TEXTURES };
 	};
 }
 
@@ -0,0 +1,238 @@
+// Author : Jihong Shin (snowapril)
+
+#include <pch.h>
+#include <Util/MeshOptimizer.h>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+namespace vfs
+{
+	namespace
+	{
+		// Scoring parameters from the reference implementation of the paper
+		constexpr uint32_t	kMaxCacheSize		= 32u;
+		constexpr float		kCacheDecayPower	= 1.5f;
+		constexpr float		kLastTriangleScore	= 0.75f;
+		constexpr float		kValenceBoostScale	= 2.0f;
+		constexpr float		kValenceBoostPower	= 0.5f;
+
+		float ComputeVertexScore(int32_t cachePosition, uint32_t numActiveTriangles)
+		{
+			// Vertex without remaining triangles never needs to be picked again
+			if (numActiveTriangles == 0)
+			{
+				return -1.0f;
+			}
+
+			float score{ 0.0f };
+			if (cachePosition >= 0)
+			{
+				// snowapril : vertices of the last triangle get fixed score, so that
+				//			   strip-like ordering does not dominate the cache usage
+				if (cachePosition < 3)
+				{
+					score = kLastTriangleScore;
+				}
+				else
+				{
+					const float scaler = 1.0f / static_cast<float>(kMaxCacheSize - 3);
+					score = std::pow(1.0f - static_cast<float>(cachePosition - 3) * scaler, kCacheDecayPower);
+				}
+			}
+
+			// Boost vertices with few remaining triangles to finish them off early
+			score += kValenceBoostScale * std::pow(static_cast<float>(numActiveTriangles), -kValenceBoostPower);
+			return score;
+		}
+	}
+
+	void MeshOptimizer::OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount)
+	{
+		const size_t numTriangles = indexCount / 3;
+		if (numTriangles == 0)
+		{
+			return;
+		}
+
+		// snowapril : adjacency is indexed by vertex, so malformed indices leave the primitive untouched
+		if (std::any_of(indices, indices + numTriangles * 3, [vertexCount](uint32_t index) { return index >= vertexCount; }))
+		{
+			return;
+		}
+
+		// Vertex to triangle adjacency, active triangles are kept in front of each list
+		std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+		for (size_t i = 0; i < numTriangles * 3; ++i)
+		{
+			++adjacencyOffsets[indices[i] + 1];
+		}
+		for (size_t v = 0; v < vertexCount; ++v)
+		{
+			adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+		}
+
+		std::vector<uint32_t> adjacency(numTriangles * 3);
+		std::vector<uint32_t> numActiveTriangles(vertexCount, 0);
+		for (size_t i = 0; i < numTriangles * 3; ++i)
+		{
+			const uint32_t vertex = indices[i];
+			adjacency[adjacencyOffsets[vertex] + numActiveTriangles[vertex]++] = static_cast<uint32_t>(i / 3);
+		}
+
+		std::vector<int32_t> cachePositions(vertexCount, -1);
+		std::vector<float>	 vertexScores(vertexCount);
+		for (size_t v = 0; v < vertexCount; ++v)
+		{
+			vertexScores[v] = ComputeVertexScore(-1, numActiveTriangles[v]);
+		}
+
+		std::vector<float> triangleScores(numTriangles);
+		std::vector<bool>  emitted(numTriangles, false);
+		size_t bestTriangle{ 0 };
+		for (size_t t = 0; t < numTriangles; ++t)
+		{
+			triangleScores[t] = vertexScores[indices[t * 3 + 0]] +
+								vertexScores[indices[t * 3 + 1]] +
+								vertexScores[indices[t * 3 + 2]];
+			bestTriangle = triangleScores[t] > triangleScores[bestTriangle] ? t : bestTriangle;
+		}
+
+		std::vector<uint32_t> result(numTriangles * 3);
+		uint32_t cache[kMaxCacheSize + 3];
+		uint32_t cacheSize{ 0 };
+		size_t	 scanCursor{ 0 };
+
+		for (size_t emitCount = 0; emitCount < numTriangles; ++emitCount)
+		{
+			// Cache does not touch any remaining triangle, continue from the next unemitted one
+			if (bestTriangle == SIZE_MAX)
+			{
+				while (emitted[scanCursor])
+				{
+					++scanCursor;
+				}
+				bestTriangle = scanCursor;
+			}
+
+			const uint32_t* triangle = indices + bestTriangle * 3;
+			std::memcpy(result.data() + emitCount * 3, triangle, sizeof(uint32_t) * 3);
+			emitted[bestTriangle] = true;
+
+			// Remove the emitted triangle from the active lists of its vertices
+			for (uint32_t k = 0; k < 3; ++k)
+			{
+				const uint32_t vertex = triangle[k];
+				uint32_t* triangles = adjacency.data() + adjacencyOffsets[vertex];
+				uint32_t& numActive = numActiveTriangles[vertex];
+				uint32_t* found = std::find(triangles, triangles + numActive, static_cast<uint32_t>(bestTriangle));
+				assert(found != triangles + numActive);
+				std::swap(*found, triangles[numActive - 1]);
+				--numActive;
+			}
+
+			// Move vertices of the emitted triangle to the front of LRU cache
+			uint32_t newCache[kMaxCacheSize + 3];
+			uint32_t newCacheSize{ 0 };
+			for (uint32_t k = 0; k < 3; ++k)
+			{
+				if (std::find(newCache, newCache + newCacheSize, triangle[k]) == newCache + newCacheSize)
+				{
+					newCache[newCacheSize++] = triangle[k];
+				}
+			}
+			for (uint32_t i = 0; i < cacheSize; ++i)
+			{
+				if (cache[i] != triangle[0] && cache[i] != triangle[1] && cache[i] != triangle[2])
+				{
+					newCache[newCacheSize++] = cache[i];
+				}
+			}
+
+			// Update scores of vertices whose cache position changed, including evicted ones
+			for (uint32_t i = 0; i < newCacheSize; ++i)
+			{
+				const uint32_t vertex = newCache[i];
+				cachePositions[vertex] = i < kMaxCacheSize ? static_cast<int32_t>(i) : -1;
+
+				const float score = ComputeVertexScore(cachePositions[vertex], numActiveTriangles[vertex]);
+				const float delta = score - vertexScores[vertex];
+				vertexScores[vertex] = score;
+
+				const uint32_t* triangles = adjacency.data() + adjacencyOffsets[vertex];
+				for (uint32_t t = 0; t < numActiveTriangles[vertex]; ++t)
+				{
+					triangleScores[triangles[t]] += delta;
+				}
+			}
+
+			cacheSize = std::min(newCacheSize, kMaxCacheSize);
+			std::memcpy(cache, newCache, sizeof(uint32_t) * cacheSize);
+
+			// Next triangle is picked among the ones touching the cache
+			bestTriangle = SIZE_MAX;
+			float bestScore{ -1.0f };
+			for (uint32_t i = 0; i < cacheSize; ++i)
+			{
+				const uint32_t* triangles = adjacency.data() + adjacencyOffsets[cache[i]];
+				for (uint32_t t = 0; t < numActiveTriangles[cache[i]]; ++t)
+				{
+					if (triangleScores[triangles[t]] > bestScore)
+					{
+						bestScore	 = triangleScores[triangles[t]];
+						bestTriangle = triangles[t];
+					}
+				}
+			}
+		}
+
+		std::memcpy(indices, result.data(), sizeof(uint32_t) * result.size());
+	}
+
+	void MeshOptimizer::OptimizeVertexFetch(uint32_t* indices, size_t indexCount, size_t vertexCount,
+											std::vector<uint32_t>* remap)
+	{
+		remap->assign(vertexCount, UINT32_MAX);
+
+		uint32_t nextVertex{ 0 };
+		for (size_t i = 0; i < indexCount; ++i)
+		{
+			uint32_t& newIndex = (*remap)[indices[i]];
+			if (newIndex == UINT32_MAX)
+			{
+				newIndex = nextVertex++;
+			}
+			indices[i] = newIndex;
+		}
+
+		// Unreferenced vertices are kept after referenced ones
+		for (uint32_t& newIndex : *remap)
+		{
+			if (newIndex == UINT32_MAX)
+			{
+				newIndex = nextVertex++;
+			}
+		}
+	}
+
+	uint32_t MeshOptimizer::CountCacheMisses(const uint32_t* indices, size_t indexCount, size_t vertexCount,
+											 uint32_t cacheSize)
+	{
+		// snowapril : FIFO is simulated with insertion timestamps, vertex is still cached
+		//			   if less than cacheSize vertices were inserted after it
+		std::vector<uint32_t> insertTimes(vertexCount, 0);
+		uint32_t timestamp = cacheSize + 1;
+		uint32_t numMisses{ 0 };
+		for (size_t i = 0; i < indexCount; ++i)
+		{
+			const uint32_t vertex = indices[i];
+			if (timestamp - insertTimes[vertex] > cacheSize)
+			{
+				insertTimes[vertex] = timestamp++;
+				++numMisses;
+			}
+		}
+		return numMisses;
+	}
+}
@@ -0,0 +1,46 @@
+// Author : Jihong Shin (snowapril)
+
+#if !defined(VFS_MESH_OPTIMIZER_H)
+#define VFS_MESH_OPTIMIZER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace vfs
+{
+	//! Import time reordering of indexed triangle lists.
+	//! Indices are local to a primitive and must be less than the given vertex count.
+	class MeshOptimizer
+	{
+	public:
+		MeshOptimizer() = delete;
+
+		//! FIFO size used to measure cache efficiency, close to the post-transform cache of current GPUs
+		static constexpr uint32_t kSimulatedCacheSize = 16u;
+
+	public:
+		//! Reorder triangles for post-transform cache locality (Forsyth, "Linear-Speed Vertex Cache Optimisation").
+		//! Indices are left untouched if any of them is out of range
+		static void		OptimizeVertexCache	(uint32_t* indices, size_t indexCount, size_t vertexCount);
+		//! Renumber vertices in order of first use, remap[oldIndex] gives the new location of each vertex
+		static void		OptimizeVertexFetch	(uint32_t* indices, size_t indexCount, size_t vertexCount,
+											 std::vector<uint32_t>* remap);
+		//! Returns number of vertex shader invocations of a FIFO cache with the given size
+		static uint32_t CountCacheMisses	(const uint32_t* indices, size_t indexCount, size_t vertexCount,
+											 uint32_t cacheSize);
+
+		//! Move vertices of a stream into locations given by OptimizeVertexFetch
+		template <typename Type>
+		static void RemapVertexStream(Type* vertices, size_t vertexCount, const std::vector<uint32_t>& remap)
+		{
+			const std::vector<Type> source(vertices, vertices + vertexCount);
+			for (size_t i = 0; i < vertexCount; ++i)
+			{
+				vertices[remap[i]] = source[i];
+			}
+		}
+	};
+}
+
+#endif
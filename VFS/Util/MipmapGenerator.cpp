@@ -0,0 +1,112 @@
+// Author : Jihong Shin (snowapril)
+
+#include <pch.h>
+#include <Util/MipmapGenerator.h>
+#include <Common/Utils.h>
+#include <cassert>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define VFS_MIPMAP_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace vfs
+{
+	uint32_t MipmapGenerator::GetNumMipLevels(uint32_t width, uint32_t height)
+	{
+		uint32_t mipLevels = 1;
+		uint32_t extent = vfs::max(width, height);
+		while (extent > 1)
+		{
+			extent >>= 1;
+			++mipLevels;
+		}
+		return mipLevels;
+	}
+
+	uint64_t MipmapGenerator::GetMipChainSize(uint32_t width, uint32_t height, uint32_t mipLevels)
+	{
+		return GetMipOffset(width, height, mipLevels);
+	}
+
+	uint64_t MipmapGenerator::GetMipOffset(uint32_t width, uint32_t height, uint32_t mipLevel)
+	{
+		uint64_t offset{ 0 };
+		for (uint32_t mip = 0; mip < mipLevel; ++mip)
+		{
+			offset += static_cast<uint64_t>(width) * height * 4;
+			width  = vfs::max(width  >> 1, 1u);
+			height = vfs::max(height >> 1, 1u);
+		}
+		return offset;
+	}
+
+	void MipmapGenerator::GenerateMipChain(std::vector<uint8_t>* image, uint32_t width,
+										   uint32_t height, uint32_t mipLevels)
+	{
+		assert(image->size() >= static_cast<size_t>(width) * height * 4);
+		image->resize(static_cast<size_t>(GetMipChainSize(width, height, mipLevels)));
+
+		uint8_t* src = image->data();
+		for (uint32_t mip = 1; mip < mipLevels; ++mip)
+		{
+			uint8_t* dst = src + static_cast<size_t>(width) * height * 4;
+			Downsample(src, width, height, dst);
+
+			src	   = dst;
+			width  = vfs::max(width  >> 1, 1u);
+			height = vfs::max(height >> 1, 1u);
+		}
+	}
+
+	void MipmapGenerator::Downsample(const uint8_t* src, uint32_t srcWidth, uint32_t srcHeight, uint8_t* dst)
+	{
+		const uint32_t dstWidth  = vfs::max(srcWidth  >> 1, 1u);
+		const uint32_t dstHeight = vfs::max(srcHeight >> 1, 1u);
+		const size_t srcPitch = static_cast<size_t>(srcWidth) * 4;
+
+		for (uint32_t y = 0; y < dstHeight; ++y)
+		{
+			const uint8_t* row0 = src + vfs::min(y * 2,		srcHeight - 1) * srcPitch;
+			const uint8_t* row1 = src + vfs::min(y * 2 + 1, srcHeight - 1) * srcPitch;
+			uint8_t* dstRow = dst + static_cast<size_t>(y) * dstWidth * 4;
+
+			uint32_t x = 0;
+#if defined(VFS_MIPMAP_USE_SSE2)
+			// Two destination pixels per iteration, 4 source texels from each row.
+			// Only valid while both horizontal source texels exist (srcWidth >= 2)
+			if (srcWidth >= 2)
+			{
+				const __m128i zero  = _mm_setzero_si128();
+				const __m128i round = _mm_set1_epi16(2);
+				for (; x + 2 <= dstWidth && (x + 2) * 2 <= srcWidth; x += 2)
+				{
+					const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 8));
+					const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 8));
+
+					// Vertical sum in 16bit, each half holds two texels
+					const __m128i sumLo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+					const __m128i sumHi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+					// Horizontal sum of neighboring texels
+					const __m128i quadLo = _mm_add_epi16(sumLo, _mm_srli_si128(sumLo, 8));
+					const __m128i quadHi = _mm_add_epi16(sumHi, _mm_srli_si128(sumHi, 8));
+
+					__m128i average = _mm_unpacklo_epi64(quadLo, quadHi);
+					average = _mm_srli_epi16(_mm_add_epi16(average, round), 2);
+					_mm_storel_epi64(reinterpret_cast<__m128i*>(dstRow + x * 4), _mm_packus_epi16(average, average));
+				}
+			}
+#endif
+			for (; x < dstWidth; ++x)
+			{
+				const uint32_t x0 = vfs::min(x * 2,		srcWidth - 1) * 4;
+				const uint32_t x1 = vfs::min(x * 2 + 1, srcWidth - 1) * 4;
+				for (uint32_t c = 0; c < 4; ++c)
+				{
+					const uint32_t sum = row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c];
+					dstRow[x * 4 + c] = static_cast<uint8_t>((sum + 2) >> 2);
+				}
+			}
+		}
+	}
+}
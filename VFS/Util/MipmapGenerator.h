@@ -0,0 +1,32 @@
+// Author : Jihong Shin (snowapril)
+
+#if !defined(VFS_MIPMAP_GENERATOR_H)
+#define VFS_MIPMAP_GENERATOR_H
+
+#include <cstdint>
+#include <vector>
+
+namespace vfs
+{
+	//! CPU side mip chain builder for RGBA8 images.
+	//! Mip levels are tightly packed one after another starting from level 0,
+	//! which matches the layout expected by buffer to image copy regions.
+	class MipmapGenerator
+	{
+	public:
+		MipmapGenerator() = delete;
+
+	public:
+		static uint32_t GetNumMipLevels	(uint32_t width, uint32_t height);
+		static uint64_t GetMipChainSize	(uint32_t width, uint32_t height, uint32_t mipLevels);
+		static uint64_t GetMipOffset	(uint32_t width, uint32_t height, uint32_t mipLevel);
+
+		//! Append mip levels 1 ~ (mipLevels - 1) after level 0 pixels stored in the given image
+		static void GenerateMipChain	(std::vector<uint8_t>* image, uint32_t width, 
+										 uint32_t height, uint32_t mipLevels);
+		//! 2x2 box filter downsampling, odd edges are clamped
+		static void Downsample			(const uint8_t* src, uint32_t srcWidth, uint32_t srcHeight, uint8_t* dst);
+	};
+}
+
+#endif
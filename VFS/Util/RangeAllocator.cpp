@@ -0,0 +1,106 @@
+// Author : Jihong Shin (snowapril)
+
+#include <pch.h>
+#include <Util/RangeAllocator.h>
+#include <Common/Utils.h>
+#include <algorithm>
+#include <cassert>
+
+namespace vfs
+{
+	RangeAllocator::RangeAllocator(uint64_t capacity)
+	{
+		reset(capacity);
+	}
+
+	void RangeAllocator::reset(uint64_t capacity)
+	{
+		_capacity = capacity;
+		_usedSize = 0;
+		_freeRanges.clear();
+		if (capacity > 0)
+		{
+			_freeRanges.push_back({ 0, capacity });
+		}
+	}
+
+	bool RangeAllocator::allocate(uint64_t size, uint64_t alignment, uint64_t* offset)
+	{
+		assert(size > 0 && alignment > 0);
+		for (size_t i = 0; i < _freeRanges.size(); ++i)
+		{
+			FreeRange& range = _freeRanges[i];
+			const uint64_t alignedOffset = (range.offset + alignment - 1) / alignment * alignment;
+			const uint64_t padding		 = alignedOffset - range.offset;
+			if (padding > range.size || range.size - padding < size)
+			{
+				continue;
+			}
+
+			// Alignment padding stays in the free list as a range of its own
+			const FreeRange tail = { alignedOffset + size, range.size - padding - size };
+			if (padding > 0)
+			{
+				range.size = padding;
+				if (tail.size > 0)
+				{
+					_freeRanges.insert(_freeRanges.begin() + i + 1, tail);
+				}
+			}
+			else if (tail.size > 0)
+			{
+				range = tail;
+			}
+			else
+			{
+				_freeRanges.erase(_freeRanges.begin() + i);
+			}
+
+			_usedSize += size;
+			*offset = alignedOffset;
+			return true;
+		}
+		return false;
+	}
+
+	void RangeAllocator::free(uint64_t offset, uint64_t size)
+	{
+		assert(size > 0 && offset + size <= _capacity && size <= _usedSize);
+		auto next = std::lower_bound(_freeRanges.begin(), _freeRanges.end(), offset,
+			[](const FreeRange& range, uint64_t value) { return range.offset < value; });
+		assert(next == _freeRanges.end() || offset + size <= next->offset);
+
+		// Merge with the following and the preceding free ranges if they touch
+		if (next != _freeRanges.end() && offset + size == next->offset)
+		{
+			next->offset = offset;
+			next->size	+= size;
+		}
+		else
+		{
+			next = _freeRanges.insert(next, { offset, size });
+		}
+
+		if (next != _freeRanges.begin())
+		{
+			auto prev = next - 1;
+			assert(prev->offset + prev->size <= offset);
+			if (prev->offset + prev->size == offset)
+			{
+				prev->size += next->size;
+				_freeRanges.erase(next);
+			}
+		}
+		_usedSize -= size;
+	}
+
+	uint64_t RangeAllocator::getLargestFreeRange(void) const
+	{
+		uint64_t largest{ 0 };
+		for (const FreeRange& range : _freeRanges)
+		{
+			largest = vfs::max(largest, range.size);
+		}
+		return largest;
+	}
+}
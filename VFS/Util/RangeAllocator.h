@@ -0,0 +1,51 @@
+// Author : Jihong Shin (snowapril)
+
+#if !defined(VFS_RANGE_ALLOCATOR_H)
+#define VFS_RANGE_ALLOCATOR_H
+
+#include <cstdint>
+#include <vector>
+
+namespace vfs
+{
+	//! Free-list suballocator of ranges in a fixed capacity arena. It only tracks
+	//! offsets, the memory itself is owned by the caller. Allocation takes the first
+	//! free range that fits and freed ranges are merged with their neighbors.
+	//! Not thread safe.
+	class RangeAllocator
+	{
+	public:
+		explicit RangeAllocator() = default;
+		explicit RangeAllocator(uint64_t capacity);
+
+	public:
+		void reset		(uint64_t capacity);
+		//! Returns false if there is no free range large enough after alignment
+		bool allocate	(uint64_t size, uint64_t alignment, uint64_t* offset);
+		void free		(uint64_t offset, uint64_t size);
+
+		inline uint64_t getCapacity(void) const
+		{
+			return _capacity;
+		}
+		inline uint64_t getUsedSize(void) const
+		{
+			return _usedSize;
+		}
+		//! Largest allocation which succeeds without alignment
+		uint64_t getLargestFreeRange(void) const;
+
+	private:
+		struct FreeRange
+		{
+			uint64_t offset { 0 };
+			uint64_t size	{ 0 };
+		};
+
+		std::vector<FreeRange>	_freeRanges; // Sorted by offset, never adjacent to each other
+		uint64_t				_capacity	{ 0 };
+		uint64_t				_usedSize	{ 0 };
+	};
+}
+
+#endif
@@ -0,0 +1,243 @@
+// Author : Jihong Shin (snowapril)
+
+#include <pch.h>
+#include <Util/SceneCache.h>
+#include <Common/Logger.h>
+#include <sys/stat.h>
+#include <cstring>
+
+namespace vfs
+{
+	constexpr uint64_t kFNVPrime = 1099511628211ull;
+
+	SceneCache::~SceneCache()
+	{
+		close();
+	}
+
+	bool SceneCache::open(const char* cachePath, uint64_t sourceHash, VertexFormat format, uint32_t importFlags)
+	{
+		if (!_file.open(cachePath))
+		{
+			return false;
+		}
+
+		if (_file.getSize() < sizeof(Header))
+		{
+			close();
+			return false;
+		}
+
+		Header header;
+		std::memcpy(&header, _file.getData(), sizeof(Header));
+		if (header.magic		!= kMagic		||
+			header.version		!= kVersion		||
+			header.sourceHash	!= sourceHash	||
+			header.vertexFormat != static_cast<uint32_t>(format) ||
+			header.importFlags	!= importFlags	||
+			header.numSections	!= static_cast<uint32_t>(Section::Count))
+		{
+			close();
+			return false;
+		}
+
+		for (const SectionRange& range : header.sections)
+		{
+			if (range.offset > _file.getSize() || range.size > _file.getSize() - range.offset)
+			{
+				VFS_WARN << "Scene cache " << cachePath << " is truncated";
+				close();
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	void SceneCache::close(void)
+	{
+		_file.close();
+	}
+
+	bool SceneCache::getSection(Section section, const uint8_t** data, uint64_t* size) const
+	{
+		if (!_file.isOpen())
+		{
+			return false;
+		}
+
+		const Header* header = reinterpret_cast<const Header*>(_file.getData());
+		const SectionRange& range = header->sections[static_cast<uint32_t>(section)];
+		*data = _file.getData() + range.offset;
+		*size = range.size;
+		return true;
+	}
+
+	bool SceneCache::HashFile(const char* filePath, uint64_t* hash)
+	{
+		MappedFile file;
+		if (!file.open(filePath))
+		{
+			return false;
+		}
+		*hash = HashBytes(file.getData(), file.getSize(), kHashSeed);
+		return true;
+	}
+
+	uint64_t SceneCache::HashBytes(const void* data, size_t size, uint64_t seed)
+	{
+		// FNV-1a 64bit
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		uint64_t hash = seed;
+		for (size_t i = 0; i < size; ++i)
+		{
+			hash ^= bytes[i];
+			hash *= kFNVPrime;
+		}
+		return hash;
+	}
+
+	bool SceneCache::GetFileStamp(const char* filePath, uint64_t* fileSize, int64_t* modifiedTime)
+	{
+		struct stat fileStat = {};
+		if (stat(filePath, &fileStat) != 0)
+		{
+			return false;
+		}
+		*fileSize	  = static_cast<uint64_t>(fileStat.st_size);
+		*modifiedTime = static_cast<int64_t>(fileStat.st_mtime);
+		return true;
+	}
+
+	SceneCacheWriter::~SceneCacheWriter()
+	{
+		if (_file != nullptr)
+		{
+			// Writer was abandoned without end(), discard the partial file
+			fclose(_file);
+			_file = nullptr;
+			std::remove(_tempPath.c_str());
+		}
+	}
+
+	bool SceneCacheWriter::begin(const char* cachePath)
+	{
+		_cachePath	= cachePath;
+		_tempPath	= _cachePath + ".tmp";
+		_file		= fopen(_tempPath.c_str(), "wb");
+		if (_file == nullptr)
+		{
+			return false;
+		}
+
+		// Reserve space for the header, it will be overwritten in end()
+		SceneCache::Header placeholder;
+		placeholder.magic = 0;
+		writeBytes(&placeholder, sizeof(SceneCache::Header));
+		return !_failed;
+	}
+
+	bool SceneCacheWriter::end(uint64_t sourceHash, VertexFormat format, uint32_t importFlags)
+	{
+		assert(_currentSection == SceneCache::Section::Count);
+		if (_file == nullptr)
+		{
+			return false;
+		}
+
+		_header.sourceHash	 = sourceHash;
+		_header.vertexFormat = static_cast<uint32_t>(format);
+		_header.importFlags	 = importFlags;
+		
+		_failed |= fseek(_file, 0, SEEK_SET) != 0;
+		_failed |= fwrite(&_header, sizeof(SceneCache::Header), 1, _file) != 1;
+		_failed |= fclose(_file) != 0;
+		_file = nullptr;
+
+		if (_failed)
+		{
+			std::remove(_tempPath.c_str());
+			return false;
+		}
+
+		// rename() does not overwrite an existing file on every platform
+		std::remove(_cachePath.c_str());
+		if (std::rename(_tempPath.c_str(), _cachePath.c_str()) != 0)
+		{
+			std::remove(_tempPath.c_str());
+			return false;
+		}
+		return true;
+	}
+
+	void SceneCacheWriter::beginSection(SceneCache::Section section)
+	{
+		assert(_currentSection == SceneCache::Section::Count);
+
+		static const uint8_t kPadding[SceneCache::kSectionAlignment] = { 0 };
+		const uint64_t remainder = _offset % SceneCache::kSectionAlignment;
+		if (remainder != 0)
+		{
+			writeBytes(kPadding, SceneCache::kSectionAlignment - remainder);
+		}
+
+		_currentSection = section;
+		_header.sections[static_cast<uint32_t>(section)].offset = _offset;
+	}
+
+	void SceneCacheWriter::endSection(void)
+	{
+		assert(_currentSection != SceneCache::Section::Count);
+		SceneCache::SectionRange& range = _header.sections[static_cast<uint32_t>(_currentSection)];
+		range.size = _offset - range.offset;
+		_currentSection = SceneCache::Section::Count;
+	}
+
+	void SceneCacheWriter::writeBytes(const void* data, uint64_t size)
+	{
+		if (_failed || size == 0)
+		{
+			return;
+		}
+		_failed |= fwrite(data, static_cast<size_t>(size), 1, _file) != 1;
+		_offset += size;
+	}
+
+	void SceneCacheWriter::writeString(const std::string& str)
+	{
+		write(static_cast<uint64_t>(str.size()));
+		writeBytes(str.data(), str.size());
+	}
+
+	SceneCacheReader::SceneCacheReader(const uint8_t* data, uint64_t size)
+		: _data(data), _size(size)
+	{
+		// Do nothing
+	}
+
+	bool SceneCacheReader::readBytes(void* dst, uint64_t size)
+	{
+		if (size > _size - _offset)
+		{
+			return false;
+		}
+		if (size > 0)
+		{
+			std::memcpy(dst, _data + _offset, static_cast<size_t>(size));
+		}
+		_offset += size;
+		return true;
+	}
+
+	bool SceneCacheReader::readString(std::string* str)
+	{
+		uint64_t length{ 0 };
+		if (!read(&length) || length > _size - _offset)
+		{
+			return false;
+		}
+		str->assign(reinterpret_cast<const char*>(_data + _offset), static_cast<size_t>(length));
+		_offset += length;
+		return true;
+	}
+}
@@ -0,0 +1,166 @@
+// Author : Jihong Shin (snowapril)
+
+#if !defined(VFS_SCENE_CACHE_H)
+#define VFS_SCENE_CACHE_H
+
+#include <pch.h>
+#include <Common/MappedFile.h>
+#include <Common/Utils.h>
+#include <Common/VertexFormat.h>
+#include <cstdio>
+#include <string>
+#include <type_traits>
+
+namespace vfs
+{
+	//! Versioned binary cache of an imported glTF scene (<scene>.vfscache).
+	//! The file is a fixed header followed by aligned sections. Vertex/index streams
+	//! and decoded images are stored raw so they can be fed from the mapping straight
+	//! into the staging buffers, while the small scene tables are serialized in Tables.
+	class SceneCache : NonCopyable
+	{
+	public:
+		explicit SceneCache() = default;
+				~SceneCache();
+
+		static constexpr uint32_t		kMagic				= 0x43534656u; // 'VFSC'
+		static constexpr uint32_t		kVersion			= 6u;
+		static constexpr uint64_t		kSectionAlignment	= 16u;
+		static constexpr const char*	kFileExtension		= ".vfscache";
+		static constexpr uint64_t		kHashSeed			= 14695981039346656037ull; // FNV-1a offset basis
+
+		enum class Section : uint32_t
+		{
+			Tables		 = 0,
+			Dependencies = 1,
+			Positions	 = 2,
+			Normals		 = 3,
+			TexCoords	 = 4,
+			Tangents	 = 5,
+			Colors		 = 6,
+			Indices		 = 7,
+			Images		 = 8,
+			Count		 = 9,
+		};
+
+		//! Loader options changing imported data, cache written with other options never validates
+		enum ImportFlags : uint32_t
+		{
+			ImportNone				= 0,
+			ImportCPUMipmaps		= 1u << 0,
+			ImportVertexCacheOpt	= 1u << 1,
+			ImportCompressTextures	= 1u << 2,
+		};
+
+		struct SectionRange
+		{
+			uint64_t offset	{ 0 };
+			uint64_t size	{ 0 };
+		};
+
+		struct Header
+		{
+			uint32_t	 magic			{ kMagic	};
+			uint32_t	 version		{ kVersion	};
+			uint64_t	 sourceHash		{ 0 };
+			uint32_t	 vertexFormat	{ 0 };
+			uint32_t	 importFlags	{ 0 };
+			uint32_t	 numSections	{ static_cast<uint32_t>(Section::Count) };
+			SectionRange sections[static_cast<uint32_t>(Section::Count)];
+		};
+
+	public:
+		bool open	(const char* cachePath, uint64_t sourceHash, VertexFormat format, uint32_t importFlags);
+		void close	(void);
+		bool getSection(Section section, const uint8_t** data, uint64_t* size) const;
+
+		inline bool isOpen(void) const
+		{
+			return _file.isOpen();
+		}
+
+		static bool		HashFile	(const char* filePath, uint64_t* hash);
+		static uint64_t HashBytes	(const void* data, size_t size, uint64_t seed);
+		static bool		GetFileStamp(const char* filePath, uint64_t* fileSize, int64_t* modifiedTime);
+
+	private:
+		MappedFile _file;
+	};
+
+	//! Streams a scene cache file to disk section by section.
+	//! The header is written last so a partially written file never validates.
+	class SceneCacheWriter : NonCopyable
+	{
+	public:
+		explicit SceneCacheWriter() = default;
+				~SceneCacheWriter();
+
+	public:
+		bool begin			(const char* cachePath);
+		bool end			(uint64_t sourceHash, VertexFormat format, uint32_t importFlags);
+		void beginSection	(SceneCache::Section section);
+		void endSection		(void);
+		void writeBytes		(const void* data, uint64_t size);
+		void writeString	(const std::string& str);
+
+		template <typename Type>
+		void write(const Type& value)
+		{
+			static_assert(std::is_trivially_copyable<Type>::value, "Only trivially copyable types can be written as raw bytes");
+			writeBytes(&value, sizeof(Type));
+		}
+		template <typename Type>
+		void writeVector(const std::vector<Type>& values)
+		{
+			static_assert(std::is_trivially_copyable<Type>::value, "Only trivially copyable types can be written as raw bytes");
+			write(static_cast<uint64_t>(values.size()));
+			writeBytes(values.data(), values.size() * sizeof(Type));
+		}
+
+	private:
+		std::string				_cachePath;
+		std::string				_tempPath;
+		FILE*					_file			{ nullptr };
+		uint64_t				_offset			{ 0 };
+		SceneCache::Section		_currentSection { SceneCache::Section::Count };
+		SceneCache::Header		_header;
+		bool					_failed			{ false };
+	};
+
+	//! Bounds-checked sequential reader over a section of a mapped scene cache.
+	class SceneCacheReader
+	{
+	public:
+		explicit SceneCacheReader(const uint8_t* data, uint64_t size);
+
+	public:
+		bool readBytes	(void* dst, uint64_t size);
+		bool readString	(std::string* str);
+
+		template <typename Type>
+		bool read(Type* value)
+		{
+			static_assert(std::is_trivially_copyable<Type>::value, "Only trivially copyable types can be read as raw bytes");
+			return readBytes(value, sizeof(Type));
+		}
+		template <typename Type>
+		bool readVector(std::vector<Type>* values)
+		{
+			static_assert(std::is_trivially_copyable<Type>::value, "Only trivially copyable types can be read as raw bytes");
+			uint64_t count{ 0 };
+			if (!read(&count) || count > (_size - _offset) / vfs::max<uint64_t>(sizeof(Type), 1))
+			{
+				return false;
+			}
+			values->resize(static_cast<size_t>(count));
+			return readBytes(values->data(), count * sizeof(Type));
+		}
+
+	private:
+		const uint8_t*	_data	{ nullptr };
+		uint64_t		_size	{ 0 };
+		uint64_t		_offset { 0 };
+	};
+}
+
+#endif
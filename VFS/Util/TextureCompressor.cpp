@@ -0,0 +1,229 @@
+// Author : Jihong Shin (snowapril)
+
+#include <pch.h>
+#include <Util/TextureCompressor.h>
+#include <Common/Utils.h>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace vfs
+{
+	namespace
+	{
+		inline uint16_t PackRGB565(const uint8_t* color)
+		{
+			const uint32_t r = (color[0] * 31u + 127u) / 255u;
+			const uint32_t g = (color[1] * 63u + 127u) / 255u;
+			const uint32_t b = (color[2] * 31u + 127u) / 255u;
+			return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+		}
+
+		inline void UnpackRGB565(uint16_t packed, int32_t* color)
+		{
+			const int32_t r = (packed >> 11) & 31;
+			const int32_t g = (packed >> 5)	 & 63;
+			const int32_t b = packed		 & 31;
+			color[0] = (r << 3) | (r >> 2);
+			color[1] = (g << 2) | (g >> 4);
+			color[2] = (b << 3) | (b >> 2);
+		}
+
+		inline uint32_t GetBlockBytes(TextureFormat format)
+		{
+			return format == TextureFormat::BC1 ? 8u : 16u;
+		}
+	}
+
+	bool TextureCompressor::IsBlockCompressed(TextureFormat format)
+	{
+		return format != TextureFormat::RGBA8;
+	}
+
+	uint64_t TextureCompressor::GetMipSize(TextureFormat format, uint32_t width, uint32_t height)
+	{
+		if (!IsBlockCompressed(format))
+		{
+			return static_cast<uint64_t>(width) * height * 4;
+		}
+		// snowapril : partial blocks on the right and bottom edges are stored as whole blocks
+		const uint64_t numBlocksX = (width  + 3) / 4;
+		const uint64_t numBlocksY = (height + 3) / 4;
+		return numBlocksX * numBlocksY * GetBlockBytes(format);
+	}
+
+	uint64_t TextureCompressor::GetMipOffset(TextureFormat format, uint32_t width, uint32_t height, uint32_t mipLevel)
+	{
+		uint64_t offset{ 0 };
+		for (uint32_t mip = 0; mip < mipLevel; ++mip)
+		{
+			offset += GetMipSize(format, width, height);
+			width  = vfs::max(width  >> 1, 1u);
+			height = vfs::max(height >> 1, 1u);
+		}
+		return offset;
+	}
+
+	uint64_t TextureCompressor::GetMipChainSize(TextureFormat format, uint32_t width, uint32_t height, uint32_t mipLevels)
+	{
+		return GetMipOffset(format, width, height, mipLevels);
+	}
+
+	void TextureCompressor::CompressMipChain(TextureFormat format, const uint8_t* pixels, uint32_t width,
+											 uint32_t height, uint32_t mipLevels, std::vector<uint8_t>* compressed)
+	{
+		assert(format == TextureFormat::BC1 || format == TextureFormat::BC3 || format == TextureFormat::BC5);
+		compressed->resize(static_cast<size_t>(GetMipChainSize(format, width, height, mipLevels)));
+
+		const uint32_t blockBytes = GetBlockBytes(format);
+		for (uint32_t mip = 0; mip < mipLevels; ++mip)
+		{
+			const uint32_t mipWidth	 = vfs::max(width  >> mip, 1u);
+			const uint32_t mipHeight = vfs::max(height >> mip, 1u);
+			const uint8_t* src = pixels + GetMipOffset(TextureFormat::RGBA8, width, height, mip);
+			uint8_t*	   dst = compressed->data() + GetMipOffset(format, width, height, mip);
+
+			uint8_t texels[16 * 4];
+			for (uint32_t blockY = 0; blockY < mipHeight; blockY += 4)
+			{
+				for (uint32_t blockX = 0; blockX < mipWidth; blockX += 4)
+				{
+					// Edge blocks replicate the last row and column
+					for (uint32_t y = 0; y < 4; ++y)
+					{
+						const uint32_t srcY = vfs::min(blockY + y, mipHeight - 1);
+						for (uint32_t x = 0; x < 4; ++x)
+						{
+							const uint32_t srcX = vfs::min(blockX + x, mipWidth - 1);
+							std::memcpy(texels + (y * 4 + x) * 4, src + (static_cast<size_t>(srcY) * mipWidth + srcX) * 4, 4);
+						}
+					}
+
+					switch (format)
+					{
+					case TextureFormat::BC1: EncodeBC1Block(texels, dst); break;
+					case TextureFormat::BC3: EncodeBC3Block(texels, dst); break;
+					case TextureFormat::BC5: EncodeBC5Block(texels, dst); break;
+					default: break;
+					}
+					dst += blockBytes;
+				}
+			}
+		}
+	}
+
+	void TextureCompressor::EncodeBC1Block(const uint8_t* texels, uint8_t* block)
+	{
+		uint8_t minColor[3] = { 255, 255, 255 };
+		uint8_t maxColor[3] = {   0,   0,   0 };
+		for (uint32_t i = 0; i < 16; ++i)
+		{
+			for (uint32_t c = 0; c < 3; ++c)
+			{
+				minColor[c] = std::min(minColor[c], texels[i * 4 + c]);
+				maxColor[c] = std::max(maxColor[c], texels[i * 4 + c]);
+			}
+		}
+
+		// Inset the bounding box by 1/16 of its extent, interpolated colors then cover the extremes better
+		for (uint32_t c = 0; c < 3; ++c)
+		{
+			const uint8_t inset = static_cast<uint8_t>((maxColor[c] - minColor[c]) >> 4);
+			minColor[c] = static_cast<uint8_t>(minColor[c] + inset);
+			maxColor[c] = static_cast<uint8_t>(maxColor[c] - inset);
+		}
+
+		// snowapril : color0 > color1 selects the four color mode without transparent texel
+		uint16_t color0 = PackRGB565(maxColor);
+		uint16_t color1 = PackRGB565(minColor);
+		if (color0 < color1)
+		{
+			std::swap(color0, color1);
+		}
+
+		uint32_t indices{ 0 };
+		if (color0 != color1)
+		{
+			int32_t palette[4][3];
+			UnpackRGB565(color0, palette[0]);
+			UnpackRGB565(color1, palette[1]);
+			for (uint32_t c = 0; c < 3; ++c)
+			{
+				palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+				palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+			}
+
+			for (uint32_t i = 0; i < 16; ++i)
+			{
+				uint32_t bestIndex{ 0 };
+				int32_t	 bestDistance{ INT32_MAX };
+				for (uint32_t p = 0; p < 4; ++p)
+				{
+					const int32_t dr = texels[i * 4 + 0] - palette[p][0];
+					const int32_t dg = texels[i * 4 + 1] - palette[p][1];
+					const int32_t db = texels[i * 4 + 2] - palette[p][2];
+					const int32_t distance = dr * dr + dg * dg + db * db;
+					if (distance < bestDistance)
+					{
+						bestDistance = distance;
+						bestIndex	 = p;
+					}
+				}
+				indices |= bestIndex << (i * 2);
+			}
+		}
+
+		block[0] = static_cast<uint8_t>(color0 & 0xFF);
+		block[1] = static_cast<uint8_t>(color0 >> 8);
+		block[2] = static_cast<uint8_t>(color1 & 0xFF);
+		block[3] = static_cast<uint8_t>(color1 >> 8);
+		for (uint32_t i = 0; i < 4; ++i)
+		{
+			block[4 + i] = static_cast<uint8_t>((indices >> (i * 8)) & 0xFF);
+		}
+	}
+
+	void TextureCompressor::EncodeBC3Block(const uint8_t* texels, uint8_t* block)
+	{
+		EncodeChannelBlock(texels, 3, block);
+		EncodeBC1Block(texels, block + 8);
+	}
+
+	void TextureCompressor::EncodeBC5Block(const uint8_t* texels, uint8_t* block)
+	{
+		EncodeChannelBlock(texels, 0, block);
+		EncodeChannelBlock(texels, 1, block + 8);
+	}
+
+	void TextureCompressor::EncodeChannelBlock(const uint8_t* texels, uint32_t channel, uint8_t* block)
+	{
+		uint8_t minValue{ 255 }, maxValue{ 0 };
+		for (uint32_t i = 0; i < 16; ++i)
+		{
+			minValue = std::min(minValue, texels[i * 4 + channel]);
+			maxValue = std::max(maxValue, texels[i * 4 + channel]);
+		}
+
+		// value0 > value1 selects the mode with six interpolated values between the endpoints
+		block[0] = maxValue;
+		block[1] = minValue;
+
+		uint64_t indices{ 0 };
+		const int32_t range = maxValue - minValue;
+		if (range > 0)
+		{
+			for (uint32_t i = 0; i < 16; ++i)
+			{
+				// Step from value0 (0) to value1 (7), which are stored as index 0 and 1
+				const int32_t step = ((maxValue - texels[i * 4 + channel]) * 7 + range / 2) / range;
+				const uint64_t index = step == 0 ? 0 : (step == 7 ? 1 : static_cast<uint64_t>(step + 1));
+				indices |= index << (i * 3);
+			}
+		}
+
+		for (uint32_t i = 0; i < 6; ++i)
+		{
+			block[2 + i] = static_cast<uint8_t>((indices >> (i * 8)) & 0xFF);
+		}
+	}
+}
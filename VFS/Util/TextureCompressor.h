@@ -0,0 +1,52 @@
+// Author : Jihong Shin (snowapril)
+
+#if !defined(VFS_TEXTURE_COMPRESSOR_H)
+#define VFS_TEXTURE_COMPRESSOR_H
+
+#include <cstdint>
+#include <vector>
+
+namespace vfs
+{
+	//! Pixel formats of scene images. Block formats store 4x4 texel blocks,
+	//! BC1 in 8 bytes and the others in 16 bytes.
+	enum class TextureFormat : uint32_t
+	{
+		RGBA8	= 0,
+		BC1		= 1, // RGB with optional 1-bit alpha
+		BC3		= 2, // RGBA
+		BC5		= 3, // Two channel, used for tangent space normal maps
+		BC7		= 4, // RGBA, accepted from pre-compressed containers only
+		Count	= 5,
+	};
+
+	//! CPU side block compression of RGBA8 mip chains laid out by MipmapGenerator.
+	//! Endpoints are chosen by inset bounding box fitting, which trades a bit of
+	//! quality for an encoder fast enough to run on every import.
+	class TextureCompressor
+	{
+	public:
+		TextureCompressor() = delete;
+
+	public:
+		static bool		IsBlockCompressed	(TextureFormat format);
+		static uint64_t GetMipSize			(TextureFormat format, uint32_t width, uint32_t height);
+		static uint64_t GetMipOffset		(TextureFormat format, uint32_t width, uint32_t height, uint32_t mipLevel);
+		static uint64_t GetMipChainSize		(TextureFormat format, uint32_t width, uint32_t height, uint32_t mipLevels);
+
+		//! Compress every level of the given RGBA8 mip chain into tightly packed blocks
+		static void CompressMipChain(TextureFormat format, const uint8_t* pixels, uint32_t width,
+									 uint32_t height, uint32_t mipLevels, std::vector<uint8_t>* compressed);
+
+		//! Encoders of single 4x4 block given as 16 RGBA8 texels in row major order
+		static void EncodeBC1Block	(const uint8_t* texels, uint8_t* block);
+		static void EncodeBC3Block	(const uint8_t* texels, uint8_t* block);
+		static void EncodeBC5Block	(const uint8_t* texels, uint8_t* block);
+
+	private:
+		//! BC4 style block of 8 interpolated values, shared by BC3 alpha and BC5 channels
+		static void EncodeChannelBlock(const uint8_t* texels, uint32_t channel, uint8_t* block);
+	};
+}
+
+#endif
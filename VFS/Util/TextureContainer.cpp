@@ -0,0 +1,184 @@
+// Author : Jihong Shin (snowapril)
+
+#include <pch.h>
+#include <Util/TextureContainer.h>
+#include <Util/MipmapGenerator.h>
+#include <Common/Utils.h>
+#include <cstring>
+
+namespace vfs
+{
+	namespace
+	{
+		constexpr uint32_t	kDDSMagic				= 0x20534444u; // 'DDS '
+		constexpr size_t	kDDSHeaderSize			= 4 + 124;
+		constexpr size_t	kDDSHeaderDX10Size		= 20;
+		constexpr uint32_t	kDDSPixelFormatFourCC	= 0x4u;
+		constexpr uint32_t	kDDSCaps2Cubemap		= 0x200u;
+		constexpr uint32_t	kDDSCaps2Volume			= 0x200000u;
+
+		constexpr uint8_t	kKTX2Identifier[12]		= { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+		constexpr size_t	kKTX2HeaderSize			= 80;
+		constexpr size_t	kKTX2LevelIndexSize		= 24;
+
+		constexpr uint32_t MakeFourCC(char a, char b, char c, char d)
+		{
+			return static_cast<uint32_t>(a) | (static_cast<uint32_t>(b) << 8) |
+				   (static_cast<uint32_t>(c) << 16) | (static_cast<uint32_t>(d) << 24);
+		}
+
+		template <typename Type>
+		inline Type ReadValue(const uint8_t* bytes, size_t offset)
+		{
+			Type value;
+			std::memcpy(&value, bytes + offset, sizeof(Type));
+			return value;
+		}
+
+		// snowapril : sRGB variants are read as UNORM, scene textures are all sampled as UNORM
+		bool GetFormatFromDXGI(uint32_t dxgiFormat, TextureFormat* format)
+		{
+			switch (dxgiFormat)
+			{
+			case 28: case 29:			*format = TextureFormat::RGBA8; return true; // R8G8B8A8_UNORM(_SRGB)
+			case 70: case 71: case 72:	*format = TextureFormat::BC1;	return true;
+			case 76: case 77: case 78:	*format = TextureFormat::BC3;	return true;
+			case 82: case 83:			*format = TextureFormat::BC5;	return true;
+			case 97: case 98: case 99:	*format = TextureFormat::BC7;	return true;
+			default:													return false;
+			}
+		}
+
+		bool GetFormatFromVulkan(uint32_t vkFormat, TextureFormat* format)
+		{
+			switch (vkFormat)
+			{
+			case VK_FORMAT_R8G8B8A8_UNORM:
+			case VK_FORMAT_R8G8B8A8_SRGB:			*format = TextureFormat::RGBA8; return true;
+			case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+			case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+			case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+			case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:		*format = TextureFormat::BC1;	return true;
+			case VK_FORMAT_BC3_UNORM_BLOCK:
+			case VK_FORMAT_BC3_SRGB_BLOCK:			*format = TextureFormat::BC3;	return true;
+			case VK_FORMAT_BC5_UNORM_BLOCK:			*format = TextureFormat::BC5;	return true;
+			case VK_FORMAT_BC7_UNORM_BLOCK:
+			case VK_FORMAT_BC7_SRGB_BLOCK:			*format = TextureFormat::BC7;	return true;
+			default:																return false;
+			}
+		}
+	}
+
+	bool TextureContainer::IsContainer(const uint8_t* bytes, size_t size)
+	{
+		return (size >= kDDSHeaderSize	 && ReadValue<uint32_t>(bytes, 0) == kDDSMagic) ||
+			   (size >= kKTX2HeaderSize	 && std::memcmp(bytes, kKTX2Identifier, sizeof(kKTX2Identifier)) == 0);
+	}
+
+	bool TextureContainer::Load(const uint8_t* bytes, size_t size, Texture* texture)
+	{
+		if (size >= kDDSHeaderSize && ReadValue<uint32_t>(bytes, 0) == kDDSMagic)
+		{
+			return LoadDDS(bytes, size, texture);
+		}
+		if (size >= kKTX2HeaderSize && std::memcmp(bytes, kKTX2Identifier, sizeof(kKTX2Identifier)) == 0)
+		{
+			return LoadKTX2(bytes, size, texture);
+		}
+		return false;
+	}
+
+	bool TextureContainer::LoadDDS(const uint8_t* bytes, size_t size, Texture* texture)
+	{
+		// DDS_HEADER follows the magic, offsets below include the magic
+		texture->height		= ReadValue<uint32_t>(bytes, 12);
+		texture->width		= ReadValue<uint32_t>(bytes, 16);
+		texture->mipLevels	= vfs::max(ReadValue<uint32_t>(bytes, 28), 1u);
+		const uint32_t pixelFormatFlags = ReadValue<uint32_t>(bytes, 80);
+		const uint32_t fourCC			= ReadValue<uint32_t>(bytes, 84);
+		const uint32_t caps2			= ReadValue<uint32_t>(bytes, 112);
+
+		if ((caps2 & (kDDSCaps2Cubemap | kDDSCaps2Volume)) != 0 || (pixelFormatFlags & kDDSPixelFormatFourCC) == 0)
+		{
+			return false;
+		}
+
+		size_t dataOffset = kDDSHeaderSize;
+		switch (fourCC)
+		{
+		case MakeFourCC('D', 'X', 'T', '1'): texture->format = TextureFormat::BC1; break;
+		case MakeFourCC('D', 'X', 'T', '5'): texture->format = TextureFormat::BC3; break;
+		case MakeFourCC('A', 'T', 'I', '2'):
+		case MakeFourCC('B', 'C', '5', 'U'): texture->format = TextureFormat::BC5; break;
+		case MakeFourCC('D', 'X', '1', '0'):
+		{
+			// DDS_HEADER_DXT10 : dxgiFormat, resourceDimension, miscFlag, arraySize, miscFlags2
+			constexpr uint32_t kResourceDimensionTexture2D = 3;
+			if (size < kDDSHeaderSize + kDDSHeaderDX10Size ||
+				ReadValue<uint32_t>(bytes, kDDSHeaderSize + 4)	!= kResourceDimensionTexture2D ||
+				ReadValue<uint32_t>(bytes, kDDSHeaderSize + 12) != 1 ||
+				!GetFormatFromDXGI(ReadValue<uint32_t>(bytes, kDDSHeaderSize), &texture->format))
+			{
+				return false;
+			}
+			dataOffset += kDDSHeaderDX10Size;
+			break;
+		}
+		default:
+			return false;
+		}
+
+		// Mip levels are stored tightly packed from the base level, the same layout as ours
+		const uint64_t dataSize = TextureCompressor::GetMipChainSize(texture->format, texture->width, texture->height, texture->mipLevels);
+		if (texture->width == 0 || texture->height == 0 ||
+			texture->mipLevels > MipmapGenerator::GetNumMipLevels(texture->width, texture->height) ||
+			dataSize > size - dataOffset)
+		{
+			return false;
+		}
+		texture->data.assign(bytes + dataOffset, bytes + dataOffset + dataSize);
+		return true;
+	}
+
+	bool TextureContainer::LoadKTX2(const uint8_t* bytes, size_t size, Texture* texture)
+	{
+		const uint32_t vkFormat					= ReadValue<uint32_t>(bytes, 12);
+		texture->width							= ReadValue<uint32_t>(bytes, 20);
+		texture->height							= ReadValue<uint32_t>(bytes, 24);
+		const uint32_t depth					= ReadValue<uint32_t>(bytes, 28);
+		const uint32_t layerCount				= ReadValue<uint32_t>(bytes, 32);
+		const uint32_t faceCount				= ReadValue<uint32_t>(bytes, 36);
+		texture->mipLevels						= vfs::max(ReadValue<uint32_t>(bytes, 40), 1u);
+		const uint32_t supercompressionScheme	= ReadValue<uint32_t>(bytes, 44);
+
+		// snowapril : VK_FORMAT_UNDEFINED means Basis Universal payload which needs transcoding
+		if (supercompressionScheme != 0 || depth > 1 || layerCount > 1 || faceCount != 1 ||
+			!GetFormatFromVulkan(vkFormat, &texture->format) || texture->width == 0 || texture->height == 0 ||
+			texture->mipLevels > MipmapGenerator::GetNumMipLevels(texture->width, texture->height) ||
+			kKTX2HeaderSize + texture->mipLevels * kKTX2LevelIndexSize > size)
+		{
+			return false;
+		}
+
+		// Level index gives location of each level, levels are gathered into one packed chain
+		texture->data.resize(static_cast<size_t>(TextureCompressor::GetMipChainSize(texture->format, texture->width,
+																					 texture->height, texture->mipLevels)));
+		for (uint32_t mip = 0; mip < texture->mipLevels; ++mip)
+		{
+			const size_t	levelIndex	= kKTX2HeaderSize + mip * kKTX2LevelIndexSize;
+			const uint64_t	byteOffset	= ReadValue<uint64_t>(bytes, levelIndex);
+			const uint64_t	byteLength	= ReadValue<uint64_t>(bytes, levelIndex + 8);
+			const uint32_t	mipWidth	= vfs::max(texture->width  >> mip, 1u);
+			const uint32_t	mipHeight	= vfs::max(texture->height >> mip, 1u);
+			if (byteLength != TextureCompressor::GetMipSize(texture->format, mipWidth, mipHeight) ||
+				byteOffset > size || byteLength > size - byteOffset)
+			{
+				return false;
+			}
+
+			const uint64_t dstOffset = TextureCompressor::GetMipOffset(texture->format, texture->width, texture->height, mip);
+			std::memcpy(texture->data.data() + dstOffset, bytes + byteOffset, static_cast<size_t>(byteLength));
+		}
+		return true;
+	}
+}
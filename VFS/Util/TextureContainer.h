@@ -0,0 +1,41 @@
+// Author : Jihong Shin (snowapril)
+
+#if !defined(VFS_TEXTURE_CONTAINER_H)
+#define VFS_TEXTURE_CONTAINER_H
+
+#include <Util/TextureCompressor.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace vfs
+{
+	//! Reader of pre-compressed texture containers referenced by MSFT_texture_dds (DDS)
+	//! and KHR_texture_basisu (KTX2). Only single 2D images in formats of TextureFormat
+	//! are accepted, supercompressed KTX2 (Basis Universal) would need a transcoder.
+	class TextureContainer
+	{
+	public:
+		TextureContainer() = delete;
+
+		struct Texture
+		{
+			TextureFormat			format		{ TextureFormat::RGBA8 };
+			uint32_t				width		{ 0 };
+			uint32_t				height		{ 0 };
+			uint32_t				mipLevels	{ 1 };
+			std::vector<uint8_t>	data;		// Mip levels packed from level 0 as TextureCompressor expects
+		};
+
+	public:
+		//! Returns true if the given bytes start with DDS or KTX2 file identifier
+		static bool IsContainer	(const uint8_t* bytes, size_t size);
+		static bool Load		(const uint8_t* bytes, size_t size, Texture* texture);
+
+	private:
+		static bool LoadDDS		(const uint8_t* bytes, size_t size, Texture* texture);
+		static bool LoadKTX2	(const uint8_t* bytes, size_t size, Texture* texture);
+	};
+}
+
+#endif
@@ -0,0 +1,79 @@
+// Author : Jihong Shin (snowapril)
+
+#include <pch.h>
+#include <Util/VertexQuantizer.h>
+#include <glm/packing.hpp>
+#include <glm/gtc/packing.hpp>
+#include <cmath>
+
+namespace vfs
+{
+	VertexQuantizer::DecodeTransform VertexQuantizer::GetDecodeTransform(const glm::vec3& boxMin, const glm::vec3& boxMax)
+	{
+		// snowapril : flat boxes still need non-zero scale for encoding
+		constexpr float kMinExtent = 1e-6f;
+
+		DecodeTransform decode;
+		decode.offset = boxMin;
+		decode.scale  = glm::max(boxMax - boxMin, glm::vec3(kMinExtent));
+		return decode;
+	}
+
+	void VertexQuantizer::EncodePositions(const glm::vec3* positions, size_t count, 
+										  const DecodeTransform& decode, uint64_t* encoded)
+	{
+		const glm::vec3 invScale = 1.0f / decode.scale;
+		for (size_t i = 0; i < count; ++i)
+		{
+			const glm::vec3 unit = glm::clamp((positions[i] - decode.offset) * invScale, 0.0f, 1.0f);
+			encoded[i] = glm::packUnorm4x16(glm::vec4(unit, 1.0f));
+		}
+	}
+
+	void VertexQuantizer::EncodeNormals(const glm::vec3* normals, size_t count, uint32_t* encoded)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			encoded[i] = glm::packSnorm2x16(EncodeOctahedral(normals[i]));
+		}
+	}
+
+	void VertexQuantizer::EncodeTexCoords(const glm::vec2* texCoords, size_t count, uint32_t* encoded)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			encoded[i] = glm::packHalf2x16(texCoords[i]);
+		}
+	}
+
+	void VertexQuantizer::EncodeTangents(const glm::vec4* tangents, size_t count, uint32_t* encoded)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			const glm::vec4& tangent = tangents[i];
+			const glm::vec2 octahedral = EncodeOctahedral(glm::vec3(tangent));
+			encoded[i] = glm::packSnorm4x8(glm::vec4(octahedral, 0.0f, tangent.w < 0.0f ? -1.0f : 1.0f));
+		}
+	}
+
+	glm::vec2 VertexQuantizer::EncodeOctahedral(glm::vec3 direction)
+	{
+		// "A Survey of Efficient Representations for Independent Unit Vectors" (Cigolle et al. 2014)
+		const float l1Norm = std::abs(direction.x) + std::abs(direction.y) + std::abs(direction.z);
+		if (l1Norm <= 0.0f || !std::isfinite(l1Norm))
+		{
+			return glm::vec2(0.0f);
+		}
+		direction /= l1Norm;
+
+		glm::vec2 octahedral(direction.x, direction.y);
+		if (direction.z < 0.0f)
+		{
+			octahedral = glm::vec2(
+				(1.0f - std::abs(direction.y)) * (direction.x >= 0.0f ? 1.0f : -1.0f),
+				(1.0f - std::abs(direction.x)) * (direction.y >= 0.0f ? 1.0f : -1.0f)
+			);
+		}
+		return octahedral;
+	}
+}
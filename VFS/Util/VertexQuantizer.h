@@ -0,0 +1,47 @@
+// Author : Jihong Shin (snowapril)
+
+#if !defined(VFS_VERTEX_QUANTIZER_H)
+#define VFS_VERTEX_QUANTIZER_H
+
+#include <pch.h>
+
+namespace vfs
+{
+	//! CPU side encoders for packed vertex streams (VertexFormat::Quantized).
+	//! Every encoded value matches the vulkan format advertised by SceneManager,
+	//! and is decoded by the vertex input stage or vertex.glsl.
+	class VertexQuantizer
+	{
+	public:
+		VertexQuantizer() = delete;
+
+		//! Transform mapping unit cube of quantized positions back to the bounding box
+		struct DecodeTransform
+		{
+			glm::vec3 offset { 0.0f };
+			glm::vec3 scale	 { 1.0f };
+
+			inline glm::mat4 getMatrix(void) const
+			{
+				return glm::scale(glm::translate(glm::mat4(1.0f), offset), scale);
+			}
+		};
+
+	public:
+		static DecodeTransform GetDecodeTransform(const glm::vec3& boxMin, const glm::vec3& boxMax);
+
+		//! R16G16B16A16_UNORM, position is normalized inside of the decode transform box
+		static void EncodePositions	(const glm::vec3* positions, size_t count, 
+									 const DecodeTransform& decode, uint64_t* encoded);
+		//! R16G16_SNORM, octahedral mapping of unit normal
+		static void EncodeNormals	(const glm::vec3* normals, size_t count, uint32_t* encoded);
+		//! R16G16_SFLOAT
+		static void EncodeTexCoords	(const glm::vec2* texCoords, size_t count, uint32_t* encoded);
+		//! R8G8B8A8_SNORM, octahedral mapping of tangent in xy and handedness in w
+		static void EncodeTangents	(const glm::vec4* tangents, size_t count, uint32_t* encoded);
+
+		static glm::vec2 EncodeOctahedral(glm::vec3 direction);
+	};
+}
+
+#endif
@@ -23,6 +23,7 @@ namespace vfs
 			_allocator			= nullptr;
 			_buffer				= VK_NULL_HANDLE;
 			_bufferAllocation	= nullptr;
+			_mappedData			= nullptr;
 		}
 	}
 
@@ -38,31 +39,69 @@ namespace vfs
 		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 		bufferInfo.usage = bufferUsage;
 
+		// Host visible buffers are mapped once at creation and stay mapped until destruction
+		const bool bHostVisible = memoryUsage == VMA_MEMORY_USAGE_CPU_ONLY	 ||
+								  memoryUsage == VMA_MEMORY_USAGE_CPU_TO_GPU ||
+								  memoryUsage == VMA_MEMORY_USAGE_GPU_TO_CPU;
+
 		VmaAllocationCreateInfo bufferAllocInfo = {};
 		bufferAllocInfo.usage = memoryUsage;
+		bufferAllocInfo.flags = bHostVisible ? VMA_ALLOCATION_CREATE_MAPPED_BIT : 0;
 
-		if (vmaCreateBuffer(_allocator, &bufferInfo, &bufferAllocInfo, &_buffer, &_bufferAllocation, nullptr) != VK_SUCCESS)
+		VmaAllocationInfo allocationInfo = {};
+		if (vmaCreateBuffer(_allocator, &bufferInfo, &bufferAllocInfo, &_buffer, &_bufferAllocation, &allocationInfo) != VK_SUCCESS)
 		{
 			return false;
 		}
+		_mappedData = allocationInfo.pMappedData;
 		return true;
 	}
 
 	void Buffer::uploadData(const void* srcData, uint64_t size)
 	{
 		assert(srcData != nullptr); // snowapril : source data must not be invalid
-		void* dstData{ nullptr };
-		vmaMapMemory(_allocator, _bufferAllocation, &dstData);
+		void* dstData = mapMemory();
 		memcpy(dstData, srcData, static_cast<size_t>(size));
-		vmaUnmapMemory(_allocator, _bufferAllocation);
+		// snowapril : no-op on host coherent memory
+		flushMemory(0, size);
+		unmapMemory();
 	}
 
 	void Buffer::downloadData(void* dstData, uint64_t size)
 	{
-		void* srcData{ nullptr };
-		vmaMapMemory(_allocator, _bufferAllocation, &srcData);
+		vmaInvalidateAllocation(_allocator, _bufferAllocation, 0, size);
+		const void* srcData = mapMemory();
 		memcpy(dstData, srcData, static_cast<size_t>(size));
-		vmaUnmapMemory(_allocator, _bufferAllocation);
+		unmapMemory();
+	}
+
+	void* Buffer::mapMemory(void)
+	{
+		if (_mappedData != nullptr)
+		{
+			return _mappedData;
+		}
+
+		void* mappedData{ nullptr };
+		if (vmaMapMemory(_allocator, _bufferAllocation, &mappedData) != VK_SUCCESS)
+		{
+			return nullptr;
+		}
+		return mappedData;
+	}
+
+	void Buffer::unmapMemory(void)
+	{
+		// Persistently mapped memory is released with the allocation itself
+		if (_mappedData == nullptr)
+		{
+			vmaUnmapMemory(_allocator, _bufferAllocation);
+		}
+	}
+
+	void Buffer::flushMemory(uint64_t offset, uint64_t size)
+	{
+		vmaFlushAllocation(_allocator, _bufferAllocation, offset, size);
 	}
 
 	VkBufferMemoryBarrier Buffer::generateMemoryBarrier(VkAccessFlags srcMask, VkAccessFlags dstMask)
@@ -19,6 +19,9 @@ namespace vfs
 		bool initialize		(VmaAllocator allocator, uint64_t bufferSize, VkBufferUsageFlags bufferUsage, VmaMemoryUsage memoryUsage);
 		void uploadData		(const void* srcData, uint64_t size);
 		void downloadData	(void* dstData, uint64_t size);
+		void* mapMemory		(void);
+		void unmapMemory	(void);
+		void flushMemory	(uint64_t offset, uint64_t size);
 		VkBufferMemoryBarrier generateMemoryBarrier(VkAccessFlags srcMask, VkAccessFlags dstMask);
 		VkBufferMemoryBarrier generateMemoryBarrier(VkAccessFlags srcMask, VkAccessFlags dstMask, 
 													uint32_t srcQueueFamily, uint32_t dstQueueFamily);
@@ -30,11 +33,17 @@ namespace vfs
 		{
 			return _allocatedSize;
 		}
+		//! Returns nullptr if buffer is not allocated on host visible memory
+		inline void* getMappedData(void) const
+		{
+			return _mappedData;
+		}
 
 	private:
 		VmaAllocator	_allocator			{	nullptr		 };
 		VkBuffer		_buffer				{ VK_NULL_HANDLE };
 		VmaAllocation	_bufferAllocation	{	nullptr		 };
+		void*			_mappedData			{	nullptr		 };
 		uint64_t		_allocatedSize		{ 0 };
 	};
 }
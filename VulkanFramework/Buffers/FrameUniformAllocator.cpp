@@ -0,0 +1,77 @@
+// Author : Jihong Shin (snowapril)
+
+#include <VulkanFramework/pch.h>
+#include <VulkanFramework/Buffers/FrameUniformAllocator.h>
+#include <VulkanFramework/Buffers/Buffer.h>
+#include <VulkanFramework/Device.h>
+#include <Common/Logger.h>
+#include <cstring>
+
+namespace vfs
+{
+	FrameUniformAllocator::FrameUniformAllocator(DevicePtr device, uint32_t frameCount, uint64_t frameSize)
+	{
+		assert(initialize(device, frameCount, frameSize));
+	}
+
+	FrameUniformAllocator::~FrameUniformAllocator()
+	{
+		destroyFrameUniformAllocator();
+	}
+
+	void FrameUniformAllocator::destroyFrameUniformAllocator(void)
+	{
+		_mappedData = nullptr;
+		_buffer.reset();
+		_device.reset();
+	}
+
+	bool FrameUniformAllocator::initialize(DevicePtr device, uint32_t frameCount, uint64_t frameSize)
+	{
+		_device		= device;
+		_frameCount = frameCount;
+		_alignment	= _device->getDeviceProperty().limits.minUniformBufferOffsetAlignment;
+		_alignment	= _alignment < 16 ? 16 : _alignment;
+		_frameSize	= (frameSize + _alignment - 1) / _alignment * _alignment;
+
+		_buffer = std::make_shared<Buffer>();
+		if (!_buffer->initialize(_device->getMemoryAllocator(), _frameSize * _frameCount,
+								 VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU))
+		{
+			return false;
+		}
+
+		_mappedData = static_cast<uint8_t*>(_buffer->getMappedData());
+		return _mappedData != nullptr;
+	}
+
+	void FrameUniformAllocator::beginFrame(uint32_t frameIndex)
+	{
+		assert(frameIndex < _frameCount);
+		_frameIndex	 = frameIndex;
+		_frameBegin	 = _frameSize * frameIndex;
+		_frameOffset = 0;
+		_bOverflowed = false;
+	}
+
+	uint32_t FrameUniformAllocator::allocate(const void* srcData, uint64_t size)
+	{
+		const uint64_t allocSize = (size + _alignment - 1) / _alignment * _alignment;
+		if (_frameOffset + allocSize > _frameSize)
+		{
+			// snowapril : slices already handed out this frame must never be overwritten
+			if (!_bOverflowed)
+			{
+				VFS_ERROR << "Frame uniform region of " << _frameSize << " bytes is out of room, frame size must be enlarged";
+				_bOverflowed = true;
+			}
+			return kInvalidOffset;
+		}
+
+		const uint64_t offset = _frameBegin + _frameOffset;
+		std::memcpy(_mappedData + offset, srcData, static_cast<size_t>(size));
+		_buffer->flushMemory(offset, size);
+		_frameOffset += allocSize;
+		return static_cast<uint32_t>(offset);
+	}
+}
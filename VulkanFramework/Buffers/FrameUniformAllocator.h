@@ -0,0 +1,55 @@
+// Author : Jihong Shin (snowapril)
+
+#if !defined(VULKAN_FRAMEWORK_FRAME_UNIFORM_ALLOCATOR_H)
+#define VULKAN_FRAMEWORK_FRAME_UNIFORM_ALLOCATOR_H
+
+#include <VulkanFramework/pch.h>
+
+namespace vfs
+{
+	//! Linear allocator handing out slices of one persistently mapped uniform buffer.
+	//! The buffer is split into one region per frame in flight, and each region is
+	//! rewound on beginFrame(), so the caller must guarantee that GPU has finished
+	//! the frame which used the region last time. Slices are bound with dynamic offsets.
+	class FrameUniformAllocator : NonCopyable
+	{
+	public:
+		explicit FrameUniformAllocator() = default;
+		explicit FrameUniformAllocator(DevicePtr device, uint32_t frameCount, uint64_t frameSize);
+				~FrameUniformAllocator();
+
+		//! Returned when the frame region is out of room, nothing is written then
+		static constexpr uint32_t kInvalidOffset = UINT32_MAX;
+
+	public:
+		void	 destroyFrameUniformAllocator	(void);
+		bool	 initialize						(DevicePtr device, uint32_t frameCount, uint64_t frameSize);
+		void	 beginFrame						(uint32_t frameIndex);
+		//! Caller must skip the work bound to the slice if kInvalidOffset is returned
+		uint32_t allocate						(const void* srcData, uint64_t size);
+
+		inline BufferPtr getBuffer(void) const
+		{
+			return _buffer;
+		}
+		//! Region slices are currently allocated from
+		inline uint32_t getFrameIndex(void) const
+		{
+			return _frameIndex;
+		}
+
+	private:
+		DevicePtr	_device			{ nullptr };
+		BufferPtr	_buffer			{ nullptr };
+		uint8_t*	_mappedData		{ nullptr };
+		uint64_t	_frameSize		{ 0 };
+		uint64_t	_alignment		{ 0 };
+		uint64_t	_frameBegin		{ 0 };
+		uint64_t	_frameOffset	{ 0 };
+		uint32_t	_frameCount		{ 0 };
+		uint32_t	_frameIndex		{ 0 };
+		bool		_bOverflowed	{ false };	// Reported once per frame
+	};
+}
+
+#endif
@@ -0,0 +1,328 @@
+// Author : Jihong Shin (snowapril)
+
+#include <VulkanFramework/pch.h>
+#include <VulkanFramework/Buffers/UploadManager.h>
+#include <VulkanFramework/Buffers/Buffer.h>
+#include <VulkanFramework/Commands/CommandPool.h>
+#include <VulkanFramework/Device.h>
+#include <VulkanFramework/Queue.h>
+#include <VulkanFramework/Sync/SubmissionScheduler.h>
+#include <cstring>
+
+namespace vfs
+{
+	namespace
+	{
+		inline uint64_t AlignUp(uint64_t offset, uint64_t alignment)
+		{
+			return (offset + alignment - 1) / alignment * alignment;
+		}
+	}
+
+	UploadManager::UploadManager(DevicePtr device, SubmissionSchedulerPtr scheduler, uint64_t ringSize)
+	{
+		assert(initialize(device, scheduler, ringSize));
+	}
+
+	UploadManager::~UploadManager()
+	{
+		destroyUploadManager();
+	}
+
+	void UploadManager::destroyUploadManager(void)
+	{
+		if (_device != nullptr)
+		{
+			flush();
+		}
+
+		_inFlightBatches.clear();
+		_recordingBatch = UploadBatch();
+		_freeCmdBuffers.clear();
+		_cmdPool.reset();
+
+		if (_ringData != nullptr)
+		{
+			_ringBuffer->unmapMemory();
+			_ringData = nullptr;
+		}
+		_ringBuffer.reset();
+		_ringSize = _ringHead = _ringTail = 0;
+		_queue.reset();
+		_scheduler.reset();
+		_device.reset();
+	}
+
+	bool UploadManager::initialize(DevicePtr device, SubmissionSchedulerPtr scheduler, uint64_t ringSize)
+	{
+		_device		= device;
+		_scheduler	= scheduler;
+		_queue		= _scheduler->getQueue();
+		_ringSize	= ringSize;
+
+		_cmdPool = std::make_shared<CommandPool>();
+		if (!_cmdPool->initialize(_device, _queue, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT))
+		{
+			return false;
+		}
+
+		_ringBuffer = std::make_shared<Buffer>();
+		if (!_ringBuffer->initialize(_device->getMemoryAllocator(), _ringSize,
+									 VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY))
+		{
+			return false;
+		}
+
+		// snowapril : ring stays mapped for whole lifetime, CPU_ONLY memory is host coherent
+		_ringData = static_cast<uint8_t*>(_ringBuffer->mapMemory());
+		return _ringData != nullptr;
+	}
+
+	bool UploadManager::allocateStaging(uint64_t size, uint64_t alignment, Allocation* allocation)
+	{
+		assert(size > 0 && alignment > 0);
+
+		// Requests which can never fit into the ring get their own staging buffer,
+		// kept alive until the batch which consumes it is retired
+		if (size + alignment > _ringSize)
+		{
+			BufferPtr dedicatedBuffer = std::make_shared<Buffer>();
+			if (!dedicatedBuffer->initialize(_device->getMemoryAllocator(), size,
+											 VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY))
+			{
+				return false;
+			}
+
+			uint8_t* dedicatedData = static_cast<uint8_t*>(dedicatedBuffer->mapMemory());
+			if (dedicatedData == nullptr)
+			{
+				return false;
+			}
+
+			beginBatch();
+			allocation->buffer	= dedicatedBuffer.get();
+			allocation->data	= dedicatedData;
+			allocation->offset	= 0;
+			_recordingBatch.dedicatedBuffers.emplace_back(std::move(dedicatedBuffer));
+			return true;
+		}
+
+		// snowapril : beginBatch rewinds an idle ring, so the batch must be recording before
+		//			   the region is taken, otherwise the region would belong to no batch
+		beginBatch();
+		uint64_t offset{ 0 };
+		while (!allocateRing(size, alignment, &offset))
+		{
+			if (_inFlightBatches.empty())
+			{
+				// snowapril : only the recording batch holds the ring, push it to the queue first
+				if (!submit())
+				{
+					return false;
+				}
+				beginBatch();
+			}
+			else if (!retireBatches(true))
+			{
+				return false;
+			}
+		}
+
+		allocation->buffer	= _ringBuffer.get();
+		allocation->data	= _ringData + offset;
+		allocation->offset	= offset;
+		return true;
+	}
+
+	bool UploadManager::uploadBuffer(const BufferPtr& dstBuffer, const void* srcData, uint64_t size, uint64_t dstOffset)
+	{
+		assert(srcData != nullptr); // snowapril : source data must not be invalid
+
+		Allocation allocation;
+		if (!allocateStaging(size, kDefaultAlignment, &allocation))
+		{
+			return false;
+		}
+		std::memcpy(allocation.data, srcData, static_cast<size_t>(size));
+
+		CommandBuffer cmdBuffer(_recordingBatch.cmdBuffer);
+		cmdBuffer.copyBuffer(allocation.buffer, dstBuffer, { { allocation.offset, dstOffset, size } });
+		return true;
+	}
+
+	void UploadManager::enqueueCommand(const RecordFn& cmdFunc)
+	{
+		beginBatch();
+
+		// Record commands in caller-side
+		cmdFunc(CommandBuffer(_recordingBatch.cmdBuffer));
+	}
+
+	void UploadManager::addWaitSemaphore(VkSemaphore semaphore, uint64_t value, VkPipelineStageFlags stageMask)
+	{
+		beginBatch();
+		_recordingBatch.waitSemaphores.push_back(semaphore);
+		_recordingBatch.waitValues.push_back(value);
+		_recordingBatch.waitStageMasks.push_back(stageMask);
+	}
+
+	void UploadManager::addSignalSemaphore(VkSemaphore semaphore, uint64_t value)
+	{
+		beginBatch();
+		_recordingBatch.signalSemaphores.push_back(semaphore);
+		_recordingBatch.signalValues.push_back(value);
+	}
+
+	bool UploadManager::enqueue(void)
+	{
+		if (!_bRecording)
+		{
+			return true;
+		}
+
+		CommandBuffer cmdBuffer(_recordingBatch.cmdBuffer);
+
+		// Make transfer writes of this batch visible to every later submission on the queue
+		VkMemoryBarrier memoryBarrier = {};
+		memoryBarrier.sType			= VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		memoryBarrier.pNext			= nullptr;
+		memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		memoryBarrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+		cmdBuffer.pipelineBarrier(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0,
+								  { memoryBarrier }, {}, {});
+		cmdBuffer.endRecord();
+
+		for (const BufferPtr& dedicatedBuffer : _recordingBatch.dedicatedBuffers)
+		{
+			dedicatedBuffer->unmapMemory();
+		}
+
+		_recordingBatch.value = _scheduler->enqueue({ cmdBuffer.getHandle() }, _recordingBatch.waitSemaphores,
+													_recordingBatch.waitValues, _recordingBatch.waitStageMasks,
+													_recordingBatch.signalSemaphores, _recordingBatch.signalValues);
+		if (!_recordingBatch.dedicatedBuffers.empty())
+		{
+			// Dedicated staging buffers are released by the scheduler, ring space is reclaimed in order below
+			std::vector<BufferPtr> dedicatedBuffers = std::move(_recordingBatch.dedicatedBuffers);
+			_scheduler->deferUntil(_recordingBatch.value, [dedicatedBuffers]() {});
+			_recordingBatch.dedicatedBuffers.clear();
+		}
+
+		_recordingBatch.ringEnd = _ringHead;
+		_inFlightBatches.emplace_back(std::move(_recordingBatch));
+		_recordingBatch = UploadBatch();
+		_bRecording		= false;
+		return true;
+	}
+
+	bool UploadManager::submit(void)
+	{
+		return enqueue() && _scheduler->flush();
+	}
+
+	bool UploadManager::flush(void)
+	{
+		if (!submit())
+		{
+			return false;
+		}
+
+		while (!_inFlightBatches.empty())
+		{
+			if (!retireBatches(true))
+			{
+				return false;
+			}
+		}
+		_scheduler->collect();
+		return true;
+	}
+
+	void UploadManager::beginBatch(void)
+	{
+		if (_bRecording)
+		{
+			return;
+		}
+
+		// Reclaim whatever the GPU has already consumed, never blocks here
+		retireBatches(false);
+
+		if (_freeCmdBuffers.empty())
+		{
+			_recordingBatch.cmdBuffer = _cmdPool->allocateCommandBuffer();
+		}
+		else
+		{
+			_recordingBatch.cmdBuffer = _freeCmdBuffers.back();
+			_freeCmdBuffers.pop_back();
+		}
+
+		CommandBuffer cmdBuffer(_recordingBatch.cmdBuffer);
+		cmdBuffer.beginRecord(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+		_bRecording = true;
+	}
+
+	bool UploadManager::allocateRing(uint64_t size, uint64_t alignment, uint64_t* offset)
+	{
+		// snowapril : head never catches up tail while any region is alive,
+		//			   so head == tail always means the ring is empty
+		const uint64_t alignedHead = AlignUp(_ringHead, alignment);
+		if (_ringHead >= _ringTail)
+		{
+			if (alignedHead + size <= _ringSize)
+			{
+				*offset	  = alignedHead;
+				_ringHead = alignedHead + size;
+				return true;
+			}
+			if (size < _ringTail)
+			{
+				*offset	  = 0;
+				_ringHead = size;
+				return true;
+			}
+			return false;
+		}
+
+		if (alignedHead + size < _ringTail)
+		{
+			*offset	  = alignedHead;
+			_ringHead = alignedHead + size;
+			return true;
+		}
+		return false;
+	}
+
+	bool UploadManager::retireBatches(bool bWaitOldest)
+	{
+		while (!_inFlightBatches.empty())
+		{
+			UploadBatch& batch = _inFlightBatches.front();
+			if (!_scheduler->isCompleted(batch.value))
+			{
+				if (!bWaitOldest)
+				{
+					break;
+				}
+				// snowapril : scheduler flushes the batch first if it has not reached the queue yet
+				if (!_scheduler->wait(batch.value))
+				{
+					return false;
+				}
+				bWaitOldest = false;
+			}
+
+			_ringTail = batch.ringEnd;
+			_freeCmdBuffers.push_back(batch.cmdBuffer);
+			_inFlightBatches.pop_front();
+		}
+
+		// Rewind the ring when nothing is alive so that large requests find contiguous space
+		if (_inFlightBatches.empty() && !_bRecording)
+		{
+			_ringHead = _ringTail = 0;
+		}
+		return true;
+	}
+}
@@ -0,0 +1,100 @@
+// Author : Jihong Shin (snowapril)
+
+#if !defined(VULKAN_FRAMEWORK_UPLOAD_MANAGER_H)
+#define VULKAN_FRAMEWORK_UPLOAD_MANAGER_H
+
+#include <VulkanFramework/pch.h>
+#include <VulkanFramework/Commands/CommandBuffer.h>
+#include <VulkanFramework/Sync/SubmissionScheduler.h>
+#include <deque>
+#include <functional>
+
+namespace vfs
+{
+	//! Streams CPU data to the GPU through one persistently mapped staging ring.
+	//! Uploads are recorded into a pending batch and pushed to the queue on submit()
+	//! without waiting; ring space is reclaimed once the scheduler signals the value of the batch.
+	//! Every batch ends with a transfer write barrier, so later submissions on the same
+	//! queue observe uploaded data without further synchronization.
+	class UploadManager : NonCopyable
+	{
+	public:
+		explicit UploadManager() = default;
+		explicit UploadManager(DevicePtr device, SubmissionSchedulerPtr scheduler, uint64_t ringSize);
+				~UploadManager();
+
+		using RecordFn = std::function<void(CommandBuffer)>;
+
+		static constexpr uint64_t kDefaultAlignment = 16;
+
+		struct Allocation
+		{
+			const Buffer*	buffer	{ nullptr };
+			uint8_t*		data	{ nullptr };
+			uint64_t		offset	{ 0 };
+		};
+
+	public:
+		void destroyUploadManager	(void);
+		bool initialize				(DevicePtr device, SubmissionSchedulerPtr scheduler, uint64_t ringSize);
+		bool allocateStaging		(uint64_t size, uint64_t alignment, Allocation* allocation);
+		bool uploadBuffer			(const BufferPtr& dstBuffer, const void* srcData, uint64_t size, uint64_t dstOffset);
+		void enqueueCommand			(const RecordFn& cmdFunc);
+		//! Make the pending batch wait for (or signal) the given timeline semaphore value on its submission
+		void addWaitSemaphore		(VkSemaphore semaphore, uint64_t value, VkPipelineStageFlags stageMask);
+		void addSignalSemaphore		(VkSemaphore semaphore, uint64_t value);
+		//! Hand the pending batch to the scheduler, it reaches the queue with the next flush of the scheduler
+		bool enqueue				(void);
+		//! Enqueue the pending batch and flush the scheduler
+		bool submit					(void);
+		bool flush					(void);
+
+		inline DevicePtr getDevicePtr(void) const
+		{
+			return _device;
+		}
+		inline QueuePtr getQueue(void) const
+		{
+			return _queue;
+		}
+		inline SubmissionSchedulerPtr getScheduler(void) const
+		{
+			return _scheduler;
+		}
+
+	private:
+		struct UploadBatch
+		{
+			VkCommandBuffer						cmdBuffer	{ VK_NULL_HANDLE };
+			uint64_t							value		{ 0 };	// Signaled by the scheduler once the batch is done
+			uint64_t							ringEnd		{ 0 };
+			std::vector<BufferPtr>				dedicatedBuffers;	// Released by the scheduler after the value
+			std::vector<VkSemaphore>			waitSemaphores;
+			std::vector<uint64_t>				waitValues;
+			std::vector<VkPipelineStageFlags>	waitStageMasks;
+			std::vector<VkSemaphore>			signalSemaphores;
+			std::vector<uint64_t>				signalValues;
+		};
+
+		void beginBatch		(void);
+		bool allocateRing	(uint64_t size, uint64_t alignment, uint64_t* offset);
+		bool retireBatches	(bool bWaitOldest);
+
+	private:
+		DevicePtr							_device			{ nullptr };
+		QueuePtr							_queue			{ nullptr };
+		SubmissionSchedulerPtr				_scheduler		{ nullptr };
+		CommandPoolPtr						_cmdPool		{ nullptr };
+		BufferPtr							_ringBuffer		{ nullptr };
+		uint8_t*							_ringData		{ nullptr };
+		uint64_t							_ringSize		{ 0 };
+		uint64_t							_ringHead		{ 0 };
+		uint64_t							_ringTail		{ 0 };
+		UploadBatch							_recordingBatch;
+		bool								_bRecording		{ false };
+		std::deque<UploadBatch>				_inFlightBatches;
+		std::vector<VkCommandBuffer>		_freeCmdBuffers;
+	};
+}
+
+#endif
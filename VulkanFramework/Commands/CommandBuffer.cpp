@@ -114,6 +114,24 @@ namespace vfs
 		vkCmdDispatchIndirect(_cmdBuffer, buffer->getBufferHandle(), offset);
 	}
 
+	void CommandBuffer::drawIndexedIndirect(const BufferPtr& buffer, const VkDeviceSize offset, uint32_t drawCount, uint32_t stride)
+	{
+		vkCmdDrawIndexedIndirect(_cmdBuffer, buffer->getBufferHandle(), offset, drawCount, stride);
+	}
+
+	void CommandBuffer::drawIndexedIndirectCount(const BufferPtr& buffer, const VkDeviceSize offset,
+												 const BufferPtr& countBuffer, const VkDeviceSize countOffset,
+												 uint32_t maxDrawCount, uint32_t stride)
+	{
+		vkCmdDrawIndexedIndirectCount(_cmdBuffer, buffer->getBufferHandle(), offset,
+									  countBuffer->getBufferHandle(), countOffset, maxDrawCount, stride);
+	}
+
+	void CommandBuffer::fillBuffer(const BufferPtr& buffer, const VkDeviceSize offset, const VkDeviceSize size, uint32_t data)
+	{
+		vkCmdFillBuffer(_cmdBuffer, buffer->getBufferHandle(), offset, size, data);
+	}
+
 	void CommandBuffer::blitImage(const ImagePtr& srcImage, VkImageLayout srcImageLayout,
 								  const ImagePtr& dstImage, VkImageLayout dstImageLayout,
 								  const std::vector<VkImageBlit>& blits, VkFilter filter)
@@ -37,6 +37,11 @@ namespace vfs
 		void writeTimeStamp		(VkPipelineStageFlagBits stageFlag, const QueryPoolPtr& queryPool, uint32_t queryIndex);
 		void resetQueryPool		(const QueryPoolPtr& queryPool, uint32_t numQuery);
 		void dispatchIndirect	(const BufferPtr& buffer, const VkDeviceSize offset);
+		void drawIndexedIndirect(const BufferPtr& buffer, const VkDeviceSize offset, uint32_t drawCount, uint32_t stride);
+		void drawIndexedIndirectCount(const BufferPtr& buffer, const VkDeviceSize offset,
+									  const BufferPtr& countBuffer, const VkDeviceSize countOffset,
+									  uint32_t maxDrawCount, uint32_t stride);
+		void fillBuffer			(const BufferPtr& buffer, const VkDeviceSize offset, const VkDeviceSize size, uint32_t data);
 		void blitImage(const ImagePtr& srcImage, VkImageLayout srcImageLayout,
 					   const ImagePtr& dstImage, VkImageLayout dstImageLayout,
 					   const std::vector<VkImageBlit>& blits, VkFilter filter);
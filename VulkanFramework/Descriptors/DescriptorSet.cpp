@@ -87,6 +87,27 @@ namespace vfs
 		vkUpdateDescriptorSets(_device->getDeviceHandle(), 1, &writeSet, 0, nullptr);
 	}
 
+	void DescriptorSet::updateDynamicUniformBuffer(const BufferPtr& buffer,
+												   const uint64_t range,
+												   const uint32_t dstBinding)
+	{
+		VkDescriptorBufferInfo bufferInfo = {};
+		bufferInfo.buffer	= buffer->getBufferHandle();
+		bufferInfo.offset	= 0;
+		bufferInfo.range	= range;
+
+		VkWriteDescriptorSet writeSet = {};
+		writeSet.sType				= VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		writeSet.pNext				= nullptr;
+		writeSet.dstBinding			= dstBinding;
+		writeSet.dstSet				= _descriptorSet;
+		writeSet.descriptorCount	= 1;
+		writeSet.descriptorType		= VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+		writeSet.pBufferInfo		= &bufferInfo;
+
+		vkUpdateDescriptorSets(_device->getDeviceHandle(), 1, &writeSet, 0, nullptr);
+	}
+
 	void DescriptorSet::updateTexelBuffer(const BufferViewPtr& bufferView,
 										  const uint32_t dstBinding, 
 										  const uint32_t descCount,
@@ -108,12 +129,14 @@ namespace vfs
 
 	void DescriptorSet::updateImage(const std::vector<VkDescriptorImageInfo>& imageInfos,
 									const uint32_t dstBinding,
-									VkDescriptorType descType)
+									VkDescriptorType descType,
+									const uint32_t dstArrayElement)
 	{
 		VkWriteDescriptorSet writeSet = {};
 		writeSet.sType			 = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
 		writeSet.pNext			 = nullptr;
 		writeSet.dstBinding		 = dstBinding;
+		writeSet.dstArrayElement = dstArrayElement;
 		writeSet.dstSet			 = _descriptorSet;
 		writeSet.descriptorCount = static_cast<uint32_t>(imageInfos.size());
 		writeSet.descriptorType  = descType;
@@ -32,7 +32,12 @@ namespace vfs
 
 		void updateImage			(const std::vector<VkDescriptorImageInfo>& imageInfos,
 									 const uint32_t dstBinding,
-									 VkDescriptorType descType);
+									 VkDescriptorType descType,
+									 const uint32_t dstArrayElement = 0);
+		//! Bind given range of the buffer as dynamic uniform buffer, offset is given at bind time
+		void updateDynamicUniformBuffer(const BufferPtr& buffer,
+										const uint64_t range,
+										const uint32_t dstBinding);
 
 		inline void updateStorageBuffer(const std::vector<BufferPtr>& buffers, 
 										const uint32_t dstBinding, 
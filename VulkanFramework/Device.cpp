@@ -9,6 +9,7 @@
 #include <Common/Logger.h>
 #include <cassert>
 #include <set>
+#include <algorithm>
 
 constexpr const char* REQUIRED_EXTENSIONS[] = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
 constexpr const char* REQUIRED_LAYERS[]		= { "VK_LAYER_KHRONOS_validation"	};
@@ -194,14 +195,24 @@ namespace vfs
 
 		vkGetPhysicalDeviceProperties(_physicalDevice, &_physicalDeviceProperties);
 		vkGetPhysicalDeviceFeatures(_physicalDevice, &_physicalDeviceFeatures);
+
+		_descIndexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+		_descIndexingProperties.pNext = nullptr;
+		VkPhysicalDeviceProperties2 properties2 = {};
+		properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+		properties2.pNext = &_descIndexingProperties;
+		vkGetPhysicalDeviceProperties2(_physicalDevice, &properties2);
 		VFS_INFO << "Selected Physical Device : " << _physicalDeviceProperties.deviceName;
 		return true;
 	}
 
-	bool Device::initializeLogicalDevice(const std::vector<uint32_t>& queueFamilyIndices)
+	bool Device::initializeLogicalDevice(const std::vector<uint32_t>& queueFamilyIndices, uint32_t maxQueuesPerFamily)
 	{
-		constexpr float QUEUE_PRIORITY = 1.0f;
+		const std::vector<float> queuePriorities(maxQueuesPerFamily, 1.0f);
 		std::set<uint32_t> uniqueQueueFamilies(queueFamilyIndices.begin(), queueFamilyIndices.end());
+
+		std::vector<VkQueueFamilyProperties> queueFamilyProperties;
+		getQueueFamilyProperties(&queueFamilyProperties);
 		
 		std::vector<VkDeviceQueueCreateInfo> queueInfos;
 		queueInfos.reserve(uniqueQueueFamilies.size());
@@ -210,9 +221,9 @@ namespace vfs
 			VkDeviceQueueCreateInfo queueInfo = {};
 			queueInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
 			queueInfo.pNext = nullptr;
-			queueInfo.queueCount = 1;
+			queueInfo.queueCount = std::min(maxQueuesPerFamily, queueFamilyProperties[queueFamily].queueCount);
 			queueInfo.queueFamilyIndex = queueFamily;
-			queueInfo.pQueuePriorities = &QUEUE_PRIORITY;
+			queueInfo.pQueuePriorities = queuePriorities.data();
 			queueInfos.emplace_back(std::move(queueInfo));
 		}
 
@@ -222,22 +233,35 @@ namespace vfs
 		deviceFeatures.fragmentStoresAndAtomics				  = VK_TRUE;
 		deviceFeatures.geometryShader						  = VK_TRUE;
 		deviceFeatures.multiDrawIndirect					  = VK_TRUE;
+		deviceFeatures.drawIndirectFirstInstance			  = VK_TRUE;
 		deviceFeatures.fillModeNonSolid						  = VK_TRUE;
 		deviceFeatures.sampleRateShading					  = VK_TRUE;
 		deviceFeatures.multiViewport						  = VK_TRUE;
 		deviceFeatures.vertexPipelineStoresAndAtomics		  = VK_TRUE;
 		deviceFeatures.shaderTessellationAndGeometryPointSize = VK_TRUE;
+		// Block compressed scene textures are used only if the device supports them
+		deviceFeatures.textureCompressionBC					  = _physicalDeviceFeatures.textureCompressionBC;
 
 		// TODO(snowapril) : support for device feature control
-		VkPhysicalDeviceDescriptorIndexingFeatures descIndexingFeatures = {};
-		descIndexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
-		descIndexingFeatures.descriptorBindingPartiallyBound				= VK_TRUE;
-		descIndexingFeatures.descriptorBindingUniformBufferUpdateAfterBind	= VK_TRUE;
-		descIndexingFeatures.descriptorBindingUpdateUnusedWhilePending		= VK_TRUE;
+		// snowapril : promoted 1.2 features are enabled through one struct, it must not be chained
+		//			   together with VkPhysicalDeviceDescriptorIndexingFeatures and friends
+		VkPhysicalDeviceVulkan12Features vulkan12Features = {};
+		vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+		vulkan12Features.descriptorBindingPartiallyBound				= VK_TRUE;
+		vulkan12Features.descriptorBindingUniformBufferUpdateAfterBind	= VK_TRUE;
+		vulkan12Features.descriptorBindingUpdateUnusedWhilePending		= VK_TRUE;
+		// Textures of every scene live in one runtime sized array written while frames are in flight
+		vulkan12Features.descriptorBindingSampledImageUpdateAfterBind	= VK_TRUE;
+		vulkan12Features.runtimeDescriptorArray							= VK_TRUE;
+		vulkan12Features.shaderSampledImageArrayNonUniformIndexing		= VK_TRUE;
+		// Scenes loaded on the loader queue are handed to the graphics queue by timeline semaphore
+		vulkan12Features.timelineSemaphore								= VK_TRUE;
+		// Survivors of GPU culling are drawn with the count written by the culling shader
+		vulkan12Features.drawIndirectCount								= VK_TRUE;
 
 		VkDeviceCreateInfo deviceCreateInfo = {};
 		deviceCreateInfo.sType					= VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-		deviceCreateInfo.pNext					= &descIndexingFeatures;
+		deviceCreateInfo.pNext					= &vulkan12Features;
 		deviceCreateInfo.queueCreateInfoCount	= static_cast<uint32_t>(queueInfos.size());
 		deviceCreateInfo.pQueueCreateInfos		= queueInfos.data();
 		deviceCreateInfo.pEnabledFeatures		= &deviceFeatures;
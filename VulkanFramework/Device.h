@@ -20,7 +20,9 @@ namespace vfs
 	public:
 		void					destroyDevice				();
 		bool					initialize					(const char* appTitle);
-		bool					initializeLogicalDevice		(const std::vector<uint32_t>& queueFamilyIndices);
+		//! Create up to maxQueuesPerFamily queues of each family, so that threads can submit to separate queues
+		bool					initializeLogicalDevice		(const std::vector<uint32_t>& queueFamilyIndices,
+															 uint32_t maxQueuesPerFamily = 1);
 		bool					initializeMemoryAllocator	(void);
 		void					getQueueFamilyProperties	(std::vector<VkQueueFamilyProperties>* properties);
 
@@ -48,6 +50,11 @@ namespace vfs
 		{
 			return _physicalDeviceFeatures;
 		}
+		//! Limits of update-after-bind descriptors, which are lower than the plain per-stage limits
+		inline const VkPhysicalDeviceDescriptorIndexingProperties& getDescriptorIndexingProperty(void) const
+		{
+			return _descIndexingProperties;
+		}
 
 	private:	
 		bool initializeInstance			(const char* appTitle);
@@ -61,6 +68,7 @@ namespace vfs
 	private:
 		VkPhysicalDeviceProperties	_physicalDeviceProperties	{		0,	 	 };
 		VkPhysicalDeviceFeatures	_physicalDeviceFeatures		{		0,		 };
+		VkPhysicalDeviceDescriptorIndexingProperties _descIndexingProperties {};
 		VkInstance					_instance					{ VK_NULL_HANDLE };
 		VkPhysicalDevice			_physicalDevice				{ VK_NULL_HANDLE };
 		VkDevice					_device						{ VK_NULL_HANDLE };
@@ -8,12 +8,14 @@ namespace vfs
 {
 	class Buffer;
 	class BufferView;
+	class CommandBuffer;
 	class CommandPool;
 	class DescriptorPool;
 	class DescriptorSet;
 	class DescriptorSetLayout;
 	class Device;
 	class Fence;
+	class FrameUniformAllocator;
 	class Framebuffer;
 	class QueryPool;
 	class PipelineBase;
@@ -23,9 +25,13 @@ namespace vfs
 	class Queue;
 	class RenderPass;
 	class Sampler;
+	class SamplerCache;
 	class Image;
 	class ImageView;
 	class Semaphore;
+	class SubmissionScheduler;
+	class TimelineSemaphore;
+	class UploadManager;
 	class Window;
 
 	using BufferPtr				 = std::shared_ptr<Buffer>;
@@ -37,6 +43,7 @@ namespace vfs
 	using DevicePtr				 = std::shared_ptr<Device>;
 	using FencePtr				 = std::shared_ptr<Fence>;
 	using FramebufferPtr		 = std::shared_ptr<Framebuffer>;
+	using FrameUniformAllocatorPtr = std::shared_ptr<FrameUniformAllocator>;
 	using QueryPoolPtr			 = std::shared_ptr<QueryPool>;
 	using PipelineBasePtr		 = std::shared_ptr<PipelineBase>;
 	using PipelineLayoutPtr		 = std::shared_ptr<PipelineLayout>;
@@ -45,10 +52,14 @@ namespace vfs
 	using QueuePtr				 = std::shared_ptr<Queue>;
 	using RenderPassPtr			 = std::shared_ptr<RenderPass>;
 	using SamplerPtr			 = std::shared_ptr<Sampler>;
+	using SamplerCachePtr		 = std::shared_ptr<SamplerCache>;
 	using ImagePtr				 = std::shared_ptr<Image>;
 	using ImageViewPtr			 = std::shared_ptr<ImageView>;
 	using WindowPtr				 = std::shared_ptr<Window>;
 	using SemaphorePtr			 = std::shared_ptr<Semaphore>;
+	using SubmissionSchedulerPtr = std::shared_ptr<SubmissionScheduler>;
+	using TimelineSemaphorePtr	 = std::shared_ptr<TimelineSemaphore>;
+	using UploadManagerPtr		 = std::shared_ptr<UploadManager>;
 };
 
 #endif
\ No newline at end of file
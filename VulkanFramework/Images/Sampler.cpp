@@ -12,6 +12,11 @@ namespace vfs
 		assert(initialize(device, sampleMode, filter, mipmapLevel));
 	}
 
+	Sampler::Sampler(DevicePtr device, const VkSamplerCreateInfo& samplerInfo)
+	{
+		assert(initialize(device, samplerInfo));
+	}
+
 	Sampler::~Sampler()
 	{
 		destroySamplerHandler();
@@ -48,6 +53,12 @@ namespace vfs
 		samplerInfo.mipLodBias		 = 0.0;
 		samplerInfo.maxAnisotropy	 = 1.0;
 		
+		return initialize(device, samplerInfo);
+	}
+
+	bool Sampler::initialize(DevicePtr device, const VkSamplerCreateInfo& samplerInfo)
+	{
+		_device = device;
 		return vkCreateSampler(_device->getDeviceHandle(), &samplerInfo, nullptr, &_samplerHandle)
 			== VK_SUCCESS;
 	}
@@ -12,11 +12,13 @@ namespace vfs
 	public:
 		explicit Sampler() = default;
 		explicit Sampler(DevicePtr device, VkSamplerAddressMode sampleMode, VkFilter filter, float mipmapLevel);
+		explicit Sampler(DevicePtr device, const VkSamplerCreateInfo& samplerInfo);
 				~Sampler();
 
 	public:
 		void destroySamplerHandler (void);
 		bool initialize			 (DevicePtr device, VkSamplerAddressMode sampleMode, VkFilter filter, float maxLod);
+		bool initialize			 (DevicePtr device, const VkSamplerCreateInfo& samplerInfo);
 
 		inline VkSampler getSamplerHandle(void) const
 		{
@@ -0,0 +1,71 @@
+// Author : Jihong Shin (snowapril)
+
+#include <VulkanFramework/pch.h>
+#include <VulkanFramework/Images/SamplerCache.h>
+#include <VulkanFramework/Images/Sampler.h>
+#include <VulkanFramework/Device.h>
+
+namespace vfs
+{
+	SamplerCache::SamplerCache(DevicePtr device)
+	{
+		assert(initialize(device));
+	}
+
+	SamplerCache::~SamplerCache()
+	{
+		destroySamplerCache();
+	}
+
+	void SamplerCache::destroySamplerCache(void)
+	{
+		_samplers.clear();
+		_device.reset();
+	}
+
+	bool SamplerCache::initialize(DevicePtr device)
+	{
+		_device = device;
+		return true;
+	}
+
+	SamplerPtr SamplerCache::getSampler(const VkSamplerCreateInfo& samplerInfo)
+	{
+		for (const std::pair<VkSamplerCreateInfo, SamplerPtr>& cached : _samplers)
+		{
+			if (IsSameState(cached.first, samplerInfo))
+			{
+				return cached.second;
+			}
+		}
+
+		SamplerPtr sampler = std::make_shared<Sampler>();
+		if (!sampler->initialize(_device, samplerInfo))
+		{
+			return nullptr;
+		}
+		_samplers.emplace_back(samplerInfo, sampler);
+		_samplers.back().first.pNext = nullptr;
+		return sampler;
+	}
+
+	bool SamplerCache::IsSameState(const VkSamplerCreateInfo& lhs, const VkSamplerCreateInfo& rhs)
+	{
+		return lhs.flags					== rhs.flags					&&
+			   lhs.magFilter				== rhs.magFilter				&&
+			   lhs.minFilter				== rhs.minFilter				&&
+			   lhs.mipmapMode				== rhs.mipmapMode				&&
+			   lhs.addressModeU				== rhs.addressModeU				&&
+			   lhs.addressModeV				== rhs.addressModeV				&&
+			   lhs.addressModeW				== rhs.addressModeW				&&
+			   lhs.mipLodBias				== rhs.mipLodBias				&&
+			   lhs.anisotropyEnable			== rhs.anisotropyEnable			&&
+			   lhs.maxAnisotropy			== rhs.maxAnisotropy			&&
+			   lhs.compareEnable			== rhs.compareEnable			&&
+			   lhs.compareOp				== rhs.compareOp				&&
+			   lhs.minLod					== rhs.minLod					&&
+			   lhs.maxLod					== rhs.maxLod					&&
+			   lhs.borderColor				== rhs.borderColor				&&
+			   lhs.unnormalizedCoordinates	== rhs.unnormalizedCoordinates;
+	}
+}
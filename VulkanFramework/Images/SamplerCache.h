@@ -0,0 +1,38 @@
+// Author : Jihong Shin (snowapril)
+
+#if !defined(VULKAN_FRAMEWORK_SAMPLER_CACHE_H)
+#define VULKAN_FRAMEWORK_SAMPLER_CACHE_H
+
+#include <VulkanFramework/pch.h>
+
+namespace vfs
+{
+	//! Shares samplers between users requesting the same sampler state.
+	//! Scenes reference only a handful of distinct states, so lookup is linear.
+	class SamplerCache : NonCopyable
+	{
+	public:
+		explicit SamplerCache() = default;
+		explicit SamplerCache(DevicePtr device);
+				~SamplerCache();
+
+	public:
+		void		destroySamplerCache	(void);
+		bool		initialize			(DevicePtr device);
+		//! Returns cached sampler of the given state or creates new one. pNext chain is not compared.
+		SamplerPtr	getSampler			(const VkSamplerCreateInfo& samplerInfo);
+
+		inline size_t getNumSamplers(void) const
+		{
+			return _samplers.size();
+		}
+
+	private:
+		static bool IsSameState(const VkSamplerCreateInfo& lhs, const VkSamplerCreateInfo& rhs);
+
+		DevicePtr _device { nullptr };
+		std::vector<std::pair<VkSamplerCreateInfo, SamplerPtr>> _samplers;
+	};
+}
+
+#endif
@@ -9,9 +9,10 @@
 namespace vfs
 {
 	Queue::Queue(DevicePtr device,
-				 uint32_t familyIndex)
+				 uint32_t familyIndex,
+				 uint32_t queueIndex)
 	{
-		assert(initialize(device, familyIndex));
+		assert(initialize(device, familyIndex, queueIndex));
 	}
 	Queue::~Queue()
 	{
@@ -25,12 +26,13 @@ namespace vfs
 	}
 
 	bool Queue::initialize(DevicePtr device,
-						   uint32_t familyIndex)
+						   uint32_t familyIndex,
+						   uint32_t queueIndex)
 	{
 		_device = device;
 		_familyIndex = familyIndex;
 		
-		vkGetDeviceQueue(_device->getDeviceHandle(), _familyIndex, 0, &_queueHandle);
+		vkGetDeviceQueue(_device->getDeviceHandle(), _familyIndex, queueIndex, &_queueHandle);
 		return true;
 	}
 
@@ -13,11 +13,12 @@ namespace vfs
 	public:
 		explicit Queue() = default;
 		explicit Queue(DevicePtr device, 
-					   uint32_t familyIndex);
+					   uint32_t familyIndex,
+					   uint32_t queueIndex = 0);
 				~Queue();
 
 	public:
-		bool			initialize					(DevicePtr device, uint32_t familyIndex);
+		bool			initialize					(DevicePtr device, uint32_t familyIndex, uint32_t queueIndex = 0);
 		void			destroyQueue				(void);
 		void			submitCmdBuffer				(const std::vector<CommandBuffer>& cmdBuffers, 
 													 const Fence* fence);
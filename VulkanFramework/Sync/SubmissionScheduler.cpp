@@ -0,0 +1,204 @@
+// Author : Jihong Shin (snowapril)
+
+#include <VulkanFramework/pch.h>
+#include <VulkanFramework/Sync/SubmissionScheduler.h>
+#include <VulkanFramework/Device.h>
+#include <VulkanFramework/Queue.h>
+#include <Common/Logger.h>
+#include <algorithm>
+
+namespace vfs
+{
+	SubmissionScheduler::SubmissionScheduler(QueuePtr queue)
+	{
+		assert(initialize(queue));
+	}
+
+	SubmissionScheduler::~SubmissionScheduler()
+	{
+		destroySubmissionScheduler();
+	}
+
+	void SubmissionScheduler::destroySubmissionScheduler(void)
+	{
+		if (_timeline != nullptr)
+		{
+			// snowapril : deferred callbacks may free resources still used by enqueued submissions
+			wait(_lastValue);
+			collect();
+		}
+
+		_deferredRetires.clear();
+		_pendingSubmissions.clear();
+		_timeline.reset();
+		_queue.reset();
+		_lastValue = _submittedValue = _completedValue = 0;
+		_bLost = false;
+	}
+
+	bool SubmissionScheduler::initialize(QueuePtr queue)
+	{
+		_queue		= queue;
+		_timeline	= std::make_unique<TimelineSemaphore>();
+		return _timeline->initialize(_queue->getDevicePtr(), 0);
+	}
+
+	uint64_t SubmissionScheduler::enqueue(const std::vector<VkCommandBuffer>& cmdBuffers,
+										  const std::vector<VkSemaphore>& waitSemaphores,
+										  const std::vector<uint64_t>& waitValues,
+										  const std::vector<VkPipelineStageFlags>& waitStageMasks,
+										  const std::vector<VkSemaphore>& signalSemaphores,
+										  const std::vector<uint64_t>& signalValues)
+	{
+		assert(waitSemaphores.size() == waitValues.size() && waitSemaphores.size() == waitStageMasks.size());
+		assert(signalSemaphores.size() == signalValues.size());
+
+		PendingSubmission submission;
+		submission.cmdBuffers		= cmdBuffers;
+		submission.waitSemaphores	= waitSemaphores;
+		submission.waitValues		= waitValues;
+		submission.waitStageMasks	= waitStageMasks;
+		submission.signalSemaphores = signalSemaphores;
+		submission.signalValues		= signalValues;
+		submission.signalSemaphores.push_back(_timeline->getHandle());
+		submission.signalValues.push_back(++_lastValue);
+
+		_pendingSubmissions.emplace_back(std::move(submission));
+		return _lastValue;
+	}
+
+	uint64_t SubmissionScheduler::enqueue(const std::vector<VkCommandBuffer>& cmdBuffers)
+	{
+		return enqueue(cmdBuffers, {}, {}, {}, {}, {});
+	}
+
+	bool SubmissionScheduler::flush(void)
+	{
+		// snowapril : later values can not be signaled in order once a submission failed
+		if (_bLost)
+		{
+			return false;
+		}
+		if (_pendingSubmissions.empty())
+		{
+			return true;
+		}
+
+		// Timeline infos are filled first, submit infos point into the vector afterwards
+		const size_t numSubmissions = _pendingSubmissions.size();
+		std::vector<VkTimelineSemaphoreSubmitInfo> timelineInfos(numSubmissions);
+		std::vector<VkSubmitInfo> submitInfos(numSubmissions);
+		for (size_t i = 0; i < numSubmissions; ++i)
+		{
+			const PendingSubmission& submission = _pendingSubmissions[i];
+
+			VkTimelineSemaphoreSubmitInfo& timelineInfo = timelineInfos[i];
+			timelineInfo.sType						= VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+			timelineInfo.pNext						= nullptr;
+			timelineInfo.waitSemaphoreValueCount	= static_cast<uint32_t>(submission.waitValues.size());
+			timelineInfo.pWaitSemaphoreValues		= submission.waitValues.data();
+			timelineInfo.signalSemaphoreValueCount	= static_cast<uint32_t>(submission.signalValues.size());
+			timelineInfo.pSignalSemaphoreValues		= submission.signalValues.data();
+
+			VkSubmitInfo& submitInfo = submitInfos[i];
+			submitInfo.sType				= VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			submitInfo.pNext				= &timelineInfo;
+			submitInfo.commandBufferCount	= static_cast<uint32_t>(submission.cmdBuffers.size());
+			submitInfo.pCommandBuffers		= submission.cmdBuffers.data();
+			submitInfo.waitSemaphoreCount	= static_cast<uint32_t>(submission.waitSemaphores.size());
+			submitInfo.pWaitSemaphores		= submission.waitSemaphores.data();
+			submitInfo.pWaitDstStageMask	= submission.waitStageMasks.data();
+			submitInfo.signalSemaphoreCount = static_cast<uint32_t>(submission.signalSemaphores.size());
+			submitInfo.pSignalSemaphores	= submission.signalSemaphores.data();
+		}
+
+		const VkResult result = vkQueueSubmit(_queue->getQueueHandle(), static_cast<uint32_t>(numSubmissions),
+											  submitInfos.data(), VK_NULL_HANDLE);
+		_pendingSubmissions.clear();
+		if (result != VK_SUCCESS)
+		{
+			VFS_ERROR << "Failed to submit values up to " << _lastValue << " of the timeline ( VkResult " << result << " )";
+			_bLost = true;
+			return false;
+		}
+		_submittedValue = _lastValue;
+		return true;
+	}
+
+	uint64_t SubmissionScheduler::submit(const std::vector<VkCommandBuffer>& cmdBuffers)
+	{
+		const uint64_t value = enqueue(cmdBuffers);
+		flush();
+		return value;
+	}
+
+	bool SubmissionScheduler::isCompleted(uint64_t value)
+	{
+		if (value <= _completedValue)
+		{
+			return true;
+		}
+		// snowapril : values still pending on the CPU side can not be signaled, skip the query.
+		//			   Values of failed submissions never execute, so nothing is left to wait for
+		if (value > _submittedValue)
+		{
+			return _bLost;
+		}
+		pollCompletedValue();
+		return value <= _completedValue;
+	}
+
+	bool SubmissionScheduler::wait(uint64_t value, uint64_t timeout)
+	{
+		assert(value <= _lastValue); // snowapril : value must be returned by enqueue
+		if (value <= _completedValue)
+		{
+			return true;
+		}
+		// Values of failed submissions are never signaled, report instead of blocking on them
+		if (value > _submittedValue && !flush())
+		{
+			return false;
+		}
+		if (!_timeline->wait(value, timeout))
+		{
+			return false;
+		}
+		_completedValue = std::max(_completedValue, value);
+		return true;
+	}
+
+	void SubmissionScheduler::deferUntil(uint64_t value, RetireFn retireFunc)
+	{
+		// Kept sorted by value so that collect() stops at the first unsignaled one
+		auto iter = std::upper_bound(_deferredRetires.begin(), _deferredRetires.end(), value,
+			[](uint64_t lhs, const std::pair<uint64_t, RetireFn>& rhs) { return lhs < rhs.first; });
+		_deferredRetires.emplace(iter, value, std::move(retireFunc));
+	}
+
+	void SubmissionScheduler::collect(void)
+	{
+		if (_deferredRetires.empty())
+		{
+			return;
+		}
+
+		pollCompletedValue();
+		while (!_deferredRetires.empty() && isRetired(_deferredRetires.front().first))
+		{
+			RetireFn retireFunc = std::move(_deferredRetires.front().second);
+			_deferredRetires.pop_front();
+			retireFunc();
+		}
+	}
+
+	bool SubmissionScheduler::isRetired(uint64_t value) const
+	{
+		return value <= _completedValue || (_bLost && value > _submittedValue);
+	}
+
+	void SubmissionScheduler::pollCompletedValue(void)
+	{
+		_completedValue = std::max(_completedValue, _timeline->getCounterValue());
+	}
+}
@@ -0,0 +1,105 @@
+// Author : Jihong Shin (snowapril)
+
+#if !defined(VULKAN_FRAMEWORK_SUBMISSION_SCHEDULER_H)
+#define VULKAN_FRAMEWORK_SUBMISSION_SCHEDULER_H
+
+#include <VulkanFramework/pch.h>
+#include <VulkanFramework/Sync/TimelineSemaphore.h>
+#include <deque>
+#include <functional>
+#include <memory>
+
+namespace vfs
+{
+	//! Tracks every submission of one queue on a single timeline semaphore.
+	//! Enqueued command buffers are assigned the next value of the timeline, signaled by the GPU
+	//! once they are done, and reach the queue together in one vkQueueSubmit on flush().
+	//! Resources are released or reused after a value through deferred callbacks run by collect(),
+	//! so owners never wait on the CPU. Not thread safe, each submitting thread owns its scheduler.
+	class SubmissionScheduler : NonCopyable
+	{
+	public:
+		explicit SubmissionScheduler() = default;
+		explicit SubmissionScheduler(QueuePtr queue);
+				~SubmissionScheduler();
+
+		using RetireFn = std::function<void(void)>;
+
+	public:
+		void	 destroySubmissionScheduler	(void);
+		bool	 initialize					(QueuePtr queue);
+		//! Returns value signaled once the command buffers are done, values of binary semaphores are ignored.
+		//! Earlier values of this scheduler's own timeline may be waited, even if enqueued in the same flush
+		uint64_t enqueue					(const std::vector<VkCommandBuffer>& cmdBuffers,
+											 const std::vector<VkSemaphore>& waitSemaphores,
+											 const std::vector<uint64_t>& waitValues,
+											 const std::vector<VkPipelineStageFlags>& waitStageMasks,
+											 const std::vector<VkSemaphore>& signalSemaphores,
+											 const std::vector<uint64_t>& signalValues);
+		uint64_t enqueue					(const std::vector<VkCommandBuffer>& cmdBuffers);
+		//! Push every enqueued submission to the queue in enqueued order with a single call.
+		//! On failure the scheduler is lost, its unsubmitted values are never signaled and nothing is submitted anymore
+		bool	 flush						(void);
+		//! Enqueue and flush at once
+		uint64_t submit						(const std::vector<VkCommandBuffer>& cmdBuffers);
+		//! Values of failed submissions count as completed, they never execute and hold no resources
+		bool	 isCompleted				(uint64_t value);
+		//! Blocks until the value is signaled, flushes first if the value has not reached the queue yet.
+		//! Returns false without blocking for values of failed submissions
+		bool	 wait						(uint64_t value, uint64_t timeout = UINT64_MAX);
+		//! Callback is run by collect() once the value is signaled, in value order
+		void	 deferUntil					(uint64_t value, RetireFn retireFunc);
+		//! Polls progress of the GPU and runs callbacks of signaled values, never blocks
+		void	 collect					(void);
+
+		//! Value of the latest enqueued submission, zero is signaled from the beginning
+		inline uint64_t getLastValue(void) const
+		{
+			return _lastValue;
+		}
+		//! Value signaled by the GPU as of the last poll
+		inline uint64_t getCompletedValue(void) const
+		{
+			return _completedValue;
+		}
+		//! A flush failed, see flush()
+		inline bool isLost(void) const
+		{
+			return _bLost;
+		}
+		inline VkSemaphore getTimelineHandle(void) const
+		{
+			return _timeline->getHandle();
+		}
+		inline QueuePtr getQueue(void) const
+		{
+			return _queue;
+		}
+
+	private:
+		struct PendingSubmission
+		{
+			std::vector<VkCommandBuffer>		cmdBuffers;
+			std::vector<VkSemaphore>			waitSemaphores;
+			std::vector<uint64_t>				waitValues;
+			std::vector<VkPipelineStageFlags>	waitStageMasks;
+			std::vector<VkSemaphore>			signalSemaphores;	// Own timeline is always the last one
+			std::vector<uint64_t>				signalValues;
+		};
+
+		bool isRetired		   (uint64_t value) const;
+		void pollCompletedValue(void);
+
+	private:
+		QueuePtr								_queue			{ nullptr };
+		std::unique_ptr<TimelineSemaphore>		_timeline		{ nullptr };
+		std::vector<PendingSubmission>			_pendingSubmissions;
+		std::deque<std::pair<uint64_t, RetireFn>> _deferredRetires;
+		uint64_t								_lastValue		{ 0 };
+		uint64_t								_submittedValue	{ 0 };
+		uint64_t								_completedValue	{ 0 };
+		bool									_bLost			{ false };
+	};
+}
+
+#endif
@@ -0,0 +1,79 @@
+// Author : Jihong Shin (snowapril)
+
+#include <VulkanFramework/pch.h>
+#include <VulkanFramework/Device.h>
+#include <VulkanFramework/Sync/TimelineSemaphore.h>
+
+namespace vfs
+{
+	TimelineSemaphore::TimelineSemaphore(DevicePtr device, uint64_t initialValue)
+	{
+		assert(initialize(device, initialValue));
+	}
+
+	TimelineSemaphore::~TimelineSemaphore()
+	{
+		destroyTimelineSemaphore();
+	}
+
+	void TimelineSemaphore::destroyTimelineSemaphore(void)
+	{
+		if (_semaphore != VK_NULL_HANDLE)
+		{
+			vkDestroySemaphore(_device->getDeviceHandle(), _semaphore, nullptr);
+			_semaphore = VK_NULL_HANDLE;
+		}
+		_device.reset();
+	}
+
+	bool TimelineSemaphore::initialize(DevicePtr device, uint64_t initialValue)
+	{
+		_device = device;
+
+		VkSemaphoreTypeCreateInfo typeInfo = {};
+		typeInfo.sType			= VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+		typeInfo.pNext			= nullptr;
+		typeInfo.semaphoreType	= VK_SEMAPHORE_TYPE_TIMELINE;
+		typeInfo.initialValue	= initialValue;
+
+		VkSemaphoreCreateInfo semaphoreInfo = {};
+		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+		semaphoreInfo.pNext = &typeInfo;
+		semaphoreInfo.flags = 0;
+
+		if (vkCreateSemaphore(_device->getDeviceHandle(), &semaphoreInfo, nullptr, &_semaphore) != VK_SUCCESS)
+		{
+			return false;
+		}
+		return true;
+	}
+
+	uint64_t TimelineSemaphore::getCounterValue(void) const
+	{
+		uint64_t value{ 0 };
+		vkGetSemaphoreCounterValue(_device->getDeviceHandle(), _semaphore, &value);
+		return value;
+	}
+
+	bool TimelineSemaphore::wait(uint64_t value, uint64_t timeout) const
+	{
+		VkSemaphoreWaitInfo waitInfo = {};
+		waitInfo.sType			= VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+		waitInfo.pNext			= nullptr;
+		waitInfo.flags			= 0;
+		waitInfo.semaphoreCount = 1;
+		waitInfo.pSemaphores	= &_semaphore;
+		waitInfo.pValues		= &value;
+		return vkWaitSemaphores(_device->getDeviceHandle(), &waitInfo, timeout) == VK_SUCCESS;
+	}
+
+	bool TimelineSemaphore::signal(uint64_t value) const
+	{
+		VkSemaphoreSignalInfo signalInfo = {};
+		signalInfo.sType		= VK_STRUCTURE_TYPE_SEMAPHORE_SIGNAL_INFO;
+		signalInfo.pNext		= nullptr;
+		signalInfo.semaphore	= _semaphore;
+		signalInfo.value		= value;
+		return vkSignalSemaphore(_device->getDeviceHandle(), &signalInfo) == VK_SUCCESS;
+	}
+}
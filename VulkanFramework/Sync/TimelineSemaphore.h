@@ -0,0 +1,39 @@
+// Author : Jihong Shin (snowapril)
+
+#if !defined(VULKAN_FRAMEWORK_TIMELINE_SEMAPHORE)
+#define VULKAN_FRAMEWORK_TIMELINE_SEMAPHORE
+
+#include <VulkanFramework/pch.h>
+
+namespace vfs
+{
+	class Device;
+
+	//! Semaphore with monotonically increasing 64-bit payload (Vulkan 1.2 core).
+	//! Queues wait for and signal specific values, host can query and wait as well.
+	class TimelineSemaphore : NonCopyable
+	{
+	public:
+		explicit TimelineSemaphore() = default;
+		explicit TimelineSemaphore(DevicePtr device, uint64_t initialValue);
+				~TimelineSemaphore();
+
+	public:
+		void	 destroyTimelineSemaphore	(void);
+		bool	 initialize					(DevicePtr device, uint64_t initialValue);
+		uint64_t getCounterValue			(void) const;
+		bool	 wait						(uint64_t value, uint64_t timeout) const;
+		bool	 signal						(uint64_t value) const;
+
+		inline const VkSemaphore& getHandle(void) const
+		{
+			return _semaphore;
+		}
+
+	private:
+		DevicePtr	_device		{ nullptr };
+		VkSemaphore _semaphore	{ VK_NULL_HANDLE };
+	};
+}
+
+#endif
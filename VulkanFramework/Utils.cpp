@@ -18,4 +18,11 @@ namespace vfs
 		if (sampleCountLimit &  VK_SAMPLE_COUNT_2_BIT) return  VK_SAMPLE_COUNT_2_BIT;
 		return VK_SAMPLE_COUNT_1_BIT;
 	}
+
+	bool isFormatFeatureSupported(DevicePtr device, VkFormat format, VkFormatFeatureFlags features)
+	{
+		VkFormatProperties formatProperties = {};
+		vkGetPhysicalDeviceFormatProperties(device->getPhysicalDeviceHandle(), format, &formatProperties);
+		return (formatProperties.optimalTilingFeatures & features) == features;
+	}
 };
\ No newline at end of file
@@ -8,6 +8,8 @@
 namespace vfs
 {
 	VkSampleCountFlagBits getMaximumSampleCounts(DevicePtr device);
+	//! True if optimal tiling images of the format support every given feature
+	bool isFormatFeatureSupported(DevicePtr device, VkFormat format, VkFormatFeatureFlags features);
 };
 
 #endif
\ No newline at end of file